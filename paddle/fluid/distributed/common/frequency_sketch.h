@@ -0,0 +1,119 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace paddle {
+namespace distributed {
+
+// FrequencySketch estimates the access frequencies of the keys for the
+// TinyLFU admission, with a count-min sketch of 4 bit counters. A key is
+// counted by 4 counters in different words of the table, and its frequency
+// is the minimum of them, at most 15. The counters are halved after
+// 10 * capacity increments, so that the frequency reflects the recent
+// accesses.
+//
+// The table takes 8 bytes per capacity, and it is not thread safe.
+class FrequencySketch {
+ public:
+  static constexpr int kMaxFrequency = 15;
+
+  explicit FrequencySketch(size_t capacity = 0) { EnsureCapacity(capacity); }
+
+  void EnsureCapacity(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    if (size <= _table.size()) {
+      return;
+    }
+    _table.assign(size, 0);
+    _mask = size - 1;
+    _sample_size = 10 * std::max(capacity, static_cast<size_t>(1));
+    _additions = 0;
+  }
+
+  int Frequency(uint64_t key) const {
+    uint64_t hash = Spread(key);
+    int start = static_cast<int>(hash & 3) << 2;
+    int frequency = kMaxFrequency;
+    for (int i = 0; i < 4; ++i) {
+      uint64_t word = _table[IndexOf(hash, i)];
+      int count = static_cast<int>((word >> ((start + i) << 2)) & 0xF);
+      frequency = std::min(frequency, count);
+    }
+    return frequency;
+  }
+
+  void Increment(uint64_t key) {
+    uint64_t hash = Spread(key);
+    int start = static_cast<int>(hash & 3) << 2;
+    bool added = false;
+    for (int i = 0; i < 4; ++i) {
+      uint64_t& word = _table[IndexOf(hash, i)];
+      uint64_t mask = 0xFULL << ((start + i) << 2);
+      if ((word & mask) != mask) {
+        word += 1ULL << ((start + i) << 2);
+        added = true;
+      }
+    }
+    if (added && ++_additions >= _sample_size) {
+      Reset();
+    }
+  }
+
+  // Halves all the counters.
+  void Reset() {
+    size_t odd = 0;
+    for (auto& word : _table) {
+      odd += __builtin_popcountll(word & 0x1111111111111111ULL);
+      word = (word >> 1) & 0x7777777777777777ULL;
+    }
+    // The odd counters lose 0.5 each, and a key is counted 4 times.
+    _additions = (_additions - std::min(_additions, odd / 4)) / 2;
+  }
+
+ private:
+  static uint64_t Spread(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+  }
+
+  size_t IndexOf(uint64_t hash, int i) const {
+    static const uint64_t kSeeds[] = {0xc3a5c85c97cb3127ULL,
+                                      0xb492b66fbe98f273ULL,
+                                      0x9ae16a3b2f90404fULL,
+                                      0xcbf29ce484222325ULL};
+    uint64_t h = (hash + kSeeds[i]) * kSeeds[i];
+    h += h >> 32;
+    return static_cast<size_t>(h) & _mask;
+  }
+
+  std::vector<uint64_t> _table{0};
+  size_t _mask = 0;
+  size_t _sample_size = 10;
+  size_t _additions = 0;
+};
+
+}  // namespace distributed
+}  // namespace paddle
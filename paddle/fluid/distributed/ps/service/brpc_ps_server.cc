@@ -618,6 +618,9 @@ int32_t BrpcPsService::LoadOneTable(Table *table,
         "PsRequestMessage.datas is requeired at least 2 for path & load_param");
     return -1;
   }
+  // the pushes merged before the load must not be updated into the values
+  // loaded
+  table->Flush();
   if (table->Load(request.params(0), request.params(1)) != 0) {
     set_response_code(response, -1, "table load failed");
     return -1;
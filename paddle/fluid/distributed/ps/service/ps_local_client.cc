@@ -47,6 +47,7 @@ int32_t PsLocalClient::Initialize() {
                                            const std::string& epoch,
                                            const std::string& mode) {
   auto* table_ptr = GetTable(table_id);
+  table_ptr->Flush();
   table_ptr->Load(epoch, mode);
   return done();
 }
@@ -153,6 +153,9 @@ class ValueAccessor {
   virtual std::string ParseToString(const float* value, int param) = 0;
   //  parse value from string, used to load model
   virtual int32_t ParseFromString(const std::string& data, float* value) = 0;
+  // the number of the leading floats saved in the binary format, the fields
+  // kept by ParseToString
+  virtual size_t SaveDim(const float* value UNUSED, size_t dim) { return dim; }
 
   virtual FsDataConverter Converter(int param) {
     FsDataConverter data_convert;
@@ -247,6 +247,13 @@ int32_t CtrCommonAccessor::Merge(float** update_values,
 int32_t CtrCommonAccessor::Update(float** update_values,
                                   const float** push_values,
                                   size_t num) {
+  // the embedx are updated in batches by the vectorized sgd kernels
+  const size_t kBatchSize = 64;
+  float* embedx_w[kBatchSize];
+  float* embedx_g2sum[kBatchSize];
+  const float* embedx_g[kBatchSize];
+  float embedx_scale[kBatchSize];
+  size_t batch_num = 0;
   for (size_t value_item = 0; value_item < num; ++value_item) {
     float* update_value = update_values[value_item];
     const float* push_value = push_values[value_item];
@@ -271,11 +278,16 @@ int32_t CtrCommonAccessor::Update(float** update_values,
         update_value + common_feature_value.EmbedG2SumIndex(),
         push_value + CtrCommonPushValue::EmbedGIndex(),
         push_show);
-    _embedx_sgd_rule->UpdateValue(
-        update_value + common_feature_value.EmbedxWIndex(),
-        update_value + common_feature_value.EmbedxG2SumIndex(),
-        push_value + CtrCommonPushValue::EmbedxGIndex(),
-        push_show);
+    embedx_w[batch_num] = update_value + common_feature_value.EmbedxWIndex();
+    embedx_g2sum[batch_num] =
+        update_value + common_feature_value.EmbedxG2SumIndex();
+    embedx_g[batch_num] = push_value + CtrCommonPushValue::EmbedxGIndex();
+    embedx_scale[batch_num] = push_show;
+    if (++batch_num == kBatchSize || value_item + 1 == num) {
+      _embedx_sgd_rule->UpdateValueBatch(
+          embedx_w, embedx_g2sum, embedx_g, embedx_scale, batch_num);
+      batch_num = 0;
+    }
   }
   return 0;
 }
@@ -342,5 +354,16 @@ int CtrCommonAccessor::ParseFromString(const std::string& str, float* value) {
   return ret;
 }
 
+size_t CtrCommonAccessor::SaveDim(const float* v, size_t dim) {
+  auto show = common_feature_value.Show(const_cast<float*>(v));
+  auto click = common_feature_value.Click(const_cast<float*>(v));
+  auto score = ShowClickScore(show, click);
+  size_t embedx_index = common_feature_value.EmbedxWIndex();
+  if (score >= _config.embedx_threshold() && dim > embedx_index) {
+    return dim;
+  }
+  return embedx_index;
+}
+
 }  // namespace distributed
 }  // namespace paddle
@@ -386,5 +386,16 @@ int CtrDoubleAccessor::ParseFromString(const std::string& str, float* value) {
   return str_len + 2;
 }
 
+size_t CtrDoubleAccessor::SaveDim(const float* v, size_t dim) {
+  auto show = CtrDoubleFeatureValue::Show(const_cast<float*>(v));
+  auto click = CtrDoubleFeatureValue::Click(const_cast<float*>(v));
+  auto score = ShowClickScore(show, click);
+  size_t embedx_index = CtrDoubleFeatureValue::EmbedxG2SumIndex();
+  if (score >= _config.embedx_threshold() && dim > embedx_index) {
+    return dim;
+  }
+  return embedx_index;
+}
+
 }  // namespace distributed
 }  // namespace paddle
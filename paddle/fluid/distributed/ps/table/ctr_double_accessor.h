@@ -199,6 +199,7 @@ class CtrDoubleAccessor : public ValueAccessor {
                          size_t num);
   std::string ParseToString(const float* value, int param) override;
   int32_t ParseFromString(const std::string& str, float* v) override;
+  size_t SaveDim(const float* value, size_t dim) override;
   virtual bool CreateValue(int type, const float* value);
   // 这个接口目前只用来取show
   float GetField(float* value, const std::string& name) override {
@@ -341,6 +341,17 @@ int CtrDymfAccessor::ParseFromString(const std::string& str, float* value) {
   return ret;
 }
 
+size_t CtrDymfAccessor::SaveDim(const float* v, size_t dim) {
+  auto show = common_feature_value.Show(const_cast<float*>(v));
+  auto click = common_feature_value.Click(const_cast<float*>(v));
+  auto score = ShowClickScore(show, click);
+  size_t embedx_index = common_feature_value.EmbedxG2SumIndex();
+  if (score >= _config.embedx_threshold() && dim > embedx_index) {
+    return dim;
+  }
+  return embedx_index;
+}
+
 bool CtrDymfAccessor::SaveMemCache(float* value,
                                    int param,
                                    double global_cache_threshold,
@@ -0,0 +1,390 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "glog/logging.h"
+
+namespace paddle {
+namespace distributed {
+
+// The value of a feature stored inline in the records of
+// FlatSparseTableShard. The floats follow the header, and the size can be
+// changed up to the capacity without moving the value, like the resize of
+// FixedFeatureValue the new floats are zeros.
+class FlatFeatureValue {
+ public:
+  float* data() { return reinterpret_cast<float*>(this + 1); }
+  size_t size() { return _size; }
+  size_t capacity() { return _capacity; }
+  void resize(size_t size) {
+    CHECK_LE(size, _capacity) << "FlatFeatureValue can not be resized to "
+                              << size << " beyond its capacity";
+    if (size > _size) {
+      memset(data() + _size, 0, (size - _size) * sizeof(float));
+    }
+    _size = static_cast<uint32_t>(size);
+  }
+  void shrink_to_fit() {}
+
+ private:
+  template <class KEY>
+  friend struct FlatSparseTableShard;
+
+  uint32_t _size;
+  uint32_t _capacity;
+};
+
+// FlatSparseTableShard has the same interface as SparseTableShard, but keeps
+// the keys and the values of value_capacity floats together in records,
+// instead of pointing to separately allocated FixedFeatureValues. The records
+// are carved from 1MB slabs aligned to the cache line, and the records of at
+// most 64 bytes do not cross the cache lines.
+//
+// The index is an open addressing table of one control byte and one record
+// number per slot. The control byte holds 7 bits of the hash of a full slot,
+// and the slots are probed 16 at a time by comparing the control bytes with
+// SSE2, so that a lookup usually touches one group of control bytes and the
+// record of the key. The records never move when the index grows, so the
+// value pointers stay valid until the key is erased.
+//
+// set_value_capacity must be called before the first insertion.
+template <class KEY>
+struct alignas(64) FlatSparseTableShard {
+ public:
+  typedef FlatFeatureValue value_type;
+
+  struct iterator {
+    FlatSparseTableShard* shard;
+    size_t slot;
+    friend bool operator==(const iterator& a, const iterator& b) {
+      return a.slot == b.slot;
+    }
+    friend bool operator!=(const iterator& a, const iterator& b) {
+      return a.slot != b.slot;
+    }
+    const KEY& key() const { return *shard->record_key(shard->_slots[slot]); }
+    FlatFeatureValue& value() const { return *value_ptr(); }
+    FlatFeatureValue* value_ptr() const {
+      return shard->record_value(shard->_slots[slot]);
+    }
+    iterator& operator++() {
+      slot = shard->next_full_slot(slot + 1);
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator ret = *this;
+      ++*this;
+      return ret;
+    }
+  };
+
+  FlatSparseTableShard() {}
+  FlatSparseTableShard(const FlatSparseTableShard&) = delete;
+  FlatSparseTableShard& operator=(const FlatSparseTableShard&) = delete;
+  ~FlatSparseTableShard() { clear(); }
+
+  void set_value_capacity(size_t capacity) {
+    CHECK_EQ(_num_records, 0U)
+        << "The value capacity should be set before the first insertion";
+    _value_capacity = capacity;
+    size_t record_size =
+        kValueOffset + sizeof(FlatFeatureValue) + capacity * sizeof(float);
+    _record_size = kCacheLineSize;
+    while (_record_size / 2 >= record_size) {
+      _record_size /= 2;
+    }
+    _record_size =
+        (record_size + _record_size - 1) / _record_size * _record_size;
+    _slab_shift = 0;
+    while ((_record_size << (_slab_shift + 1)) <= kSlabSize) {
+      ++_slab_shift;
+    }
+  }
+  size_t value_capacity() { return _value_capacity; }
+  void set_max_load_factor(float x) {
+    _max_load_factor = std::min(std::max(x, 0.1f), kMaxLoadFactor);
+  }
+
+  bool empty() { return _size == 0; }
+  size_t size() { return _size; }
+  // The bytes of the index and the records, for the memory statistics.
+  size_t memory_size() {
+    return _slabs.size() * (_record_size << _slab_shift) + _ctrl.capacity() +
+           _slots.capacity() * sizeof(uint32_t) +
+           _free_records.capacity() * sizeof(uint32_t);
+  }
+
+  void clear() {
+    for (char* slab : _slabs) {
+      free(slab);
+    }
+    _slabs.clear();
+    _free_records.clear();
+    _num_records = 0;
+    std::vector<uint8_t>().swap(_ctrl);
+    std::vector<uint32_t>().swap(_slots);
+    _capacity = 0;
+    _size = 0;
+    _growth_left = 0;
+  }
+
+  iterator begin() { return {this, next_full_slot(0)}; }
+  iterator end() { return {this, _capacity}; }
+  iterator find(const KEY& key) {
+    if (_size == 0) {
+      return end();
+    }
+    size_t hash = Hash(key);
+    uint8_t h2 = static_cast<uint8_t>(hash & kHashMask);
+    size_t mask = _capacity - 1;
+    size_t pos = (hash >> 7) & mask;
+    for (size_t step = kGroupWidth;; step += kGroupWidth) {
+      for (uint32_t match = MatchByte(&_ctrl[pos], h2); match != 0;
+           match &= match - 1) {
+        size_t slot = (pos + __builtin_ctz(match)) & mask;
+        if (*record_key(_slots[slot]) == key) {
+          return {this, slot};
+        }
+      }
+      if (MatchByte(&_ctrl[pos], kEmpty) != 0) {
+        return end();
+      }
+      pos = (pos + step) & mask;
+    }
+  }
+  FlatFeatureValue& operator[](const KEY& key) {
+    return emplace(key).first.value();
+  }
+  std::pair<iterator, bool> emplace(const KEY& key) {
+    auto it = find(key);
+    if (it != end()) {
+      return {it, false};
+    }
+    if (_growth_left == 0) {
+      if (_capacity == 0) {
+        rehash(kGroupWidth);
+      } else if (_size < max_size(_capacity) / 2) {
+        // Mostly erased slots, drop them in place.
+        rehash(_capacity);
+      } else {
+        rehash(_capacity * 2);
+      }
+    }
+    size_t hash = Hash(key);
+    size_t slot = find_insert_slot(hash);
+    if (_ctrl[slot] == kEmpty) {
+      --_growth_left;
+    }
+    set_ctrl(slot, static_cast<uint8_t>(hash & kHashMask));
+    _slots[slot] = acquire_record(key);
+    ++_size;
+    return {{this, slot}, true};
+  }
+  iterator erase(iterator it) {
+    _free_records.push_back(_slots[it.slot]);
+    set_ctrl(it.slot, kDeleted);
+    --_size;
+    return {this, next_full_slot(it.slot + 1)};
+  }
+  size_t erase(const KEY& key) {
+    auto it = find(key);
+    if (it == end()) {
+      return 0;
+    }
+    erase(it);
+    return 1;
+  }
+
+ private:
+  static constexpr size_t kGroupWidth = 16;
+  static constexpr size_t kCacheLineSize = 64;
+  static constexpr size_t kSlabSize = 1 << 20;
+  static constexpr size_t kHashMask = 0x7F;
+  static constexpr uint8_t kEmpty = 0x80;
+  static constexpr uint8_t kDeleted = 0xFE;
+  static constexpr float kMaxLoadFactor = 0.875f;
+  // The value follows the key in a record.
+  static constexpr size_t kValueOffset =
+      (sizeof(KEY) + alignof(FlatFeatureValue) - 1) /
+      alignof(FlatFeatureValue) * alignof(FlatFeatureValue);
+
+  static size_t Hash(const KEY& key) {
+    // The finalizer of MurmurHash3, since the keys of a shard share the same
+    // remainder of the shard number.
+    uint64_t h = static_cast<uint64_t>(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return static_cast<size_t>(h);
+  }
+
+  // Bit i of the result is set if ctrl[i] == b, for the group of kGroupWidth
+  // control bytes starting at ctrl.
+  static uint32_t MatchByte(const uint8_t* ctrl, uint8_t b) {
+#ifdef __SSE2__
+    __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+    return static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(b)))));
+#else
+    uint32_t match = 0;
+    for (size_t i = 0; i < kGroupWidth; ++i) {
+      match |= static_cast<uint32_t>(ctrl[i] == b) << i;
+    }
+    return match;
+#endif
+  }
+
+  // The empty and the deleted control bytes have the high bit set.
+  static uint32_t MatchEmptyOrDeleted(const uint8_t* ctrl) {
+#ifdef __SSE2__
+    __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+    return static_cast<uint32_t>(_mm_movemask_epi8(group));
+#else
+    uint32_t match = 0;
+    for (size_t i = 0; i < kGroupWidth; ++i) {
+      match |= static_cast<uint32_t>(ctrl[i] >> 7) << i;
+    }
+    return match;
+#endif
+  }
+
+  size_t max_size(size_t capacity) {
+    return std::min(capacity - 1,
+                    static_cast<size_t>(capacity * _max_load_factor));
+  }
+
+  size_t next_full_slot(size_t slot) {
+    while (slot < _capacity && (_ctrl[slot] & kEmpty) != 0) {
+      ++slot;
+    }
+    return slot;
+  }
+
+  // The control bytes of the first group are mirrored after the last slot,
+  // so that a group can be loaded at any slot.
+  void set_ctrl(size_t slot, uint8_t h) {
+    _ctrl[slot] = h;
+    if (slot < kGroupWidth) {
+      _ctrl[_capacity + slot] = h;
+    }
+  }
+
+  size_t find_insert_slot(size_t hash) {
+    size_t mask = _capacity - 1;
+    size_t pos = (hash >> 7) & mask;
+    for (size_t step = kGroupWidth;; step += kGroupWidth) {
+      uint32_t match = MatchEmptyOrDeleted(&_ctrl[pos]);
+      if (match != 0) {
+        return (pos + __builtin_ctz(match)) & mask;
+      }
+      pos = (pos + step) & mask;
+    }
+  }
+
+  // Rebuilds the index with capacity slots, the records are not moved.
+  void rehash(size_t capacity) {
+    std::vector<uint8_t> old_ctrl(capacity + kGroupWidth, kEmpty);
+    std::vector<uint32_t> old_slots(capacity, 0);
+    old_ctrl.swap(_ctrl);
+    old_slots.swap(_slots);
+    size_t old_capacity = _capacity;
+    _capacity = capacity;
+    for (size_t i = 0; i < old_capacity; ++i) {
+      if ((old_ctrl[i] & kEmpty) == 0) {
+        size_t hash = Hash(*record_key(old_slots[i]));
+        size_t slot = find_insert_slot(hash);
+        set_ctrl(slot, static_cast<uint8_t>(hash & kHashMask));
+        _slots[slot] = old_slots[i];
+      }
+    }
+    _growth_left = max_size(_capacity) - _size;
+  }
+
+  char* record(uint32_t index) {
+    return _slabs[index >> _slab_shift] +
+           (index & ((1U << _slab_shift) - 1)) * _record_size;
+  }
+  KEY* record_key(uint32_t index) {
+    return reinterpret_cast<KEY*>(record(index));
+  }
+  FlatFeatureValue* record_value(uint32_t index) {
+    return reinterpret_cast<FlatFeatureValue*>(record(index) + kValueOffset);
+  }
+
+  uint32_t acquire_record(const KEY& key) {
+    uint32_t index;
+    if (!_free_records.empty()) {
+      index = _free_records.back();
+      _free_records.pop_back();
+    } else {
+      if ((_num_records >> _slab_shift) == _slabs.size()) {
+        void* slab = nullptr;
+        CHECK_EQ(posix_memalign(
+                     &slab, kCacheLineSize, _record_size << _slab_shift),
+                 0)
+            << "Fail to allocate the slab of FlatSparseTableShard";
+        _slabs.push_back(static_cast<char*>(slab));
+      }
+      index = _num_records++;
+    }
+    *record_key(index) = key;
+    FlatFeatureValue* value = record_value(index);
+    value->_size = 0;
+    value->_capacity = static_cast<uint32_t>(_value_capacity);
+    return index;
+  }
+
+  size_t _value_capacity = 0;
+  size_t _record_size = kCacheLineSize;
+  size_t _slab_shift = 0;
+  std::vector<char*> _slabs;
+  uint32_t _num_records = 0;
+  std::vector<uint32_t> _free_records;
+
+  // kEmpty, kDeleted or 7 bits of the hash of the slots
+  std::vector<uint8_t> _ctrl;
+  std::vector<uint32_t> _slots;
+  size_t _capacity = 0;
+  size_t _size = 0;
+  // The empty slots which can be filled before the index grows.
+  size_t _growth_left = 0;
+  float _max_load_factor = kMaxLoadFactor;
+};
+
+template <class KEY>
+constexpr size_t FlatSparseTableShard<KEY>::kGroupWidth;
+template <class KEY>
+constexpr uint8_t FlatSparseTableShard<KEY>::kEmpty;
+template <class KEY>
+constexpr uint8_t FlatSparseTableShard<KEY>::kDeleted;
+template <class KEY>
+constexpr float FlatSparseTableShard<KEY>::kMaxLoadFactor;
+
+}  // namespace distributed
+}  // namespace paddle
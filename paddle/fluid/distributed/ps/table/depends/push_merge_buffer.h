@@ -0,0 +1,204 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+
+namespace paddle {
+namespace distributed {
+
+// Merges the update values pushed to a shard of MemorySparseTable by the
+// key, so that a key pushed by many workers in a window is updated once.
+//
+// Add is called by the push threads concurrently. A key is inserted into an
+// open addressing table by a CAS on its slot without a lock, and the value
+// pushed again is merged into the slot under the spin lock of the slot. The
+// buffer is double buffered: Drain switches Add to the other table, waits
+// for the Adds still on the old one, then passes its merged values to the
+// caller, so the pushes are never blocked by the updates.
+class PushMergeBuffer {
+ public:
+  // Merges the update value other into value.
+  typedef std::function<void(float* value, const float* other)> MergeFunc;
+
+  PushMergeBuffer(size_t max_key_num, size_t value_dim, MergeFunc merge_func)
+      : _max_key_num(max_key_num),
+        _value_dim(value_dim),
+        _merge_func(std::move(merge_func)) {
+    // at most half of the slots are used to keep the probes short
+    _capacity = 1;
+    while (_capacity < max_key_num * 2) {
+      _capacity *= 2;
+    }
+    for (auto& table : _tables) {
+      table.keys.reset(new std::atomic<uint64_t>[_capacity]);
+      table.states.reset(new std::atomic<uint32_t>[_capacity]);
+      table.slots.reset(new uint32_t[_capacity]);
+      table.values.resize(_capacity * value_dim);
+      for (size_t i = 0; i < _capacity; ++i) {
+        table.keys[i].store(kEmptyKey, std::memory_order_relaxed);
+        table.states[i].store(kSlotInit, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Adds the update value of the key. Returns false if the buffer is full,
+  // then the caller should update the key directly.
+  bool Add(uint64_t key, const float* value) {
+    if (key == kEmptyKey) {
+      return false;
+    }
+    Table* table = nullptr;
+    while (true) {
+      table = &_tables[_active.load()];
+      table->writers.fetch_add(1);
+      if (table == &_tables[_active.load()]) {
+        break;
+      }
+      table->writers.fetch_sub(1);
+    }
+    bool added = AddToTable(table, key, value);
+    table->writers.fetch_sub(1);
+    if (added) {
+      _added_num.fetch_add(1, std::memory_order_relaxed);
+    }
+    return added;
+  }
+
+  // Calls func(keys, values, num) with the keys added since the last Drain
+  // and their merged values, and returns num. The values can be modified by
+  // func. Drain can be called concurrently with Add.
+  template <class Func>
+  size_t Drain(Func&& func) {
+    std::lock_guard<std::mutex> guard(_drain_mutex);
+    int old_active = _active.load();
+    _active.store(old_active ^ 1);
+    Table& table = _tables[old_active];
+    while (table.writers.load() > 0) {
+      std::this_thread::yield();
+    }
+    size_t num = table.size.load();
+    if (num == 0) {
+      return 0;
+    }
+    _drain_keys.resize(num);
+    _drain_values.resize(num);
+    for (size_t i = 0; i < num; ++i) {
+      uint32_t slot = table.slots[i];
+      _drain_keys[i] = table.keys[slot].load(std::memory_order_relaxed);
+      _drain_values[i] = table.values.data() + slot * _value_dim;
+    }
+    func(_drain_keys.data(), _drain_values.data(), num);
+    for (size_t i = 0; i < num; ++i) {
+      uint32_t slot = table.slots[i];
+      table.keys[slot].store(kEmptyKey, std::memory_order_relaxed);
+      table.states[slot].store(kSlotInit, std::memory_order_relaxed);
+    }
+    table.size.store(0);
+    _drained_num.fetch_add(num, std::memory_order_relaxed);
+    return num;
+  }
+
+  // The number of the values added and the number of the merged values
+  // passed to Drain.
+  uint64_t AddedNum() const { return _added_num.load(); }
+  uint64_t DrainedNum() const { return _drained_num.load(); }
+
+ private:
+  static const uint64_t kEmptyKey = UINT64_MAX;
+  // the states of a slot
+  static const uint32_t kSlotInit = 0;    // the value is being initialized
+  static const uint32_t kSlotReady = 1;   // the value can be merged
+  static const uint32_t kSlotLocked = 2;  // the value is being merged
+
+  struct Table {
+    std::unique_ptr<std::atomic<uint64_t>[]> keys;
+    std::unique_ptr<std::atomic<uint32_t>[]> states;
+    // the slots in the order of insertion, the first size ones are used
+    std::unique_ptr<uint32_t[]> slots;
+    std::vector<float> values;
+    std::atomic<uint32_t> size{0};
+    // the number of the Adds on the table
+    std::atomic<int> writers{0};
+  };
+
+  bool AddToTable(Table* table, uint64_t key, const float* value) {
+    size_t mask = _capacity - 1;
+    size_t slot = (key * 0x9E3779B97F4A7C15ULL >> 17) & mask;
+    for (size_t probe = 0; probe < _capacity; ++probe) {
+      uint64_t slot_key = table->keys[slot].load(std::memory_order_acquire);
+      if (slot_key == kEmptyKey) {
+        if (table->size.load(std::memory_order_relaxed) >= _max_key_num) {
+          return false;
+        }
+        if (table->keys[slot].compare_exchange_strong(
+                slot_key, key, std::memory_order_acq_rel)) {
+          memcpy(table->values.data() + slot * _value_dim,
+                 value,
+                 _value_dim * sizeof(float));
+          table->slots[table->size.fetch_add(1)] = slot;
+          table->states[slot].store(kSlotReady, std::memory_order_release);
+          return true;
+        }
+        // slot_key is the key inserted by another Add
+      }
+      if (slot_key == key) {
+        MergeToSlot(table, slot, value);
+        return true;
+      }
+      slot = (slot + 1) & mask;
+    }
+    return false;
+  }
+
+  void MergeToSlot(Table* table, size_t slot, const float* value) {
+    std::atomic<uint32_t>& state = table->states[slot];
+    uint32_t expected = kSlotReady;
+    while (!state.compare_exchange_weak(
+        expected, kSlotLocked, std::memory_order_acquire)) {
+      expected = kSlotReady;
+      std::this_thread::yield();
+    }
+    _merge_func(table->values.data() + slot * _value_dim, value);
+    state.store(kSlotReady, std::memory_order_release);
+  }
+
+  size_t _max_key_num;
+  size_t _value_dim;
+  size_t _capacity;
+  MergeFunc _merge_func;
+  Table _tables[2];
+  // the index of the table used by Add
+  std::atomic<int> _active{0};
+  std::mutex _drain_mutex;
+  std::vector<uint64_t> _drain_keys;
+  std::vector<float*> _drain_values;
+  std::atomic<uint64_t> _added_num{0};
+  std::atomic<uint64_t> _drained_num{0};
+};
+
+}  // namespace distributed
+}  // namespace paddle
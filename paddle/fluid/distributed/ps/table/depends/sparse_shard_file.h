@@ -0,0 +1,291 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+#include "snappy.h"
+
+namespace paddle {
+namespace distributed {
+
+// The binary file of a local shard saved by MemorySparseTable with
+// TableParameter.save_binary:
+//
+//   block 0 | block 1 | ... | index | footer
+//
+// The keys are in ascending order, and every kKeysPerBlock keys with their
+// values form a block compressed by snappy. A block is stored by column:
+// the keys, the dims of the values, then for each i the i-th floats of the
+// values longer than i, so that the same fields of the values are compressed
+// together. The index has a SparseShardFileBlock for each block, which
+// locates a key by binary search, and the footer locates the index.
+struct SparseShardFileBlock {
+  uint64_t first_key;
+  uint64_t last_key;
+  uint64_t offset;
+  uint32_t size;  // compressed size
+  uint32_t key_num;
+};
+
+struct SparseShardFileFooter {
+  uint64_t index_offset;
+  uint64_t block_num;
+  uint64_t key_num;
+  uint64_t magic;
+};
+
+static_assert(sizeof(SparseShardFileBlock) == 32,
+              "SparseShardFileBlock should not be padded");
+static_assert(sizeof(SparseShardFileFooter) == 32,
+              "SparseShardFileFooter should not be padded");
+
+static const uint64_t kSparseShardFileMagic = 0x31305346534c4450ULL;
+
+class SparseShardFileWriter {
+ public:
+  static const uint32_t kKeysPerBlock = 4096;
+  // Writes the bytes to the file, returns 0 if succeeded.
+  typedef std::function<int(const char*, size_t)> WriteFunc;
+
+  explicit SparseShardFileWriter(WriteFunc write_func)
+      : _write_func(std::move(write_func)) {}
+
+  // Adds the value of the key, which is greater than the keys added before.
+  // Returns 0 if succeeded.
+  int Add(uint64_t key, const float* value, uint32_t dim) {
+    CHECK(_keys.empty() || key > _keys.back());
+    CHECK(_index.empty() || key > _index.back().last_key);
+    _keys.push_back(key);
+    _dims.push_back(dim);
+    _values.insert(_values.end(), value, value + dim);
+    if (_keys.size() == kKeysPerBlock) {
+      return FlushBlock();
+    }
+    return 0;
+  }
+
+  // Writes the last block, the index and the footer. Returns 0 if succeeded.
+  int Finish() {
+    if (!_keys.empty() && FlushBlock() != 0) {
+      return -1;
+    }
+    SparseShardFileFooter footer;
+    footer.index_offset = _offset;
+    footer.block_num = _index.size();
+    footer.key_num = _key_num;
+    footer.magic = kSparseShardFileMagic;
+    if (!_index.empty() &&
+        _write_func(reinterpret_cast<const char*>(_index.data()),
+                    _index.size() * sizeof(SparseShardFileBlock)) != 0) {
+      return -1;
+    }
+    return _write_func(reinterpret_cast<const char*>(&footer), sizeof(footer));
+  }
+
+  size_t KeyNum() const { return _key_num + _keys.size(); }
+
+ private:
+  int FlushBlock() {
+    size_t key_num = _keys.size();
+    _block.clear();
+    _block.append(reinterpret_cast<const char*>(_keys.data()),
+                  key_num * sizeof(uint64_t));
+    _block.append(reinterpret_cast<const char*>(_dims.data()),
+                  key_num * sizeof(uint32_t));
+    // transpose the values to the columns
+    uint32_t max_dim = *std::max_element(_dims.begin(), _dims.end());
+    _offsets.resize(key_num);
+    size_t offset = 0;
+    for (size_t i = 0; i < key_num; ++i) {
+      _offsets[i] = offset;
+      offset += _dims[i];
+    }
+    _columns.clear();
+    for (uint32_t j = 0; j < max_dim; ++j) {
+      for (size_t i = 0; i < key_num; ++i) {
+        if (_dims[i] > j) {
+          _columns.push_back(_values[_offsets[i] + j]);
+        }
+      }
+    }
+    _block.append(reinterpret_cast<const char*>(_columns.data()),
+                  _columns.size() * sizeof(float));
+    snappy::Compress(_block.data(), _block.size(), &_compressed);
+
+    SparseShardFileBlock block;
+    block.first_key = _keys.front();
+    block.last_key = _keys.back();
+    block.offset = _offset;
+    block.size = static_cast<uint32_t>(_compressed.size());
+    block.key_num = static_cast<uint32_t>(key_num);
+    if (_write_func(_compressed.data(), _compressed.size()) != 0) {
+      return -1;
+    }
+    _offset += _compressed.size();
+    _key_num += key_num;
+    _index.push_back(block);
+    _keys.clear();
+    _dims.clear();
+    _values.clear();
+    return 0;
+  }
+
+  WriteFunc _write_func;
+  // the values of the current block in rows
+  std::vector<uint64_t> _keys;
+  std::vector<uint32_t> _dims;
+  std::vector<float> _values;
+  std::vector<size_t> _offsets;
+  std::vector<float> _columns;
+  std::string _block;
+  std::string _compressed;
+
+  std::vector<SparseShardFileBlock> _index;
+  uint64_t _offset = 0;
+  uint64_t _key_num = 0;
+};
+
+// Reads a SparseShardFile in memory, for example mapped from a local file,
+// which should outlive the reader.
+class SparseShardFileReader {
+ public:
+  SparseShardFileReader(const char* data, size_t size) : _data(data) {
+    SparseShardFileFooter footer;
+    if (size < sizeof(footer)) {
+      return;
+    }
+    memcpy(&footer, data + size - sizeof(footer), sizeof(footer));
+    if (footer.magic != kSparseShardFileMagic ||
+        footer.index_offset > size - sizeof(footer)) {
+      return;
+    }
+    size_t index_size = size - sizeof(footer) - footer.index_offset;
+    if (index_size != footer.block_num * sizeof(SparseShardFileBlock)) {
+      return;
+    }
+    _index.resize(footer.block_num);
+    if (!_index.empty()) {
+      memcpy(_index.data(), data + footer.index_offset, index_size);
+    }
+    for (auto& block : _index) {
+      if (block.offset + block.size > footer.index_offset) {
+        return;
+      }
+    }
+    _key_num = footer.key_num;
+    _valid = true;
+  }
+
+  // Whether the footer and the index are valid.
+  bool Valid() const { return _valid; }
+  size_t BlockNum() const { return _index.size(); }
+  size_t KeyNum() const { return _key_num; }
+
+  // Calls func(key, value, dim) for each value in the block in the order of
+  // the keys. Returns false if the block is corrupted.
+  template <class Func>
+  bool VisitBlock(size_t block_idx, Func&& func) {
+    const SparseShardFileBlock& block = _index[block_idx];
+    const char* compressed = _data + block.offset;
+    size_t length = 0;
+    if (!snappy::GetUncompressedLength(compressed, block.size, &length)) {
+      return false;
+    }
+    _block.resize(length);
+    if (!snappy::RawUncompress(compressed, block.size, &_block[0])) {
+      return false;
+    }
+    size_t key_num = block.key_num;
+    size_t header_size = key_num * (sizeof(uint64_t) + sizeof(uint32_t));
+    if (length < header_size) {
+      return false;
+    }
+    const uint64_t* keys = reinterpret_cast<const uint64_t*>(_block.data());
+    const uint32_t* dims = reinterpret_cast<const uint32_t*>(
+        _block.data() + key_num * sizeof(uint64_t));
+    const float* columns =
+        reinterpret_cast<const float*>(_block.data() + header_size);
+
+    // transpose the columns back to the values
+    uint32_t max_dim = 0;
+    size_t offset = 0;
+    _offsets.resize(key_num);
+    for (size_t i = 0; i < key_num; ++i) {
+      _offsets[i] = offset;
+      offset += dims[i];
+      max_dim = std::max(max_dim, dims[i]);
+    }
+    if (length != header_size + offset * sizeof(float)) {
+      return false;
+    }
+    _values.resize(offset);
+    for (uint32_t j = 0; j < max_dim; ++j) {
+      for (size_t i = 0; i < key_num; ++i) {
+        if (dims[i] > j) {
+          _values[_offsets[i] + j] = *columns++;
+        }
+      }
+    }
+    for (size_t i = 0; i < key_num; ++i) {
+      func(keys[i], _values.data() + _offsets[i], dims[i]);
+    }
+    return true;
+  }
+
+  // Finds the value of the key by the index, returns false if not found.
+  bool Find(uint64_t key, std::vector<float>* value) {
+    auto it = std::lower_bound(
+        _index.begin(),
+        _index.end(),
+        key,
+        [](const SparseShardFileBlock& block, uint64_t target) {
+          return block.last_key < target;
+        });
+    if (it == _index.end() || it->first_key > key) {
+      return false;
+    }
+    bool found = false;
+    bool valid = VisitBlock(
+        it - _index.begin(),
+        [&](uint64_t block_key, const float* block_value, uint32_t dim) {
+          if (block_key == key) {
+            value->assign(block_value, block_value + dim);
+            found = true;
+          }
+        });
+    return valid && found;
+  }
+
+ private:
+  const char* _data;
+  bool _valid = false;
+  size_t _key_num = 0;
+  std::vector<SparseShardFileBlock> _index;
+  std::string _block;
+  std::vector<size_t> _offsets;
+  std::vector<float> _values;
+};
+
+}  // namespace distributed
+}  // namespace paddle
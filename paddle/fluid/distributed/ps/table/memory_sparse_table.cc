@@ -12,13 +12,20 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <fcntl.h>
 #include <omp.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
 #include <sstream>
 
 #include "glog/logging.h"
 #include "paddle/fluid/distributed/common/cost_timer.h"
 #include "paddle/fluid/distributed/common/local_random.h"
 #include "paddle/fluid/distributed/common/topk_calculator.h"
+#include "paddle/fluid/distributed/ps/table/depends/sparse_shard_file.h"
 #include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
 #include "paddle/fluid/framework/archive.h"
 #include "paddle/fluid/framework/io/fs.h"
@@ -36,6 +43,14 @@ DEFINE_bool(pserver_enable_create_feasign_randomly,
             false,
             "pserver_enable_create_feasign_randomly");
 DEFINE_int32(pserver_table_save_max_retry, 3, "pserver_table_save_max_retry");
+DEFINE_int32(pserver_push_merge_window_ms,
+             0,
+             "merge the sparse pushes of the same key in the window and "
+             "update the key once, 0 to update every push directly");
+DEFINE_int32(pserver_push_merge_buffer_keys,
+             8192,
+             "the max number of the keys merged in a window of a local shard, "
+             "the keys beyond it are updated directly");
 
 namespace paddle {
 namespace distributed {
@@ -49,6 +64,22 @@ int32_t MemorySparseTable::Initialize() {
   for (size_t i = 0; i < _shards_task_pool.size(); ++i) {
     _shards_task_pool[i].reset(new ::ThreadPool(1));
   }
+  if (FLAGS_pserver_push_merge_window_ms > 0 && CanMergePush()) {
+    size_t update_value_col =
+        _value_accesor->GetAccessorInfo().update_size / sizeof(float);
+    ValueAccessor *accessor = _value_accesor.get();
+    for (int i = 0; i < _real_local_shard_num; ++i) {
+      _push_merge_buffers.emplace_back(new PushMergeBuffer(
+          FLAGS_pserver_push_merge_buffer_keys,
+          update_value_col,
+          [accessor](float *value, const float *other) {
+            accessor->Merge(&value, &other, 1);
+          }));
+    }
+    _push_merge_thread = std::thread([this]() { PushMergeLoop(); });
+    VLOG(0) << "MemorySparseTable merges the pushes in "
+            << FLAGS_pserver_push_merge_window_ms << " ms windows";
+  }
   VLOG(0) << "initalize MemorySparseTable succ";
   return 0;
 }
@@ -75,6 +106,36 @@ int32_t MemorySparseTable::InitializeValue() {
 
   _local_shards.reset(new shard_type[_real_local_shard_num]);
 
+  _use_flat_shard = _config.use_flat_shard();
+  if (_use_flat_shard && !CanUseFlatShard()) {
+    LOG(WARNING) << _config.table_class()
+                 << " does not support the flat shard, use the default one";
+    _use_flat_shard = false;
+  }
+  if (_use_flat_shard && _config.enable_revert()) {
+    LOG(WARNING) << "The flat shard does not support the revert of the patch "
+                    "model, use the default one";
+    _use_flat_shard = false;
+  }
+#ifdef PADDLE_WITH_HETERPS
+  // HeterPS reads the values pulled by PullSparsePtr as FixedFeatureValue.
+  if (_use_flat_shard) {
+    LOG(WARNING) << "The flat shard does not support HeterPS, use the "
+                    "default one";
+    _use_flat_shard = false;
+  }
+#endif
+  if (_use_flat_shard) {
+    size_t value_capacity =
+        _value_accesor->GetAccessorInfo().size / sizeof(float);
+    _local_flat_shards.reset(new flat_shard_type[_real_local_shard_num]);
+    for (int i = 0; i < _real_local_shard_num; ++i) {
+      _local_flat_shards[i].set_value_capacity(value_capacity);
+    }
+    VLOG(1) << "memory sparse table uses the flat shard with value capacity "
+            << value_capacity;
+  }
+
   if (_config.enable_revert()) {
     // calculate merged shard number based on config param;
     _shard_merge_rate = _config.has_shard_merge_rate()
@@ -125,6 +186,12 @@ int32_t MemorySparseTable::Load(const std::string &path,
   }
 
   if (load_param == 5) {
+    if (_use_flat_shard) {
+      LOG(WARNING) << "MemorySparseTable with the flat shard can not load "
+                      "the patch model, path:"
+                   << path;
+      return -1;
+    }
     return LoadPatch(file_list, load_param);
   }
 
@@ -133,6 +200,9 @@ int32_t MemorySparseTable::Load(const std::string &path,
   if (file_start_idx >= file_list.size()) {
     return 0;
   }
+  if (paddle::string::ends_with(file_list[file_start_idx], ".bin")) {
+    return LoadBinary(file_list, file_start_idx);
+  }
 
   size_t feature_value_size =
       _value_accesor->GetAccessorInfo().size / sizeof(float);
@@ -163,16 +233,18 @@ int32_t MemorySparseTable::Load(const std::string &path,
       std::string line_data;
       auto read_channel = _afs_client.open_r(channel_config, 0, &err_no);
       char *end = NULL;
-      auto &shard = _local_shards[i];
       try {
-        while (read_channel->read_line(line_data) == 0 &&
-               line_data.size() > 1) {
-          uint64_t key = std::strtoul(line_data.data(), &end, 10);
-          auto &value = shard[key];
-          value.resize(feature_value_size);
-          int parse_size = _value_accesor->ParseFromString(++end, value.data());
-          value.resize(parse_size);
-        }
+        VisitLocalShard(i, [&](auto &shard) {
+          while (read_channel->read_line(line_data) == 0 &&
+                 line_data.size() > 1) {
+            uint64_t key = std::strtoul(line_data.data(), &end, 10);
+            auto &value = shard[key];
+            value.resize(feature_value_size);
+            int parse_size =
+                _value_accesor->ParseFromString(++end, value.data());
+            value.resize(parse_size);
+          }
+        });
         read_channel->close();
         if (err_no == -1) {
           ++retry_num;
@@ -335,6 +407,11 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
   std::string table_path = TableDir(dirname);
   _afs_client.remove(paddle::string::format_string(
       "%s/part-%03d-*", table_path.c_str(), _shard_idx));
+  if (_config.save_binary() && (save_param == 0 || save_param == 3)) {
+    int32_t ret = SaveBinary(table_path, save_param);
+    _local_show_threshold = tk.top();
+    return ret;
+  }
   std::atomic<uint32_t> feasign_size_all{0};
 
   size_t file_start_idx = _avg_local_shard_num * _shard_idx;
@@ -367,36 +444,37 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
     int feasign_size = 0;
     int retry_num = 0;
     int err_no = 0;
-    auto &shard = _local_shards[i];
     do {
       err_no = 0;
       feasign_size = 0;
       is_write_failed = false;
       auto write_channel =
           _afs_client.open_w(channel_config, 1024 * 1024 * 40, &err_no);
-      for (auto it = shard.begin(); it != shard.end(); ++it) {
-        if (_config.enable_sparse_table_cache() &&
-            (save_param == 1 || save_param == 2) &&
-            _value_accesor->Save(it.value().data(), 4)) {
-          CostTimer timer10("sprase table top push");
-          tk.push(i, _value_accesor->GetField(it.value().data(), "show"));
-        }
+      VisitLocalShard(i, [&](auto &shard) {
+        for (auto it = shard.begin(); it != shard.end(); ++it) {
+          if (_config.enable_sparse_table_cache() &&
+              (save_param == 1 || save_param == 2) &&
+              _value_accesor->Save(it.value().data(), 4)) {
+            CostTimer timer10("sprase table top push");
+            tk.push(i, _value_accesor->GetField(it.value().data(), "show"));
+          }
 
-        if (_value_accesor->Save(it.value().data(), save_param)) {
-          std::string format_value = _value_accesor->ParseToString(
-              it.value().data(), it.value().size());
-          if (0 != write_channel->write_line(paddle::string::format_string(
-                       "%lu %s", it.key(), format_value.c_str()))) {
-            ++retry_num;
-            is_write_failed = true;
-            LOG(ERROR)
-                << "MemorySparseTable save prefix failed, retry it! path:"
-                << channel_config.path << " , retry_num=" << retry_num;
-            break;
+          if (_value_accesor->Save(it.value().data(), save_param)) {
+            std::string format_value = _value_accesor->ParseToString(
+                it.value().data(), it.value().size());
+            if (0 != write_channel->write_line(paddle::string::format_string(
+                         "%lu %s", it.key(), format_value.c_str()))) {
+              ++retry_num;
+              is_write_failed = true;
+              LOG(ERROR)
+                  << "MemorySparseTable save prefix failed, retry it! path:"
+                  << channel_config.path << " , retry_num=" << retry_num;
+              break;
+            }
+            ++feasign_size;
           }
-          ++feasign_size;
         }
-      }
+      });
       write_channel->close();
       if (err_no == -1) {
         ++retry_num;
@@ -414,9 +492,11 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
       }
     } while (is_write_failed);
     feasign_size_all += feasign_size;
-    for (auto it = shard.begin(); it != shard.end(); ++it) {
-      _value_accesor->UpdateStatAfterSave(it.value().data(), save_param);
-    }
+    VisitLocalShard(i, [&](auto &shard) {
+      for (auto it = shard.begin(); it != shard.end(); ++it) {
+        _value_accesor->UpdateStatAfterSave(it.value().data(), save_param);
+      }
+    });
     LOG(INFO) << "MemorySparseTable save prefix success, path: "
               << channel_config.path << " feasign_size: " << feasign_size;
   }
@@ -425,6 +505,206 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
   return 0;
 }
 
+int32_t MemorySparseTable::SaveBinary(const std::string &table_path,
+                                      int save_param) {
+  struct SaveValue {
+    uint64_t key;
+    float *data;
+    uint32_t dim;
+  };
+  size_t file_start_idx = _avg_local_shard_num * _shard_idx;
+  std::atomic<uint64_t> feasign_size_all{0};
+  std::vector<std::future<int>> tasks(_real_local_shard_num);
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    tasks[i] = _shards_task_pool[i % _shards_task_pool.size()]->enqueue(
+        [this, i, &table_path, save_param, file_start_idx, &feasign_size_all]()
+            -> int {
+          // the file is sorted by key for the index
+          std::vector<SaveValue> values;
+          VisitLocalShard(i, [&](auto &shard) {
+            values.reserve(shard.size());
+            for (auto it = shard.begin(); it != shard.end(); ++it) {
+              if (_value_accesor->Save(it.value().data(), save_param)) {
+                // the same fields as the text format
+                size_t dim = _value_accesor->SaveDim(it.value().data(),
+                                                     it.value().size());
+                values.push_back({it.key(),
+                                  it.value().data(),
+                                  static_cast<uint32_t>(dim)});
+              }
+            }
+          });
+          std::sort(values.begin(),
+                    values.end(),
+                    [](const SaveValue &a, const SaveValue &b) {
+                      return a.key < b.key;
+                    });
+
+          // the blocks are compressed by the writer, so no converter
+          FsChannelConfig channel_config;
+          channel_config.path =
+              paddle::string::format_string("%s/part-%03d-%05d.bin",
+                                            table_path.c_str(),
+                                            _shard_idx,
+                                            file_start_idx + i);
+          bool is_write_failed = false;
+          int retry_num = 0;
+          do {
+            int err_no = 0;
+            is_write_failed = false;
+            auto write_channel =
+                _afs_client.open_w(channel_config, 1024 * 1024 * 40, &err_no);
+            SparseShardFileWriter writer(
+                [&write_channel](const char *data, size_t size) -> int {
+                  return write_channel->write(data, size) == 0 ? 0 : -1;
+                });
+            for (auto &value : values) {
+              if (writer.Add(value.key, value.data, value.dim) != 0) {
+                is_write_failed = true;
+                break;
+              }
+            }
+            if (!is_write_failed && writer.Finish() != 0) {
+              is_write_failed = true;
+            }
+            write_channel->close();
+            if (is_write_failed || err_no == -1) {
+              ++retry_num;
+              is_write_failed = true;
+              LOG(ERROR) << "MemorySparseTable save binary failed, retry it! "
+                         << "path:" << channel_config.path
+                         << " , retry_num=" << retry_num;
+              _afs_client.remove(channel_config.path);
+            }
+            if (retry_num > FLAGS_pserver_table_save_max_retry) {
+              LOG(ERROR)
+                  << "MemorySparseTable save binary failed reach max limit!";
+              exit(-1);
+            }
+          } while (is_write_failed);
+          feasign_size_all += values.size();
+          VisitLocalShard(i, [&](auto &shard) {
+            for (auto it = shard.begin(); it != shard.end(); ++it) {
+              _value_accesor->UpdateStatAfterSave(it.value().data(),
+                                                  save_param);
+            }
+          });
+          LOG(INFO) << "MemorySparseTable save binary success, path: "
+                    << channel_config.path
+                    << " feasign_size: " << values.size();
+          return 0;
+        });
+  }
+  for (auto &task : tasks) {
+    task.wait();
+  }
+  LOG(INFO) << "MemorySparseTable save binary success, feasign_size_all: "
+            << feasign_size_all.load();
+  return 0;
+}
+
+int32_t MemorySparseTable::LoadBinary(const std::vector<std::string> &file_list,
+                                      size_t file_start_idx) {
+  std::vector<std::future<int>> tasks(_real_local_shard_num);
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    tasks[i] = _shards_task_pool[i % _shards_task_pool.size()]->enqueue(
+        [this, i, &file_list, file_start_idx]() -> int {
+          const std::string &path = file_list[file_start_idx + i];
+          int retry_num = 0;
+          while (LoadBinaryShard(i, path) != 0) {
+            ++retry_num;
+            LOG(ERROR) << "MemorySparseTable load binary failed, retry it! "
+                       << "path:" << path << " , retry_num=" << retry_num;
+            if (retry_num > FLAGS_pserver_table_save_max_retry) {
+              LOG(ERROR)
+                  << "MemorySparseTable load binary failed reach max limit!";
+              exit(-1);
+            }
+          }
+          return 0;
+        });
+  }
+  for (auto &task : tasks) {
+    task.wait();
+  }
+  LOG(INFO) << "MemorySparseTable load binary success, path from "
+            << file_list[file_start_idx] << " to "
+            << file_list[file_start_idx + _real_local_shard_num - 1];
+  return 0;
+}
+
+int32_t MemorySparseTable::LoadBinaryShard(int shard_id,
+                                           const std::string &path) {
+  // the local file is mapped, and the others are read by the fs client
+  const char *data = nullptr;
+  size_t size = 0;
+  void *mapped = MAP_FAILED;
+  std::string buffer;
+  if (paddle::framework::fs_select_internal(path) == 0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return -1;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+      size = file_stat.st_size;
+      mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (mapped == MAP_FAILED) {
+      return -1;
+    }
+    madvise(mapped, size, MADV_SEQUENTIAL);
+    data = static_cast<const char *>(mapped);
+  } else {
+    FsChannelConfig channel_config;
+    channel_config.path = path;
+    int err_no = 0;
+    auto read_channel = _afs_client.open_r(channel_config, 0, &err_no);
+    const size_t kReadSize = 1024 * 1024 * 4;
+    int read_size = 0;
+    do {
+      buffer.resize(size + kReadSize);
+      read_size = read_channel->read(&buffer[size], kReadSize);
+      size += read_size > 0 ? read_size : 0;
+    } while (read_size > 0);
+    read_channel->close();
+    if (err_no == -1) {
+      return -1;
+    }
+    buffer.resize(size);
+    data = buffer.data();
+  }
+
+  int32_t ret = 0;
+  SparseShardFileReader reader(data, size);
+  if (!reader.Valid()) {
+    LOG(ERROR) << "MemorySparseTable invalid binary file, path:" << path;
+    ret = -1;
+  }
+  VisitLocalShard(shard_id, [&](auto &shard) {
+    for (size_t block = 0; ret == 0 && block < reader.BlockNum(); ++block) {
+      bool valid = reader.VisitBlock(
+          block, [&](uint64_t key, const float *value, uint32_t dim) {
+            auto &feature_value = shard[key];
+            feature_value.resize(dim);
+            memcpy(feature_value.data(), value, dim * sizeof(float));
+          });
+      if (!valid) {
+        LOG(ERROR) << "MemorySparseTable invalid block " << block
+                   << " of binary file, path:" << path;
+        ret = -1;
+      }
+    }
+  });
+  if (mapped != MAP_FAILED) {
+    munmap(mapped, size);
+  }
+  VLOG(1) << "MemorySparseTable::LoadBinaryShard " << path
+          << " into local shard " << shard_id << " keys:" << reader.KeyNum();
+  return ret;
+}
+
 int32_t MemorySparseTable::SavePatch(const std::string &path, int save_param) {
   if (!_config.enable_revert()) {
     LOG(INFO) << "MemorySparseTable should be enabled revert.";
@@ -559,17 +839,24 @@ int64_t MemorySparseTable::CacheShuffle(
     for (size_t idx = 0; idx < table_ptrs.size(); idx++) {
       Table *table_ptr = table_ptrs[idx];
       auto value_accesor = table_ptr->ValueAccesor();
-      shard_type *shard_ptr = static_cast<shard_type *>(table_ptr->GetShard(i));
-
-      for (auto it = shard_ptr->begin(); it != shard_ptr->end(); ++it) {
-        if (value_accesor->SaveCache(
-                it.value().data(), save_param, cache_threshold)) {
-          std::string format_value = value_accesor->ParseToString(
-              it.value().data(), it.value().size());
-          std::pair<uint64_t, std::string> pkv(it.key(), format_value.c_str());
-          writer << pkv;
-          ++feasign_size;
+      auto shuffle = [&](auto *shard_ptr) {
+        for (auto it = shard_ptr->begin(); it != shard_ptr->end(); ++it) {
+          if (value_accesor->SaveCache(
+                  it.value().data(), save_param, cache_threshold)) {
+            std::string format_value = value_accesor->ParseToString(
+                it.value().data(), it.value().size());
+            std::pair<uint64_t, std::string> pkv(it.key(),
+                                                 format_value.c_str());
+            writer << pkv;
+            ++feasign_size;
+          }
         }
+      };
+      auto *sparse_table = dynamic_cast<MemorySparseTable *>(table_ptr);
+      if (sparse_table != nullptr && sparse_table->UseFlatShard()) {
+        shuffle(static_cast<flat_shard_type *>(table_ptr->GetShard(i)));
+      } else {
+        shuffle(static_cast<shard_type *>(table_ptr->GetShard(i)));
       }
     }
     writer.Flush();
@@ -679,7 +966,7 @@ int32_t MemorySparseTable::SaveCache(
 int64_t MemorySparseTable::LocalSize() {
   int64_t local_size = 0;
   for (int i = 0; i < _real_local_shard_num; ++i) {
-    local_size += _local_shards[i].size();
+    VisitLocalShard(i, [&](auto &shard) { local_size += shard.size(); });
   }
   return local_size;
 }
@@ -692,13 +979,14 @@ int64_t MemorySparseTable::LocalMFSize() {
     tasks[shard_id] =
         _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
             [this, shard_id, &size_arr]() -> int {
-              auto &local_shard = _local_shards[shard_id];
-              for (auto it = local_shard.begin(); it != local_shard.end();
-                   ++it) {
-                if (_value_accesor->HasMF(it.value().size())) {
-                  size_arr[shard_id] += 1;
+              VisitLocalShard(shard_id, [&](auto &local_shard) {
+                for (auto it = local_shard.begin(); it != local_shard.end();
+                     ++it) {
+                  if (_value_accesor->HasMF(it.value().size())) {
+                    size_arr[shard_id] += 1;
+                  }
                 }
-              }
+              });
               return 0;
             });
   }
@@ -714,6 +1002,16 @@ int64_t MemorySparseTable::LocalMFSize() {
 std::pair<int64_t, int64_t> MemorySparseTable::PrintTableStat() {
   int64_t feasign_size = LocalSize();
   int64_t mf_size = LocalMFSize();
+  if (!_push_merge_buffers.empty()) {
+    PushMergeStat stat = GetPushMergeStat();
+    double merge_ratio =
+        stat.updated_keys > 0
+            ? static_cast<double>(stat.pushed_keys) / stat.updated_keys
+            : 0;
+    LOG(INFO) << "MemorySparseTable push merge pushed_keys:" << stat.pushed_keys
+              << " updated_keys:" << stat.updated_keys
+              << " merge_ratio:" << merge_ratio;
+  }
   return {feasign_size, mf_size};
 }
 
@@ -774,41 +1072,42 @@ int32_t MemorySparseTable::PullSparse(float *pull_values,
              pull_values,
              mf_value_size,
              select_value_size]() -> int {
-              auto &local_shard = _local_shards[shard_id];
-              float data_buffer[value_size];  // NOLINT
-              float *data_buffer_ptr = data_buffer;
-
               auto &keys = task_keys[shard_id];
-              for (size_t i = 0; i < keys.size(); i++) {
-                uint64_t key = keys[i].first;
-                auto itr = local_shard.find(key);
-                size_t data_size = value_size - mf_value_size;
-                if (itr == local_shard.end()) {
-                  // ++missed_keys;
-                  if (FLAGS_pserver_create_value_when_push) {
-                    memset(data_buffer, 0, sizeof(float) * data_size);
+              VisitLocalShard(shard_id, [&](auto &local_shard) {
+                float data_buffer[value_size];  // NOLINT
+                float *data_buffer_ptr = data_buffer;
+                for (size_t i = 0; i < keys.size(); i++) {
+                  uint64_t key = keys[i].first;
+                  auto itr = local_shard.find(key);
+                  size_t data_size = value_size - mf_value_size;
+                  if (itr == local_shard.end()) {
+                    // ++missed_keys;
+                    if (FLAGS_pserver_create_value_when_push) {
+                      memset(data_buffer, 0, sizeof(float) * data_size);
+                    } else {
+                      auto &feature_value = local_shard[key];
+                      feature_value.resize(data_size);
+                      float *data_ptr = feature_value.data();
+                      _value_accesor->Create(&data_buffer_ptr, 1);
+                      memcpy(
+                          data_ptr, data_buffer_ptr, data_size * sizeof(float));
+                    }
                   } else {
-                    auto &feature_value = local_shard[key];
-                    feature_value.resize(data_size);
-                    float *data_ptr = feature_value.data();
-                    _value_accesor->Create(&data_buffer_ptr, 1);
-                    memcpy(
-                        data_ptr, data_buffer_ptr, data_size * sizeof(float));
+                    data_size = itr.value().size();
+                    memcpy(data_buffer_ptr,
+                           itr.value().data(),
+                           data_size * sizeof(float));
                   }
-                } else {
-                  data_size = itr.value().size();
-                  memcpy(data_buffer_ptr,
-                         itr.value().data(),
-                         data_size * sizeof(float));
-                }
-                for (size_t mf_idx = data_size; mf_idx < value_size; ++mf_idx) {
-                  data_buffer[mf_idx] = 0.0;
+                  for (size_t mf_idx = data_size; mf_idx < value_size;
+                       ++mf_idx) {
+                    data_buffer[mf_idx] = 0.0;
+                  }
+                  auto offset = keys[i].second;
+                  float *select_data = pull_values + select_value_size * offset;
+                  _value_accesor->Select(
+                      &select_data, (const float **)&data_buffer_ptr, 1);
                 }
-                auto offset = keys[i].second;
-                float *select_data = pull_values + select_value_size * offset;
-                _value_accesor->Select(
-                    &select_data, (const float **)&data_buffer_ptr, 1);
-              }
+              });
 
               return 0;
             });
@@ -848,28 +1147,30 @@ int32_t MemorySparseTable::PullSparsePtr(int shard_id,  // fake num
              value_size,
              mf_value_size]() -> int {
               auto &keys = task_keys[shard_id];
-              auto &local_shard = _local_shards[shard_id];
-              float data_buffer[value_size];  // NOLINT
-              float *data_buffer_ptr = data_buffer;
-              for (size_t i = 0; i < keys.size(); ++i) {
-                uint64_t key = keys[i].first;
-                auto itr = local_shard.find(key);
-                size_t data_size = value_size - mf_value_size;
-                FixedFeatureValue *ret = NULL;
-                if (itr == local_shard.end()) {
-                  // ++missed_keys;
-                  auto &feature_value = local_shard[key];
-                  feature_value.resize(data_size);
-                  float *data_ptr = feature_value.data();
-                  _value_accesor->Create(&data_buffer_ptr, 1);
-                  memcpy(data_ptr, data_buffer_ptr, data_size * sizeof(float));
-                  ret = &feature_value;
-                } else {
-                  ret = itr.value_ptr();
+              VisitLocalShard(shard_id, [&](auto &local_shard) {
+                float data_buffer[value_size];  // NOLINT
+                float *data_buffer_ptr = data_buffer;
+                for (size_t i = 0; i < keys.size(); ++i) {
+                  uint64_t key = keys[i].first;
+                  auto itr = local_shard.find(key);
+                  size_t data_size = value_size - mf_value_size;
+                  char *ret = NULL;
+                  if (itr == local_shard.end()) {
+                    // ++missed_keys;
+                    auto &feature_value = local_shard[key];
+                    feature_value.resize(data_size);
+                    float *data_ptr = feature_value.data();
+                    _value_accesor->Create(&data_buffer_ptr, 1);
+                    memcpy(
+                        data_ptr, data_buffer_ptr, data_size * sizeof(float));
+                    ret = reinterpret_cast<char *>(&feature_value);
+                  } else {
+                    ret = reinterpret_cast<char *>(itr.value_ptr());
+                  }
+                  int pull_data_idx = keys[i].second;
+                  pull_values[pull_data_idx] = ret;
                 }
-                int pull_data_idx = keys[i].second;
-                pull_values[pull_data_idx] = reinterpret_cast<char *>(ret);
-              }
+              });
               return 0;
             });
   }
@@ -879,93 +1180,121 @@ int32_t MemorySparseTable::PullSparsePtr(int shard_id,  // fake num
   return 0;
 }
 
+template <class GetUpdate>
+void MemorySparseTable::UpdateLocalShard(int shard_id,
+                                         size_t num,
+                                         GetUpdate &&get_update,
+                                         bool update_revert) {
+  const size_t value_col =
+      _value_accesor->GetAccessorInfo().size / sizeof(float);
+  size_t mf_value_col =
+      _value_accesor->GetAccessorInfo().mf_size / sizeof(float);
+  VisitLocalShard(shard_id, [&](auto &local_shard) {
+    float data_buffer[value_col];  // NOLINT
+    float *data_buffer_ptr = data_buffer;
+    // the values updated in place are updated in batches unless they are
+    // copied to the revert shard right after updated
+    const bool batch_update = !update_revert;
+    PushBatch batch;
+    for (size_t i = 0; i < num; ++i) {
+      std::pair<uint64_t, const float *> update = get_update(i);
+      uint64_t key = update.first;
+      const float *update_data = update.second;
+      auto itr = local_shard.find(key);
+      if (itr == local_shard.end()) {
+        if (FLAGS_pserver_enable_create_feasign_randomly &&
+            !_value_accesor->CreateValue(1, update_data)) {
+          continue;
+        }
+        // the insertion may move the values in the batch
+        FlushPushBatch(&batch);
+        auto value_size = value_col - mf_value_col;
+        auto &feature_value = local_shard[key];
+        feature_value.resize(value_size);
+        _value_accesor->Create(&data_buffer_ptr, 1);
+        memcpy(feature_value.data(),
+               data_buffer_ptr,
+               value_size * sizeof(float));
+        itr = local_shard.find(key);
+      }
+
+      auto &feature_value = itr.value();
+      float *value_data = feature_value.data();
+      size_t value_size = feature_value.size();
+
+      if (value_size == value_col) {  // 已拓展到最大size, 则就地update
+        if (batch_update) {
+          AddToPushBatch(&batch, value_data, update_data);
+        } else {
+          _value_accesor->Update(&value_data, &update_data, 1);
+        }
+      } else {
+        // 拷入buffer区进行update，然后再回填，不需要的mf则回填时抛弃了
+        memcpy(data_buffer_ptr, value_data, value_size * sizeof(float));
+        _value_accesor->Update(&data_buffer_ptr, &update_data, 1);
+
+        if (_value_accesor->NeedExtendMF(data_buffer)) {
+          feature_value.resize(value_col);
+          value_data = feature_value.data();
+          _value_accesor->Create(&value_data, 1);
+        }
+        memcpy(value_data, data_buffer_ptr, value_size * sizeof(float));
+      }
+      if (update_revert) {
+        FixedFeatureValue *feature_value_new =
+            &(_local_shards_new[shard_id][key]);
+        auto new_size = feature_value.size();
+        feature_value_new->resize(new_size);
+        memcpy(
+            feature_value_new->data(), value_data, new_size * sizeof(float));
+      }
+    }
+    FlushPushBatch(&batch);
+  });
+}
+
 int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
                                       const float *values,
                                       size_t num) {
   CostTimer timer("pserver_sparse_update_all");
+  size_t update_value_col =
+      _value_accesor->GetAccessorInfo().update_size / sizeof(float);
   std::vector<std::future<int>> tasks(_real_local_shard_num);
   std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
       _real_local_shard_num);
   for (size_t i = 0; i < num; ++i) {
     int shard_id = (keys[i] % _sparse_table_shard_num) % _avg_local_shard_num;
+    if (!_push_merge_buffers.empty() &&
+        _push_merge_buffers[shard_id]->Add(keys[i],
+                                           values + i * update_value_col)) {
+      continue;
+    }
     task_keys[shard_id].push_back({keys[i], i});
   }
 
-  const size_t value_col =
-      _value_accesor->GetAccessorInfo().size / sizeof(float);
-  size_t mf_value_col =
-      _value_accesor->GetAccessorInfo().mf_size / sizeof(float);
-  size_t update_value_col =
-      _value_accesor->GetAccessorInfo().update_size / sizeof(float);
-
   for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+    if (task_keys[shard_id].empty()) {
+      continue;
+    }
     tasks[shard_id] = _shards_task_pool[shard_id % _task_pool_size]->enqueue(
-        [this,
-         shard_id,
-         value_col,
-         mf_value_col,
-         update_value_col,
-         values,
-         &task_keys]() -> int {
+        [this, shard_id, update_value_col, values, &task_keys]() -> int {
           auto &keys = task_keys[shard_id];
-          auto &local_shard = _local_shards[shard_id];
-          auto &local_shard_new = _local_shards_new[shard_id];
-          float data_buffer[value_col];  // NOLINT
-          float *data_buffer_ptr = data_buffer;
-          for (size_t i = 0; i < keys.size(); ++i) {
-            uint64_t key = keys[i].first;
-            uint64_t push_data_idx = keys[i].second;
-            const float *update_data =
-                values + push_data_idx * update_value_col;
-            auto itr = local_shard.find(key);
-            if (itr == local_shard.end()) {
-              if (FLAGS_pserver_enable_create_feasign_randomly &&
-                  !_value_accesor->CreateValue(1, update_data)) {
-                continue;
-              }
-              auto value_size = value_col - mf_value_col;
-              auto &feature_value = local_shard[key];
-              feature_value.resize(value_size);
-              _value_accesor->Create(&data_buffer_ptr, 1);
-              memcpy(feature_value.data(),
-                     data_buffer_ptr,
-                     value_size * sizeof(float));
-              itr = local_shard.find(key);
-            }
-
-            auto &feature_value = itr.value();
-            float *value_data = feature_value.data();
-            size_t value_size = feature_value.size();
-
-            if (value_size == value_col) {  // 已拓展到最大size, 则就地update
-              _value_accesor->Update(&value_data, &update_data, 1);
-            } else {
-              // 拷入buffer区进行update，然后再回填，不需要的mf则回填时抛弃了
-              memcpy(data_buffer_ptr, value_data, value_size * sizeof(float));
-              _value_accesor->Update(&data_buffer_ptr, &update_data, 1);
-
-              if (_value_accesor->NeedExtendMF(data_buffer)) {
-                feature_value.resize(value_col);
-                value_data = feature_value.data();
-                _value_accesor->Create(&value_data, 1);
-              }
-              memcpy(value_data, data_buffer_ptr, value_size * sizeof(float));
-            }
-            if (_config.enable_revert()) {
-              FixedFeatureValue *feature_value_new = &(local_shard_new[key]);
-              auto new_size = feature_value.size();
-              feature_value_new->resize(new_size);
-              memcpy(feature_value_new->data(),
-                     value_data,
-                     new_size * sizeof(float));
-            }
-          }
+          UpdateLocalShard(
+              shard_id,
+              keys.size(),
+              [&](size_t i) {
+                return std::make_pair(
+                    keys[i].first, values + keys[i].second * update_value_col);
+              },
+              _config.enable_revert());
           return 0;
         });
   }
 
   for (size_t shard_id = 0; shard_id < tasks.size(); ++shard_id) {
-    tasks[shard_id].wait();
+    if (tasks[shard_id].valid()) {
+      tasks[shard_id].wait();
+    }
   }
   return 0;
 }
@@ -978,89 +1307,105 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
       _real_local_shard_num);
   for (size_t i = 0; i < num; ++i) {
     int shard_id = (keys[i] % _sparse_table_shard_num) % _avg_local_shard_num;
+    if (!_push_merge_buffers.empty() &&
+        _push_merge_buffers[shard_id]->Add(keys[i], values[i])) {
+      continue;
+    }
     task_keys[shard_id].push_back({keys[i], i});
   }
 
-  size_t value_col = _value_accesor->GetAccessorInfo().size / sizeof(float);
-  size_t mf_value_col =
-      _value_accesor->GetAccessorInfo().mf_size / sizeof(float);
-  size_t update_value_col =
-      _value_accesor->GetAccessorInfo().update_size / sizeof(float);
-
   for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+    if (task_keys[shard_id].empty()) {
+      continue;
+    }
     tasks[shard_id] = _shards_task_pool[shard_id % _task_pool_size]->enqueue(
-        [this,
-         shard_id,
-         value_col,
-         mf_value_col,
-         update_value_col,
-         values,
-         &task_keys]() -> int {
+        [this, shard_id, values, &task_keys]() -> int {
           auto &keys = task_keys[shard_id];
-          auto &local_shard = _local_shards[shard_id];
-          float data_buffer[value_col];  // NOLINT
-          float *data_buffer_ptr = data_buffer;
-          for (size_t i = 0; i < keys.size(); ++i) {
-            uint64_t key = keys[i].first;
-            uint64_t push_data_idx = keys[i].second;
-            const float *update_data = values[push_data_idx];
-            auto itr = local_shard.find(key);
-            if (itr == local_shard.end()) {
-              if (FLAGS_pserver_enable_create_feasign_randomly &&
-                  !_value_accesor->CreateValue(1, update_data)) {
-                continue;
-              }
-              auto value_size = value_col - mf_value_col;
-              auto &feature_value = local_shard[key];
-              feature_value.resize(value_size);
-              _value_accesor->Create(&data_buffer_ptr, 1);
-              memcpy(feature_value.data(),
-                     data_buffer_ptr,
-                     value_size * sizeof(float));
-              itr = local_shard.find(key);
-            }
-            auto &feature_value = itr.value();
-            float *value_data = feature_value.data();
-            size_t value_size = feature_value.size();
-            if (value_size == value_col) {  // 已拓展到最大size, 则就地update
-              _value_accesor->Update(&value_data, &update_data, 1);
-            } else {
-              // 拷入buffer区进行update，然后再回填，不需要的mf则回填时抛弃了
-              memcpy(data_buffer_ptr, value_data, value_size * sizeof(float));
-              _value_accesor->Update(&data_buffer_ptr, &update_data, 1);
-              if (_value_accesor->NeedExtendMF(data_buffer)) {
-                feature_value.resize(value_col);
-                value_data = feature_value.data();
-                _value_accesor->Create(&value_data, 1);
-              }
-              memcpy(value_data, data_buffer_ptr, value_size * sizeof(float));
-            }
-          }
+          UpdateLocalShard(
+              shard_id,
+              keys.size(),
+              [&](size_t i) {
+                return std::make_pair(keys[i].first, values[keys[i].second]);
+              },
+              false);
           return 0;
         });
   }
 
   for (size_t shard_id = 0; shard_id < tasks.size(); ++shard_id) {
-    tasks[shard_id].wait();
+    if (tasks[shard_id].valid()) {
+      tasks[shard_id].wait();
+    }
   }
   return 0;
 }
 
-int32_t MemorySparseTable::Flush() { return 0; }
+void MemorySparseTable::DrainPushMergeBuffers() {
+  std::vector<std::future<int>> tasks(_real_local_shard_num);
+  for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+    tasks[shard_id] = _shards_task_pool[shard_id % _task_pool_size]->enqueue(
+        [this, shard_id]() -> int {
+          _push_merge_buffers[shard_id]->Drain(
+              [&](const uint64_t *keys, float **values, size_t num) {
+                UpdateLocalShard(
+                    shard_id,
+                    num,
+                    [&](size_t i) {
+                      return std::make_pair(
+                          keys[i], static_cast<const float *>(values[i]));
+                    },
+                    _config.enable_revert());
+              });
+          return 0;
+        });
+  }
+  for (auto &task : tasks) {
+    task.wait();
+  }
+}
+
+void MemorySparseTable::PushMergeLoop() {
+  std::unique_lock<std::mutex> lock(_push_merge_mutex);
+  auto window = std::chrono::milliseconds(FLAGS_pserver_push_merge_window_ms);
+  while (!_push_merge_stop) {
+    _push_merge_cv.wait_for(lock, window);
+    lock.unlock();
+    DrainPushMergeBuffers();
+    lock.lock();
+  }
+}
+
+MemorySparseTable::PushMergeStat MemorySparseTable::GetPushMergeStat() {
+  PushMergeStat stat;
+  for (auto &buffer : _push_merge_buffers) {
+    stat.pushed_keys += buffer->AddedNum();
+    stat.updated_keys += buffer->DrainedNum();
+  }
+  return stat;
+}
+
+int32_t MemorySparseTable::Flush() {
+  // the pushes merged are updated before saved, loaded, shrinked or cleared
+  if (!_push_merge_buffers.empty()) {
+    DrainPushMergeBuffers();
+  }
+  return 0;
+}
 
 int32_t MemorySparseTable::Shrink(const std::string &param) {
   VLOG(0) << "MemorySparseTable::Shrink";
   // TODO(zhaocaibei123): implement with multi-thread
   for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
     // Shrink
-    auto &shard = _local_shards[shard_id];
-    for (auto it = shard.begin(); it != shard.end();) {
-      if (_value_accesor->Shrink(it.value().data())) {
-        it = shard.erase(it);
-      } else {
-        ++it;
+    VisitLocalShard(shard_id, [&](auto &shard) {
+      for (auto it = shard.begin(); it != shard.end();) {
+        if (_value_accesor->Shrink(it.value().data())) {
+          it = shard.erase(it);
+        } else {
+          ++it;
+        }
       }
-    }
+    });
   }
   return 0;
 }
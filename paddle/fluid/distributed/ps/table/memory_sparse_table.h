@@ -18,9 +18,11 @@
 #include <assert.h>
 #include <pthread.h>
 
+#include <condition_variable>  // NOLINT
 #include <memory>
 #include <mutex>  // NOLINT
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -29,6 +31,8 @@
 #include "paddle/fluid/distributed/ps/table/accessor.h"
 #include "paddle/fluid/distributed/ps/table/common_table.h"
 #include "paddle/fluid/distributed/ps/table/depends/feature_value.h"
+#include "paddle/fluid/distributed/ps/table/depends/flat_feature_value.h"
+#include "paddle/fluid/distributed/ps/table/depends/push_merge_buffer.h"
 #include "paddle/fluid/string/string_helper.h"
 
 #define PSERVER_SAVE_SUFFIX ".shard"
@@ -39,8 +43,25 @@ namespace distributed {
 class MemorySparseTable : public Table {
  public:
   typedef SparseTableShard<uint64_t, FixedFeatureValue> shard_type;
+  typedef FlatSparseTableShard<uint64_t> flat_shard_type;
+  // The counters of the push merge buffers, the merge ratio is
+  // pushed_keys / updated_keys.
+  struct PushMergeStat {
+    uint64_t pushed_keys = 0;   // the keys added to the buffers
+    uint64_t updated_keys = 0;  // the merged keys updated
+  };
+
   MemorySparseTable() {}
-  virtual ~MemorySparseTable() {}
+  virtual ~MemorySparseTable() {
+    if (_push_merge_thread.joinable()) {
+      {
+        std::lock_guard<std::mutex> guard(_push_merge_mutex);
+        _push_merge_stop = true;
+      }
+      _push_merge_cv.notify_all();
+      _push_merge_thread.join();
+    }
+  }
 
   // unused method end
   static int32_t sparse_local_shard_num(uint32_t shard_num,
@@ -100,13 +121,24 @@ class MemorySparseTable : public Table {
 
   int32_t PushSparse(const uint64_t* keys, const float** values, size_t num);
 
+  // Updates the pushes merged, which is called before the table is saved.
   int32_t Flush() override;
   int32_t Shrink(const std::string& param) override;
   void Clear() override;
 
+  PushMergeStat GetPushMergeStat();
+
+  // The flat_shard_type if UseFlatShard, and the shard_type otherwise.
   void* GetShard(size_t shard_idx) override {
+    if (_use_flat_shard) {
+      return &_local_flat_shards[shard_idx];
+    }
     return &_local_shards[shard_idx];
   }
+  // Whether the values are stored inline in flat_shard_type, then the
+  // pointers returned by PullSparsePtr point to FlatFeatureValue instead of
+  // FixedFeatureValue.
+  bool UseFlatShard() const { return _use_flat_shard; }
 
   virtual void Revert();
   virtual void CheckSavePrePatchDone();
@@ -115,6 +147,61 @@ class MemorySparseTable : public Table {
   virtual int32_t SavePatch(const std::string& path, int save_param);
   virtual int32_t LoadPatch(const std::vector<std::string>& file_list,
                             int save_param);
+  // Saves and loads the local shards in the binary SparseShardFile, see
+  // depends/sparse_shard_file.h.
+  int32_t SaveBinary(const std::string& table_path, int save_param);
+  int32_t LoadBinary(const std::vector<std::string>& file_list,
+                     size_t file_start_idx);
+  int32_t LoadBinaryShard(int shard_id, const std::string& path);
+  // The values updated in place by PushSparse are collected and passed to
+  // the accessor together, so that the sgd rules can update them in batches.
+  struct PushBatch {
+    static const size_t kSize = 64;
+    float* values[kSize];
+    const float* updates[kSize];
+    size_t num = 0;
+  };
+  void AddToPushBatch(PushBatch* batch, float* value, const float* update) {
+    batch->values[batch->num] = value;
+    batch->updates[batch->num] = update;
+    if (++batch->num == PushBatch::kSize) {
+      FlushPushBatch(batch);
+    }
+  }
+  void FlushPushBatch(PushBatch* batch) {
+    if (batch->num > 0) {
+      _value_accesor->Update(batch->values, batch->updates, batch->num);
+      batch->num = 0;
+    }
+  }
+  // The subclasses which access _local_shards directly return false.
+  virtual bool CanUseFlatShard() const { return true; }
+  // The subclasses which do not push by PushSparse return false.
+  virtual bool CanMergePush() const { return true; }
+
+  // Updates the values of the keys in the local shard shard_id, where
+  // get_update(i) returns the i-th key and its update value. It is called
+  // by the task pool of the shard.
+  template <class GetUpdate>
+  void UpdateLocalShard(int shard_id,
+                        size_t num,
+                        GetUpdate&& get_update,
+                        bool update_revert);
+  // Updates the merged pushes of all the local shards.
+  void DrainPushMergeBuffers();
+  // Drains the push merge buffers every window until the table is destroyed.
+  void PushMergeLoop();
+
+  // Calls func with the local shard shard_id, which is a shard_type or a
+  // flat_shard_type.
+  template <class Func>
+  void VisitLocalShard(int shard_id, Func&& func) {
+    if (_use_flat_shard) {
+      func(_local_flat_shards[shard_id]);
+    } else {
+      func(_local_shards[shard_id]);
+    }
+  }
 
   int _task_pool_size = 24;
   int _avg_local_shard_num;
@@ -122,6 +209,15 @@ class MemorySparseTable : public Table {
   int _sparse_table_shard_num;
   std::vector<std::shared_ptr<::ThreadPool>> _shards_task_pool;
   std::unique_ptr<shard_type[]> _local_shards;
+  bool _use_flat_shard{false};
+  std::unique_ptr<flat_shard_type[]> _local_flat_shards;
+  // the buffers merging the pushes of the local shards if
+  // FLAGS_pserver_push_merge_window_ms > 0
+  std::vector<std::unique_ptr<PushMergeBuffer>> _push_merge_buffers;
+  std::thread _push_merge_thread;
+  std::mutex _push_merge_mutex;
+  std::condition_variable _push_merge_cv;
+  bool _push_merge_stop{false};
 
   // for patch model
   int _m_avg_local_shard_num;
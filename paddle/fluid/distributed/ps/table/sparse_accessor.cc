@@ -305,5 +305,16 @@ int SparseAccessor::ParseFromString(const std::string& str, float* value) {
   return ret;
 }
 
+size_t SparseAccessor::SaveDim(const float* v, size_t dim) {
+  auto show = sparse_feature_value.Show(const_cast<float*>(v));
+  auto click = sparse_feature_value.Click(const_cast<float*>(v));
+  auto score = ShowClickScore(show, click);
+  size_t embedx_index = sparse_feature_value.EmbedxWIndex();
+  if (score >= _config.embedx_threshold() && dim > embedx_index) {
+    return dim;
+  }
+  return embedx_index;
+}
+
 }  // namespace distributed
 }  // namespace paddle
@@ -164,6 +164,7 @@ class SparseAccessor : public ValueAccessor {
 
   std::string ParseToString(const float* value, int param) override;
   int32_t ParseFromString(const std::string& str, float* v) override;
+  size_t SaveDim(const float* value, size_t dim) override;
   virtual bool CreateValue(int type, const float* value);
 
   // 这个接口目前只用来取show
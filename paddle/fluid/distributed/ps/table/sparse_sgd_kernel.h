@@ -0,0 +1,57 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+
+namespace paddle {
+namespace distributed {
+
+// The configuration of a sparse sgd rule used by the vectorized kernels.
+struct SparseSGDKernelParam {
+  size_t dim;
+  float learning_rate;
+  float initial_g2sum;
+  float beta1_decay_rate;
+  float beta2_decay_rate;
+  float ada_epsilon;
+  float min_bound;
+  float max_bound;
+};
+
+// Updates the embeddings of num keys. w[k], sgd[k] and grad[k] are the
+// embedding, the optimizer states and the gradient of the k-th key laid out
+// as in UpdateValueWork of the rule, and scale[k] is its gradient scale.
+typedef void (*SparseSGDKernel)(const SparseSGDKernelParam& param,
+                                float* const* w,
+                                float* const* sgd,
+                                const float* const* grad,
+                                const float* scale,
+                                size_t num);
+
+struct SparseSGDKernels {
+  SparseSGDKernel adagrad;      // SparseAdaGradSGDRule
+  SparseSGDKernel std_adagrad;  // StdAdaGradSGDRule
+  SparseSGDKernel adam;         // SparseAdamSGDRule
+  SparseSGDKernel shared_adam;  // SparseSharedAdamSGDRule
+};
+
+// The kernels are compiled in separate files with the instruction set
+// enabled, and nullptr is returned if the compiler does not support it.
+const SparseSGDKernels* GetSparseSGDKernelsAVX2();
+const SparseSGDKernels* GetSparseSGDKernelsAVX512();
+
+}  // namespace distributed
+}  // namespace paddle
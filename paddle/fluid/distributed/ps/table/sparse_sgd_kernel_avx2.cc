@@ -0,0 +1,75 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/sparse_sgd_kernel.h"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+
+#include "paddle/fluid/distributed/ps/table/sparse_sgd_kernel_impl.h"
+#endif
+
+namespace paddle {
+namespace distributed {
+
+#if defined(__AVX2__) && defined(__FMA__)
+namespace {
+
+struct AVX2Vec {
+  typedef __m256 Vec;
+  typedef __m256i Mask;
+  static const size_t kWidth = 8;
+
+  static Mask FullMask() { return _mm256_set1_epi32(-1); }
+  static Mask TailMask(size_t n) {
+    static const int32_t kMasks[16] = {
+        -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0};
+    return _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(kMasks + 8 - n));
+  }
+  static Vec Load(const float* p, Mask m) { return _mm256_maskload_ps(p, m); }
+  static void Store(float* p, Vec v, Mask m) { _mm256_maskstore_ps(p, m, v); }
+  static Vec Select(Vec v, Mask m) {
+    return _mm256_and_ps(v, _mm256_castsi256_ps(m));
+  }
+  static Vec Set1(float x) { return _mm256_set1_ps(x); }
+  static Vec Add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+  static Vec Sub(Vec a, Vec b) { return _mm256_sub_ps(a, b); }
+  static Vec Mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+  static Vec Div(Vec a, Vec b) { return _mm256_div_ps(a, b); }
+  static Vec Sqrt(Vec a) { return _mm256_sqrt_ps(a); }
+  // max_ps returns the second operand if either is NaN
+  static Vec Max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+  static Vec Min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+  static Vec Fmadd(Vec a, Vec b, Vec c) { return _mm256_fmadd_ps(a, b, c); }
+  static float ReduceAdd(Vec v) {
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v),
+                            _mm256_extractf128_ps(v, 1));
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+    return _mm_cvtss_f32(sum);
+  }
+};
+
+}  // namespace
+
+const SparseSGDKernels* GetSparseSGDKernelsAVX2() {
+  return sgd_kernel::GetKernels<AVX2Vec>();
+}
+#else
+const SparseSGDKernels* GetSparseSGDKernelsAVX2() { return nullptr; }
+#endif
+
+}  // namespace distributed
+}  // namespace paddle
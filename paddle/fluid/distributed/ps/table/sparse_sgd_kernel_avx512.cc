@@ -0,0 +1,66 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/sparse_sgd_kernel.h"
+
+#ifdef __AVX512F__
+// the _mm512_undefined_ps in the intrinsics of gcc 12 is warned wrongly
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+
+#include "paddle/fluid/distributed/ps/table/sparse_sgd_kernel_impl.h"
+#endif
+
+namespace paddle {
+namespace distributed {
+
+#ifdef __AVX512F__
+namespace {
+
+struct AVX512Vec {
+  typedef __m512 Vec;
+  typedef __mmask16 Mask;
+  static const size_t kWidth = 16;
+
+  static Mask FullMask() { return 0xFFFF; }
+  static Mask TailMask(size_t n) { return (1U << n) - 1; }
+  static Vec Load(const float* p, Mask m) {
+    return _mm512_maskz_loadu_ps(m, p);
+  }
+  static void Store(float* p, Vec v, Mask m) { _mm512_mask_storeu_ps(p, m, v); }
+  static Vec Select(Vec v, Mask m) { return _mm512_maskz_mov_ps(m, v); }
+  static Vec Set1(float x) { return _mm512_set1_ps(x); }
+  static Vec Add(Vec a, Vec b) { return _mm512_add_ps(a, b); }
+  static Vec Sub(Vec a, Vec b) { return _mm512_sub_ps(a, b); }
+  static Vec Mul(Vec a, Vec b) { return _mm512_mul_ps(a, b); }
+  static Vec Div(Vec a, Vec b) { return _mm512_div_ps(a, b); }
+  static Vec Sqrt(Vec a) { return _mm512_sqrt_ps(a); }
+  // max_ps returns the second operand if either is NaN
+  static Vec Max(Vec a, Vec b) { return _mm512_max_ps(a, b); }
+  static Vec Min(Vec a, Vec b) { return _mm512_min_ps(a, b); }
+  static Vec Fmadd(Vec a, Vec b, Vec c) { return _mm512_fmadd_ps(a, b, c); }
+  static float ReduceAdd(Vec v) { return _mm512_reduce_add_ps(v); }
+};
+
+}  // namespace
+
+const SparseSGDKernels* GetSparseSGDKernelsAVX512() {
+  return sgd_kernel::GetKernels<AVX512Vec>();
+}
+#else
+const SparseSGDKernels* GetSparseSGDKernelsAVX512() { return nullptr; }
+#endif
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,217 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <math.h>
+
+#include "paddle/fluid/distributed/ps/table/sparse_sgd_kernel.h"
+
+// The kernels of the sparse sgd rules on the vector type V, which is
+// included by the files compiled for an instruction set. V provides:
+//   Vec, Mask, kWidth   the vector of kWidth floats and the lane mask
+//   FullMask()          the mask of all the lanes
+//   TailMask(n)         the mask of the first n lanes
+//   Load(p, m)          loads the lanes in m, and the others are zeros
+//   Store(p, v, m)      stores the lanes in m
+//   Select(v, m)        keeps the lanes in m, and the others are zeros
+//   Set1, Add, Sub, Mul, Div, Sqrt, Max, Min, Fmadd(a, b, c) = a * b + c
+//   ReduceAdd(v)        the sum of the lanes
+// They follow the scalar UpdateValueWork of the rules, but compute in float.
+
+namespace paddle {
+namespace distributed {
+namespace sgd_kernel {
+
+// Calls func(i, mask) for the chunks of kWidth floats in [0, dim).
+template <class V, class Func>
+inline void ForEachChunk(size_t dim, Func&& func) {
+  size_t i = 0;
+  for (; i + V::kWidth <= dim; i += V::kWidth) {
+    func(i, V::FullMask());
+  }
+  if (i < dim) {
+    func(i, V::TailMask(dim - i));
+  }
+}
+
+// Same as BoundValue, a NaN is bounded to the min bound.
+template <class V>
+inline typename V::Vec Bound(typename V::Vec w,
+                             typename V::Vec min_bound,
+                             typename V::Vec max_bound) {
+  return V::Min(V::Max(w, min_bound), max_bound);
+}
+
+template <class V>
+void AdaGrad(const SparseSGDKernelParam& param,
+             float* const* w,
+             float* const* sgd,
+             const float* const* grad,
+             const float* scale,
+             size_t num) {
+  typedef typename V::Vec Vec;
+  typedef typename V::Mask Mask;
+  const Vec min_bound = V::Set1(param.min_bound);
+  const Vec max_bound = V::Set1(param.max_bound);
+  for (size_t k = 0; k < num; ++k) {
+    float* w_k = w[k];
+    const float* grad_k = grad[k];
+    float& g2sum = sgd[k][0];
+    const Vec ratio = V::Set1(
+        param.learning_rate *
+        sqrtf(param.initial_g2sum / (param.initial_g2sum + g2sum)));
+    const Vec scale_k = V::Set1(scale[k]);
+    Vec add_g2sum = V::Set1(0);
+    ForEachChunk<V>(param.dim, [&](size_t i, Mask mask) {
+      Vec scaled_grad = V::Div(V::Load(grad_k + i, mask), scale_k);
+      Vec w_i = V::Sub(V::Load(w_k + i, mask), V::Mul(ratio, scaled_grad));
+      V::Store(w_k + i, Bound<V>(w_i, min_bound, max_bound), mask);
+      scaled_grad = V::Select(scaled_grad, mask);
+      add_g2sum = V::Fmadd(scaled_grad, scaled_grad, add_g2sum);
+    });
+    g2sum += V::ReduceAdd(add_g2sum) / param.dim;
+  }
+}
+
+template <class V>
+void StdAdaGrad(const SparseSGDKernelParam& param,
+                float* const* w,
+                float* const* sgd,
+                const float* const* grad,
+                const float* scale,
+                size_t num) {
+  typedef typename V::Vec Vec;
+  typedef typename V::Mask Mask;
+  const Vec min_bound = V::Set1(param.min_bound);
+  const Vec max_bound = V::Set1(param.max_bound);
+  const Vec learning_rate = V::Set1(param.learning_rate);
+  const Vec initial_g2sum = V::Set1(param.initial_g2sum);
+  for (size_t k = 0; k < num; ++k) {
+    float* w_k = w[k];
+    float* g2sum_k = sgd[k];
+    const float* grad_k = grad[k];
+    const Vec scale_k = V::Set1(scale[k]);
+    ForEachChunk<V>(param.dim, [&](size_t i, Mask mask) {
+      Vec g2sum = V::Load(g2sum_k + i, mask);
+      Vec scaled_grad = V::Div(V::Load(grad_k + i, mask), scale_k);
+      Vec ratio = V::Mul(
+          learning_rate,
+          V::Sqrt(V::Div(initial_g2sum, V::Add(initial_g2sum, g2sum))));
+      Vec w_i = V::Sub(V::Load(w_k + i, mask), V::Mul(ratio, scaled_grad));
+      V::Store(w_k + i, Bound<V>(w_i, min_bound, max_bound), mask);
+      V::Store(g2sum_k + i, V::Fmadd(scaled_grad, scaled_grad, g2sum), mask);
+    });
+  }
+}
+
+template <class V>
+void Adam(const SparseSGDKernelParam& param,
+          float* const* w,
+          float* const* sgd,
+          const float* const* grad,
+          const float* scale,
+          size_t num) {
+  typedef typename V::Vec Vec;
+  typedef typename V::Mask Mask;
+  const Vec min_bound = V::Set1(param.min_bound);
+  const Vec max_bound = V::Set1(param.max_bound);
+  const Vec beta1 = V::Set1(param.beta1_decay_rate);
+  const Vec beta2 = V::Set1(param.beta2_decay_rate);
+  const Vec one_minus_beta1 = V::Set1(1 - param.beta1_decay_rate);
+  const Vec one_minus_beta2 = V::Set1(1 - param.beta2_decay_rate);
+  const Vec epsilon = V::Set1(param.ada_epsilon);
+  for (size_t k = 0; k < num; ++k) {
+    float* w_k = w[k];
+    float* gsum_k = sgd[k];
+    float* g2sum_k = gsum_k + param.dim;
+    float& beta1_pow = g2sum_k[param.dim];
+    float& beta2_pow = g2sum_k[param.dim + 1];
+    const float* grad_k = grad[k];
+    const Vec lr = V::Set1(param.learning_rate * sqrtf(1 - beta2_pow) /
+                           (1 - beta1_pow));
+    ForEachChunk<V>(param.dim, [&](size_t i, Mask mask) {
+      Vec g = V::Load(grad_k + i, mask);
+      Vec gsum = V::Fmadd(
+          beta1, V::Load(gsum_k + i, mask), V::Mul(one_minus_beta1, g));
+      Vec g2sum = V::Fmadd(beta2,
+                           V::Load(g2sum_k + i, mask),
+                           V::Mul(one_minus_beta2, V::Mul(g, g)));
+      Vec w_i = V::Sub(
+          V::Load(w_k + i, mask),
+          V::Mul(lr, V::Div(gsum, V::Add(V::Sqrt(g2sum), epsilon))));
+      V::Store(w_k + i, Bound<V>(w_i, min_bound, max_bound), mask);
+      V::Store(gsum_k + i, gsum, mask);
+      V::Store(g2sum_k + i, g2sum, mask);
+    });
+    beta1_pow *= param.beta1_decay_rate;
+    beta2_pow *= param.beta2_decay_rate;
+  }
+}
+
+template <class V>
+void SharedAdam(const SparseSGDKernelParam& param,
+                float* const* w,
+                float* const* sgd,
+                const float* const* grad,
+                const float* scale,
+                size_t num) {
+  typedef typename V::Vec Vec;
+  typedef typename V::Mask Mask;
+  const Vec min_bound = V::Set1(param.min_bound);
+  const Vec max_bound = V::Set1(param.max_bound);
+  const Vec one_minus_beta1 = V::Set1(1 - param.beta1_decay_rate);
+  const Vec one_minus_beta2 = V::Set1(1 - param.beta2_decay_rate);
+  const Vec epsilon = V::Set1(param.ada_epsilon);
+  for (size_t k = 0; k < num; ++k) {
+    float* w_k = w[k];
+    float& gsum = sgd[k][0];
+    float& g2sum = sgd[k][1];
+    float& beta1_pow = sgd[k][2];
+    float& beta2_pow = sgd[k][3];
+    const float* grad_k = grad[k];
+    const Vec lr = V::Set1(param.learning_rate * sqrtf(1 - beta2_pow) /
+                           (1 - beta1_pow));
+    const Vec decayed_gsum = V::Set1(param.beta1_decay_rate * gsum);
+    const Vec decayed_g2sum = V::Set1(param.beta2_decay_rate * g2sum);
+    Vec sum_gsum = V::Set1(0);
+    Vec sum_g2sum = V::Set1(0);
+    ForEachChunk<V>(param.dim, [&](size_t i, Mask mask) {
+      Vec g = V::Load(grad_k + i, mask);
+      Vec new_gsum = V::Fmadd(one_minus_beta1, g, decayed_gsum);
+      Vec new_g2sum = V::Fmadd(one_minus_beta2, V::Mul(g, g), decayed_g2sum);
+      Vec w_i = V::Sub(
+          V::Load(w_k + i, mask),
+          V::Mul(lr, V::Div(new_gsum, V::Add(V::Sqrt(new_g2sum), epsilon))));
+      V::Store(w_k + i, Bound<V>(w_i, min_bound, max_bound), mask);
+      sum_gsum = V::Add(sum_gsum, V::Select(new_gsum, mask));
+      sum_g2sum = V::Add(sum_g2sum, V::Select(new_g2sum, mask));
+    });
+    gsum = V::ReduceAdd(sum_gsum) / param.dim;
+    g2sum = V::ReduceAdd(sum_g2sum) / param.dim;
+    beta1_pow *= param.beta1_decay_rate;
+    beta2_pow *= param.beta2_decay_rate;
+  }
+}
+
+template <class V>
+const SparseSGDKernels* GetKernels() {
+  static const SparseSGDKernels kernels = {
+      AdaGrad<V>, StdAdaGrad<V>, Adam<V>, SharedAdam<V>};
+  return &kernels;
+}
+
+}  // namespace sgd_kernel
+}  // namespace distributed
+}  // namespace paddle
@@ -17,12 +17,34 @@
 #include <gflags/gflags.h>
 
 #include "glog/logging.h"
+#include "paddle/phi/backends/cpu/cpu_info.h"
 
 DEFINE_bool(enable_show_scale_gradient, true, "enable show scale gradient");
+DEFINE_bool(pserver_sparse_sgd_use_simd,
+            true,
+            "update the embeddings of dim >= 8 by the avx2 or avx512 kernels "
+            "in UpdateValueBatch of the sparse sgd rules");
 
 namespace paddle {
 namespace distributed {
 
+SparseSGDKernel SparseValueSGDRule::SelectBatchKernel(
+    SparseSGDKernel SparseSGDKernels::*select) const {
+  // the tail of a short embedding is most of the work
+  if (!FLAGS_pserver_sparse_sgd_use_simd || _embedding_dim < 8) {
+    return nullptr;
+  }
+  const SparseSGDKernels *kernels = nullptr;
+  if (phi::backends::cpu::MayIUse(phi::backends::cpu::avx512f)) {
+    kernels = GetSparseSGDKernelsAVX512();
+  }
+  if (kernels == nullptr &&
+      phi::backends::cpu::MayIUse(phi::backends::cpu::avx2)) {
+    kernels = GetSparseSGDKernelsAVX2();
+  }
+  return kernels == nullptr ? nullptr : kernels->*select;
+}
+
 void SparseNaiveSGDRule::LoadConfig(const SparseCommonSGDRuleParameter &param,
                                     size_t emb_dim) {
   _embedding_dim = emb_dim;
@@ -86,6 +108,7 @@ void SparseAdaGradSGDRule::LoadConfig(const SparseCommonSGDRuleParameter &param,
     _min_bound = adagrad_param.weight_bounds(0);
     _max_bound = adagrad_param.weight_bounds(1);
   }
+  _batch_kernel = SelectBatchKernel(&SparseSGDKernels::adagrad);
 }
 
 void SparseAdaGradSGDRule::UpdateValueWork(float *w,
@@ -106,6 +129,13 @@ void SparseAdaGradSGDRule::UpdateValueWork(float *w,
   g2sum += add_g2sum / _embedding_dim;
 }
 
+SparseSGDKernelParam SparseAdaGradSGDRule::BatchKernelParam() const {
+  SparseSGDKernelParam param = SparseValueSGDRule::BatchKernelParam();
+  param.learning_rate = learning_rate_;
+  param.initial_g2sum = _initial_g2sum;
+  return param;
+}
+
 void SparseAdaGradSGDRule::InitValueWork(float *value,
                                          float *sgd,
                                          bool zero_init) {
@@ -143,6 +173,7 @@ void StdAdaGradSGDRule::LoadConfig(const SparseCommonSGDRuleParameter &param,
     _min_bound = adagrad_param.weight_bounds(0);
     _max_bound = adagrad_param.weight_bounds(1);
   }
+  _batch_kernel = SelectBatchKernel(&SparseSGDKernels::std_adagrad);
 }
 
 void StdAdaGradSGDRule::UpdateValueWork(float *w,
@@ -159,6 +190,13 @@ void StdAdaGradSGDRule::UpdateValueWork(float *w,
   }
 }
 
+SparseSGDKernelParam StdAdaGradSGDRule::BatchKernelParam() const {
+  SparseSGDKernelParam param = SparseValueSGDRule::BatchKernelParam();
+  param.learning_rate = learning_rate_;
+  param.initial_g2sum = _initial_g2sum;
+  return param;
+}
+
 void StdAdaGradSGDRule::InitValueWork(float *value,
                                       float *sgd,
                                       bool zero_init) {
@@ -197,6 +235,7 @@ void SparseAdamSGDRule::LoadConfig(const SparseCommonSGDRuleParameter &param,
     _min_bound = adam_param.weight_bounds(0);
     _max_bound = adam_param.weight_bounds(1);
   }
+  _batch_kernel = SelectBatchKernel(&SparseSGDKernels::adam);
 }
 
 void SparseAdamSGDRule::UpdateValueWork(float *w,
@@ -227,6 +266,15 @@ void SparseAdamSGDRule::UpdateValueWork(float *w,
   (*beta2_pow) *= _beta2_decay_rate;
 }
 
+SparseSGDKernelParam SparseAdamSGDRule::BatchKernelParam() const {
+  SparseSGDKernelParam param = SparseValueSGDRule::BatchKernelParam();
+  param.learning_rate = learning_rate_;
+  param.beta1_decay_rate = _beta1_decay_rate;
+  param.beta2_decay_rate = _beta2_decay_rate;
+  param.ada_epsilon = _ada_epsilon;
+  return param;
+}
+
 void SparseAdamSGDRule::InitValueWork(float *value,
                                       float *sgd,
                                       bool zero_init) {
@@ -271,6 +319,7 @@ void SparseSharedAdamSGDRule::LoadConfig(
     _min_bound = adam_param.weight_bounds(0);
     _max_bound = adam_param.weight_bounds(1);
   }
+  _batch_kernel = SelectBatchKernel(&SparseSGDKernels::shared_adam);
 }
 
 void SparseSharedAdamSGDRule::UpdateValueWork(float *w,
@@ -310,6 +359,15 @@ void SparseSharedAdamSGDRule::UpdateValueWork(float *w,
   (*beta2_pow) *= _beta2_decay_rate;
 }
 
+SparseSGDKernelParam SparseSharedAdamSGDRule::BatchKernelParam() const {
+  SparseSGDKernelParam param = SparseValueSGDRule::BatchKernelParam();
+  param.learning_rate = learning_rate_;
+  param.beta1_decay_rate = _beta1_decay_rate;
+  param.beta2_decay_rate = _beta2_decay_rate;
+  param.ada_epsilon = _ada_epsilon;
+  return param;
+}
+
 void SparseSharedAdamSGDRule::InitValueWork(float *value,
                                             float *sgd,
                                             bool zero_init) {
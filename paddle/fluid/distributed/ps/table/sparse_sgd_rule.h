@@ -21,6 +21,7 @@
 #include "glog/logging.h"                                  // for CHECK
 #include "paddle/fluid/distributed/common/local_random.h"  // for local_uniform_real_distribution
 #include "paddle/fluid/distributed/common/registerer.h"
+#include "paddle/fluid/distributed/ps/table/sparse_sgd_kernel.h"
 #include "paddle/fluid/distributed/the_one_ps.pb.h"
 
 namespace paddle {
@@ -51,6 +52,21 @@ class SparseValueSGDRule {
                    float scale = 1) {
     UpdateValueWork(w, sgd, push_value, scale);
   }
+  // Updates num keys in a call, which is the same as calling UpdateValue for
+  // each key in order, up to the rounding of the vectorized kernel.
+  void UpdateValueBatch(float* const* w,
+                        float* const* sgd,
+                        const float* const* push_value,
+                        const float* scale,
+                        size_t num) {
+    if (_batch_kernel != nullptr) {
+      _batch_kernel(BatchKernelParam(), w, sgd, push_value, scale, num);
+      return;
+    }
+    for (size_t i = 0; i < num; ++i) {
+      UpdateValueWork(w[i], sgd[i], push_value[i], scale[i]);
+    }
+  }
   template <class T>
   void BoundValue(T& w) {  // NOLINT
     if (!(w >= _min_bound)) {
@@ -63,10 +79,24 @@ class SparseValueSGDRule {
   float& MaxBound() { return _max_bound; }
 
  protected:
+  // Returns the kernel of the best instruction set supported by the cpu
+  // picked by select, or nullptr if the kernels are disabled or unavailable.
+  SparseSGDKernel SelectBatchKernel(
+      SparseSGDKernel SparseSGDKernels::*select) const;
+  virtual SparseSGDKernelParam BatchKernelParam() const {
+    SparseSGDKernelParam param = SparseSGDKernelParam();
+    param.dim = _embedding_dim;
+    param.min_bound = _min_bound;
+    param.max_bound = _max_bound;
+    return param;
+  }
+
   float _min_bound;
   float _max_bound;
   float _initial_range;
   size_t _embedding_dim;
+  // the vectorized kernel used by UpdateValueBatch if not nullptr
+  SparseSGDKernel _batch_kernel = nullptr;
 
  private:
   std::string _name;
@@ -101,6 +131,9 @@ class SparseAdaGradSGDRule : public SparseValueSGDRule {
   virtual size_t Dim() { return 1; }
   size_t G2SumIndex() { return 0; }
 
+ protected:
+  virtual SparseSGDKernelParam BatchKernelParam() const;
+
  private:
   float learning_rate_;
   float _initial_g2sum;
@@ -118,6 +151,9 @@ class StdAdaGradSGDRule : public SparseValueSGDRule {
   virtual size_t Dim() { return _embedding_dim; }
   size_t G2SumIndex() { return 0; }
 
+ protected:
+  virtual SparseSGDKernelParam BatchKernelParam() const;
+
  private:
   float learning_rate_;
   float _initial_g2sum;
@@ -139,6 +175,8 @@ class SparseAdamSGDRule : public SparseValueSGDRule {
   size_t Beta2PowIndex() { return Beta1PowIndex() + 1; }
 
  protected:
+  virtual SparseSGDKernelParam BatchKernelParam() const;
+
   float learning_rate_;
   float _beta1_decay_rate;
   float _beta2_decay_rate;
@@ -161,6 +199,8 @@ class SparseSharedAdamSGDRule : public SparseValueSGDRule {
   size_t Beta2PowIndex() { return Beta1PowIndex() + 1; }
 
  protected:
+  virtual SparseSGDKernelParam BatchKernelParam() const;
+
   float learning_rate_;
   float _beta1_decay_rate;
   float _beta2_decay_rate;
@@ -14,6 +14,8 @@
 
 #include "paddle/fluid/distributed/ps/table/ssd_sparse_table.h"
 
+#include <algorithm>
+
 #include "paddle/fluid/distributed/common/cost_timer.h"
 #include "paddle/fluid/distributed/common/local_random.h"
 #include "paddle/fluid/distributed/common/topk_calculator.h"
@@ -25,6 +27,11 @@ DECLARE_bool(pserver_create_value_when_push);
 DECLARE_bool(pserver_enable_create_feasign_randomly);
 DEFINE_bool(pserver_open_strict_check, false, "pserver_open_strict_check");
 DEFINE_int32(pserver_load_batch_size, 5000, "load batch size for ssd");
+DEFINE_int32(pserver_ssd_shard_mem_mb,
+             0,
+             "memory budget in MB of each shard of the ssd sparse table, the "
+             "less frequently accessed keys are kept in rocksdb when it is "
+             "exceeded, 0 means unbounded");
 PADDLE_DEFINE_EXPORTED_string(rocksdb_path,
                               "database",
                               "path of sparse table rocksdb file");
@@ -32,13 +39,40 @@ PADDLE_DEFINE_EXPORTED_string(rocksdb_path,
 namespace paddle {
 namespace distributed {
 
+// The memory of a key in the memory shards besides its value, including the
+// hash map slot and the FixedFeatureValue.
+static const size_t kShardKeyOverhead = 64;
+// The keys sampled to estimate the frequency threshold of the demotion.
+static const size_t kDemoteSampleNum = 1024;
+
+SSDSparseTable::~SSDSparseTable() { WaitCacheTasks(); }
+
 int32_t SSDSparseTable::Initialize() {
   MemorySparseTable::Initialize();
   _db = paddle::distributed::RocksDBHandler::GetInstance();
   _db->initialize(FLAGS_rocksdb_path, _real_local_shard_num);
+  _shard_caches.reset(new ShardCache[_real_local_shard_num]);
+  if (FLAGS_pserver_ssd_shard_mem_mb > 0) {
+#ifdef PADDLE_WITH_HETERPS
+    // the values pulled by PullSparsePtr are referenced during the pass
+    LOG(WARNING) << "pserver_ssd_shard_mem_mb is not supported with HeterPS, "
+                    "the memory shards are unbounded";
+#else
+    size_t key_bytes =
+        _value_accesor->GetAccessorInfo().size + kShardKeyOverhead;
+    _shard_mem_key_budget =
+        (static_cast<size_t>(FLAGS_pserver_ssd_shard_mem_mb) << 20) /
+        key_bytes;
+    _shard_mem_key_budget = std::max(_shard_mem_key_budget, kDemoteSampleNum);
+    for (int i = 0; i < _real_local_shard_num; ++i) {
+      _shard_caches[i].sketch.EnsureCapacity(_shard_mem_key_budget);
+    }
+#endif
+  }
   VLOG(0) << "initalize SSDSparseTable succ";
   VLOG(0) << "SSD FLAGS_pserver_print_missed_key_num_every_push:"
           << FLAGS_pserver_print_missed_key_num_every_push;
+  VLOG(0) << "SSD shard memory key budget:" << _shard_mem_key_budget;
   return 0;
 }
 
@@ -106,10 +140,15 @@ int32_t SSDSparseTable::PullSparse(float* pull_values,
                &missed_keys]() -> int {
                 auto& keys = task_keys[shard_id];
                 auto& local_shard = _local_shards[shard_id];
+                auto& cache = _shard_caches[shard_id];
+                CacheStat stat;
                 float data_buffer[value_size];  // NOLINT
                 float* data_buffer_ptr = data_buffer;
                 for (size_t i = 0; i < keys.size(); ++i) {
                   uint64_t key = keys[i].first;
+                  if (UseCacheBudget()) {
+                    cache.sketch.Increment(key);
+                  }
                   auto itr = local_shard.find(key);
                   size_t data_size = value_size - mf_value_size;
                   if (itr == local_shard.end()) {
@@ -120,6 +159,7 @@ int32_t SSDSparseTable::PullSparse(float* pull_values,
                                  sizeof(uint64_t),
                                  tmp_string) > 0) {
                       ++missed_keys;
+                      ++stat.misses;
                       if (FLAGS_pserver_create_value_when_push) {
                         memset(data_buffer, 0, sizeof(float) * data_size);
                       } else {
@@ -137,17 +177,24 @@ int32_t SSDSparseTable::PullSparse(float* pull_values,
                       memcpy(data_buffer_ptr,
                              paddle::string::str_to_float(tmp_string),
                              data_size * sizeof(float));
-                      // from rocksdb to mem
-                      auto& feature_value = local_shard[key];
-                      feature_value.resize(data_size);
-                      memcpy(const_cast<float*>(feature_value.data()),
-                             data_buffer_ptr,
-                             data_size * sizeof(float));
-                      _db->del_data(shard_id,
-                                    reinterpret_cast<char*>(&key),
-                                    sizeof(uint64_t));
+                      ++stat.ssd_hits;
+                      if (AdmitToMemory(shard_id, key)) {
+                        // from rocksdb to mem
+                        ++stat.promotions;
+                        auto& feature_value = local_shard[key];
+                        feature_value.resize(data_size);
+                        memcpy(const_cast<float*>(feature_value.data()),
+                               data_buffer_ptr,
+                               data_size * sizeof(float));
+                        _db->del_data(shard_id,
+                                      reinterpret_cast<char*>(&key),
+                                      sizeof(uint64_t));
+                      } else {
+                        ++stat.rejections;
+                      }
                     }
                   } else {
+                    ++stat.mem_hits;
                     data_size = itr.value().size();
                     memcpy(data_buffer_ptr,
                            itr.value().data(),
@@ -163,6 +210,8 @@ int32_t SSDSparseTable::PullSparse(float* pull_values,
                   _value_accesor->Select(
                       &select_data, (const float**)&data_buffer_ptr, 1);
                 }
+                AddCacheStat(shard_id, stat);
+                MaybeDemote(shard_id);
                 return 0;
               });
     }
@@ -197,6 +246,7 @@ int32_t SSDSparseTable::PullSparsePtr(int shard_id,
     float data_buffer[value_size];  // NOLINT
     float* data_buffer_ptr = data_buffer;
 
+    CacheStat stat;
     for (size_t i = 0; i < num; ++i) {
       uint64_t key = pull_keys[i];
       auto itr = local_shard.find(key);
@@ -224,6 +274,7 @@ int32_t SSDSparseTable::PullSparsePtr(int shard_id,
               uint64_t cur_key = *(reinterpret_cast<uint64_t*>(
                   const_cast<char*>(cur_ctx->batch_keys[idx].data())));
               if (cur_ctx->status[idx].IsNotFound()) {
+                ++stat.misses;
                 auto& feature_value = local_shard[cur_key];
                 int init_size = value_size - mf_value_size;
                 feature_value.resize(init_size);
@@ -233,6 +284,8 @@ int32_t SSDSparseTable::PullSparsePtr(int shard_id,
                        init_size * sizeof(float));
                 ret = &feature_value;
               } else {
+                ++stat.ssd_hits;
+                ++stat.promotions;
                 int data_size =
                     cur_ctx->batch_values[idx].size() / sizeof(float);
                 // from rocksdb to mem
@@ -257,6 +310,7 @@ int32_t SSDSparseTable::PullSparsePtr(int shard_id,
           tasks.push_back(std::move(fut));
         }
       } else {
+        ++stat.mem_hits;
         ret = itr.value_ptr();
         // int pull_data_idx = keys[i].second;
         _value_accesor->UpdatePassId(ret->data(), pass_id);
@@ -287,6 +341,7 @@ int32_t SSDSparseTable::PullSparsePtr(int shard_id,
         uint64_t cur_key = *(reinterpret_cast<uint64_t*>(
             const_cast<char*>(cur_ctx->batch_keys[idx].data())));
         if (cur_ctx->status[idx].IsNotFound()) {
+          ++stat.misses;
           auto& feature_value = local_shard[cur_key];
           int init_size = value_size - mf_value_size;
           feature_value.resize(init_size);
@@ -296,6 +351,8 @@ int32_t SSDSparseTable::PullSparsePtr(int shard_id,
                  init_size * sizeof(float));
           ret = &feature_value;
         } else {
+          ++stat.ssd_hits;
+          ++stat.promotions;
           int data_size = cur_ctx->batch_values[idx].size() / sizeof(float);
           // from rocksdb to mem
           auto& feature_value = local_shard[cur_key];
@@ -314,6 +371,7 @@ int32_t SSDSparseTable::PullSparsePtr(int shard_id,
       }
       cur_ctx->reset();
     }
+    AddCacheStat(shard_id, stat);
   }
   return 0;
 }
@@ -348,6 +406,8 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                &task_keys]() -> int {
                 auto& keys = task_keys[shard_id];
                 auto& local_shard = _local_shards[shard_id];
+                auto& cache = _shard_caches[shard_id];
+                CacheStat stat;
                 float data_buffer[value_col];  // NOLINT
                 float* data_buffer_ptr = data_buffer;
                 for (size_t i = 0; i < keys.size(); ++i) {
@@ -355,8 +415,31 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                   uint64_t push_data_idx = keys[i].second;
                   const float* update_data =
                       values + push_data_idx * update_value_col;
+                  if (UseCacheBudget()) {
+                    cache.sketch.Increment(key);
+                  }
                   auto itr = local_shard.find(key);
+                  if (itr != local_shard.end()) {
+                    ++stat.mem_hits;
+                  } else if (UseCacheBudget()) {
+                    // the keys not admitted to memory are updated in rocksdb
+                    bool promoted = false;
+                    if (PushToSSDValue(shard_id,
+                                       key,
+                                       update_data,
+                                       data_buffer_ptr,
+                                       &promoted)) {
+                      ++stat.ssd_hits;
+                      if (!promoted) {
+                        ++stat.rejections;
+                        continue;
+                      }
+                      ++stat.promotions;
+                      itr = local_shard.find(key);
+                    }
+                  }
                   if (itr == local_shard.end()) {
+                    ++stat.misses;
                     if (FLAGS_pserver_enable_create_feasign_randomly &&
                         !_value_accesor->CreateValue(1, update_data)) {
                       continue;
@@ -393,6 +476,8 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                            value_size * sizeof(float));
                   }
                 }
+                AddCacheStat(shard_id, stat);
+                MaybeDemote(shard_id);
                 return 0;
               });
     }
@@ -454,14 +539,39 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                &task_keys]() -> int {
                 auto& keys = task_keys[shard_id];
                 auto& local_shard = _local_shards[shard_id];
+                auto& cache = _shard_caches[shard_id];
+                CacheStat stat;
                 float data_buffer[value_col];  // NOLINT
                 float* data_buffer_ptr = data_buffer;
                 for (size_t i = 0; i < keys.size(); ++i) {
                   uint64_t key = keys[i].first;
                   uint64_t push_data_idx = keys[i].second;
                   const float* update_data = values[push_data_idx];
+                  if (UseCacheBudget()) {
+                    cache.sketch.Increment(key);
+                  }
                   auto itr = local_shard.find(key);
+                  if (itr != local_shard.end()) {
+                    ++stat.mem_hits;
+                  } else if (UseCacheBudget()) {
+                    // the keys not admitted to memory are updated in rocksdb
+                    bool promoted = false;
+                    if (PushToSSDValue(shard_id,
+                                       key,
+                                       update_data,
+                                       data_buffer_ptr,
+                                       &promoted)) {
+                      ++stat.ssd_hits;
+                      if (!promoted) {
+                        ++stat.rejections;
+                        continue;
+                      }
+                      ++stat.promotions;
+                      itr = local_shard.find(key);
+                    }
+                  }
                   if (itr == local_shard.end()) {
+                    ++stat.misses;
                     if (FLAGS_pserver_enable_create_feasign_randomly &&
                         !_value_accesor->CreateValue(1, update_data)) {
                       continue;
@@ -498,6 +608,8 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                            value_size * sizeof(float));
                   }
                 }
+                AddCacheStat(shard_id, stat);
+                MaybeDemote(shard_id);
                 return 0;
               });
     }
@@ -508,7 +620,193 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
   return 0;
 }
 
+bool SSDSparseTable::PushToSSDValue(int shard_id,
+                                    uint64_t key,
+                                    const float* update_data,
+                                    float* data_buffer,
+                                    bool* promoted) {
+  std::string tmp_string("");
+  if (_db->get(shard_id,
+               reinterpret_cast<char*>(&key),
+               sizeof(uint64_t),
+               tmp_string) > 0) {
+    return false;
+  }
+  size_t data_size = tmp_string.size() / sizeof(float);
+  const float* ssd_data = paddle::string::str_to_float(tmp_string);
+  *promoted = AdmitToMemory(shard_id, key);
+  if (*promoted) {
+    // from rocksdb to mem, and updated by the caller
+    auto& feature_value = _local_shards[shard_id][key];
+    feature_value.resize(data_size);
+    memcpy(feature_value.data(), ssd_data, data_size * sizeof(float));
+    _db->del_data(shard_id, reinterpret_cast<char*>(&key), sizeof(uint64_t));
+    return true;
+  }
+  size_t value_col = _value_accesor->GetAccessorInfo().size / sizeof(float);
+  memcpy(data_buffer, ssd_data, data_size * sizeof(float));
+  _value_accesor->Update(&data_buffer, &update_data, 1);
+  if (data_size < value_col && _value_accesor->NeedExtendMF(data_buffer)) {
+    std::vector<float> extended_value(value_col);
+    float* extended_data = extended_value.data();
+    _value_accesor->Create(&extended_data, 1);
+    memcpy(extended_data, data_buffer, data_size * sizeof(float));
+    _db->put(shard_id,
+             reinterpret_cast<char*>(&key),
+             sizeof(uint64_t),
+             reinterpret_cast<char*>(extended_data),
+             value_col * sizeof(float));
+  } else {
+    _db->put(shard_id,
+             reinterpret_cast<char*>(&key),
+             sizeof(uint64_t),
+             reinterpret_cast<char*>(data_buffer),
+             data_size * sizeof(float));
+  }
+  return true;
+}
+
+bool SSDSparseTable::AdmitToMemory(int shard_id, uint64_t key) {
+  if (!UseCacheBudget() ||
+      _local_shards[shard_id].size() < _shard_mem_key_budget) {
+    return true;
+  }
+  auto& cache = _shard_caches[shard_id];
+  return cache.sketch.Frequency(key) > cache.admit_frequency;
+}
+
+void SSDSparseTable::MaybeDemote(int shard_id) {
+  auto& cache = _shard_caches[shard_id];
+  if (!UseCacheBudget() || cache.demote_pending ||
+      _local_shards[shard_id].size() <= _shard_mem_key_budget) {
+    return;
+  }
+  cache.demote_pending = true;
+  _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
+      [this, shard_id]() -> int {
+        DemoteShard(shard_id);
+        return 0;
+      });
+}
+
+void SSDSparseTable::DemoteShard(int shard_id) {
+  auto& cache = _shard_caches[shard_id];
+  auto& shard = _local_shards[shard_id];
+  cache.demote_pending = false;
+  // demote to 90% of the budget, so that it is not triggered by every pull
+  size_t target = _shard_mem_key_budget / 10 * 9;
+  if (shard.size() <= target) {
+    return;
+  }
+  size_t demote_num = shard.size() - target;
+  size_t bucket_num = shard.bucket_count();
+
+  // the frequency of the demote_num-th least frequent key, estimated by the
+  // keys sampled from the buckets to be swept
+  std::vector<int> frequencies;
+  frequencies.reserve(kDemoteSampleNum);
+  for (size_t i = 0; i < bucket_num && frequencies.size() < kDemoteSampleNum;
+       ++i) {
+    size_t bucket = (cache.demote_bucket + i) % bucket_num;
+    for (auto it = shard.begin(bucket);
+         it != shard.end(bucket) && frequencies.size() < kDemoteSampleNum;
+         ++it) {
+      frequencies.push_back(cache.sketch.Frequency(it.key()));
+    }
+  }
+  size_t nth = std::min(frequencies.size() - 1,
+                        frequencies.size() * demote_num / shard.size());
+  std::nth_element(
+      frequencies.begin(), frequencies.begin() + nth, frequencies.end());
+  int threshold = frequencies[nth];
+  cache.admit_frequency = threshold;
+
+  // sweep the buckets from the last demoted one, and demote the keys not more
+  // frequent than the threshold, or any key if they are not enough
+  std::vector<uint64_t> keys;
+  std::vector<FixedFeatureValue*> values;
+  std::vector<std::pair<char*, int>> ssd_keys;
+  std::vector<std::pair<char*, int>> ssd_values;
+  size_t demoted = 0;
+  for (int pass = 0; pass < 2 && demoted < demote_num; ++pass) {
+    for (size_t i = 0; i < bucket_num && demoted < demote_num; ++i) {
+      size_t bucket = (cache.demote_bucket + i) % bucket_num;
+      keys.clear();
+      values.clear();
+      for (auto it = shard.begin(bucket);
+           it != shard.end(bucket) && demoted + keys.size() < demote_num;
+           ++it) {
+        if (pass == 0 && cache.sketch.Frequency(it.key()) > threshold) {
+          continue;
+        }
+        keys.push_back(it.key());
+        values.push_back(&it.value());
+      }
+      if (keys.empty()) {
+        continue;
+      }
+      ssd_keys.clear();
+      ssd_values.clear();
+      for (size_t j = 0; j < keys.size(); ++j) {
+        ssd_keys.emplace_back(reinterpret_cast<char*>(&keys[j]),
+                              sizeof(uint64_t));
+        ssd_values.emplace_back(reinterpret_cast<char*>(values[j]->data()),
+                                values[j]->size() * sizeof(float));
+      }
+      _db->put_batch(shard_id, ssd_keys, ssd_values, keys.size());
+      for (auto key : keys) {
+        shard.erase(key);
+      }
+      demoted += keys.size();
+      cache.demote_bucket = bucket;
+    }
+  }
+  cache.demotions.fetch_add(demoted, std::memory_order_relaxed);
+  VLOG(3) << "SSDSparseTable demote shard:" << shard_id
+          << " keys:" << demoted << " threshold:" << threshold;
+}
+
+void SSDSparseTable::WaitCacheTasks() {
+  if (!UseCacheBudget()) {
+    return;
+  }
+  // the task pools run the tasks in order, so the demotions queued before
+  // are done when the tasks queued now are done
+  std::vector<std::future<int>> tasks;
+  for (auto& task_pool : _shards_task_pool) {
+    tasks.push_back(task_pool->enqueue([]() -> int { return 0; }));
+  }
+  for (auto& task : tasks) {
+    task.wait();
+  }
+}
+
+void SSDSparseTable::AddCacheStat(int shard_id, const CacheStat& stat) {
+  auto& cache = _shard_caches[shard_id];
+  cache.mem_hits.fetch_add(stat.mem_hits, std::memory_order_relaxed);
+  cache.ssd_hits.fetch_add(stat.ssd_hits, std::memory_order_relaxed);
+  cache.misses.fetch_add(stat.misses, std::memory_order_relaxed);
+  cache.promotions.fetch_add(stat.promotions, std::memory_order_relaxed);
+  cache.rejections.fetch_add(stat.rejections, std::memory_order_relaxed);
+}
+
+SSDSparseTable::CacheStat SSDSparseTable::GetCacheStat() {
+  WaitCacheTasks();
+  CacheStat stat;
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    auto& cache = _shard_caches[i];
+    stat.mem_hits += cache.mem_hits.load(std::memory_order_relaxed);
+    stat.ssd_hits += cache.ssd_hits.load(std::memory_order_relaxed);
+    stat.misses += cache.misses.load(std::memory_order_relaxed);
+    stat.promotions += cache.promotions.load(std::memory_order_relaxed);
+    stat.rejections += cache.rejections.load(std::memory_order_relaxed);
+    stat.demotions += cache.demotions.load(std::memory_order_relaxed);
+  }
+  return stat;
+}
+
 int32_t SSDSparseTable::Shrink(const std::string& param) {
+  WaitCacheTasks();
   int thread_num = _real_local_shard_num < 20 ? _real_local_shard_num : 20;
   omp_set_num_threads(thread_num);
 #pragma omp parallel for schedule(dynamic)
@@ -549,6 +847,7 @@ int32_t SSDSparseTable::Shrink(const std::string& param) {
 }
 
 int32_t SSDSparseTable::UpdateTable() {
+  WaitCacheTasks();
   int count = 0;
   for (int i = 0; i < _real_local_shard_num; ++i) {
     auto& shard = _local_shards[i];
@@ -583,6 +882,7 @@ int64_t SSDSparseTable::LocalSize() {
 int32_t SSDSparseTable::Save(const std::string& path,
                              const std::string& param) {
   std::lock_guard<std::mutex> guard(_table_mutex);
+  WaitCacheTasks();
 #ifdef PADDLE_WITH_HETERPS
   int save_param = atoi(param.c_str());
   int32_t ret = 0;
@@ -1526,6 +1826,7 @@ int32_t SSDSparseTable::SaveCache(
 int32_t SSDSparseTable::Load(const std::string& path,
                              const std::string& param) {
   VLOG(0) << "LOAD FLAGS_rocksdb_path:" << FLAGS_rocksdb_path;
+  WaitCacheTasks();
   std::string table_path = TableDir(path);
   auto file_list = _afs_client.list(table_path);
 
@@ -1945,11 +2246,21 @@ int32_t SSDSparseTable::LoadWithBinary(const std::string& path, int param) {
 
 std::pair<int64_t, int64_t> SSDSparseTable::PrintTableStat() {
   int64_t feasign_size = LocalSize();
+  CacheStat stat = GetCacheStat();
+  uint64_t access = stat.mem_hits + stat.ssd_hits + stat.misses;
+  LOG(INFO) << "SSDSparseTable mem feasign:" << feasign_size
+            << " mem_hits:" << stat.mem_hits << " ssd_hits:" << stat.ssd_hits
+            << " misses:" << stat.misses << " mem_hit_rate:"
+            << (access > 0 ? static_cast<double>(stat.mem_hits) / access : 0)
+            << " promotions:" << stat.promotions
+            << " rejections:" << stat.rejections
+            << " demotions:" << stat.demotions;
   return {feasign_size, -1};
 }
 
 int32_t SSDSparseTable::CacheTable(uint16_t pass_id) {
   std::lock_guard<std::mutex> guard(_table_mutex);
+  WaitCacheTasks();
   VLOG(0) << "cache_table";
   std::atomic<uint32_t> count{0};
   std::vector<std::future<int>> tasks;
@@ -14,7 +14,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+
 #include "gflags/gflags.h"
+#include "paddle/fluid/distributed/common/frequency_sketch.h"
 #include "paddle/fluid/distributed/ps/table/depends/rocksdb_warpper.h"
 #include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
 
@@ -56,11 +60,29 @@ class MemRegion {
   char* _buf;
 };
 
+// SSDSparseTable keeps the hot keys in the memory shards and the others in
+// rocksdb. If FLAGS_pserver_ssd_shard_mem_mb is set, the keys of a memory
+// shard are bounded by the budget with a TinyLFU policy: a key read from
+// rocksdb is promoted to memory only if the shard is under the budget or the
+// key is accessed more frequently than the keys demoted last time, otherwise
+// it is served and updated in rocksdb. When a shard exceeds the budget, its
+// least frequently accessed keys are demoted to rocksdb by a task queued to
+// the task pool of the shard, after the pull or push.
 class SSDSparseTable : public MemorySparseTable {
  public:
   typedef SparseTableShard<uint64_t, FixedFeatureValue> shard_type;
+  // The accesses of the keys in the memory shards and in rocksdb.
+  struct CacheStat {
+    uint64_t mem_hits = 0;
+    uint64_t ssd_hits = 0;
+    uint64_t misses = 0;  // new keys
+    uint64_t promotions = 0;
+    uint64_t rejections = 0;  // ssd hits not admitted to memory
+    uint64_t demotions = 0;
+  };
+
   SSDSparseTable() {}
-  virtual ~SSDSparseTable() {}
+  virtual ~SSDSparseTable();
 
   int32_t Initialize() override;
   int32_t InitializeShard() override;
@@ -122,12 +144,61 @@ class SSDSparseTable : public MemorySparseTable {
 
   int32_t CacheTable(uint16_t pass_id) override;
 
+  // The accesses summed over the local shards, after the queued demotions.
+  CacheStat GetCacheStat();
+  // The keys a memory shard may hold, 0 means unbounded.
+  size_t ShardMemKeyBudget() const { return _shard_mem_key_budget; }
+
+ protected:
+  bool CanUseFlatShard() const override { return false; }
+  bool CanMergePush() const override { return false; }
+
  private:
+  // The two tier cache state of a local shard, which is only accessed by the
+  // task pool of the shard except the counters.
+  struct ShardCache {
+    FrequencySketch sketch;
+    // Frequency of the keys demoted last time, the keys in rocksdb more
+    // frequent than it are admitted to a full shard.
+    int admit_frequency = 0;
+    size_t demote_bucket = 0;
+    bool demote_pending = false;
+    std::atomic<uint64_t> mem_hits{0};
+    std::atomic<uint64_t> ssd_hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> promotions{0};
+    std::atomic<uint64_t> rejections{0};
+    std::atomic<uint64_t> demotions{0};
+  };
+
+  bool UseCacheBudget() const { return _shard_mem_key_budget > 0; }
+  // Whether the key read from rocksdb is promoted to the memory shard.
+  bool AdmitToMemory(int shard_id, uint64_t key);
+  // Queues the demotion of the shard if it exceeds the budget, called in the
+  // task pool of the shard.
+  void MaybeDemote(int shard_id);
+  void DemoteShard(int shard_id);
+  // Waits for the queued demotions.
+  void WaitCacheTasks();
+  void AddCacheStat(int shard_id, const CacheStat& stat);
+  // Looks up the key missed in the memory shard in rocksdb, and returns
+  // whether it is found. The value is promoted to the memory shard to be
+  // updated by the caller if admitted, otherwise updated in rocksdb.
+  bool PushToSSDValue(int shard_id,
+                      uint64_t key,
+                      const float* update_data,
+                      float* data_buffer,
+                      bool* promoted);
+
   RocksDBHandler* _db;
   int64_t _cache_tk_size;
   double _local_show_threshold{0.0};
   std::vector<paddle::framework::Channel<std::string>> _fs_channel;
   std::mutex _table_mutex;
+
+  // The keys a memory shard may hold, 0 means unbounded.
+  size_t _shard_mem_key_budget = 0;
+  std::unique_ptr<ShardCache[]> _shard_caches;
 };
 
 }  // namespace distributed
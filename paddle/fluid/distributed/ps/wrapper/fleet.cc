@@ -65,7 +65,9 @@ void FleetWrapper::LoadSparseOnServer(const std::string& path,
                                       uint32_t table_id) {
   VLOG(3) << "load sparse table " << table_id << " with " << path << " meta "
           << meta;
-  pserver_ptr_->_server_ptr->GetTable(table_id)->Load(path, meta);
+  auto* table = pserver_ptr_->_server_ptr->GetTable(table_id);
+  table->Flush();
+  table->Load(path, meta);
 }
 
 void FleetWrapper::InitServer(
@@ -14,9 +14,11 @@ limitations under the License. */
 
 #include "paddle/fluid/distributed/ps/table/depends/feature_value.h"
 
+#include <set>
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/table/depends/flat_feature_value.h"
 
 namespace paddle {
 namespace distributed {
@@ -46,5 +48,70 @@ TEST(BENCHMARK, LargeScaleKV) {
   ASSERT_FLOAT_EQ(value_data[3], 0.3);
 }
 
+TEST(FlatSparseTableShard, InsertFindErase) {
+  typedef FlatSparseTableShard<uint64_t> shard_type;
+  const size_t value_capacity = 11;
+  const uint64_t num = 100000;
+  shard_type shard;
+  shard.set_value_capacity(value_capacity);
+  ASSERT_TRUE(shard.find(1) == shard.end());
+
+  // The keys of a shard share the same remainder of the shard number.
+  std::vector<FlatFeatureValue*> values;
+  for (uint64_t i = 0; i < num; ++i) {
+    auto& feature_value = shard[i * 1000 + 7];
+    ASSERT_EQ(feature_value.size(), 0UL);
+    ASSERT_EQ(feature_value.capacity(), value_capacity);
+    feature_value.resize(i % 2 == 0 ? value_capacity : 3);
+    feature_value.data()[0] = static_cast<float>(i);
+    values.push_back(&feature_value);
+  }
+  ASSERT_EQ(shard.size(), num);
+
+  // The values are not moved when the index grows.
+  for (uint64_t i = 0; i < num; ++i) {
+    auto itr = shard.find(i * 1000 + 7);
+    ASSERT_TRUE(itr != shard.end());
+    ASSERT_EQ(itr.key(), i * 1000 + 7);
+    ASSERT_EQ(itr.value_ptr(), values[i]);
+    ASSERT_EQ(itr.value().size(), i % 2 == 0 ? value_capacity : 3);
+    ASSERT_FLOAT_EQ(itr.value().data()[0], static_cast<float>(i));
+  }
+  ASSERT_TRUE(shard.find(8) == shard.end());
+
+  // Erase the odd keys while iterating, like the shrink of the tables.
+  size_t visited = 0;
+  std::set<FlatFeatureValue*> erased_values;
+  for (auto it = shard.begin(); it != shard.end();) {
+    ++visited;
+    if (it.value().size() != value_capacity) {
+      erased_values.insert(it.value_ptr());
+      it = shard.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  ASSERT_EQ(visited, num);
+  ASSERT_EQ(shard.size(), num / 2);
+  for (uint64_t i = 0; i < num; ++i) {
+    ASSERT_EQ(shard.find(i * 1000 + 7) != shard.end(), i % 2 == 0);
+  }
+
+  // The erased records are reused.
+  for (uint64_t i = 0; i < num / 2; ++i) {
+    auto& feature_value = shard[i * 1000 + 8];
+    ASSERT_EQ(erased_values.count(&feature_value), 1UL);
+    ASSERT_EQ(feature_value.size(), 0UL);
+  }
+  ASSERT_EQ(shard.size(), num);
+  LOG(INFO) << "FlatSparseTableShard uses " << shard.memory_size() / num
+            << " bytes per key of " << value_capacity << " floats";
+
+  shard.clear();
+  ASSERT_TRUE(shard.empty());
+  ASSERT_TRUE(shard.begin() == shard.end());
+  ASSERT_TRUE(shard.find(7) == shard.end());
+}
+
 }  // namespace distributed
 }  // namespace paddle
@@ -0,0 +1,67 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/common/frequency_sketch.h"
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace distributed {
+
+TEST(FrequencySketch, Frequency) {
+  FrequencySketch sketch(1024);
+  ASSERT_EQ(sketch.Frequency(1), 0);
+  for (int i = 0; i < 5; ++i) {
+    sketch.Increment(1);
+  }
+  ASSERT_EQ(sketch.Frequency(1), 5);
+
+  // saturated at kMaxFrequency
+  for (int i = 0; i < 100; ++i) {
+    sketch.Increment(2);
+  }
+  ASSERT_EQ(sketch.Frequency(2),
+            static_cast<int>(FrequencySketch::kMaxFrequency));
+
+  sketch.Reset();
+  ASSERT_EQ(sketch.Frequency(1), 2);
+  ASSERT_EQ(sketch.Frequency(2), 7);
+}
+
+TEST(FrequencySketch, HotKeys) {
+  // 100 hot keys accessed 10 times as often as 10000 cold keys, with the
+  // counters halved several times.
+  const size_t capacity = 1000;
+  FrequencySketch sketch(capacity);
+  for (int round = 0; round < 20; ++round) {
+    for (uint64_t key = 0; key < 10000; ++key) {
+      sketch.Increment(key + 1000000);
+      if (key % 10 == 0) {
+        sketch.Increment(key / 10 % 100);
+      }
+    }
+  }
+  int hot = 0;
+  for (uint64_t key = 0; key < 100; ++key) {
+    hot += sketch.Frequency(key);
+  }
+  int cold = 0;
+  for (uint64_t key = 0; key < 100; ++key) {
+    cold += sketch.Frequency(key + 1000000);
+  }
+  ASSERT_GT(hot, 2 * cold);
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -17,17 +17,107 @@ limitations under the License. */
 #include <ThreadPool.h>
 #include <unistd.h>
 
+#include <cstdlib>
+#include <memory>
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "google/protobuf/text_format.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/distributed/ps/table/table.h"
 #include "paddle/fluid/distributed/the_one_ps.pb.h"
+#include "paddle/fluid/framework/io/fs.h"
+
+DECLARE_int32(pserver_push_merge_window_ms);
 
 namespace paddle {
 namespace distributed {
 
+// the table of CtrCommonAccessor with the naive sgd rules
+TableParameter MakeCtrTableConfig(int emb_dim) {
+  TableParameter table_config;
+  table_config.set_table_class("MemorySparseTable");
+  table_config.set_shard_num(10);
+  TableAccessorParameter *accessor_config = table_config.mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(11);
+  accessor_config->set_embedx_dim(emb_dim);
+  accessor_config->set_embedx_threshold(5);
+  accessor_config->mutable_embed_sgd_param()->set_name("SparseNaiveSGDRule");
+  auto *naive_param =
+      accessor_config->mutable_embed_sgd_param()->mutable_naive();
+  naive_param->set_learning_rate(0.1);
+  naive_param->set_initial_range(0.3);
+  accessor_config->mutable_embedx_sgd_param()->set_name("SparseNaiveSGDRule");
+  naive_param = accessor_config->mutable_embedx_sgd_param()->mutable_naive();
+  naive_param->set_learning_rate(0.1);
+  naive_param->set_initial_range(0.3);
+  return table_config;
+}
+
+std::unique_ptr<Table> MakeTable(const TableParameter &table_config) {
+  std::unique_ptr<Table> table(new MemorySparseTable());
+  table->SetShard(0, 1);
+  FsClientParameter fs_config;
+  EXPECT_EQ(table->Initialize(table_config, fs_config), 0);
+  return table;
+}
+
+// the push gradients of the keys with the show and the embed gradients 0.1
+std::vector<float> MakeGradients(size_t key_num, float show, int emb_dim) {
+  std::vector<float> gradients;
+  for (size_t i = 0; i < key_num; ++i) {
+    gradients.push_back(0);     // slot
+    gradients.push_back(show);  // show
+    gradients.push_back(0);     // click
+    for (int j = 0; j < emb_dim + 1; ++j) {
+      gradients.push_back(0.1);
+    }
+  }
+  return gradients;
+}
+
+int32_t PushGradients(Table *table,
+                      std::vector<uint64_t> *keys,
+                      std::vector<float> *gradients) {
+  TableContext push_context;
+  push_context.value_type = Sparse;
+  push_context.push_context.keys = keys->data();
+  push_context.push_context.values = gradients->data();
+  push_context.num = keys->size();
+  return table->Push(push_context);
+}
+
+std::vector<char *> PullPtrs(Table *table, std::vector<uint64_t> *keys) {
+  std::vector<char *> ptrs(keys->size(), nullptr);
+  TableContext pull_context;
+  pull_context.value_type = Sparse;
+  pull_context.use_ptr = true;
+  pull_context.pull_context.keys = keys->data();
+  pull_context.pull_context.ptr_values = ptrs.data();
+  pull_context.num = keys->size();
+  pull_context.shard_id = 0;
+  pull_context.pass_id = 0;
+  EXPECT_EQ(table->Pull(pull_context), 0);
+  return ptrs;
+}
+
+// a temporary directory removed with its files when the test ends
+class ScopedTempDir {
+ public:
+  ScopedTempDir() {
+    char path[] = "/tmp/memory_sparse_table_test_XXXXXX";
+    EXPECT_NE(mkdtemp(path), nullptr);
+    path_ = path;
+  }
+  ~ScopedTempDir() { paddle::framework::fs_remove(path_); }
+  const std::string &path() const { return path_; }
+
+ private:
+  std::string path_;
+};
+
 TEST(MemorySparseTable, SGD) {
   int emb_dim = 8;
   int trainers = 2;
@@ -152,5 +242,151 @@ TEST(MemorySparseTable, SGD) {
   }
 }
 
+// the flat shard is turned off under HeterPS
+#ifndef PADDLE_WITH_HETERPS
+TEST(MemorySparseTable, FlatShard) {
+  int emb_dim = 8;
+  TableParameter table_config = MakeCtrTableConfig(emb_dim);
+  table_config.set_use_flat_shard(true);
+  auto table = MakeTable(table_config);
+  auto *sparse_table = dynamic_cast<MemorySparseTable *>(table.get());
+  ASSERT_TRUE(sparse_table->UseFlatShard());
+  size_t value_col =
+      table->ValueAccesor()->GetAccessorInfo().size / sizeof(float);
+  size_t mf_value_col =
+      table->ValueAccesor()->GetAccessorInfo().mf_size / sizeof(float);
+
+  // push gradients of a large show to create and extend the values
+  std::vector<uint64_t> keys;
+  for (uint64_t key = 0; key < 1000; ++key) {
+    keys.push_back(key);
+  }
+  auto gradients = MakeGradients(keys.size(), 100, emb_dim);
+  ASSERT_EQ(PushGradients(table.get(), &keys, &gradients), 0);
+  ASSERT_EQ(sparse_table->LocalSize(), static_cast<int64_t>(keys.size()));
+
+  // the pointers pulled from the flat shard point to FlatFeatureValue
+  std::vector<uint64_t> pull_keys = keys;
+  pull_keys.push_back(1000);
+  auto pull_ptrs = PullPtrs(table.get(), &pull_keys);
+  for (size_t i = 0; i < pull_keys.size(); ++i) {
+    auto *value = reinterpret_cast<FlatFeatureValue *>(pull_ptrs[i]);
+    ASSERT_NE(value, nullptr);
+    ASSERT_EQ(value->capacity(), value_col);
+    // the new key is not extended
+    ASSERT_EQ(value->size(),
+              i < keys.size() ? value_col : value_col - mf_value_col);
+  }
+  ASSERT_EQ(sparse_table->LocalSize(), static_cast<int64_t>(pull_keys.size()));
+  ASSERT_EQ(sparse_table->LocalMFSize(), static_cast<int64_t>(keys.size()));
+
+  // the values pulled again are not moved
+  ASSERT_EQ(PullPtrs(table.get(), &pull_keys), pull_ptrs);
+}
+#endif
+
+TEST(MemorySparseTable, MergePush) {
+  // the window is long enough that the pushes are merged until Flush
+  FLAGS_pserver_push_merge_window_ms = 3600 * 1000;
+  int emb_dim = 8;
+  int trainers = 4;
+  auto table = MakeTable(MakeCtrTableConfig(emb_dim));
+  FLAGS_pserver_push_merge_window_ms = 0;
+  auto *sparse_table = dynamic_cast<MemorySparseTable *>(table.get());
+
+  // pull to create the values
+  std::vector<uint64_t> keys = {0, 1, 2, 3, 4, 15, 26};
+  std::vector<uint32_t> fres(keys.size(), 1);
+  auto pull_value = PullSparseValue(keys, fres, emb_dim);
+  std::vector<float> init_values(keys.size() * (emb_dim + 3));
+  TableContext pull_context;
+  pull_context.value_type = Sparse;
+  pull_context.pull_context.pull_value = pull_value;
+  pull_context.pull_context.values = init_values.data();
+  ASSERT_EQ(table->Pull(pull_context), 0);
+
+  // every trainer pushes the embed gradient 0.1 of all the keys
+  auto gradients = MakeGradients(keys.size(), 1, emb_dim);
+  std::vector<std::thread> pushers;
+  for (int i = 0; i < trainers; ++i) {
+    pushers.emplace_back([&]() {
+      ASSERT_EQ(PushGradients(table.get(), &keys, &gradients), 0);
+    });
+  }
+  for (auto &pusher : pushers) {
+    pusher.join();
+  }
+
+  // the values are not updated until Flush
+  std::vector<float> pull_values(init_values.size());
+  pull_context.pull_context.values = pull_values.data();
+  ASSERT_EQ(table->Pull(pull_context), 0);
+  ASSERT_EQ(pull_values, init_values);
+
+  ASSERT_EQ(table->Flush(), 0);
+  ASSERT_EQ(table->Pull(pull_context), 0);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    float *init_value = init_values.data() + i * (emb_dim + 3);
+    float *value = pull_values.data() + i * (emb_dim + 3);
+    ASSERT_FLOAT_EQ(value[0], init_value[0] + trainers);  // show
+    ASSERT_NEAR(value[2], init_value[2] - 0.1 * 0.1 * trainers, 1e-6);
+  }
+  auto stat = sparse_table->GetPushMergeStat();
+  ASSERT_EQ(stat.pushed_keys, keys.size() * trainers);
+  ASSERT_EQ(stat.updated_keys, keys.size());
+}
+
+TEST(MemorySparseTable, SaveLoadBinary) {
+  int emb_dim = 8;
+  TableParameter table_config = MakeCtrTableConfig(emb_dim);
+  table_config.set_save_binary(true);
+  ScopedTempDir dir;
+
+  // all the values are extended, then the odd keys fall below the threshold
+  auto table = MakeTable(table_config);
+  size_t value_col =
+      table->ValueAccesor()->GetAccessorInfo().size / sizeof(float);
+  size_t mf_value_col =
+      table->ValueAccesor()->GetAccessorInfo().mf_size / sizeof(float);
+  std::vector<uint64_t> keys;
+  std::vector<uint64_t> odd_keys;
+  for (uint64_t key = 0; key < 100; ++key) {
+    keys.push_back(key);
+    if (key % 2 == 1) {
+      odd_keys.push_back(key);
+    }
+  }
+  auto gradients = MakeGradients(keys.size(), 100, emb_dim);
+  ASSERT_EQ(PushGradients(table.get(), &keys, &gradients), 0);
+  gradients = MakeGradients(odd_keys.size(), -100, emb_dim);
+  ASSERT_EQ(PushGradients(table.get(), &odd_keys, &gradients), 0);
+  auto *sparse_table = dynamic_cast<MemorySparseTable *>(table.get());
+  ASSERT_EQ(sparse_table->LocalMFSize(), static_cast<int64_t>(keys.size()));
+  std::vector<std::vector<float>> saved_values;
+  for (auto *ptr : PullPtrs(table.get(), &keys)) {
+    auto *value = reinterpret_cast<FixedFeatureValue *>(ptr);
+    ASSERT_EQ(value->size(), value_col);
+    saved_values.emplace_back(value->data(), value->data() + value->size());
+  }
+  ASSERT_EQ(table->Save(dir.path(), "0"), 0);
+
+  // the embedx of the odd keys is dropped like in the text format
+  table = MakeTable(table_config);
+  ASSERT_EQ(table->Load(dir.path(), "0"), 0);
+  sparse_table = dynamic_cast<MemorySparseTable *>(table.get());
+  ASSERT_EQ(sparse_table->LocalSize(), static_cast<int64_t>(keys.size()));
+  ASSERT_EQ(sparse_table->LocalMFSize(),
+            static_cast<int64_t>(keys.size() - odd_keys.size()));
+  auto loaded_ptrs = PullPtrs(table.get(), &keys);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    auto *value = reinterpret_cast<FixedFeatureValue *>(loaded_ptrs[i]);
+    size_t dim = keys[i] % 2 == 1 ? value_col - mf_value_col : value_col;
+    ASSERT_EQ(value->size(), dim);
+    for (size_t j = 0; j < dim; ++j) {
+      ASSERT_EQ(value->data()[j], saved_values[i][j]);
+    }
+  }
+}
+
 }  // namespace distributed
 }  // namespace paddle
@@ -0,0 +1,108 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/depends/push_merge_buffer.h"
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace distributed {
+
+TEST(PushMergeBuffer, Merge) {
+  // value[0] is a count and value[1] is overwritten like the slot
+  PushMergeBuffer buffer(4, 2, [](float* value, const float* other) {
+    value[0] += other[0];
+    value[1] = other[1];
+  });
+  float value[2] = {1, 0};
+  for (uint64_t key = 0; key < 4; ++key) {
+    for (int i = 0; i <= static_cast<int>(key); ++i) {
+      value[1] = i;
+      ASSERT_TRUE(buffer.Add(key, value));
+    }
+  }
+  // the buffer is full
+  ASSERT_FALSE(buffer.Add(4, value));
+  ASSERT_TRUE(buffer.Add(3, value));
+  ASSERT_EQ(buffer.AddedNum(), 11UL);
+
+  std::vector<float> counts(5, 0);
+  auto count = [&](const uint64_t* keys, float** values, size_t num) {
+    for (size_t i = 0; i < num; ++i) {
+      counts[keys[i]] = values[i][0];
+      ASSERT_EQ(values[i][1], keys[i]);
+    }
+  };
+  ASSERT_EQ(buffer.Drain(count), 4UL);
+  ASSERT_EQ(counts, std::vector<float>({1, 2, 3, 5, 0}));
+  ASSERT_EQ(buffer.DrainedNum(), 4UL);
+
+  // the other table is used after the drain
+  value[1] = 4;
+  ASSERT_TRUE(buffer.Add(4, value));
+  ASSERT_EQ(buffer.Drain(count), 1UL);
+  ASSERT_EQ(counts[4], 1);
+  ASSERT_EQ(buffer.Drain([](const uint64_t*, float**, size_t) {}), 0UL);
+}
+
+TEST(PushMergeBuffer, Concurrent) {
+  const int thread_num = 8;
+  const int round_num = 2000;
+  const uint64_t key_num = 100;
+  PushMergeBuffer buffer(
+      key_num, 1, [](float* value, const float* other) { *value += *other; });
+  std::vector<double> sums(key_num, 0);
+  std::atomic<bool> stop{false};
+  auto drain = [&]() {
+    buffer.Drain([&](const uint64_t* keys, float** values, size_t num) {
+      for (size_t i = 0; i < num; ++i) {
+        sums[keys[i]] += values[i][0];
+      }
+    });
+  };
+  std::thread drainer([&]() {
+    while (!stop) {
+      drain();
+    }
+  });
+  std::vector<std::thread> pushers;
+  for (int t = 0; t < thread_num; ++t) {
+    pushers.emplace_back([&]() {
+      float one = 1;
+      for (int round = 0; round < round_num; ++round) {
+        for (uint64_t key = 0; key < key_num; ++key) {
+          ASSERT_TRUE(buffer.Add(key, &one));
+        }
+      }
+    });
+  }
+  for (auto& pusher : pushers) {
+    pusher.join();
+  }
+  stop = true;
+  drainer.join();
+  drain();
+  for (uint64_t key = 0; key < key_num; ++key) {
+    ASSERT_EQ(sums[key], thread_num * round_num);
+  }
+  ASSERT_EQ(buffer.AddedNum(), thread_num * round_num * key_num);
+  ASSERT_LE(buffer.DrainedNum(), buffer.AddedNum());
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,157 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares UpdateValue key by key with UpdateValueBatch of the sparse sgd
+// rules, for example:
+//   ./sparse_sgd_rule_benchmark --key_num=100000 --repeat=20
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/fluid/distributed/ps/table/sparse_sgd_rule.h"
+
+DEFINE_int32(repeat, 20, "Repeat times.");
+DEFINE_int32(key_num, 100000, "The number of keys updated in a repeat.");
+DEFINE_int32(batch_size, 64, "The number of keys of UpdateValueBatch.");
+
+DECLARE_bool(pserver_sparse_sgd_use_simd);
+
+namespace paddle {
+namespace distributed {
+
+class SparseSGDRuleBenchmark {
+ public:
+  SparseSGDRuleBenchmark(size_t dim, size_t sgd_dim)
+      : _dim(dim), _value_dim(dim + sgd_dim) {
+    size_t key_num = FLAGS_key_num;
+    std::mt19937 rng(100);
+    std::uniform_real_distribution<float> dist(-1, 1);
+    _values.resize(key_num * _value_dim);
+    _grads.resize(key_num * dim);
+    for (auto& grad : _grads) {
+      grad = dist(rng);
+    }
+    _scales.assign(key_num, 1);
+    // the keys are updated in a random order as in a push
+    std::vector<size_t> order(key_num);
+    for (size_t i = 0; i < key_num; ++i) {
+      order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+    for (size_t key : order) {
+      _w.push_back(_values.data() + key * _value_dim);
+      _sgd.push_back(_w.back() + dim);
+      _grad.push_back(_grads.data() + key * dim);
+    }
+  }
+
+  // Returns the average us of updating all the keys.
+  double Run(SparseValueSGDRule* rule, bool batch) {
+    size_t key_num = FLAGS_key_num;
+    for (size_t k = 0; k < key_num; ++k) {
+      rule->InitValue(_w[k], _sgd[k], false);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < FLAGS_repeat; ++i) {
+      if (batch) {
+        for (size_t k = 0; k < key_num; k += FLAGS_batch_size) {
+          size_t num = std::min<size_t>(FLAGS_batch_size, key_num - k);
+          rule->UpdateValueBatch(
+              &_w[k], &_sgd[k], &_grad[k], &_scales[k], num);
+        }
+      } else {
+        for (size_t k = 0; k < key_num; ++k) {
+          rule->UpdateValue(_w[k], _sgd[k], _grad[k], _scales[k]);
+        }
+      }
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() /
+           FLAGS_repeat;
+  }
+
+ private:
+  size_t _dim;
+  size_t _value_dim;
+  std::vector<float> _values;
+  std::vector<float> _grads;
+  std::vector<float> _scales;
+  std::vector<float*> _w;
+  std::vector<float*> _sgd;
+  std::vector<const float*> _grad;
+};
+
+template <class Rule>
+void BenchRule(const std::string& name,
+               const SparseCommonSGDRuleParameter& param) {
+  for (size_t dim : {8, 16, 32, 64}) {
+    FLAGS_pserver_sparse_sgd_use_simd = false;
+    Rule scalar_rule;
+    scalar_rule.LoadConfig(param, dim);
+    FLAGS_pserver_sparse_sgd_use_simd = true;
+    Rule simd_rule;
+    simd_rule.LoadConfig(param, dim);
+
+    SparseSGDRuleBenchmark benchmark(dim, scalar_rule.Dim());
+    double scalar = benchmark.Run(&scalar_rule, false);
+    double batch = benchmark.Run(&scalar_rule, true);
+    double simd = benchmark.Run(&simd_rule, true);
+    LOG(INFO) << name << " dim " << dim << ": UpdateValue takes " << scalar
+              << " us; UpdateValueBatch without simd takes " << batch
+              << " us; UpdateValueBatch takes " << simd << " us; speedup "
+              << scalar / simd;
+  }
+}
+
+void RunAllBenchmarks() {
+  SparseCommonSGDRuleParameter adagrad_param;
+  auto* adagrad = adagrad_param.mutable_adagrad();
+  adagrad->set_learning_rate(0.05);
+  adagrad->set_initial_g2sum(3.0);
+  adagrad->set_initial_range(0.0001);
+  adagrad->add_weight_bounds(-10.0);
+  adagrad->add_weight_bounds(10.0);
+
+  SparseCommonSGDRuleParameter adam_param;
+  auto* adam = adam_param.mutable_adam();
+  adam->set_learning_rate(0.001);
+  adam->set_initial_range(0.0001);
+  adam->set_beta1_decay_rate(0.9);
+  adam->set_beta2_decay_rate(0.999);
+  adam->set_ada_epsilon(1e-08);
+  adam->add_weight_bounds(-10.0);
+  adam->add_weight_bounds(10.0);
+
+  BenchRule<SparseAdaGradSGDRule>("SparseAdaGradSGDRule", adagrad_param);
+  BenchRule<StdAdaGradSGDRule>("StdAdaGradSGDRule", adagrad_param);
+  BenchRule<SparseAdamSGDRule>("SparseAdamSGDRule", adam_param);
+  BenchRule<SparseSharedAdamSGDRule>("SparseSharedAdamSGDRule", adam_param);
+}
+
+}  // namespace distributed
+}  // namespace paddle
+
+int main(int argc, char* argv[]) {
+  ::GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  LOG(INFO) << "Update " << FLAGS_key_num << " keys, Repeat " << FLAGS_repeat
+            << " times.";
+  paddle::distributed::RunAllBenchmarks();
+  return 0;
+}
@@ -14,8 +14,11 @@ limitations under the License. */
 
 #include "paddle/fluid/distributed/ps/table/sparse_sgd_rule.h"
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "paddle/fluid/distributed/the_one_ps.pb.h"
@@ -205,5 +208,84 @@ TEST(downpour_sparse_adam_test, test_init_and_update) {
     ASSERT_FLOAT_EQ(value[i], label[i]) << "i is " << i;
   }
 }
+// Checks UpdateValueBatch, which uses the vectorized kernel if the cpu
+// supports it, against UpdateValue of the same rule.
+template <class Rule>
+void CheckUpdateValueBatch(const SparseCommonSGDRuleParameter& param,
+                           size_t dim) {
+  Rule batch_rule;
+  Rule rule;
+  batch_rule.LoadConfig(param, dim);
+  rule.LoadConfig(param, dim);
+  const size_t key_num = 37;
+  const size_t value_dim = dim + rule.Dim();
+  std::vector<float> batch_values(key_num * value_dim);
+  std::vector<float> grads(key_num * dim);
+  std::vector<float> scales(key_num);
+  for (size_t k = 0; k < key_num; ++k) {
+    float* value = batch_values.data() + k * value_dim;
+    rule.InitValue(value, value + dim, false);
+    for (size_t i = 0; i < dim; ++i) {
+      grads[k * dim + i] = std::sin(k * 13 + i) * 0.5;
+    }
+    scales[k] = 1 + k % 3;
+  }
+  std::vector<float> values = batch_values;
+
+  // the last key is pushed twice in a batch
+  std::vector<float*> w;
+  std::vector<float*> sgd;
+  std::vector<const float*> grad;
+  std::vector<float> scale;
+  for (size_t k = 0; k <= key_num; ++k) {
+    size_t key = std::min(k, key_num - 1);
+    w.push_back(batch_values.data() + key * value_dim);
+    sgd.push_back(w.back() + dim);
+    grad.push_back(grads.data() + key * dim);
+    scale.push_back(scales[key]);
+  }
+  for (int round = 0; round < 3; ++round) {
+    batch_rule.UpdateValueBatch(
+        w.data(), sgd.data(), grad.data(), scale.data(), w.size());
+    for (size_t k = 0; k < w.size(); ++k) {
+      float* value = values.data() + (w[k] - batch_values.data());
+      rule.UpdateValue(value, value + dim, grad[k], scale[k]);
+    }
+  }
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_NEAR(batch_values[i], values[i], 1e-5 * (1 + std::fabs(values[i])))
+        << "dim " << dim << ", index " << i;
+  }
+}
+
+TEST(sparse_sgd_rule_test, update_value_batch) {
+  SparseCommonSGDRuleParameter adagrad_param;
+  adagrad_param.set_name("adagrad");
+  auto* adagrad = adagrad_param.mutable_adagrad();
+  adagrad->set_learning_rate(0.1);
+  adagrad->set_initial_g2sum(0.2);
+  adagrad->set_initial_range(0.3);
+  adagrad->add_weight_bounds(-0.5);
+  adagrad->add_weight_bounds(0.5);
+
+  SparseCommonSGDRuleParameter adam_param;
+  adam_param.set_name("adam");
+  auto* adam = adam_param.mutable_adam();
+  adam->set_learning_rate(0.1);
+  adam->set_initial_range(0.3);
+  adam->set_beta1_decay_rate(0.9);
+  adam->set_beta2_decay_rate(0.999);
+  adam->set_ada_epsilon(1e-08);
+  adam->add_weight_bounds(-0.5);
+  adam->add_weight_bounds(0.5);
+
+  for (size_t dim : {8, 11, 16, 32, 37, 64}) {
+    CheckUpdateValueBatch<SparseAdaGradSGDRule>(adagrad_param, dim);
+    CheckUpdateValueBatch<StdAdaGradSGDRule>(adagrad_param, dim);
+    CheckUpdateValueBatch<SparseAdamSGDRule>(adam_param, dim);
+    CheckUpdateValueBatch<SparseSharedAdamSGDRule>(adam_param, dim);
+  }
+}
+
 }  // namespace distributed
 }  // namespace paddle
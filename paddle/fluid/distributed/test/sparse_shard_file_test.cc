@@ -0,0 +1,76 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/depends/sparse_shard_file.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace distributed {
+
+TEST(SparseShardFile, WriteRead) {
+  std::string file;
+  SparseShardFileWriter writer([&file](const char* data, size_t size) {
+    file.append(data, size);
+    return 0;
+  });
+  // values of 3 or 5 floats in 3 blocks
+  const uint64_t key_num = 2 * SparseShardFileWriter::kKeysPerBlock + 10;
+  auto dim_of = [](uint64_t key) { return key % 3 == 0 ? 5 : 3; };
+  for (uint64_t i = 0; i < key_num; ++i) {
+    uint64_t key = i * 7 + 1;
+    std::vector<float> value(dim_of(key));
+    for (size_t j = 0; j < value.size(); ++j) {
+      value[j] = key + j * 0.5;
+    }
+    ASSERT_EQ(writer.Add(key, value.data(), value.size()), 0);
+  }
+  ASSERT_EQ(writer.Finish(), 0);
+
+  SparseShardFileReader reader(file.data(), file.size());
+  ASSERT_TRUE(reader.Valid());
+  ASSERT_EQ(reader.BlockNum(), 3UL);
+  ASSERT_EQ(reader.KeyNum(), key_num);
+
+  uint64_t visited = 0;
+  for (size_t block = 0; block < reader.BlockNum(); ++block) {
+    ASSERT_TRUE(reader.VisitBlock(
+        block, [&](uint64_t key, const float* value, uint32_t dim) {
+          ASSERT_EQ(key, visited * 7 + 1);
+          ASSERT_EQ(dim, static_cast<uint32_t>(dim_of(key)));
+          for (uint32_t j = 0; j < dim; ++j) {
+            ASSERT_FLOAT_EQ(value[j], key + j * 0.5);
+          }
+          ++visited;
+        }));
+  }
+  ASSERT_EQ(visited, key_num);
+
+  std::vector<float> value;
+  ASSERT_TRUE(reader.Find(4096 * 7 + 1, &value));
+  ASSERT_EQ(value.size(), 3UL);
+  ASSERT_FLOAT_EQ(value[1], 4096 * 7 + 1.5);
+  ASSERT_FALSE(reader.Find(2, &value));
+  ASSERT_FALSE(reader.Find(key_num * 7 + 1, &value));
+
+  // a truncated file is rejected
+  SparseShardFileReader truncated(file.data(), file.size() - 1);
+  ASSERT_FALSE(truncated.Valid());
+}
+
+}  // namespace distributed
+}  // namespace paddle
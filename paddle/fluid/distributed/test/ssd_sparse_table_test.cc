@@ -0,0 +1,178 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/ssd_sparse_table.h"
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/table/depends/rocksdb_warpper.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+#include "paddle/fluid/framework/io/fs.h"
+
+DECLARE_string(rocksdb_path);
+DECLARE_int32(pserver_ssd_shard_mem_mb);
+
+namespace paddle {
+namespace distributed {
+
+// the table of a single shard with CtrCommonAccessor and the naive sgd rules
+TableParameter MakeSSDTableConfig(int emb_dim) {
+  TableParameter table_config;
+  table_config.set_table_class("SSDSparseTable");
+  table_config.set_shard_num(1);
+  TableAccessorParameter *accessor_config = table_config.mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(11);
+  accessor_config->set_embedx_dim(emb_dim);
+  accessor_config->set_embedx_threshold(5);
+  accessor_config->mutable_embed_sgd_param()->set_name("SparseNaiveSGDRule");
+  auto *naive_param =
+      accessor_config->mutable_embed_sgd_param()->mutable_naive();
+  naive_param->set_learning_rate(0.1);
+  naive_param->set_initial_range(0.3);
+  accessor_config->mutable_embedx_sgd_param()->set_name("SparseNaiveSGDRule");
+  naive_param = accessor_config->mutable_embedx_sgd_param()->mutable_naive();
+  naive_param->set_learning_rate(0.1);
+  naive_param->set_initial_range(0.3);
+  return table_config;
+}
+
+// pushes the show 1 and the embed gradients 0.1 of the keys
+int32_t PushKeys(Table *table, const std::vector<uint64_t> &keys, int emb_dim) {
+  std::vector<float> gradients;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    gradients.push_back(0);  // slot
+    gradients.push_back(1);  // show
+    gradients.push_back(0);  // click
+    for (int j = 0; j < emb_dim + 1; ++j) {
+      gradients.push_back(0.1);
+    }
+  }
+  TableContext push_context;
+  push_context.value_type = Sparse;
+  push_context.push_context.keys = keys.data();
+  push_context.push_context.values = gradients.data();
+  push_context.num = keys.size();
+  return table->Push(push_context);
+}
+
+// the value of the key in rocksdb, empty if it is not there
+std::vector<float> GetSSDValue(uint64_t key) {
+  std::string value;
+  if (RocksDBHandler::GetInstance()->get(
+          0, reinterpret_cast<char *>(&key), sizeof(uint64_t), value) > 0) {
+    return {};
+  }
+  const float *data = reinterpret_cast<const float *>(value.data());
+  return std::vector<float>(data, data + value.size() / sizeof(float));
+}
+
+// the keys [begin, end)
+std::vector<uint64_t> KeyRange(uint64_t begin, uint64_t end) {
+  std::vector<uint64_t> keys;
+  for (uint64_t key = begin; key < end; ++key) {
+    keys.push_back(key);
+  }
+  return keys;
+}
+
+TEST(SSDSparseTable, ShardMemBudget) {
+  int emb_dim = 8;
+  // rocksdb opens the files with O_DIRECT, which tmpfs doesn't support
+  char dir[] = "./ssd_sparse_table_test_XXXXXX";
+  ASSERT_NE(mkdtemp(dir), nullptr);
+  FLAGS_rocksdb_path = std::string(dir) + "/rocksdb";
+  FLAGS_pserver_ssd_shard_mem_mb = 1;
+
+  std::unique_ptr<Table> table(new SSDSparseTable());
+  table->SetShard(0, 1);
+  FsClientParameter fs_config;
+  ASSERT_EQ(table->Initialize(MakeSSDTableConfig(emb_dim), fs_config), 0);
+  FLAGS_pserver_ssd_shard_mem_mb = 0;
+  auto *ssd_table = dynamic_cast<SSDSparseTable *>(table.get());
+  auto accessor = table->ValueAccesor();
+  const uint64_t budget = ssd_table->ShardMemKeyBudget();
+  ASSERT_GT(budget, 0UL);
+
+  // the shard is filled up with the keys accessed twice, no demotion
+  std::vector<uint64_t> hot_keys = KeyRange(0, budget);
+  ASSERT_EQ(PushKeys(table.get(), hot_keys, emb_dim), 0);
+  ASSERT_EQ(PushKeys(table.get(), hot_keys, emb_dim), 0);
+  auto stat = ssd_table->GetCacheStat();
+  ASSERT_EQ(stat.misses, budget);
+  ASSERT_EQ(stat.mem_hits, budget);
+  ASSERT_EQ(stat.demotions, 0UL);
+  ASSERT_EQ(ssd_table->LocalSize(), static_cast<int64_t>(budget));
+
+  // the new keys accessed once are fewer than the demoted keys, so the keys
+  // accessed twice are demoted too, and a key has to be accessed more than
+  // twice to be admitted to the full shard
+  std::vector<uint64_t> cold_keys = KeyRange(budget, budget + budget / 4);
+  ASSERT_EQ(PushKeys(table.get(), cold_keys, emb_dim), 0);
+  stat = ssd_table->GetCacheStat();
+  ASSERT_EQ(stat.misses, budget + cold_keys.size());
+  ASSERT_GT(stat.demotions, 0UL);
+  ASSERT_LE(ssd_table->LocalSize(), static_cast<int64_t>(budget));
+  ASSERT_EQ(stat.demotions,
+            stat.misses - static_cast<uint64_t>(ssd_table->LocalSize()));
+
+  // the new keys fill up the shard again, then the demoted cold keys are
+  // pushed once more
+  std::vector<uint64_t> push_keys =
+      KeyRange(budget * 2, budget * 2 + budget / 5);
+  std::vector<uint64_t> demoted_keys;
+  std::vector<std::vector<float>> demoted_values;
+  for (uint64_t key : cold_keys) {
+    auto value = GetSSDValue(key);
+    if (!value.empty()) {
+      demoted_keys.push_back(key);
+      demoted_values.push_back(value);
+      push_keys.push_back(key);
+    }
+  }
+  ASSERT_FALSE(demoted_keys.empty());
+  ASSERT_EQ(PushKeys(table.get(), push_keys, emb_dim), 0);
+  auto last_stat = stat;
+  stat = ssd_table->GetCacheStat();
+  ASSERT_EQ(stat.ssd_hits - last_stat.ssd_hits, demoted_keys.size());
+  ASSERT_EQ(stat.promotions + stat.rejections, demoted_keys.size());
+  ASSERT_GT(stat.rejections, 0UL);
+  ASSERT_LE(ssd_table->LocalSize(), static_cast<int64_t>(budget));
+  ASSERT_EQ(stat.demotions - stat.promotions,
+            stat.misses - static_cast<uint64_t>(ssd_table->LocalSize()));
+
+  // the keys in rocksdb are updated there if rejected, or in memory before
+  // demoted again if promoted
+  size_t ssd_keys = 0;
+  for (size_t i = 0; i < demoted_keys.size(); ++i) {
+    auto value = GetSSDValue(demoted_keys[i]);
+    if (value.empty()) {
+      continue;
+    }
+    ++ssd_keys;
+    ASSERT_FLOAT_EQ(accessor->GetField(value.data(), "show"),
+                    accessor->GetField(demoted_values[i].data(), "show") + 1);
+  }
+  ASSERT_GE(ssd_keys, stat.rejections);
+
+  table.reset();
+  paddle::framework::fs_remove(dir);
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -16,6 +16,8 @@ limitations under the License. */
 
 #include <stdint.h>
 
+#include <cstring>
+
 #include "paddle/fluid/framework/convert_utils.h"
 #include "paddle/fluid/framework/version.h"
 
@@ -320,6 +322,105 @@ void DeserializeFromStream(std::istream &is,
       is, static_cast<phi::DenseTensor *>(tensor), dev_ctx);
 }
 
+namespace {
+
+// Returns the pointer to the next size bytes of the buffer, and advances
+// *offset past them.
+const char *ReadFromBuffer(const phi::Allocation &buffer,
+                           size_t size,
+                           size_t *offset) {
+  PADDLE_ENFORCE_LE(
+      *offset + size,
+      buffer.size(),
+      platform::errors::Unavailable(
+          "Fail to read %d bytes at offset %d of the buffer of %d bytes, "
+          "please check whether the model file is complete or damaged.",
+          size,
+          *offset,
+          buffer.size()));
+  const char *data = static_cast<const char *>(buffer.ptr()) + *offset;
+  *offset += size;
+  return data;
+}
+
+template <typename T>
+T ReadFromBuffer(const phi::Allocation &buffer, size_t *offset) {
+  T value;
+  std::memcpy(&value, ReadFromBuffer(buffer, sizeof(T), offset), sizeof(T));
+  return value;
+}
+
+}  // namespace
+
+void DeserializeFromBuffer(const std::shared_ptr<phi::Allocation> &buffer,
+                           size_t *offset,
+                           phi::DenseTensor *tensor) {
+  PADDLE_ENFORCE_EQ(
+      platform::is_cpu_place(buffer->place()),
+      true,
+      platform::errors::InvalidArgument(
+          "Only the tensor in the CPU buffer can be deserialized, but got %s.",
+          buffer->place()));
+  // The layout is the same as DeserializeFromStream and TensorFromStream.
+  uint32_t version = ReadFromBuffer<uint32_t>(*buffer, offset);
+  PADDLE_ENFORCE_EQ(
+      version,
+      0U,
+      platform::errors::InvalidArgument(
+          "Deserialize to tensor failed, maybe the loaded file is "
+          "not a paddle model(expected file format: 0, but %u found).",
+          version));
+  uint64_t lod_level = ReadFromBuffer<uint64_t>(*buffer, offset);
+  auto &lod = *tensor->mutable_lod();
+  lod.resize(lod_level);
+  for (uint64_t i = 0; i < lod_level; ++i) {
+    uint64_t size = ReadFromBuffer<uint64_t>(*buffer, offset);
+    const char *data = ReadFromBuffer(*buffer, size, offset);
+    std::vector<size_t> tmp(size / sizeof(size_t));
+    std::memcpy(tmp.data(), data, tmp.size() * sizeof(size_t));
+    lod[i] = tmp;
+  }
+
+  version = ReadFromBuffer<uint32_t>(*buffer, offset);
+  PADDLE_ENFORCE_EQ(
+      version,
+      0U,
+      platform::errors::InvalidArgument(
+          "tensor version %u is not supported, Only version 0 is supported",
+          version));
+  int32_t desc_size = ReadFromBuffer<int32_t>(*buffer, offset);
+  PADDLE_ENFORCE_GE(desc_size,
+                    0,
+                    platform::errors::InvalidArgument(
+                        "phi::DenseTensor desc size should >= 0"));
+  proto::VarType::TensorDesc desc;
+  PADDLE_ENFORCE_EQ(
+      desc.ParseFromArray(ReadFromBuffer(*buffer, desc_size, offset),
+                          desc_size),
+      true,
+      platform::errors::InvalidArgument("Cannot parse tensor desc"));
+
+  std::vector<int64_t> dims(desc.dims().begin(), desc.dims().end());
+  tensor->Resize(phi::make_ddim(dims));
+  auto dtype = TransToPhiDataType(desc.data_type());
+  size_t type_size = SizeOfType(desc.data_type());
+  size_t size = tensor->numel() * type_size;
+  size_t data_offset = *offset;
+  const char *data = ReadFromBuffer(*buffer, size, offset);
+  if (reinterpret_cast<uintptr_t>(data) % type_size == 0) {
+    // clear resets the offset into the previous holder.
+    tensor->clear();
+    tensor->set_type(dtype);
+    tensor->ResetHolder(
+        std::make_shared<BufferSliceAllocation>(buffer, data_offset, size));
+  } else {
+    VLOG(4) << "Copy the tensor at offset " << data_offset
+            << " of the buffer, which is not aligned to its data type";
+    void *dst = tensor->mutable_data(platform::CPUPlace(), dtype);
+    std::memcpy(dst, data, size);
+  }
+}
+
 LoD ConvertToOffsetBasedLoD(const LoD &length_lod) {
   LoD offset_lod;
   offset_lod.reserve(length_lod.size());
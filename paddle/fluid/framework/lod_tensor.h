@@ -182,6 +182,38 @@ void DeserializeFromStream(std::istream& is,
                            const size_t& seek,
                            const std::vector<int64_t>& shape);
 
+/*
+ * The holder of a tensor deserialized from a buffer without copying. It
+ * refers to a range of the buffer, and keeps the buffer alive.
+ */
+class BufferSliceAllocation : public phi::Allocation {
+ public:
+  BufferSliceAllocation(const std::shared_ptr<phi::Allocation>& buffer,
+                        size_t offset,
+                        size_t size)
+      : phi::Allocation(static_cast<char*>(buffer->ptr()) + offset,
+                        size,
+                        buffer->place()),
+        buffer_(buffer) {}
+
+  const std::shared_ptr<phi::Allocation>& buffer() const { return buffer_; }
+
+ private:
+  std::shared_ptr<phi::Allocation> buffer_;
+};
+
+/*
+ * Desiralize the CPU phi::DenseTensor serialized by SerializeToStream at
+ * *offset of the buffer, e.g., a mapped file, and advance *offset past it.
+ * The tensor shares the memory of the buffer without copying if its data is
+ * aligned to the size of its data type, otherwise the data is copied. The
+ * data written by TensorToStream to a seekable stream is aligned to 64 bytes
+ * from the start of the stream.
+ */
+void DeserializeFromBuffer(const std::shared_ptr<phi::Allocation>& buffer,
+                           size_t* offset,
+                           phi::DenseTensor* tensor);
+
 LoD ConvertToOffsetBasedLoD(const LoD& length_lod);
 
 void SerializeToStream(std::ostream& os, const phi::DenseTensor& tensor);
@@ -43,6 +43,16 @@ PADDLE_DEFINE_EXPORTED_bool(
     new_executor_log_memory_stats,
     false,
     "Log memory stats after each op runs, just used for debug.");
+PADDLE_DEFINE_EXPORTED_bool(
+    new_executor_workqueue_adaptive_spinning,
+    false,
+    "Let the host worker threads of the new executor spin according to the "
+    "recent inter-task arrival time instead of a fixed spin count.");
+PADDLE_DEFINE_EXPORTED_int32(
+    new_executor_host_numa_node,
+    -1,
+    "Bind the host worker threads of the new executor to the cpus of this "
+    "NUMA node, -1 means not to bind.");
 
 PHI_DECLARE_bool(use_mkldnn);
 PHI_DECLARE_bool(check_nan_inf);
@@ -96,6 +106,9 @@ const std::vector<WorkQueueOptions> ConstructWorkQueueOptions(
                              /*track_task*/ false,
                              /*detached*/ true,
                              /*events_waiter*/ waiter);
+  group_options.back().adaptive_spinning =
+      FLAGS_new_executor_workqueue_adaptive_spinning;
+  group_options.back().numa_node = FLAGS_new_executor_host_numa_node;
   // for launch device Kernel
   group_options.emplace_back(/*name*/ "DeviceKernelLaunch",
                              /*num_threads*/ device_num_threads,
@@ -122,6 +135,12 @@ void AsyncWorkQueue::AddTask(const OpFuncType& op_func_type,
   queue_group_->AddTask(op_func_type == OpFuncType::kGpuAsync, std::move(fn));
 }
 
+void AsyncWorkQueue::AddTasks(const OpFuncType& op_func_type,
+                              std::vector<std::function<void()>> fns) {
+  queue_group_->AddTasks(op_func_type == OpFuncType::kGpuAsync,
+                         std::move(fns));
+}
+
 bool IsCommunicationOp(const std::string& op_name) {
   const std::set<std::string> special_comm_op_set = {
       "send",
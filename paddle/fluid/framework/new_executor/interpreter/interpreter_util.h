@@ -54,6 +54,9 @@ class AsyncWorkQueue {
 
   void AddTask(const OpFuncType& op_func_type, std::function<void()> fn);
 
+  void AddTasks(const OpFuncType& op_func_type,
+                std::vector<std::function<void()>> fns);
+
   void Cancel() { queue_group_->Cancel(); }
 
   size_t QueueNumThreads(size_t idx) {
@@ -0,0 +1,222 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/new_executor/interpreter/static_memory_planner.h"
+
+#include <algorithm>
+
+#include "paddle/fluid/memory/malloc.h"
+
+namespace paddle {
+namespace framework {
+namespace interpreter {
+
+namespace {
+
+constexpr size_t kArenaAlignment = 64;
+
+size_t AlignedSize(size_t size) {
+  return (size + kArenaAlignment - 1) / kArenaAlignment * kArenaAlignment;
+}
+
+// A slice of the arena which does not own the memory, but keeps the arena
+// alive as long as any tensor still refers to it.
+class ArenaAllocation : public phi::Allocation {
+ public:
+  ArenaAllocation(std::shared_ptr<phi::Allocation> arena,
+                  size_t offset,
+                  size_t size)
+      : phi::Allocation(static_cast<uint8_t*>(arena->ptr()) + offset,
+                        size,
+                        arena->place()),
+        arena_(std::move(arena)) {}
+
+ private:
+  std::shared_ptr<phi::Allocation> arena_;
+};
+
+}  // namespace
+
+void StaticMemoryPlanner::Build(
+    const std::vector<Instruction>& instructions,
+    const DependencyBuilder& dependency_builder,
+    const std::map<size_t, std::set<size_t>>& last_live_ops,
+    const std::set<size_t>& candidate_vars) {
+  dependency_builder_ = &dependency_builder;
+
+  std::unordered_map<size_t, std::vector<size_t>> read_ops;
+  for (const Instruction& instr : instructions) {
+    for (auto& item : instr.Outputs()) {
+      for (int var_id : item.second) {
+        if (var_id != kEmptyVarIndex && candidate_vars.count(var_id)) {
+          def_ops_[var_id].push_back(instr.Id());
+        }
+      }
+    }
+    for (auto& item : instr.Inputs()) {
+      for (int var_id : item.second) {
+        if (var_id != kEmptyVarIndex && candidate_vars.count(var_id)) {
+          read_ops[var_id].push_back(instr.Id());
+        }
+      }
+    }
+  }
+
+  for (size_t var_id : candidate_vars) {
+    auto def_iter = def_ops_.find(var_id);
+    auto live_iter = last_live_ops.find(var_id);
+    if (def_iter == def_ops_.end() || live_iter == last_live_ops.end() ||
+        live_iter->second.empty()) {
+      def_ops_.erase(var_id);
+      continue;
+    }
+    // A variable read before it is written in this block (e.g., an optional
+    // input) must not see the data of another variable.
+    const std::vector<size_t>& defs = def_iter->second;
+    bool read_after_def = true;
+    for (size_t read_op : read_ops[var_id]) {
+      read_after_def = std::any_of(defs.begin(), defs.end(), [&](size_t def) {
+        return def == read_op ||
+               dependency_builder.OpHappensBefore(def, read_op);
+      });
+      if (!read_after_def) break;
+    }
+    if (!read_after_def) {
+      VLOG(4) << "Skip static memory plan for var " << var_id
+              << " since it is read before written";
+      def_ops_.erase(var_id);
+      continue;
+    }
+    last_live_ops_[var_id].assign(live_iter->second.begin(),
+                                  live_iter->second.end());
+  }
+
+  is_recording_ = !def_ops_.empty();
+  VLOG(4) << "Static memory plan candidates: " << def_ops_.size();
+}
+
+void StaticMemoryPlanner::Record(size_t var_id, Variable* var) {
+  if (!def_ops_.count(var_id) || !var->IsType<phi::DenseTensor>()) {
+    return;
+  }
+  const std::shared_ptr<phi::Allocation>& holder =
+      var->Get<phi::DenseTensor>().Holder();
+  if (holder == nullptr) {
+    return;
+  }
+
+  std::lock_guard<memory::SpinLock> guard(spinlock_);
+  if (holder.use_count() > 1) {
+    shared_vars_.insert(var_id);
+    shared_holders_.push_back(holder);
+    return;
+  }
+  size_t& size = recorded_sizes_[var_id];
+  size = std::max(size, holder->size());
+}
+
+bool StaticMemoryPlanner::EndsBefore(size_t prior, size_t posterior) const {
+  for (size_t last_op : last_live_ops_.at(prior)) {
+    for (size_t def_op : def_ops_.at(posterior)) {
+      if (last_op == def_op ||
+          !dependency_builder_->OpHappensBefore(last_op, def_op)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void StaticMemoryPlanner::Plan(const platform::Place& place) {
+  is_recording_ = false;
+
+  std::vector<size_t> planned_vars;
+  for (auto& item : recorded_sizes_) {
+    if (item.second > 0 && !shared_vars_.count(item.first)) {
+      planned_vars.push_back(item.first);
+    }
+  }
+  shared_holders_.clear();
+
+  // Greedy by size: place the larger variables first, each at the lowest
+  // offset which does not overlap any placed variable alive at the same time.
+  std::sort(planned_vars.begin(), planned_vars.end(), [&](size_t a, size_t b) {
+    size_t size_a = recorded_sizes_.at(a), size_b = recorded_sizes_.at(b);
+    return size_a != size_b ? size_a > size_b : a < b;
+  });
+
+  size_t arena_size = 0;
+  size_t total_size = 0;
+  std::vector<size_t> placed_vars;
+  for (size_t var_id : planned_vars) {
+    size_t size = AlignedSize(recorded_sizes_.at(var_id));
+    std::vector<std::pair<size_t, size_t>> occupied;
+    for (size_t placed : placed_vars) {
+      if (Conflict(var_id, placed)) {
+        size_t offset = offsets_.at(placed);
+        occupied.emplace_back(offset,
+                              offset + AlignedSize(recorded_sizes_.at(placed)));
+      }
+    }
+    std::sort(occupied.begin(), occupied.end());
+
+    size_t offset = 0;
+    for (auto& range : occupied) {
+      if (range.first >= offset + size) break;
+      offset = std::max(offset, range.second);
+    }
+    offsets_[var_id] = offset;
+    placed_vars.push_back(var_id);
+    arena_size = std::max(arena_size, offset + size);
+    total_size += size;
+  }
+
+  if (placed_vars.empty()) {
+    VLOG(4) << "No variable is planned statically";
+    return;
+  }
+
+  arena_ = memory::AllocShared(place, arena_size);
+  size_t max_var_id = *std::max_element(placed_vars.begin(), placed_vars.end());
+  is_planned_.assign(max_var_id + 1, false);
+  for (size_t var_id : placed_vars) {
+    is_planned_[var_id] = true;
+  }
+  VLOG(1) << "Static memory plan: " << placed_vars.size()
+          << " variables share an arena of " << arena_size << " bytes, "
+          << total_size << " bytes without reuse";
+}
+
+void StaticMemoryPlanner::Apply(
+    const std::vector<std::shared_ptr<VarRefInfo>>& refs) const {
+  for (auto& item : offsets_) {
+    size_t var_id = item.first;
+    Variable* var = refs.at(var_id)->Var();
+    if (var == nullptr || !var->IsType<phi::DenseTensor>()) {
+      continue;
+    }
+    auto* tensor = var->GetMutable<phi::DenseTensor>();
+    // A variable which already holds memory keeps it, it is just not garbage
+    // collected any more.
+    if (tensor->IsInitialized()) {
+      continue;
+    }
+    tensor->ResetHolder(std::make_shared<ArenaAllocation>(
+        arena_, item.second, recorded_sizes_.at(var_id)));
+  }
+}
+
+}  // namespace interpreter
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,101 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/fluid/framework/new_executor/interpreter/dependency_builder.h"
+#include "paddle/fluid/framework/new_executor/new_executor_defs.h"
+#include "paddle/fluid/memory/allocation/spin_lock.h"
+
+namespace paddle {
+namespace framework {
+namespace interpreter {
+
+// StaticMemoryPlanner assigns the intermediate DenseTensors of a block a fixed
+// offset in one preallocated arena, so that the steady-state runs of a
+// fixed-shape program neither call the allocator nor the garbage collector for
+// them.
+//
+// Two variables may share the same memory only if all the last-live ops of
+// one happen before all the ops writing the other, which is decided with the
+// op_happens_before_ matrix of DependencyBuilder, so the plan stays valid under
+// multi-threaded scheduling. The sizes are recorded when the variables are
+// garbage collected in the first run after building, and the plan is applied
+// at the end of that run. Variables whose holder is shared with another one
+// (e.g., the output of reshape2 shares the buffer of its input) are excluded.
+class StaticMemoryPlanner {
+ public:
+  StaticMemoryPlanner() = default;
+
+  // Collect the candidate variables and their lifetime, and start recording.
+  void Build(const std::vector<Instruction>& instructions,
+             const DependencyBuilder& dependency_builder,
+             const std::map<size_t, std::set<size_t>>& last_live_ops,
+             const std::set<size_t>& candidate_vars);
+
+  bool IsRecording() const { return is_recording_; }
+
+  bool IsPlanned(size_t var_id) const {
+    return var_id < is_planned_.size() && is_planned_[var_id];
+  }
+
+  // Record the size of a candidate variable before it is garbage collected,
+  // thread-safe.
+  void Record(size_t var_id, Variable* var);
+
+  // Assign the offsets of the recorded variables and allocate the arena.
+  void Plan(const platform::Place& place);
+
+  // Bind the planned variables to their slices of the arena.
+  void Apply(const std::vector<std::shared_ptr<VarRefInfo>>& refs) const;
+
+  size_t ArenaSize() const { return arena_ ? arena_->size() : 0; }
+
+ private:
+  // Returns true if the lifetime of var prior ends before the lifetime of var
+  // posterior begins.
+  bool EndsBefore(size_t prior, size_t posterior) const;
+
+  bool Conflict(size_t lhs, size_t rhs) const {
+    return !EndsBefore(lhs, rhs) && !EndsBefore(rhs, lhs);
+  }
+
+  const DependencyBuilder* dependency_builder_{nullptr};  // not owned
+  bool is_recording_{false};
+
+  std::unordered_map<size_t, std::vector<size_t>> def_ops_;
+  std::unordered_map<size_t, std::vector<size_t>> last_live_ops_;
+
+  memory::SpinLock spinlock_;
+  std::unordered_map<size_t, size_t> recorded_sizes_;
+  std::unordered_set<size_t> shared_vars_;
+  // Keep the shared holders alive until planning, so that the other variables
+  // sharing them can be detected by their use_count.
+  std::vector<std::shared_ptr<phi::Allocation>> shared_holders_;
+
+  std::vector<bool> is_planned_;
+  std::unordered_map<size_t, size_t> offsets_;
+  std::shared_ptr<phi::Allocation> arena_{nullptr};
+};
+
+}  // namespace interpreter
+}  // namespace framework
+}  // namespace paddle
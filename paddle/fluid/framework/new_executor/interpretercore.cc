@@ -14,6 +14,8 @@
 
 #include "paddle/fluid/framework/new_executor/interpretercore.h"
 
+#include <algorithm>
+#include <chrono>
 #include <unordered_set>
 
 #include "gflags/gflags.h"
@@ -47,6 +49,22 @@ PADDLE_DEFINE_EXPORTED_bool(
 PADDLE_DEFINE_EXPORTED_bool(new_executor_use_inplace,
                             false,
                             "Use inplace in new executor");
+PADDLE_DEFINE_EXPORTED_bool(
+    new_executor_static_memory_plan,
+    false,
+    "Assign the intermediate tensors fixed offsets in one arena for CPU "
+    "programs with fixed shapes, so that they are neither allocated nor "
+    "garbage collected after the first run.");
+PADDLE_DEFINE_EXPORTED_bool(
+    new_executor_replay,
+    false,
+    "Replay the instructions of CPU programs with static shapes in the order "
+    "recorded by the first run, with prebuilt kernel contexts and gc points.");
+PADDLE_DEFINE_EXPORTED_bool(
+    new_executor_critical_path_scheduling,
+    false,
+    "Dispatch the ready instructions on the longest remaining path first, "
+    "with the kernel time measured in the first run as the cost.");
 PADDLE_DEFINE_EXPORTED_bool(new_executor_use_local_scope,
                             true,
                             "Use local_scope in new executor(especially used "
@@ -137,6 +155,10 @@ InterpreterCore::InterpreterCore(const platform::Place& place,
     SchedulingPriority rhs_scheduling_priority =
         vec_instruction_[rhs].GetSchedulingPriority();
     if (lhs_scheduling_priority == rhs_scheduling_priority) {
+      if (!critical_path_cost_.empty() &&
+          critical_path_cost_[lhs] != critical_path_cost_[rhs]) {
+        return critical_path_cost_[lhs] < critical_path_cost_[rhs];
+      }
       return lhs < rhs;
     }
     return lhs_scheduling_priority > rhs_scheduling_priority;
@@ -164,19 +186,39 @@ void InterpreterCore::RunImpl() {
     gc_ = CreateInterpreterCoreGarbageCollector(place_, vec_instruction_);
   }
 
-  interpreter::ResetAtomicGuard guard(&deps_, &refs_);
-
-  if ((execution_config_.used_for_jit || execution_config_.used_for_cinn) &&
-      (sync_op_num_ == 0)) {
-    VLOG(4) << "Tracing Instruction List";
-    TraceInstructionList(vec_instruction_);
+  if (!replay_list_.empty()) {
+    VLOG(4) << "Replaying Instruction List";
+    ReplayInstructionList();
+    ++replayed_run_num_;
   } else {
-    VLOG(4) << "Non-tracing";
-    // For the program that only run once, it is no need to
-    // create work_queue, so the async_work_queue_ is created
-    // until the second step run.
-    async_work_queue_ = GetWorkQueue();
-    ExecuteInstructionList(vec_instruction_);
+    interpreter::ResetAtomicGuard guard(&deps_, &refs_);
+
+    if ((execution_config_.used_for_jit || execution_config_.used_for_cinn) &&
+        (sync_op_num_ == 0)) {
+      VLOG(4) << "Tracing Instruction List";
+      TraceInstructionList(vec_instruction_);
+    } else {
+      VLOG(4) << "Non-tracing";
+      // For the program that only run once, it is no need to
+      // create work_queue, so the async_work_queue_ is created
+      // until the second step run.
+      async_work_queue_ = GetWorkQueue();
+      ExecuteInstructionList(vec_instruction_);
+    }
+  }
+
+  // The sizes of the planned variables are recorded in the first run.
+  if (UNLIKELY(memory_planner_.IsRecording())) {
+    memory_planner_.Plan(place_);
+    memory_planner_.Apply(refs_);
+  }
+  if (UNLIKELY(is_measuring_cost_)) {
+    is_measuring_cost_ = false;
+    UpdateCriticalPathCost();
+    AnalyseExecuteOrderForTrace();
+  }
+  if (FLAGS_new_executor_replay && !is_replay_built_) {
+    BuildReplayList();
   }
 #ifdef PADDLE_WITH_CUSTOM_DEVICE
   if (platform::is_custom_place(place_)) {
@@ -338,6 +380,12 @@ void InterpreterCore::reset_scope(Scope* new_scope) {
   for (size_t i = 0; i < vec_instruction_.size(); i++) {
     BuildAndCacheInstructionCtx(&vec_instruction_[i]);
   }
+
+  memory_planner_.Apply(refs_);
+
+  // The prebuilt kernel contexts refer to the variables of the old scope.
+  replay_list_.clear();
+  is_replay_built_ = false;
 }
 
 void InterpreterCore::ShareWorkQueueFrom(std::shared_ptr<InterpreterCore> src) {
@@ -817,9 +865,82 @@ void InterpreterCore::Convert(
         vec_meta_info[i].var_ref_count_, var_scope_.VarRef(i)));
   }
 
+  if (FLAGS_new_executor_static_memory_plan) {
+    BuildStaticMemoryPlan();
+  }
+
+  if (FLAGS_new_executor_critical_path_scheduling) {
+    // Take each instruction as unit cost until the first run measures them.
+    instr_cost_.assign(op_nums, 1.0);
+    for (size_t i = 0; i < op_nums; ++i) {
+      if (vec_instruction_[i].IsArtificial()) {
+        instr_cost_[i] = 0.0;
+      }
+    }
+    UpdateCriticalPathCost();
+    is_measuring_cost_ = true;
+  }
+
   AnalyseExecuteOrderForTrace();
 }
 
+void InterpreterCore::BuildStaticMemoryPlan() {
+  if (!platform::is_cpu_place(place_)) {
+    VLOG(4) << "Static memory plan is only supported on CPUPlace, skip it.";
+    return;
+  }
+
+  // Variables whose buffer is shared explicitly by the executor or by the
+  // operator are managed by their owners.
+  std::set<size_t> skip_vars;
+  auto SkipVarsOf = [&skip_vars](
+                        const std::map<std::string, std::vector<int>>& vars) {
+    for (auto& item : vars) {
+      skip_vars.insert(item.second.begin(), item.second.end());
+    }
+  };
+  for (const Instruction& instr : vec_instruction_) {
+    const std::string& op_type = instr.OpBase()->Type();
+    if (op_type == kCoalesceTensor || op_type == "share_buffer" ||
+        op_type == "share_data") {
+      SkipVarsOf(instr.Inputs());
+      SkipVarsOf(instr.Outputs());
+    }
+    for (auto& item : instr.InplaceBackMap()) {
+      skip_vars.insert(item.first);
+      skip_vars.insert(item.second);
+    }
+  }
+  std::unordered_set<const Variable*> inplace_vars;
+  for (const Instruction& instr : vec_instruction_) {
+    for (auto& pair : instr.InplaceInfo()) {
+      inplace_vars.insert(pair.first);
+      inplace_vars.insert(pair.second);
+    }
+  }
+
+  std::set<size_t> candidate_vars;
+  for (auto& item : last_live_ops_) {
+    size_t var_id = item.first;
+    if (item.second.empty() || skip_vars.count(var_id)) {
+      continue;
+    }
+    auto* var_desc = var_scope_.VarDesc(var_id);
+    if (var_desc == nullptr || var_desc->Persistable()) {
+      continue;
+    }
+    Variable* var = refs_[var_id]->Var();
+    if (var == nullptr || !var->IsType<phi::DenseTensor>() ||
+        inplace_vars.count(var)) {
+      continue;
+    }
+    candidate_vars.insert(var_id);
+  }
+
+  memory_planner_.Build(
+      vec_instruction_, dependency_builder_, last_live_ops_, candidate_vars);
+}
+
 void InterpreterCore::BuildSkipShareLoDInfo() {
   for (size_t i = 0; i < vec_instruction_.size(); ++i) {
     bool can_skip_lod = true;
@@ -1007,7 +1128,16 @@ void InterpreterCore::RunInstruction(const Instruction& instr_node) {
     instr_node.WaitEvent(place_);
 
     if (!instr_node.IsArtificial()) {
-      RunOperator(instr_node);
+      if (UNLIKELY(is_measuring_cost_)) {
+        auto start = std::chrono::steady_clock::now();
+        RunOperator(instr_node);
+        instr_cost_[instr_node.Id()] =
+            std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - start)
+                .count();
+      } else {
+        RunOperator(instr_node);
+      }
       CheckGC(instr_node);
       interpreter::LogDeviceMemoryStats(place_);
     }
@@ -1038,7 +1168,11 @@ std::string InterpreterCore::GetDepsString() const {
   for (size_t i = 0; i < deps_.size(); ++i) {
     ss << "op:" << i << ", type: " << vec_instruction_[i].OpBase()->Type()
        << ", static_dep:" << deps_[i]->StaticDep()
-       << ", dynamic_dep:" << deps_[i]->DynamicDep() << ", downstream op: ";
+       << ", dynamic_dep:" << deps_[i]->DynamicDep();
+    if (!critical_path_cost_.empty()) {
+      ss << ", critical_path_cost:" << critical_path_cost_[i];
+    }
+    ss << ", downstream op: ";
     for (auto id : downstream_map[i]) {
       ss << id << ", ";
     }
@@ -1057,6 +1191,8 @@ void InterpreterCore::ExecuteInstructionList(
 
   exception_holder_.Clear();
 
+  std::vector<size_t> host_instr_ids;
+  std::vector<size_t> device_instr_ids;
   for (size_t i = 0; i < dependecy_count_.size(); ++i) {
     if (dependecy_count_[i] == 0) {
       // NOTE(zhiqiu): hot fix for jit input var
@@ -1064,11 +1200,16 @@ void InterpreterCore::ExecuteInstructionList(
       if (FLAGS_new_executor_serial_run) {
         RunInstructionAsync(i);
       } else {
-        async_work_queue_->AddTask(vec_instr.at(i).KernelType(),
-                                   [this, i] { RunInstructionAsync(i); });
+        auto& instr_ids =
+            vec_instr.at(i).KernelType() == OpFuncType::kGpuAsync
+                ? device_instr_ids
+                : host_instr_ids;
+        instr_ids.emplace_back(i);
       }
     }
   }
+  AddInstructionTasks(OpFuncType::kCpuSync, std::move(host_instr_ids));
+  AddInstructionTasks(OpFuncType::kGpuAsync, std::move(device_instr_ids));
 
   // For debug hang in main_thread_blocker_.WaitEvent(),
   // launch async task to log deps every
@@ -1139,13 +1280,21 @@ void InterpreterCore::RunNextInstructions(const Instruction& instr,
     return deps_[next_id]->CheckAndDecrease();
   };
 
+  // Submit the ready ops of a fan-out in batches, one per queue, so that only
+  // as many worker threads as needed are woken up.
+  std::vector<size_t> host_instr_ids;
+  std::vector<size_t> device_instr_ids;
   for (size_t next_instr_id : instr.NextInstrsInDifferenceThread()) {
     if (IsReady(next_instr_id)) {
-      async_work_queue_->AddTask(
-          vec_instruction_[next_instr_id].KernelType(),
-          [this, next_instr_id]() { RunInstructionAsync(next_instr_id); });
+      auto& instr_ids =
+          vec_instruction_[next_instr_id].KernelType() == OpFuncType::kGpuAsync
+              ? device_instr_ids
+              : host_instr_ids;
+      instr_ids.emplace_back(next_instr_id);
     }
   }
+  AddInstructionTasks(OpFuncType::kCpuSync, std::move(host_instr_ids));
+  AddInstructionTasks(OpFuncType::kGpuAsync, std::move(device_instr_ids));
 
   for (size_t next_instr_id : instr.NextInstrsInSameThread()) {
     if (IsReady(next_instr_id)) {
@@ -1154,6 +1303,37 @@ void InterpreterCore::RunNextInstructions(const Instruction& instr,
   }
 }
 
+void InterpreterCore::AddTasks(const OpFuncType& op_func_type,
+                               std::vector<std::function<void()>> tasks) {
+  if (tasks.empty()) {
+    return;
+  }
+  if (tasks.size() == 1) {
+    async_work_queue_->AddTask(op_func_type, std::move(tasks[0]));
+  } else {
+    async_work_queue_->AddTasks(op_func_type, std::move(tasks));
+  }
+}
+
+void InterpreterCore::AddInstructionTasks(const OpFuncType& op_func_type,
+                                          std::vector<size_t> instr_ids) {
+  // The instructions on the longest critical paths are dispatched first.
+  if (!critical_path_cost_.empty()) {
+    std::stable_sort(instr_ids.begin(),
+                     instr_ids.end(),
+                     [this](size_t lhs, size_t rhs) {
+                       return critical_path_cost_[lhs] >
+                              critical_path_cost_[rhs];
+                     });
+  }
+  std::vector<std::function<void()>> tasks;
+  tasks.reserve(instr_ids.size());
+  for (size_t instr_id : instr_ids) {
+    tasks.emplace_back([this, instr_id]() { RunInstructionAsync(instr_id); });
+  }
+  AddTasks(op_func_type, std::move(tasks));
+}
+
 void InterpreterCore::RunInstructionAsync(size_t instr_id) {
   // NOTE(Ruibiao): Due to the uncertain order in multi-threading asynchronous
   // scheduling, the priority order involved cross-thread scheduling is not
@@ -1303,6 +1483,13 @@ void InterpreterCore::CheckGC(const Instruction& instr) {
       continue;
     }
     if (is_ready) {
+      // The planned variables live in the arena of the static memory plan.
+      if (memory_planner_.IsPlanned(var_id)) {
+        continue;
+      }
+      if (UNLIKELY(memory_planner_.IsRecording())) {
+        memory_planner_.Record(var_id, refs_[var_id]->Var());
+      }
       VLOG(6) << "Async delete variable with name : "
               << var_scope.GetNameById(var_id);
       gc_->Add(refs_[var_id]->Var(), instr);
@@ -1435,6 +1622,178 @@ void InterpreterCore::TraceInstructionList(
   }
 }
 
+// The critical path cost of an instruction is its own cost plus the maximum
+// critical path cost of its downstream instructions. Dispatching the ready
+// instructions with larger critical path cost first shortens the end-to-end
+// latency of wide programs when there are more ready instructions than threads.
+void InterpreterCore::UpdateCriticalPathCost() {
+  size_t instr_num = vec_instruction_.size();
+  const std::map<size_t, std::set<size_t>>& downstream_map =
+      dependency_builder_.OpDownstreamMap();
+
+  std::vector<size_t> pending_deps(dependecy_count_);
+  std::vector<size_t> topo_order;
+  topo_order.reserve(instr_num);
+  for (size_t i = 0; i < instr_num; ++i) {
+    if (pending_deps[i] == 0) {
+      topo_order.push_back(i);
+    }
+  }
+  for (size_t i = 0; i < topo_order.size(); ++i) {
+    auto iter = downstream_map.find(topo_order[i]);
+    if (iter == downstream_map.end()) {
+      continue;
+    }
+    for (size_t next_id : iter->second) {
+      if (--pending_deps[next_id] == 0) {
+        topo_order.push_back(next_id);
+      }
+    }
+  }
+  PADDLE_ENFORCE_EQ(
+      topo_order.size(),
+      instr_num,
+      platform::errors::PreconditionNotMet(
+          "The dependency graph of instructions should be acyclic."));
+
+  critical_path_cost_.assign(instr_num, 0.0);
+  for (auto it = topo_order.rbegin(); it != topo_order.rend(); ++it) {
+    double downstream_cost = 0.0;
+    auto iter = downstream_map.find(*it);
+    if (iter != downstream_map.end()) {
+      for (size_t next_id : iter->second) {
+        downstream_cost =
+            std::max(downstream_cost, critical_path_cost_[next_id]);
+      }
+    }
+    critical_path_cost_[*it] = instr_cost_[*it] + downstream_cost;
+    VLOG(6) << "Critical path cost of "
+            << vec_instruction_[*it].OpBase()->Type() << " (" << *it
+            << "): " << critical_path_cost_[*it];
+  }
+}
+
+// Note(Replay):
+// When a CPU program with static shapes runs many times, the overhead of
+// scheduling (the SchedulingQueue, the atomic deps_ and refs_, and the
+// RuntimeContext lookups in RunOperator) may dominate for small models. After
+// the first run, BuildReplayList freezes trace_execute_order_ into a flat list
+// where each phi function kernel carries a prebuilt phi::KernelContext, and
+// each instruction carries the variables to be garbage collected after it, so
+// that the following runs just iterate the list in the main thread. It is a
+// CPU analogue of CUDA Graph capturing.
+void InterpreterCore::BuildReplayList() {
+  is_replay_built_ = true;
+  if (!platform::is_cpu_place(place_) || !hookfuncs_.empty() ||
+      FLAGS_check_nan_inf || FLAGS_benchmark ||
+      trace_execute_order_.size() != vec_instruction_.size()) {
+    VLOG(4) << "Replay is not supported for this program, skip it.";
+    return;
+  }
+
+  // In a fixed order, a variable is garbage collected after the last of its
+  // gc check instructions.
+  std::vector<size_t> position(vec_instruction_.size());
+  for (size_t i = 0; i < trace_execute_order_.size(); ++i) {
+    position[trace_execute_order_[i]] = i;
+  }
+  std::map<size_t, size_t> gc_position;
+  for (const Instruction& instr : vec_instruction_) {
+    for (size_t var_id : instr.GCCheckVars()) {
+      auto* var_desc = var_scope_.VarDesc(var_id);
+      if ((var_desc && var_desc->Persistable()) ||
+          memory_planner_.IsPlanned(var_id)) {
+        continue;
+      }
+      size_t& pos = gc_position[var_id];
+      pos = std::max(pos, position[instr.Id()]);
+    }
+  }
+
+  std::vector<ReplayInstruction> replay_list(trace_execute_order_.size());
+  for (auto& item : gc_position) {
+    replay_list[item.second].gc_vars.push_back(refs_[item.first]->Var());
+  }
+
+  size_t num_prebuilt = 0;
+  for (size_t i = 0; i < trace_execute_order_.size(); ++i) {
+    const Instruction& instr = vec_instruction_[trace_execute_order_[i]];
+    ReplayInstruction& replay_instr = replay_list[i];
+    replay_instr.instr = &instr;
+
+    // Fall back to RunOperator for the instructions which need extra work at
+    // runtime.
+    auto* op_with_kernel =
+        dynamic_cast<const framework::OperatorWithKernel*>(instr.OpBase());
+    phi::Kernel* kernel = instr.PhiKernel();
+    if (instr.IsArtificial() || op_with_kernel == nullptr ||
+        kernel == nullptr || !kernel->IsValid() ||
+        kernel->GetKernelRegisteredType() !=
+            phi::KernelRegisteredType::FUNCTION ||
+        instr.InnerInferShapeContext()->IsRunMKLDNNKernel() ||
+        !instr.InplaceInfo().empty() || !instr.InplaceBackMap().empty()) {
+      continue;
+    }
+    // The attributes built from input tensors, e.g., ShapeTensor, may change
+    // between runs.
+    const RuntimeContext& runtime_ctx = *instr.InnerRuntimeContext();
+    const phi::KernelSignature* signature =
+        op_with_kernel->PhiKernelSignature();
+    if (signature == nullptr ||
+        std::any_of(signature->attr_names.begin(),
+                    signature->attr_names.end(),
+                    [&](const char* attr_name) {
+                      return !op_with_kernel->HasAttr(attr_name) &&
+                             runtime_ctx.inputs.count(attr_name);
+                    })) {
+      continue;
+    }
+
+    replay_instr.kernel = kernel;
+    replay_instr.kernel_context = std::make_unique<phi::KernelContext>();
+    op_with_kernel->BuildPhiKernelContext(
+        runtime_ctx,
+        const_cast<platform::DeviceContext*>(&instr.DeviceContext()),
+        replay_instr.kernel_context.get());
+    replay_instr.need_infer_shape =
+        !(op_with_kernel->HasAttr(kAllKernelsMustComputeRuntimeShape) &&
+          op_with_kernel->Attr<bool>(kAllKernelsMustComputeRuntimeShape));
+    ++num_prebuilt;
+  }
+
+  replay_list_ = std::move(replay_list);
+  VLOG(4) << "Build replay list with " << replay_list_.size()
+          << " instructions, " << num_prebuilt
+          << " of them have prebuilt kernel contexts.";
+}
+
+void InterpreterCore::ReplayInstructionList() {
+  for (const ReplayInstruction& replay_instr : replay_list_) {
+    const Instruction& instr = *replay_instr.instr;
+    auto* op = instr.OpBase();
+    platform::RecordEvent instruction_event(
+        op->Type(), platform::TracerEventType::Operator, 1);
+
+    try {
+      if (replay_instr.kernel_context) {
+        if (replay_instr.need_infer_shape) {
+          op->Info().infer_shape_(instr.InnerInferShapeContext().get());
+        }
+        (*replay_instr.kernel)(replay_instr.kernel_context.get());
+      } else if (!instr.IsArtificial()) {
+        RunOperator(instr);
+      }
+    } catch (platform::EnforceNotMet& ex) {
+      framework::InsertCallStackInfo(op->Type(), op->Attrs(), &ex);
+      throw;
+    }
+
+    for (Variable* var : replay_instr.gc_vars) {
+      gc_->Add(var, instr);
+    }
+  }
+}
+
 void InterpreterCore::RecordMemcpyD2H(const Instruction& instr_node) {
   // NOTE(zhiqiu): hot fix for jit input var
   if (instr_node.OpBase()->Type() == interpreter::kMemcpyD2H) {
@@ -24,6 +24,7 @@
 #include "paddle/fluid/framework/new_executor/interpreter/dependency_builder.h"
 #include "paddle/fluid/framework/new_executor/interpreter/execution_config.h"
 #include "paddle/fluid/framework/new_executor/interpreter/interpreter_util.h"
+#include "paddle/fluid/framework/new_executor/interpreter/static_memory_planner.h"
 #include "paddle/fluid/framework/new_executor/interpreter/stream_analyzer.h"
 #include "paddle/fluid/framework/new_executor/new_executor_defs.h"
 #include "paddle/fluid/framework/new_executor/profiler.h"
@@ -77,6 +78,19 @@ class InterpreterCore {
 
   const platform::Place& GetPlace() const { return place_; }
 
+  // The cost of the longest path from each instruction to the end of the
+  // program, in microseconds once measured by the first run. It is used as the
+  // scheduling priority if FLAGS_new_executor_critical_path_scheduling is on.
+  const std::vector<double>& CriticalPathCost() const {
+    return critical_path_cost_;
+  }
+
+  // The number of instructions in the replay list, which is built after the
+  // first RunImpl if FLAGS_new_executor_replay is on, and the number of runs
+  // which have replayed it.
+  size_t ReplayListSize() const { return replay_list_.size(); }
+  int64_t ReplayedRunNum() const { return replayed_run_num_; }
+
   using HookFunc = std::function<void(OperatorBase*, Scope*)>;
   void SetOutputHooks(const std::vector<HookFunc>& hookfuncs) {
     hookfuncs_ = hookfuncs;
@@ -91,6 +105,7 @@ class InterpreterCore {
   void BuildSkipShareLoDInfo();
   void UpdateSyncOpNum();
   void AnalyseExecuteOrderForTrace();
+  void UpdateCriticalPathCost();
 
   // inplace
   void BuildInplace();
@@ -98,6 +113,9 @@ class InterpreterCore {
       const std::vector<std::vector<size_t>>& input_var2op, size_t var_index);
   void SetFeedVarsInplaceSkip(const std::vector<std::string>& feed_names);
 
+  // static memory plan
+  void BuildStaticMemoryPlan();
+
   // cuda graph
   void CheckCUDAGraphBeforeRun(const std::vector<std::string>& feed_names);
   void PrepareForCUDAGraphCapture();
@@ -109,9 +127,20 @@ class InterpreterCore {
   void RunInstruction(const Instruction& instr_node);
   void RunNextInstructions(const Instruction& instr_id,
                            SchedulingQueue* reserved_next_ops);
+  // Submit the tasks to the queue of op_func_type, in one batch if there are
+  // more than one.
+  void AddTasks(const OpFuncType& op_func_type,
+                std::vector<std::function<void()>> tasks);
+  // Submit the tasks running the instructions, in descending order of their
+  // critical path cost if it is computed.
+  void AddInstructionTasks(const OpFuncType& op_func_type,
+                           std::vector<size_t> instr_ids);
   void RunOperator(const Instruction& instr_node);
   // Trace
   void TraceInstructionList(const std::vector<Instruction>& vec_instr);
+  // Replay
+  void BuildReplayList();
+  void ReplayInstructionList();
 
   // only used when program contains no feed op
   void Prepare(const std::vector<std::string>& feed_names,
@@ -143,6 +172,7 @@ class InterpreterCore {
 
   interpreter::DependencyBuilder dependency_builder_;
   interpreter::StreamAnalyzer stream_analyzer_;
+  interpreter::StaticMemoryPlanner memory_planner_;
 
   // NOTE(zhiqiu): when add fetch ops in GetInterpreterCore, we will
   // copy a new program and block, the copy_program_ here is used to
@@ -188,6 +218,25 @@ class InterpreterCore {
   int64_t sync_op_num_{-1};
   std::vector<size_t> trace_execute_order_;
 
+  // used for Replay, the instructions in trace_execute_order_ with their
+  // prebuilt phi::KernelContext and the variables to gc after them
+  struct ReplayInstruction {
+    const Instruction* instr;
+    phi::Kernel* kernel{nullptr};
+    std::unique_ptr<phi::KernelContext> kernel_context{nullptr};
+    bool need_infer_shape{true};
+    std::vector<Variable*> gc_vars;
+  };
+  bool is_replay_built_{false};
+  std::vector<ReplayInstruction> replay_list_;
+  int64_t replayed_run_num_{0};
+
+  // used for critical-path scheduling, instr_cost_[i] is the cost of the i-th
+  // instruction measured in the first run
+  bool is_measuring_cost_{false};
+  std::vector<double> instr_cost_;
+  std::vector<double> critical_path_cost_;
+
   InstructionSchedulingPriorityLess instruction_scheduling_priority_less;
 
   std::vector<HookFunc> hookfuncs_;
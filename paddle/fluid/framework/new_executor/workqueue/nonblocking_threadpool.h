@@ -9,7 +9,9 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstdlib>
 #include <vector>
 
@@ -33,10 +35,16 @@ class ThreadPoolTempl {
                   int num_threads,
                   bool allow_spinning,
                   bool always_spinning,
+                  bool adaptive_spinning = false,
+                  const std::vector<int>& thread_cpus = {},
                   Environment env = Environment())
       : env_(env),
         allow_spinning_(allow_spinning),
         always_spinning_(always_spinning),
+        adaptive_spinning_(adaptive_spinning),
+        thread_cpus_(thread_cpus),
+        last_task_time_ns_(0),
+        task_interval_ns_(kMaxAdaptiveSpinNs),
         global_steal_partition_(EncodePartition(0, num_threads)),
         blocked_(0),
         num_tasks_(0),
@@ -54,6 +62,8 @@ class ThreadPoolTempl {
     // repetitions (effectively getting a presudo-random permutation of thread
     // indices).
     assert(num_threads_ >= 1 && num_threads_ < kMaxThreads);
+    assert(thread_cpus_.empty() ||
+           thread_cpus_.size() == static_cast<size_t>(num_threads_));
     all_coprimes_.reserve(num_threads_);
     for (int i = 1; i <= num_threads_; ++i) {
       all_coprimes_.emplace_back();
@@ -109,6 +119,9 @@ class ThreadPoolTempl {
   void AddTaskWithHint(std::function<void()> fn, int start, int limit) {
     Task t = env_.CreateTask(std::move(fn));
     PerThread* pt = GetPerThread();
+    if (adaptive_spinning_) {
+      UpdateTaskInterval();
+    }
     uint64_t num_tasks = num_tasks_.fetch_add(1, std::memory_order_relaxed) + 1;
     if (pt->pool == this) {
       // Worker thread of this pool, push onto the thread's queue.
@@ -146,6 +159,74 @@ class ThreadPoolTempl {
     }
   }
 
+  // Push a batch of tasks and wake up at most as many blocked threads as the
+  // tasks that cannot be taken by the running threads, instead of notifying
+  // once per task. The tasks are spread over the queues in [start, limit)
+  // when called from a thread not belonging to this pool, otherwise they are
+  // pushed to the front of the queue of the calling thread, which takes them
+  // in the given order.
+  void AddTasks(std::vector<std::function<void()>> fns) {
+    AddTasksWithHint(std::move(fns), 0, num_threads_);
+  }
+
+  void AddTasksWithHint(std::vector<std::function<void()>> fns,
+                        int start,
+                        int limit) {
+    if (fns.empty()) {
+      return;
+    }
+    PerThread* pt = GetPerThread();
+    if (adaptive_spinning_) {
+      UpdateTaskInterval();
+    }
+    uint64_t num_tasks =
+        num_tasks_.fetch_add(fns.size(), std::memory_order_relaxed) +
+        fns.size();
+    std::vector<Task> rejected;
+    int rnd = 0;
+    if (pt->pool != this) {
+      assert(start < limit);
+      assert(limit <= num_threads_);
+      rnd = Rand(&pt->rand) % (limit - start);
+    }
+    for (size_t i = 0; i < fns.size(); ++i) {
+      // The own queue is filled from the front, so the last task is pushed
+      // first to keep the first one in front.
+      size_t fn_idx = pt->pool == this ? fns.size() - 1 - i : i;
+      Task t = env_.CreateTask(std::move(fns[fn_idx]));
+      if (pt->pool == this) {
+        Queue& q = thread_data_[pt->thread_id].queue;
+        t = q.PushFront(std::move(t));
+      } else {
+        int idx = start + (rnd + i) % (limit - start);
+        Queue& q = thread_data_[idx].queue;
+        t = q.PushBack(std::move(t));
+      }
+      if (t.f) {
+        rejected.emplace_back(std::move(t));
+      }
+    }
+    uint64_t num_pushed = fns.size() - rejected.size();
+    // Same 'false positive' tolerant estimation as AddTaskWithHint, each
+    // notification wakes up at most one thread.
+    uint64_t num_running = num_threads_ - blocked_;
+    uint64_t num_notify = 0;
+    if (num_tasks > num_running) {
+      num_notify = std::min(num_pushed, num_tasks - num_running);
+    }
+    VLOG(6) << "Add " << fns.size() << " tasks, Notify " << num_notify
+            << " times";
+    for (uint64_t i = 0; i < num_notify; ++i) {
+      ec_.Notify(false);
+    }
+    if (!rejected.empty()) {
+      num_tasks_.fetch_sub(rejected.size(), std::memory_order_relaxed);
+      for (Task& t : rejected) {
+        env_.ExecuteTask(t);  // Push failed, execute directly.
+      }
+    }
+  }
+
   void Cancel() {
     cancelled_ = true;
     done_ = true;
@@ -182,6 +263,12 @@ class ThreadPoolTempl {
   static const int kMaxPartitionBits = 16;
   static const int kMaxThreads = 1 << kMaxPartitionBits;
 
+  // With adaptive spinning, idle threads spin for about twice the recent
+  // inter-task arrival time before parking, but never longer than this. Parking
+  // and waking up a thread costs tens of microseconds, so it is not worth
+  // spinning longer.
+  static const uint64_t kMaxAdaptiveSpinNs = 100000;
+
   inline unsigned EncodePartition(unsigned start, unsigned limit) {
     return (start << kMaxPartitionBits) | limit;
   }
@@ -241,6 +328,11 @@ class ThreadPoolTempl {
   Environment env_;
   const bool allow_spinning_;
   const bool always_spinning_;
+  const bool adaptive_spinning_;
+  const std::vector<int> thread_cpus_;
+  // Exponential moving average of the interval between AddTask calls.
+  std::atomic<uint64_t> last_task_time_ns_;
+  std::atomic<uint64_t> task_interval_ns_;
   std::vector<std::vector<unsigned>> all_coprimes_;
   unsigned global_steal_partition_;
   std::atomic<unsigned> blocked_;
@@ -257,6 +349,14 @@ class ThreadPoolTempl {
     std::string thr_name = name_ + "_thread_" + std::to_string(thread_id);
     VLOG(1) << thr_name << " started ";
     platform::SetCurrentThreadName(thr_name);
+    if (!thread_cpus_.empty()) {
+      int cpu = thread_cpus_[thread_id];
+      if (SetCurrentThreadAffinity(cpu)) {
+        VLOG(1) << thr_name << " is bound to cpu " << cpu;
+      } else {
+        LOG(WARNING) << "Failed to bind " << thr_name << " to cpu " << cpu;
+      }
+    }
     PerThread* pt = GetPerThread();
     pt->pool = this;
     pt->rand = GlobalThreadIdHash();
@@ -278,10 +378,18 @@ class ThreadPoolTempl {
       // pools tend to be used for.
       while (!cancelled_) {
         Task t = q.PopFront();
-        for (int i = 0; i < spin_count && !t.f; i++) {
-          if (!cancelled_.load(std::memory_order_relaxed)) {
+        if (adaptive_spinning_) {
+          uint64_t deadline = NowNs() + AdaptiveSpinNs();
+          while (!t.f && !cancelled_.load(std::memory_order_relaxed) &&
+                 NowNs() < deadline) {
             t = q.PopFront();
           }
+        } else {
+          for (int i = 0; i < spin_count && !t.f; i++) {
+            if (!cancelled_.load(std::memory_order_relaxed)) {
+              t = q.PopFront();
+            }
+          }
         }
         if (!t.f) {
           if (!WaitForWork(waiter, &t)) {
@@ -301,7 +409,16 @@ class ThreadPoolTempl {
           if (!t.f) {
             t = GlobalSteal();
             if (!t.f) {
-              if (allow_spinning_) {
+              if (adaptive_spinning_) {
+                uint64_t deadline = NowNs() + AdaptiveSpinNs();
+                while (!t.f && NowNs() < deadline) {
+                  if (!cancelled_.load(std::memory_order_relaxed)) {
+                    t = GlobalSteal();
+                  } else {
+                    return;
+                  }
+                }
+              } else if (allow_spinning_) {
                 for (int i = 0; i < spin_count && !t.f; i++) {
                   if (!cancelled_.load(std::memory_order_relaxed)) {
                     t = GlobalSteal();
@@ -458,6 +575,37 @@ class ThreadPoolTempl {
     return -1;
   }
 
+  static inline uint64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  // Update the moving average of the inter-task arrival time with weight 1/8.
+  // The races between concurrent AddTask calls only lose some samples.
+  void UpdateTaskInterval() {
+    uint64_t now = NowNs();
+    uint64_t last = last_task_time_ns_.exchange(now, std::memory_order_relaxed);
+    if (last == 0 || now <= last) {
+      return;
+    }
+    uint64_t interval = std::min(now - last, 2 * kMaxAdaptiveSpinNs);
+    uint64_t average = task_interval_ns_.load(std::memory_order_relaxed);
+    task_interval_ns_.store(average - average / 8 + interval / 8,
+                            std::memory_order_relaxed);
+  }
+
+  // Spin while the next task is likely to come soon, and park immediately if
+  // the tasks come rarely.
+  uint64_t AdaptiveSpinNs() const {
+    uint64_t interval = task_interval_ns_.load(std::memory_order_relaxed);
+    if (interval > kMaxAdaptiveSpinNs) {
+      return 0;
+    }
+    return 2 * interval > kMaxAdaptiveSpinNs ? kMaxAdaptiveSpinNs
+                                             : 2 * interval;
+  }
+
   static inline uint64_t GlobalThreadIdHash() {
     return std::hash<std::thread::id>()(std::this_thread::get_id());
   }
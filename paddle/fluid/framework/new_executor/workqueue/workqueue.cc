@@ -6,6 +6,9 @@
 
 #include "paddle/fluid/framework/new_executor/workqueue/workqueue.h"
 
+#include <algorithm>
+#include <utility>
+
 #include "paddle/fluid/framework/new_executor/workqueue/nonblocking_threadpool.h"
 #include "paddle/fluid/framework/new_executor/workqueue/workqueue_utils.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -29,12 +32,84 @@ void WorkQueueOptions::Validate() const {
       false,
       platform::errors::InvalidArgument("WorkQueueOptions.allow_spinning must "
                                         "be true when always_spinning is set"));
+  PADDLE_ENFORCE_EQ(
+      adaptive_spinning && (!allow_spinning || always_spinning),
+      false,
+      platform::errors::InvalidArgument(
+          "WorkQueueOptions.adaptive_spinning needs allow_spinning to be set "
+          "and always_spinning not"));
 }
 
 namespace {
 
 using TaskTracker = TaskTracker<EventsWaiter::EventNotifier>;
 
+// Returns the cpu of each worker thread, or an empty vector if the threads are
+// not bound. The threads are distributed evenly and in order over the cpus
+// sorted by their NUMA nodes, so that the threads on the same node have
+// contiguous indices.
+std::vector<int> GetThreadCpus(const WorkQueueOptions& options,
+                               std::vector<int>* thread_numa_nodes) {
+  std::vector<int> cpus = options.cpu_affinity;
+  if (cpus.empty() && options.numa_node >= 0) {
+    cpus = GetNumaNodeCpus(options.numa_node);
+    if (cpus.empty()) {
+      LOG(WARNING) << "Cannot find the cpus of NUMA node " << options.numa_node
+                   << ", the threads of " << options.name << " are not bound.";
+    }
+  }
+  if (cpus.empty()) {
+    return {};
+  }
+
+  std::vector<std::pair<int, int>> node_and_cpus;
+  for (int cpu : cpus) {
+    node_and_cpus.emplace_back(GetCpuNumaNode(cpu), cpu);
+  }
+  std::sort(node_and_cpus.begin(), node_and_cpus.end());
+
+  std::vector<int> thread_cpus(options.num_threads);
+  thread_numa_nodes->resize(options.num_threads);
+  for (size_t i = 0; i < options.num_threads; ++i) {
+    const auto& node_and_cpu =
+        node_and_cpus[i * node_and_cpus.size() / options.num_threads];
+    (*thread_numa_nodes)[i] = node_and_cpu.first;
+    thread_cpus[i] = node_and_cpu.second;
+  }
+  return thread_cpus;
+}
+
+// Create a NonblockingThreadPool whose steal partitions are aligned with the
+// NUMA nodes of the bound threads.
+NonblockingThreadPool* CreateThreadPool(const WorkQueueOptions& options,
+                                        void* storage) {
+  std::vector<int> thread_numa_nodes;
+  std::vector<int> thread_cpus = GetThreadCpus(options, &thread_numa_nodes);
+  NonblockingThreadPool* pool =
+      new (storage) NonblockingThreadPool(options.name,
+                                          options.num_threads,
+                                          options.allow_spinning,
+                                          options.always_spinning,
+                                          options.adaptive_spinning,
+                                          thread_cpus);
+  if (!thread_numa_nodes.empty()) {
+    std::vector<std::pair<unsigned, unsigned>> partitions(options.num_threads);
+    size_t start = 0;
+    for (size_t i = 1; i <= options.num_threads; ++i) {
+      if (i == options.num_threads ||
+          thread_numa_nodes[i] != thread_numa_nodes[start]) {
+        for (size_t j = start; j < i; ++j) {
+          partitions[j] = std::make_pair(static_cast<unsigned>(start),
+                                         static_cast<unsigned>(i));
+        }
+        start = i;
+      }
+    }
+    pool->SetStealPartitions(partitions);
+  }
+  return pool;
+}
+
 class WorkQueueImpl : public WorkQueue {
  public:
   explicit WorkQueueImpl(const WorkQueueOptions& options) : WorkQueue(options) {
@@ -47,14 +122,14 @@ class WorkQueueImpl : public WorkQueue {
       destruct_notifier_ =
           options.events_waiter->RegisterEvent(kQueueDestructEvent);
     }
-    queue_ = new NonblockingThreadPool(options_.name,
-                                       options_.num_threads,
-                                       options_.allow_spinning,
-                                       options_.always_spinning);
+    queue_ = CreateThreadPool(options_,
+                              AlignedMalloc(sizeof(NonblockingThreadPool),
+                                            alignof(NonblockingThreadPool)));
   }
 
   virtual ~WorkQueueImpl() {
-    delete queue_;
+    queue_->~NonblockingThreadPool();
+    AlignedFree(queue_);
     if (tracker_ != nullptr) {
       tracker_->~TaskTracker();
       AlignedFree(tracker_);
@@ -75,6 +150,19 @@ class WorkQueueImpl : public WorkQueue {
     queue_->AddTask(std::move(fn));
   }
 
+  void AddTasks(std::vector<std::function<void()>> fns) override {
+    platform::RecordEvent record("WorkQueue::AddTasks",
+                                 platform::TracerEventType::UserDefined,
+                                 10 /*level*/);
+    if (tracker_ != nullptr) {
+      for (auto& fn : fns) {
+        fn = [task = std::move(fn),
+              raii = CounterGuard<TaskTracker>(tracker_)]() mutable { task(); };
+      }
+    }
+    queue_->AddTasks(std::move(fns));
+  }
+
   void Cancel() override {
     queue_->Cancel();
     queue_->WaitThreadsExit();
@@ -98,6 +186,9 @@ class WorkQueueGroupImpl : public WorkQueueGroup {
 
   void AddTask(size_t queue_idx, std::function<void()> fn) override;
 
+  void AddTasks(size_t queue_idx,
+                std::vector<std::function<void()>> fns) override;
+
   size_t QueueNumThreads(size_t queue_idx) const override;
 
   size_t QueueGroupNumThreads() const override;
@@ -139,11 +230,7 @@ WorkQueueGroupImpl::WorkQueueGroupImpl(
       destruct_notifier_ =
           options.events_waiter->RegisterEvent(kQueueDestructEvent);
     }
-    queues_[idx] = new (&queues_storage_[idx])
-        NonblockingThreadPool(options.name,
-                              options.num_threads,
-                              options.allow_spinning,
-                              options.always_spinning);
+    queues_[idx] = CreateThreadPool(options, &queues_storage_[idx]);
   }
 }
 
@@ -179,6 +266,25 @@ void WorkQueueGroupImpl::AddTask(size_t queue_idx, std::function<void()> fn) {
   queues_[queue_idx]->AddTask(std::move(fn));
 }
 
+void WorkQueueGroupImpl::AddTasks(size_t queue_idx,
+                                  std::vector<std::function<void()>> fns) {
+  platform::RecordEvent record("WorkQueue::AddTasks",
+                               platform::TracerEventType::UserDefined,
+                               10 /*level*/);
+  assert(queue_idx < queues_.size());
+  PADDLE_ENFORCE_NOT_NULL(
+      queues_.at(queue_idx),
+      platform::errors::NotFound("Workqueue of index %d is not initialized.",
+                                 queue_idx));
+  if (queues_options_.at(queue_idx).track_task) {
+    for (auto& fn : fns) {
+      fn = [task = std::move(fn),
+            raii = CounterGuard<TaskTracker>(tracker_)]() mutable { task(); };
+    }
+  }
+  queues_[queue_idx]->AddTasks(std::move(fns));
+}
+
 size_t WorkQueueGroupImpl::QueueNumThreads(size_t queue_idx) const {
   assert(queue_idx < queues_.size());
   if (!queues_.at(queue_idx)) {
@@ -93,6 +93,16 @@ struct WorkQueueOptions {
   // Worker threads will never sleep if this flag is set.
   // Better performance vs. higher CPU utilization.
   bool always_spinning{false};
+  // Worker threads adapt the spinning time to the recent inter-task arrival
+  // time: spin if the next task is likely to come soon, otherwise park. Need
+  // allow_spinning to be set and always_spinning not.
+  bool adaptive_spinning{false};
+  // Bind the worker threads to these cpus. If it is empty and numa_node is not
+  // negative, the cpus of numa_node are used. The threads are evenly
+  // distributed over the cpus, and the threads on the same NUMA node steal
+  // tasks from each other before stealing from the other nodes.
+  std::vector<int> cpu_affinity;
+  int numa_node{-1};
   // If you need to blocking the calling  thread to wait "queue empty", set
   // track_task = true and set events_waiter. EventsWaiter::WaitEvent will
   // block the calling thread until any of events (including "queue empty")
@@ -116,6 +126,10 @@ class WorkQueue {
 
   virtual void AddTask(std::function<void()> fn) = 0;
 
+  // Add a batch of tasks at once, which wakes up fewer threads than calling
+  // AddTask for each of them.
+  virtual void AddTasks(std::vector<std::function<void()>> fns) = 0;
+
   // Higher cost than AddTask
   template <typename F, typename... Args>
   std::future<typename std::result_of<F(Args...)>::type> AddAwaitableTask(
@@ -155,6 +169,11 @@ class WorkQueueGroup {
 
   virtual void AddTask(size_t queue_idx, std::function<void()> fn) = 0;
 
+  // Add a batch of tasks at once, which wakes up fewer threads than calling
+  // AddTask for each of them.
+  virtual void AddTasks(size_t queue_idx,
+                        std::vector<std::function<void()>> fns) = 0;
+
   // Higher cost than AddTask
   template <typename F, typename... Args>
   std::future<typename std::result_of<F(Args...)>::type> AddAwaitableTask(
@@ -15,6 +15,7 @@
 #include "paddle/fluid/framework/new_executor/workqueue/workqueue.h"
 
 #include <atomic>
+#include <chrono>
 #include <thread>
 
 #include "glog/logging.h"
@@ -204,3 +205,115 @@ TEST(WorkQueue, TestWorkQueueGroup) {
   queue_group.reset();
   waiter_thread.join();
 }
+
+TEST(WorkQueue, TestSpinningPolicy) {
+  using paddle::framework::CreateMultiThreadedWorkQueue;
+  using paddle::framework::EventsWaiter;
+  using paddle::framework::GetNumaNodeCpus;
+  using paddle::framework::WorkQueueOptions;
+  constexpr unsigned kTaskNum = 2000;
+  // Short bursts of small tasks separated by a short idle time, the pattern
+  // of the host tasks of the new executor.
+  auto run = [kTaskNum](WorkQueueOptions options) {
+    EventsWaiter events_waiter;
+    options.track_task = true;
+    options.events_waiter = &events_waiter;
+    auto work_queue = CreateMultiThreadedWorkQueue(options);
+    std::atomic<unsigned> counter{0};
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < kTaskNum; ++i) {
+      work_queue->AddTask([&counter]() { ++counter; });
+      if (i % 10 == 9) {
+        events_waiter.WaitEvent();
+        std::this_thread::sleep_for(std::chrono::microseconds(10));
+      }
+    }
+    events_waiter.WaitEvent();
+    auto cost = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+    LOG(INFO) << options.name << " costs " << cost << " us";
+    EXPECT_EQ(counter.load(), kTaskNum);
+  };
+
+  WorkQueueOptions options(/*name*/ "NoSpinning",
+                           /*num_threads*/ 4,
+                           /*allow_spinning*/ false,
+                           /*track_task*/ false);
+  run(options);
+
+  options.name = "AlwaysSpinning";
+  options.allow_spinning = true;
+  options.always_spinning = true;
+  run(options);
+
+  options.name = "AdaptiveSpinning";
+  options.always_spinning = false;
+  options.adaptive_spinning = true;
+  run(options);
+
+  // Binding to the cpus of a NUMA node is skipped silently if the topology is
+  // not available.
+  options.name = "AdaptiveSpinningOnNumaNode0";
+  options.numa_node = 0;
+  run(options);
+
+  std::vector<int> cpus = GetNumaNodeCpus(0);
+  if (!cpus.empty()) {
+    options.name = "AdaptiveSpinningOnCpu0";
+    options.numa_node = -1;
+    options.cpu_affinity = {cpus[0]};
+    run(options);
+  }
+}
+
+TEST(WorkQueue, TestAddTasks) {
+  using paddle::framework::CreateMultiThreadedWorkQueue;
+  using paddle::framework::CreateWorkQueueGroup;
+  using paddle::framework::EventsWaiter;
+  using paddle::framework::WorkQueueOptions;
+  std::atomic<unsigned> counter{0};
+  constexpr unsigned kTaskNum = 64;
+  auto make_tasks = [&counter, kTaskNum]() {
+    std::vector<std::function<void()>> tasks;
+    for (unsigned i = 0; i < kTaskNum; ++i) {
+      tasks.emplace_back([&counter]() { ++counter; });
+    }
+    return tasks;
+  };
+  // From a free-standing thread
+  EventsWaiter events_waiter;
+  WorkQueueOptions options(/*name*/ "MultiThreadedWorkQueueForTesting",
+                           /*num_threads*/ 4,
+                           /*allow_spinning*/ true,
+                           /*always_spinning*/ false,
+                           /*track_task*/ true,
+                           /*detached*/ true,
+                           &events_waiter);
+  auto work_queue = CreateMultiThreadedWorkQueue(options);
+  work_queue->AddTasks(make_tasks());
+  EXPECT_EQ(events_waiter.WaitEvent(), paddle::framework::kQueueEmptyEvent);
+  EXPECT_EQ(counter.load(), kTaskNum);
+  // From a worker thread of the same queue
+  work_queue->AddTask([&work_queue, &make_tasks]() {
+    work_queue->AddTasks(make_tasks());
+  });
+  events_waiter.WaitEvent();
+  EXPECT_EQ(counter.load(), 2 * kTaskNum);
+  // An empty batch
+  work_queue->AddTasks({});
+  work_queue.reset();
+
+  // WorkQueueGroup
+  WorkQueueOptions group_options(/*name*/ "WorkQueueGroupForTesting",
+                                 /*num_threads*/ 4,
+                                 /*allow_spinning*/ true,
+                                 /*always_spinning*/ false,
+                                 /*track_task*/ true,
+                                 /*detached*/ true,
+                                 &events_waiter);
+  auto queue_group = CreateWorkQueueGroup({group_options});
+  queue_group->AddTasks(0, make_tasks());
+  events_waiter.WaitEvent();
+  EXPECT_EQ(counter.load(), 3 * kTaskNum);
+}
@@ -16,6 +16,13 @@
 
 #include <cstdint>
 #include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace paddle {
 namespace framework {
@@ -56,5 +63,66 @@ void AlignedFree(void* mem_ptr) {
 #endif
 }
 
+namespace {
+
+// Parses a cpu list of sysfs, e.g., "0-3,8-11".
+std::vector<int> ParseCpuList(const std::string& cpu_list) {
+  std::vector<int> cpus;
+  std::stringstream ss(cpu_list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty()) {
+      continue;
+    }
+    size_t dash = range.find('-');
+    int first = std::atoi(range.substr(0, dash).c_str());
+    int last =
+        dash == std::string::npos ? first : std::atoi(range.c_str() + dash + 1);
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+}  // namespace
+
+std::vector<int> GetNumaNodeCpus(int numa_node) {
+  std::ifstream fin("/sys/devices/system/node/node" +
+                    std::to_string(numa_node) + "/cpulist");
+  std::string cpu_list;
+  if (!fin || !std::getline(fin, cpu_list)) {
+    return {};
+  }
+  return ParseCpuList(cpu_list);
+}
+
+int GetCpuNumaNode(int cpu) {
+  for (int numa_node = 0;; ++numa_node) {
+    std::ifstream fin("/sys/devices/system/node/node" +
+                      std::to_string(numa_node) + "/cpulist");
+    std::string cpu_list;
+    if (!fin || !std::getline(fin, cpu_list)) {
+      return 0;
+    }
+    for (int node_cpu : ParseCpuList(cpu_list)) {
+      if (node_cpu == cpu) {
+        return numa_node;
+      }
+    }
+  }
+}
+
+bool SetCurrentThreadAffinity(int cpu) {
+#if defined(__linux__)
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  CPU_SET(cpu, &mask);
+  return pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0;
+#else
+  return false;
+#endif
+}
+
 }  // namespace framework
 }  // namespace paddle
@@ -21,6 +21,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "paddle/fluid/framework/new_executor/workqueue/events_waiter.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -69,6 +70,16 @@ void* AlignedMalloc(size_t size, size_t alignment);
 
 void AlignedFree(void* memory_ptr);
 
+// Returns the cpus of the NUMA node, or an empty vector if it is unknown.
+std::vector<int> GetNumaNodeCpus(int numa_node);
+
+// Returns the NUMA node of the cpu, or 0 if it is unknown.
+int GetCpuNumaNode(int cpu);
+
+// Pins the calling thread to the cpu, returns false if it is not supported or
+// failed.
+bool SetCurrentThreadAffinity(int cpu);
+
 template <typename Notifier>
 class TaskTracker {
  public:
@@ -467,6 +467,21 @@ void TensorToStream(std::ostream& os,
     auto* pb_dims = desc.mutable_dims();
     pb_dims->Resize(static_cast<int>(dims.size()), 0);
     std::copy(dims.begin(), dims.end(), pb_dims->begin());
+    // Align the data to 64 bytes from the start of the stream, so that it can
+    // be used in place when the file is mapped, see DeserializeFromBuffer.
+    constexpr int64_t kDataAlignment = 64;
+    // The padding field takes a tag byte and a length byte.
+    constexpr int64_t kPaddingFieldSize = 2;
+    int64_t pos = os.tellp();
+    if (pos >= 0) {
+      int64_t data_pos = pos + sizeof(int32_t) + desc.ByteSize();
+      int64_t padding = (kDataAlignment - data_pos % kDataAlignment) %
+                        kDataAlignment;
+      if (padding > 0) {
+        if (padding < kPaddingFieldSize) padding += kDataAlignment;
+        desc.set_padding(std::string(padding - kPaddingFieldSize, '\0'));
+      }
+    }
     int32_t size = desc.ByteSize();
     os.write(reinterpret_cast<const char*>(&size), sizeof(size));
     auto out = desc.SerializeAsString();
@@ -18,10 +18,14 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <functional>
 #include <memory>
 #include <set>
+#include <sstream>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -34,6 +38,7 @@
 #include "paddle/fluid/framework/op_proto_maker.h"
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/framework/transfer_scope_cache.h"
 #include "paddle/fluid/framework/var_type_traits.h"
 #include "paddle/fluid/framework/version.h"
@@ -170,6 +175,21 @@ bool IsPersistable(const framework::VarDesc *var) {
   return false;
 }
 
+bool IsSameWeight(const phi::DenseTensor &x, const phi::DenseTensor &y) {
+  if (x.dims() != y.dims() || x.dtype() != y.dtype() ||
+      x.place() != y.place() || x.lod() != y.lod()) {
+    return false;
+  }
+  size_t size = x.numel() * phi::SizeOf(x.dtype());
+  if (platform::is_cpu_place(x.place())) {
+    return std::memcmp(x.data(), y.data(), size) == 0;
+  }
+  phi::DenseTensor cpu_x, cpu_y;
+  framework::TensorCopySync(x, platform::CPUPlace(), &cpu_x);
+  framework::TensorCopySync(y, platform::CPUPlace(), &cpu_y);
+  return std::memcmp(cpu_x.data(), cpu_y.data(), size) == 0;
+}
+
 phi::DataType ConvertPrecision(AnalysisConfig::Precision precision) {
   switch (precision) {
     case AnalysisConfig::Precision::kFloat32:
@@ -358,6 +378,10 @@ bool AnalysisPredictor::Init(
     return false;
   }
 
+  if (config_.weight_sharing_enabled() && !status_is_cloned_) {
+    ShareWeights();
+  }
+
   // Get the feed_target_names and fetch_target_names
   PrepareFeedFetch();
 
@@ -2456,6 +2480,81 @@ bool AnalysisPredictor::LoadParameters() {
   return true;
 }
 
+void AnalysisPredictor::ShareWeights() {
+  // The weights written by the ops, e.g., the moving statistics, are private.
+  std::unordered_set<std::string> written_vars;
+  for (size_t i = 0; i < inference_program_->Size(); ++i) {
+    for (auto *op : inference_program_->Block(i).AllOps()) {
+      for (auto &name : op->OutputArgumentNames()) {
+        written_vars.insert(name);
+      }
+    }
+  }
+
+  std::ostringstream prefix;
+  prefix << std::hash<std::string>()(config_.model_dir() +
+                                     config_.prog_file() +
+                                     config_.params_file())
+         << "/" << place_ << "/";
+  auto &resource_manager = ResourceManager::Instance();
+  uint64_t shared_size = 0;
+  for (auto *var_desc : inference_program_->Block(0).AllVars()) {
+    if (!IsPersistable(var_desc) || written_vars.count(var_desc->Name())) {
+      continue;
+    }
+    auto *var = scope_->FindLocalVar(var_desc->Name());
+    if (var == nullptr || !var->IsType<phi::DenseTensor>()) {
+      continue;
+    }
+    auto *tensor = var->GetMutable<phi::DenseTensor>();
+    if (!tensor->initialized()) {
+      continue;
+    }
+    auto weight = resource_manager.FindOrRegisterWeight(
+        prefix.str() + var_desc->Name(), *tensor);
+    // The weight of the same name may differ, e.g., when calibrated
+    // differently, so the contents are compared before sharing.
+    if (weight.IsSharedWith(*tensor) || !IsSameWeight(weight, *tensor)) {
+      continue;
+    }
+    VLOG(4) << "Share weight " << var_desc->Name() << " of predictor "
+            << predictor_id_;
+    shared_size += tensor->Holder()->size();
+    tensor->ShareDataWith(weight);
+  }
+  VLOG(3) << "Predictor " << predictor_id_ << " shares " << shared_size
+          << " bytes of weights with the other predictors";
+}
+
+uint64_t AnalysisPredictor::GetWeightMemorySize(uint64_t *shared_size) {
+  // The clones share the whole scope.
+  bool scope_shared = scope_.use_count() > 1;
+  std::unordered_set<phi::Allocation *> holders;
+  uint64_t size = 0;
+  uint64_t shared = 0;
+  for (auto *var_desc : inference_program_->Block(0).AllVars()) {
+    if (!IsPersistable(var_desc)) {
+      continue;
+    }
+    auto *var = scope_->FindLocalVar(var_desc->Name());
+    if (var == nullptr || !var->IsType<phi::DenseTensor>()) {
+      continue;
+    }
+    auto &holder = var->Get<phi::DenseTensor>().Holder();
+    if (holder == nullptr || !holders.insert(holder.get()).second) {
+      continue;
+    }
+    size += holder->size();
+    if (scope_shared || holder.use_count() > 1) {
+      shared += holder->size();
+    }
+  }
+  if (shared_size != nullptr) {
+    *shared_size = shared;
+  }
+  return size;
+}
+
 uint64_t AnalysisPredictor::TryShrinkMemory() {
   ClearIntermediateTensor();
   return paddle::memory::Release(place_);
@@ -2961,6 +3060,18 @@ void Predictor::ClearIntermediateTensor() {
 
 uint64_t Predictor::TryShrinkMemory() { return predictor_->TryShrinkMemory(); }
 
+uint64_t Predictor::GetWeightMemorySize(uint64_t *shared_size) {
+  auto *pred = dynamic_cast<paddle::AnalysisPredictor *>(predictor_.get());
+  if (pred == nullptr) {
+    // the weights of the other backends, like ONNXRuntime, are not counted
+    if (shared_size != nullptr) {
+      *shared_size = 0;
+    }
+    return 0;
+  }
+  return pred->GetWeightMemorySize(shared_size);
+}
+
 void Predictor::RegisterOutputHook(const OutputTensorHookFunc &hookfunc) {
   predictor_->RegisterOutputHook(hookfunc);
 }
@@ -279,6 +279,16 @@ class AnalysisPredictor : public PaddlePredictor {
   ///
   uint64_t TryShrinkMemory() override;
 
+  ///
+  /// \brief Get the memory held by the weights, i.e., the persistable
+  /// tensors of the predictor.
+  ///
+  /// \param[out] shared_size The bytes among them shared with the other
+  /// predictors, by Clone or AnalysisConfig::EnableWeightSharing.
+  /// \return The bytes of the weights.
+  ///
+  uint64_t GetWeightMemorySize(uint64_t *shared_size = nullptr);
+
   ///
   /// \brief Get the argument used by predictor
   ///
@@ -383,6 +393,12 @@ class AnalysisPredictor : public PaddlePredictor {
   /// \return Whether the function executed successfully
   ///
   bool LoadParameters();
+  ///
+  /// \brief Replace the weights identical to the ones of the other alive
+  /// predictors of the same model with theirs, see
+  /// AnalysisConfig::EnableWeightSharing.
+  ///
+  void ShareWeights();
 
   ///
   /// \brief Prepare input data, only used in Run()
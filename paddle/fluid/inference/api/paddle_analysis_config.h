@@ -1043,6 +1043,24 @@ struct PD_INFER_DECL AnalysisConfig {
   ///
   bool enable_memory_optim() const;
 
+  ///
+  /// \brief Turn on sharing the weights with the other predictors of the same
+  /// model in this process, e.g., the ones of a PredictorPool. The optimized
+  /// weights identical to the ones of an alive predictor are released, and
+  /// that predictor's are used instead, so N predictors keep a single copy.
+  /// The weights written by the ops stay private. The cloned predictors
+  /// always share the weights of the predictor they are cloned from.
+  ///
+  /// \param x Whether to enable the weight sharing.
+  ///
+  void EnableWeightSharing(bool x = true);
+  ///
+  /// \brief A boolean state telling whether the weight sharing is enabled.
+  ///
+  /// \return bool Whether the weight sharing is enabled.
+  ///
+  bool weight_sharing_enabled() const;
+
   ///
   /// \brief Turn on profiling report.
   /// If not turned on, no profiling report will be generated.
@@ -1230,6 +1248,7 @@ struct PD_INFER_DECL AnalysisConfig {
 
   // memory reuse related.
   bool enable_memory_optim_{false};
+  bool enable_weight_sharing_{false};
   bool trt_engine_memory_sharing_{false};
   int trt_engine_memory_sharing_identifier_{0};
 
@@ -190,6 +190,16 @@ class PD_INFER_DECL Predictor {
   ///
   uint64_t TryShrinkMemory();
 
+  ///
+  /// \brief Get the memory held by the weights of the predictor.
+  ///
+  /// \param[out] shared_size The bytes among them shared with the other
+  /// predictors, by Clone or Config::EnableWeightSharing.
+  /// \return The bytes of the weights, 0 for the predictors not run by
+  /// Paddle, like ONNXRuntime.
+  ///
+  uint64_t GetWeightMemorySize(uint64_t* shared_size = nullptr);
+
   ///
   /// \brief Register a output hook function to operate the intermediate tensor
   /// of op output. when using this function, memory reuse should be tured off.
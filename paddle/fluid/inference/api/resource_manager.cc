@@ -14,6 +14,7 @@
 
 #include "paddle/fluid/inference/api/resource_manager.h"
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -375,6 +376,40 @@ CPUContextResource* ResourceManager::GetCPUResource() const {
   return cpu_resource_.get();
 }
 
+phi::DenseTensor ResourceManager::FindOrRegisterWeight(
+    const std::string& key, const phi::DenseTensor& weight) {
+  std::lock_guard<std::mutex> lock_gurad(weight_mutex_);
+  auto it = weights_.find(key);
+  if (it != weights_.end()) {
+    auto holder = it->second.first.lock();
+    if (holder) {
+      return phi::DenseTensor(holder, it->second.second);
+    }
+  }
+  weights_[key] = std::make_pair(
+      std::weak_ptr<phi::Allocation>(weight.Holder()), weight.meta());
+  if (weights_.size() >= weights_sweep_size_) {
+    for (auto iter = weights_.begin(); iter != weights_.end();) {
+      if (iter->second.first.expired()) {
+        iter = weights_.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+    weights_sweep_size_ = std::max<size_t>(1024, weights_.size() * 2);
+  }
+  return weight;
+}
+
+size_t ResourceManager::NumRegisteredWeights() {
+  std::lock_guard<std::mutex> lock_gurad(weight_mutex_);
+  size_t num = 0;
+  for (auto& item : weights_) {
+    num += !item.second.first.expired();
+  }
+  return num;
+}
+
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 void* ResourceManager::InitGPUResource(const phi::Place& place, void* stream) {
   std::lock_guard<std::mutex> lock_gurad(gpu_mutex_);
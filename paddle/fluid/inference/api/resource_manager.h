@@ -18,11 +18,15 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
 
 #include "paddle/fluid/platform/macros.h"
 #include "paddle/phi/api/include/tensor.h"
 #include "paddle/phi/backends/cpu/forwards.h"
 #include "paddle/phi/common/place.h"
+#include "paddle/phi/core/dense_tensor.h"
 #include "unsupported/Eigen/CXX11/Tensor"
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
@@ -141,6 +145,24 @@ class ResourceManager {
   std::mutex cpu_mutex_;
   std::unique_ptr<CPUContextResource> cpu_resource_{nullptr};
 
+  // Weight Resource
+ public:
+  // Returns the weight registered with key if it is still alive, otherwise
+  // registers weight with key and returns it. Only the weak references of the
+  // holders are kept, so a weight is released with its last user.
+  phi::DenseTensor FindOrRegisterWeight(const std::string& key,
+                                        const phi::DenseTensor& weight);
+  size_t NumRegisteredWeights();
+
+ private:
+  std::mutex weight_mutex_;
+  std::unordered_map<std::string,
+                     std::pair<std::weak_ptr<phi::Allocation>,
+                               phi::DenseTensorMeta>>
+      weights_;
+  // The expired weights are removed when the registry grows to this size.
+  size_t weights_sweep_size_{1024};
+
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   // GPU Resource
  public:
@@ -33,6 +33,7 @@ H_FILE_TEMPLATE = """#ifdef GET_OP_LIST
 #include <vector>
 
 #include "paddle/ir/core/builder.h"
+#include "paddle/ir/core/builtin_op.h"
 #include "paddle/ir/core/operation_utils.h"
 #include "paddle/ir/core/op_base.h"
 #include "paddle/fluid/ir/dialect/utils.h"
@@ -70,6 +71,114 @@ op_n_attribute_declare_str = (
     "static const char *attributes_name[{attribute_num}];"
 )
 
+# =====================================
+# Ops with side effects
+# =====================================
+# The ops which must not be erased or merged by the optimization passes, even
+# if their results are unused or they are identical to another op: the ops
+# exchanging data with the outside of the program, the collective ops and the
+# random ops.
+SIDE_EFFECT_OPS = {"feed", "fetch", "print", "barrier"}
+SIDE_EFFECT_OP_PREFIXES = (
+    "c_",
+    "send_v2",
+    "recv_v2",
+    "partial_send",
+    "partial_recv",
+)
+# The ops drawing random numbers. The list is explicit, since the names of
+# the random ops don't follow a pattern, see collect_random_ops.
+RANDOM_OPS = {
+    "bernoulli",
+    "class_center_sample",
+    "dirichlet",
+    "dropout",
+    "flash_attn",
+    "flash_attn_unpadded",
+    "gaussian",
+    "gumbel_softmax",
+    "memory_efficient_attention",
+    "multinomial",
+    "poisson",
+    "randint",
+    "randperm",
+    "rnn",
+    "rrelu",
+    "truncated_gaussian_random",
+    "uniform",
+    "uniform_inplace",
+    "weighted_sample_neighbors",
+}
+# The ops which look random, see looks_random, but are deterministic.
+DETERMINISTIC_OPS = set()
+RANDOM_OP_KEYWORDS = (
+    "random",
+    "dropout",
+    "uniform",
+    "gaussian",
+    "bernoulli",
+    "multinomial",
+    "randint",
+    "randperm",
+    "poisson",
+)
+RANDOM_OP_ATTRIBUTES = ("seed", "fix_seed", "rng_name")
+
+
+def has_side_effect(op_name, random_ops):
+    # The inplace ops write their inputs.
+    if op_name[-1] == "_":
+        return True
+    if op_name in SIDE_EFFECT_OPS:
+        return True
+    if op_name.startswith(SIDE_EFFECT_OP_PREFIXES):
+        return True
+    return op_name in random_ops
+
+
+def looks_random(op_item):
+    if any(keyword in op_item['name'] for keyword in RANDOM_OP_KEYWORDS):
+        return True
+    for attr in op_item.get('attrs', []):
+        if attr['name'] in RANDOM_OP_ATTRIBUTES or 'dropout' in attr['name']:
+            return True
+    return False
+
+
+def collect_random_ops(op_yaml_items):
+    """Returns RANDOM_OPS and the ops of the yaml files which look random but
+    are in neither RANDOM_OPS nor DETERMINISTIC_OPS. The latter are taken as
+    random with a warning, so that a renamed random op or a new op with a
+    random name or a seed attribute isn't silently merged or erased by the
+    optimization passes, and the build doesn't break either."""
+    forward_ops = {
+        op['name']: op
+        for op in op_yaml_items
+        if not op['name'].endswith("_grad")
+    }
+    unknown_ops = sorted(RANDOM_OPS - set(forward_ops.keys()))
+    if len(unknown_ops) > 0:
+        print(
+            f"Warning: RANDOM_OPS {unknown_ops} are not defined in the op "
+            "yaml files."
+        )
+    random_ops = set(RANDOM_OPS)
+    for name, op in forward_ops.items():
+        if name in RANDOM_OPS or name in DETERMINISTIC_OPS:
+            continue
+        # The inplace only ops get the trait from their names.
+        if name[-1] == "_":
+            continue
+        if looks_random(op):
+            print(
+                f"Warning: Op {name} looks random and gets the side effect "
+                "trait, add it to RANDOM_OPS or DETERMINISTIC_OPS in "
+                "op_gen.py."
+            )
+            random_ops.add(name)
+    return random_ops
+
+
 OP_GET_INPUT_TEMPLATE = """  ir::OpOperand {input_name}() {{ return operation()->GetOperandByIndex({input_index}); }}
 """
 OP_GET_OUTPUT_TEMPLATE = """  ir::OpResult {output_name}() {{ return operation()->GetResultByIndex({output_index}); }}
@@ -1206,6 +1315,7 @@ def OpGenerator(
         with open(yaml_file, "r") as f:
             ops = yaml.safe_load(f)
             op_yaml_items = op_yaml_items + ops
+    random_ops = collect_random_ops(op_yaml_items)
     op_info_items = []
     for op in op_yaml_items:
         op_info_items.append(
@@ -1278,8 +1388,11 @@ def OpGenerator(
             if len(op_interfaces) > 0:
                 op_interfaces_str = "," + ",".join(op_interfaces)
             op_traits_str = ""
-            if len(op_traits) > 0:
-                op_traits_str = "," + ",".join(op_traits)
+            cur_op_traits = list(op_traits)
+            if has_side_effect(op_name, random_ops):
+                cur_op_traits.append("ir::SideEffectTrait")
+            if len(cur_op_traits) > 0:
+                op_traits_str = "," + ",".join(cur_op_traits)
 
             # =================================== #
             #  gen get input/output methods str   #
@@ -22,6 +22,7 @@
 #include "paddle/fluid/ir/dialect/pd_type.h"
 #include "paddle/fluid/ir/dialect/pd_type_storage.h"
 #include "paddle/fluid/ir/dialect/utils.h"
+#include "paddle/ir/core/bytecode.h"
 #include "paddle/ir/core/dialect_interface.h"
 #include "paddle/ir/core/utils.h"
 #include "paddle/phi/common/data_type.h"
@@ -29,6 +30,21 @@
 
 namespace paddle {
 namespace dialect {
+namespace {
+// The kinds of the types and attributes of this dialect in the bytecode, the
+// values are persisted and must not be changed.
+enum class PaddleTypeKind : uint8_t {
+  kDenseTensor = 0,
+};
+
+enum class PaddleAttributeKind : uint8_t {
+  kIntArray = 0,
+  kDataType = 1,
+  kPlace = 2,
+  kDataLayout = 3,
+};
+}  // namespace
+
 std::shared_ptr<paddle::framework::Variable>
 ParameterConvertInterface::ParameterToVariable(ir::Parameter *parameter) {
   if (parameter->type().isa<DenseTensorType>()) {
@@ -143,5 +159,114 @@ void PaddleDialect::PrintAttribute(ir::Attribute attr, std::ostream &os) const {
   }
 }
 
+void PaddleDialect::WriteType(ir::Type type,
+                              ir::BytecodeWriter &writer) const {
+  auto tensor_type = type.dyn_cast<DenseTensorType>();
+  PADDLE_ENFORCE_EQ(static_cast<bool>(tensor_type),
+                    true,
+                    phi::errors::Unimplemented(
+                        "Only DenseTensorType can be written into bytecode."));
+  writer.WriteByte(static_cast<uint8_t>(PaddleTypeKind::kDenseTensor));
+  writer.WriteType(tensor_type.dtype());
+  std::vector<int64_t> dims = phi::vectorize(tensor_type.dims());
+  writer.WriteVarInt(dims.size());
+  for (int64_t dim : dims) {
+    writer.WriteSignedVarInt(dim);
+  }
+  writer.WriteVarInt(static_cast<uint64_t>(tensor_type.data_layout()));
+  const phi::LoD &lod = tensor_type.lod();
+  writer.WriteVarInt(lod.size());
+  for (auto &level : lod) {
+    writer.WriteVarInt(level.size());
+    for (size_t offset : level) {
+      writer.WriteVarInt(offset);
+    }
+  }
+  writer.WriteVarInt(tensor_type.offset());
+}
+
+ir::Type PaddleDialect::ReadType(ir::BytecodeReader &reader) const {
+  auto kind = static_cast<PaddleTypeKind>(reader.ReadByte());
+  PADDLE_ENFORCE_EQ(kind == PaddleTypeKind::kDenseTensor,
+                    true,
+                    phi::errors::InvalidArgument(
+                        "Unknown type kind of pd dialect in bytecode."));
+  ir::Type dtype = reader.ReadType();
+  std::vector<int64_t> dims(reader.ReadVarInt());
+  for (auto &dim : dims) {
+    dim = reader.ReadSignedVarInt();
+  }
+  auto layout = static_cast<phi::DataLayout>(reader.ReadVarInt());
+  phi::LoD lod(reader.ReadVarInt());
+  for (auto &level : lod) {
+    level.resize(reader.ReadVarInt());
+    for (auto &offset : level) {
+      offset = reader.ReadVarInt();
+    }
+  }
+  size_t offset = reader.ReadVarInt();
+  return DenseTensorType::get(
+      ir_context(), dtype, phi::make_ddim(dims), layout, lod, offset);
+}
+
+void PaddleDialect::WriteAttribute(ir::Attribute attr,
+                                   ir::BytecodeWriter &writer) const {
+  if (auto int_array_attr = attr.dyn_cast<IntArrayAttribute>()) {
+    writer.WriteByte(static_cast<uint8_t>(PaddleAttributeKind::kIntArray));
+    phi::IntArray data = int_array_attr.data();
+    writer.WriteByte(data.FromTensor());
+    writer.WriteVarInt(data.GetData().size());
+    for (int64_t value : data.GetData()) {
+      writer.WriteSignedVarInt(value);
+    }
+  } else if (auto data_type_attr = attr.dyn_cast<DataTypeAttribute>()) {
+    writer.WriteByte(static_cast<uint8_t>(PaddleAttributeKind::kDataType));
+    writer.WriteVarInt(static_cast<uint64_t>(data_type_attr.data()));
+  } else if (auto place_attr = attr.dyn_cast<PlaceAttribute>()) {
+    writer.WriteByte(static_cast<uint8_t>(PaddleAttributeKind::kPlace));
+    phi::Place place = place_attr.data();
+    writer.WriteVarInt(static_cast<uint64_t>(place.GetType()));
+    writer.WriteSignedVarInt(place.GetDeviceId());
+    writer.WriteString(place.GetDeviceType());
+  } else if (auto data_layout_attr = attr.dyn_cast<DataLayoutAttribute>()) {
+    writer.WriteByte(static_cast<uint8_t>(PaddleAttributeKind::kDataLayout));
+    writer.WriteVarInt(static_cast<uint64_t>(data_layout_attr.data()));
+  } else {
+    PADDLE_THROW(phi::errors::Unimplemented(
+        "The attribute can't be written into bytecode by pd dialect."));
+  }
+}
+
+ir::Attribute PaddleDialect::ReadAttribute(ir::BytecodeReader &reader) const {
+  ir::IrContext *ctx = ir_context();
+  switch (static_cast<PaddleAttributeKind>(reader.ReadByte())) {
+    case PaddleAttributeKind::kIntArray: {
+      bool from_tensor = reader.ReadByte() != 0;
+      std::vector<int64_t> data(reader.ReadVarInt());
+      for (auto &value : data) {
+        value = reader.ReadSignedVarInt();
+      }
+      phi::IntArray int_array(data);
+      int_array.SetFromTensor(from_tensor);
+      return IntArrayAttribute::get(ctx, int_array);
+    }
+    case PaddleAttributeKind::kDataType:
+      return DataTypeAttribute::get(
+          ctx, static_cast<phi::DataType>(reader.ReadVarInt()));
+    case PaddleAttributeKind::kPlace: {
+      auto type = static_cast<phi::AllocationType>(reader.ReadVarInt());
+      auto device_id = static_cast<int8_t>(reader.ReadSignedVarInt());
+      std::string device_type = reader.ReadString();
+      return PlaceAttribute::get(ctx,
+                                 phi::Place(type, device_id, device_type));
+    }
+    case PaddleAttributeKind::kDataLayout:
+      return DataLayoutAttribute::get(
+          ctx, static_cast<phi::DataLayout>(reader.ReadVarInt()));
+  }
+  PADDLE_THROW(phi::errors::InvalidArgument(
+      "Unknown attribute kind of pd dialect in bytecode."));
+}
+
 }  // namespace dialect
 }  // namespace paddle
@@ -42,6 +42,12 @@ class PaddleDialect : public ir::Dialect {
   void PrintType(ir::Type type, std::ostream& os) const;
   void PrintAttribute(ir::Attribute type, std::ostream& os) const;
 
+  void WriteType(ir::Type type, ir::BytecodeWriter& writer) const;
+  ir::Type ReadType(ir::BytecodeReader& reader) const;
+
+  void WriteAttribute(ir::Attribute attr, ir::BytecodeWriter& writer) const;
+  ir::Attribute ReadAttribute(ir::BytecodeReader& reader) const;
+
  private:
   void initialize();
 };
@@ -0,0 +1,513 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/ir/transforms/constant_folding_pass.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/ir/dialect/pd_attribute.h"
+#include "paddle/fluid/ir/dialect/pd_type.h"
+#include "paddle/fluid/ir/dialect/utils.h"
+#include "paddle/fluid/ir/interface/infershape.h"
+#include "paddle/fluid/ir/interface/op_yaml_info.h"
+#include "paddle/ir/core/builder.h"
+#include "paddle/ir/core/builtin_attribute.h"
+#include "paddle/ir/core/builtin_op.h"
+#include "paddle/ir/core/operation.h"
+#include "paddle/ir/core/parameter.h"
+#include "paddle/ir/core/program.h"
+#include "paddle/ir/core/region.h"
+#include "paddle/ir/pass/pass.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/common/data_type.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/infermeta_utils.h"
+#include "paddle/phi/core/kernel_context.h"
+#include "paddle/phi/core/kernel_factory.h"
+#include "paddle/phi/core/meta_tensor.h"
+
+namespace ir {
+
+namespace {
+
+using paddle::dialect::DenseTensorType;
+
+bool IsFoldableType(Type type) {
+  if (!type || !type.isa<DenseTensorType>()) return false;
+  Type dtype = type.dyn_cast<DenseTensorType>().dtype();
+  return dtype.isa<Float16Type>() || dtype.isa<Float32Type>() ||
+         dtype.isa<Float64Type>() || dtype.isa<Int16Type>() ||
+         dtype.isa<Int32Type>() || dtype.isa<Int64Type>();
+}
+
+template <typename T, typename AttributeT>
+std::vector<T> TransToVector(Attribute attr) {
+  std::vector<T> result;
+  for (auto element : attr.dyn_cast<ArrayAttribute>().data()) {
+    result.push_back(element.dyn_cast<AttributeT>().data());
+  }
+  return result;
+}
+
+// Convert the attribute of a pd op to the attribute of phi kernels by the
+// type name recorded in OpYamlInfoInterface, return false if the type isn't
+// supported.
+bool TransToPhiAttribute(Attribute attr,
+                         const std::string &type_name,
+                         phi::Attribute *result) {
+  if (!attr) return false;
+  if (type_name == "paddle::dialect::IntArrayAttribute") {
+    *result = attr.dyn_cast<paddle::dialect::IntArrayAttribute>().data();
+  } else if (type_name == "paddle::dialect::ScalarAttribute") {
+    *result = attr.dyn_cast<paddle::dialect::ScalarAttribute>().data();
+  } else if (type_name == "paddle::dialect::DataTypeAttribute") {
+    *result = attr.dyn_cast<paddle::dialect::DataTypeAttribute>().data();
+  } else if (type_name == "paddle::dialect::PlaceAttribute") {
+    *result = attr.dyn_cast<paddle::dialect::PlaceAttribute>().data();
+  } else if (type_name == "paddle::dialect::DataLayoutAttribute") {
+    *result = attr.dyn_cast<paddle::dialect::DataLayoutAttribute>().data();
+  } else if (type_name == "ir::Int32_tAttribute") {
+    *result = attr.dyn_cast<Int32_tAttribute>().data();
+  } else if (type_name == "ir::Int64_tAttribute") {
+    *result = attr.dyn_cast<Int64_tAttribute>().data();
+  } else if (type_name == "ir::FloatAttribute") {
+    *result = attr.dyn_cast<FloatAttribute>().data();
+  } else if (type_name == "ir::DoubleAttribute") {
+    *result = attr.dyn_cast<DoubleAttribute>().data();
+  } else if (type_name == "ir::BoolAttribute") {
+    *result = attr.dyn_cast<BoolAttribute>().data();
+  } else if (type_name == "ir::StrAttribute") {
+    *result = attr.dyn_cast<StrAttribute>().data();
+  } else if (type_name == "ir::ArrayAttribute<ir::Int32_tAttribute>") {
+    *result = TransToVector<int, Int32_tAttribute>(attr);
+  } else if (type_name == "ir::ArrayAttribute<ir::Int64_tAttribute>") {
+    *result = TransToVector<int64_t, Int64_tAttribute>(attr);
+  } else if (type_name == "ir::ArrayAttribute<ir::FloatAttribute>") {
+    *result = TransToVector<float, FloatAttribute>(attr);
+  } else if (type_name == "ir::ArrayAttribute<ir::BoolAttribute>") {
+    *result = TransToVector<bool, BoolAttribute>(attr);
+  } else if (type_name == "ir::ArrayAttribute<ir::StrAttribute>") {
+    *result = TransToVector<std::string, StrAttribute>(attr);
+  } else if (type_name ==
+             "ir::ArrayAttribute<paddle::dialect::ScalarAttribute>") {
+    std::vector<phi::Scalar> scalars;
+    for (auto element : attr.dyn_cast<ArrayAttribute>().data()) {
+      scalars.push_back(
+          element.dyn_cast<paddle::dialect::ScalarAttribute>().data());
+    }
+    *result = scalars;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// The information needed to run the phi kernel of a pd op.
+struct KernelInfo {
+  std::vector<paddle::dialect::OpInputInfo> inputs;
+  std::map<std::string, size_t> input_index;
+  std::map<std::string, std::string> attribute_types;
+  std::vector<std::string> infer_meta_params;
+  std::vector<std::string> kernel_params;
+  phi::Kernel kernel;
+};
+
+class ConstantFoldingPass : public Pass {
+ public:
+  explicit ConstantFoldingPass(paddle::framework::Scope *scope)
+      : Pass("ConstantFoldingPass", 2), scope_(scope) {}
+
+  void Run(Operation *op) override {
+    Program *program = op->GetParentProgram();
+    if (program == nullptr) return MarkAllAnalysesPreserved();
+    CollectWrittenParameters(program->module_op());
+
+    size_t num_folded = 0;
+    for (size_t i = 0; i < op->num_regions(); ++i) {
+      for (Block *block : op->GetRegion(i)) {
+        num_folded += FoldBlock(program, block);
+      }
+    }
+    VLOG(6) << "ConstantFoldingPass folded " << num_folded << " operations.";
+    if (num_folded == 0) MarkAllAnalysesPreserved();
+  }
+
+ private:
+  // The parameters written by set_parameter, or by the users of their
+  // get_parameter results, can't be folded.
+  void CollectWrittenParameters(Operation *op) {
+    written_parameters_.clear();
+    std::vector<Operation *> worklist = {op};
+    while (!worklist.empty()) {
+      Operation *cur_op = worklist.back();
+      worklist.pop_back();
+      if (cur_op->name() == SetParameterOp::name() ||
+          (cur_op->name() == GetParameterOp::name() &&
+           MayBeWritten(cur_op->GetResultByIndex(0)))) {
+        written_parameters_.insert(ParameterName(cur_op));
+      }
+      for (size_t i = 0; i < cur_op->num_regions(); ++i) {
+        for (Block *block : cur_op->GetRegion(i)) {
+          worklist.insert(worklist.end(), block->begin(), block->end());
+        }
+      }
+    }
+  }
+
+  // The inplace ops, whose names end with '_', write their inputs, and the
+  // ops with side effects may do so.
+  static bool MayBeWritten(Value value) {
+    for (auto it = value.begin(); it != value.end(); ++it) {
+      Operation *user = it.owner();
+      if (user->name().back() == '_' || user->HasTrait<SideEffectTrait>()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static std::string ParameterName(Operation *op) {
+    return op->attributes()
+        .at("parameter_name")
+        .dyn_cast<StrAttribute>()
+        .data();
+  }
+
+  // Returns the tensor of the parameter read by the get_parameter op, or
+  // nullptr if the parameter isn't available on CPU.
+  const phi::DenseTensor *FindScopeTensor(const std::string &name) const {
+    if (scope_ == nullptr) return nullptr;
+    paddle::framework::Variable *var = scope_->FindVar(name);
+    if (var == nullptr || !var->IsType<phi::DenseTensor>()) return nullptr;
+    const phi::DenseTensor &tensor = var->Get<phi::DenseTensor>();
+    if (!tensor.initialized() ||
+        tensor.place().GetType() != phi::AllocationType::CPU) {
+      return nullptr;
+    }
+    return &tensor;
+  }
+
+  bool IsConstantParameter(Program *program, Operation *op) const {
+    std::string name = ParameterName(op);
+    if (written_parameters_.count(name)) return false;
+    if (!IsFoldableType(op->GetResultByIndex(0).type())) return false;
+    if (Parameter *parameter = program->GetParameter(name)) {
+      return !parameter->is_mutable() && IsFoldableType(parameter->type());
+    }
+    return FindScopeTensor(name) != nullptr;
+  }
+
+  // Returns true if op can be run with phi CPU kernels at compile time, and
+  // fills the information of the kernel.
+  bool GetKernelInfo(Operation *op,
+                     const std::unordered_set<Value> &constants,
+                     KernelInfo *info) const {
+    if (op->num_results() == 0 || op->num_regions() > 0 ||
+        op->HasTrait<SideEffectTrait>() ||
+        !op->HasInterface<paddle::dialect::OpYamlInfoInterface>() ||
+        !op->HasInterface<InferShapeInterface>()) {
+      return false;
+    }
+    for (uint32_t i = 0; i < op->num_operands(); ++i) {
+      Value operand = op->GetOperandByIndex(i).source();
+      if (!operand || !constants.count(operand)) return false;
+    }
+    for (uint32_t i = 0; i < op->num_results(); ++i) {
+      if (!IsFoldableType(op->GetResultByIndex(i).type())) return false;
+    }
+
+    auto op_info = op->dyn_cast<paddle::dialect::OpYamlInfoInterface>()
+                       .GetOpInfo();
+    info->inputs = std::get<0>(op_info);
+    if (info->inputs.size() != op->num_operands()) return false;
+    for (size_t i = 0; i < info->inputs.size(); ++i) {
+      info->input_index[info->inputs[i].name] = i;
+    }
+    for (auto &attribute : std::get<1>(op_info)) {
+      phi::Attribute phi_attribute;
+      auto it = op->attributes().find(attribute.name);
+      if (it == op->attributes().end() ||
+          !TransToPhiAttribute(it->second, attribute.type_name,
+                               &phi_attribute)) {
+        return false;
+      }
+      info->attribute_types[attribute.name] = attribute.type_name;
+    }
+    auto &runtime_info = std::get<3>(op_info);
+    if (runtime_info.kernel_func.empty()) return false;
+    info->infer_meta_params = runtime_info.infer_meta_param;
+    info->kernel_params = runtime_info.kernel_param;
+
+    // The kernel is selected by the dtype of the first tensor input, or the
+    // first output if there is no tensor input.
+    Type dtype_source = op->GetResultByIndex(0).type();
+    for (size_t i = 0; i < info->inputs.size(); ++i) {
+      if (!info->inputs[i].is_mutable_attribute) {
+        dtype_source = op->GetOperandByIndex(i).source().type();
+        break;
+      }
+    }
+    phi::KernelKey kernel_key(
+        phi::Backend::CPU,
+        phi::DataLayout::ALL_LAYOUT,
+        paddle::dialect::TransToPhiDataType(
+            dtype_source.dyn_cast<DenseTensorType>().dtype()));
+    const std::string &kernel_name = runtime_info.kernel_func[0];
+    if (!phi::KernelFactory::Instance().HasKernel(kernel_name, kernel_key)) {
+      return false;
+    }
+    info->kernel =
+        phi::KernelFactory::Instance().SelectKernel(kernel_name, kernel_key);
+    return info->kernel.IsValid();
+  }
+
+  template <typename Context>
+  void BuildContext(Operation *op,
+                    const KernelInfo &info,
+                    const std::vector<std::string> &params,
+                    std::unordered_map<Value, phi::DenseTensor> *tensors,
+                    Context *ctx) {
+    for (auto &param : params) {
+      auto input_it = info.input_index.find(param);
+      if (input_it != info.input_index.end()) {
+        size_t index = input_it->second;
+        phi::DenseTensor *tensor =
+            &tensors->at(op->GetOperandByIndex(index).source());
+        const std::string &type_name = info.inputs[index].type_name;
+        if (!info.inputs[index].is_mutable_attribute) {
+          ctx->EmplaceBackInput(tensor);
+        } else if (type_name == "paddle::dialect::IntArrayAttribute") {
+          ctx->EmplaceBackAttr(phi::IntArray(*tensor));
+        } else {
+          ctx->EmplaceBackAttr(phi::Scalar(*tensor));
+        }
+        continue;
+      }
+      auto attribute_it = info.attribute_types.find(param);
+      if (attribute_it != info.attribute_types.end()) {
+        phi::Attribute attribute;
+        TransToPhiAttribute(
+            op->attributes().at(param), attribute_it->second, &attribute);
+        ctx->EmplaceBackAttr(attribute);
+      }
+    }
+    for (uint32_t i = 0; i < op->num_results(); ++i) {
+      ctx->EmplaceBackOutput(&(*tensors)[op->GetResultByIndex(i)]);
+    }
+  }
+
+  void LoadParameter(Program *program,
+                     Operation *op,
+                     phi::DeviceContext *dev_ctx,
+                     std::unordered_map<Value, phi::DenseTensor> *tensors) {
+    Value result = op->GetResultByIndex(0);
+    if (tensors->count(result)) return;
+    std::string name = ParameterName(op);
+    Parameter *parameter = program->GetParameter(name);
+    if (parameter == nullptr) {
+      // The tensor in the scope is shared, the kernels never write inputs.
+      (*tensors)[result] = *FindScopeTensor(name);
+      return;
+    }
+    auto type = parameter->type().dyn_cast<DenseTensorType>();
+    phi::DenseTensor &tensor = (*tensors)[result];
+    tensor.set_meta(phi::DenseTensorMeta(
+        paddle::dialect::TransToPhiDataType(type.dtype()),
+        type.dims(),
+        type.data_layout(),
+        type.lod()));
+    dev_ctx->Alloc(&tensor, tensor.dtype());
+    size_t size = tensor.numel() * phi::SizeOf(tensor.dtype());
+    PADDLE_ENFORCE_EQ(
+        parameter->size(),
+        size,
+        phi::errors::InvalidArgument(
+            "The size of parameter %s is %d bytes, which doesn't match its "
+            "type of %d bytes.",
+            name,
+            parameter->size(),
+            size));
+    std::memcpy(tensor.data(), parameter->data(), size);
+  }
+
+  std::string NewParameterName(Program *program) {
+    std::string name;
+    do {
+      name = "constant_folding@" + std::to_string(num_parameters_++);
+    } while (program->parameters().count(name) ||
+             (scope_ && scope_->FindVar(name)));
+    return name;
+  }
+
+  // Materialize the folded value as a new parameter, and replace its uses
+  // with a get_parameter op inserted before the folding root.
+  void Materialize(Program *program,
+                   Operation *root,
+                   Value value,
+                   phi::DenseTensor *tensor) {
+    IrContext *ctx = root->ir_context();
+    std::string name = NewParameterName(program);
+    Type type = DenseTensorType::get(
+        ctx,
+        paddle::dialect::TransToIrDataType(tensor->dtype(), ctx),
+        tensor->dims(),
+        tensor->layout(),
+        tensor->lod(),
+        0);
+    size_t size = tensor->numel() * phi::SizeOf(tensor->dtype());
+    program->SetParameter(
+        name,
+        std::make_unique<Parameter>(
+            size > 0 ? tensor->data() : nullptr, size, type));
+    if (scope_) {
+      *scope_->Var(name)->GetMutable<phi::DenseTensor>() = *tensor;
+    }
+
+    Builder builder(ctx, root->GetParent());
+    builder.SetInsertionPoint(root);
+    Operation *get_parameter =
+        builder.Build({},
+                      {{"parameter_name", StrAttribute::get(ctx, name)}},
+                      {value.type()},
+                      ctx->GetRegisteredOpInfo(GetParameterOp::name()));
+    value.ReplaceAllUsesWith(get_parameter->GetResultByIndex(0));
+  }
+
+  size_t FoldBlock(Program *program, Block *block) {
+    // 1. Find the foldable operations, in topological order.
+    std::unordered_set<Value> constants;
+    std::unordered_set<Operation *> foldable_ops;
+    std::vector<Operation *> foldable_op_list;
+    std::unordered_map<Operation *, KernelInfo> kernel_infos;
+    for (Operation *op : *block) {
+      if (op->name() == GetParameterOp::name()) {
+        if (IsConstantParameter(program, op)) {
+          constants.insert(op->GetResultByIndex(0));
+        }
+        continue;
+      }
+      KernelInfo info;
+      if (!GetKernelInfo(op, constants, &info)) continue;
+      for (uint32_t i = 0; i < op->num_results(); ++i) {
+        constants.insert(op->GetResultByIndex(i));
+      }
+      foldable_ops.insert(op);
+      foldable_op_list.push_back(op);
+      kernel_infos.emplace(op, std::move(info));
+    }
+
+    // 2. Only the operations computing the values used by the rest of the
+    // program are run. The leaf operations without operand, e.g. full, are
+    // kept if they are used by the rest of the program directly.
+    auto is_used_outside = [&](Value value) {
+      for (auto use = value.begin(); use != value.end(); ++use) {
+        if (!foldable_ops.count(use.owner())) return true;
+      }
+      return false;
+    };
+    std::unordered_set<Operation *> needed_ops;
+    std::vector<Operation *> run_ops;
+    for (auto it = foldable_op_list.rbegin(); it != foldable_op_list.rend();
+         ++it) {
+      Operation *op = *it;
+      bool needed = needed_ops.count(op) > 0;
+      for (uint32_t i = 0; !needed && op->num_operands() > 0 &&
+                           i < op->num_results();
+           ++i) {
+        needed = is_used_outside(op->GetResultByIndex(i));
+      }
+      if (!needed) continue;
+      needed_ops.insert(op);
+      run_ops.push_back(op);
+      for (uint32_t i = 0; i < op->num_operands(); ++i) {
+        needed_ops.insert(op->GetOperandByIndex(i).source().GetDefiningOp());
+      }
+    }
+    if (run_ops.empty()) return 0;
+    std::reverse(run_ops.begin(), run_ops.end());
+
+    // 3. Run the operations with phi CPU kernels in batch, the intermediate
+    // tensors are kept in memory only during the folding.
+    auto *dev_ctx = phi::DeviceContextPool::Instance().Get(phi::CPUPlace());
+    std::unordered_map<Value, phi::DenseTensor> tensors;
+    for (Operation *op : run_ops) {
+      for (uint32_t i = 0; i < op->num_operands(); ++i) {
+        Operation *def_op = op->GetOperandByIndex(i).source().GetDefiningOp();
+        if (def_op->name() == GetParameterOp::name()) {
+          LoadParameter(program, def_op, dev_ctx, &tensors);
+        }
+      }
+      const KernelInfo &info = kernel_infos.at(op);
+      VLOG(6) << "ConstantFoldingPass runs " << op->name() << ".";
+
+      phi::InferMetaContext infer_meta_ctx;
+      BuildContext(
+          op, info, info.infer_meta_params, &tensors, &infer_meta_ctx);
+      op->dyn_cast<InferShapeInterface>().InferShape(&infer_meta_ctx);
+
+      phi::KernelContext kernel_ctx(dev_ctx);
+      BuildContext(op, info, info.kernel_params, &tensors, &kernel_ctx);
+      info.kernel(&kernel_ctx);
+    }
+
+    // 4. Materialize the results used by the rest of the program, then erase
+    // the folded operations and the parameters read by them only.
+    for (Operation *op : run_ops) {
+      if (op->num_operands() == 0) continue;
+      for (uint32_t i = 0; i < op->num_results(); ++i) {
+        Value result = op->GetResultByIndex(i);
+        if (is_used_outside(result)) {
+          Materialize(program, op, result, &tensors.at(result));
+        }
+      }
+    }
+    size_t num_folded = 0;
+    for (auto it = run_ops.rbegin(); it != run_ops.rend(); ++it) {
+      Operation *op = *it;
+      if (!op->use_empty()) continue;
+      std::unordered_set<Operation *> def_ops;
+      for (uint32_t i = 0; i < op->num_operands(); ++i) {
+        def_ops.insert(op->GetOperandByIndex(i).source().GetDefiningOp());
+      }
+      block->erase(Block::iterator(*op));
+      ++num_folded;
+      for (Operation *def_op : def_ops) {
+        if (def_op->name() == GetParameterOp::name() && def_op->use_empty()) {
+          block->erase(Block::iterator(*def_op));
+        }
+      }
+    }
+    return num_folded;
+  }
+
+  paddle::framework::Scope *scope_;
+  std::unordered_set<std::string> written_parameters_;
+  size_t num_parameters_{0};
+};
+
+}  // namespace
+
+std::unique_ptr<Pass> CreateConstantFoldingPass(
+    paddle::framework::Scope *scope) {
+  return std::make_unique<ConstantFoldingPass>(scope);
+}
+
+}  // namespace ir
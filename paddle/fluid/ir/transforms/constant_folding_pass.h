@@ -0,0 +1,42 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+
+namespace paddle {
+namespace framework {
+class Scope;
+}  // namespace framework
+}  // namespace paddle
+
+namespace ir {
+
+class Pass;
+
+///
+/// \brief Create a pass that folds the pd operations whose inputs are all
+/// constants or parameters never written by the program, e.g. the shape
+/// computations. The foldable subgraph of each block is evaluated at once
+/// with the phi CPU kernels, and its results used by the rest of the program
+/// are materialized as new parameters, read by builtin.get_parameter.
+///
+/// The parameters without data in the program are read from `scope` if it is
+/// given, the new parameters are also stored in it.
+///
+std::unique_ptr<Pass> CreateConstantFoldingPass(
+    paddle::framework::Scope *scope = nullptr);
+
+}  // namespace ir
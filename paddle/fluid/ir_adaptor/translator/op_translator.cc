@@ -28,6 +28,7 @@
 #include "paddle/fluid/ir_adaptor/translator/attribute_translator.h"
 #include "paddle/fluid/ir_adaptor/translator/op_compat_info.h"
 #include "paddle/fluid/ir_adaptor/translator/program_translator.h"
+#include "paddle/fluid/ir_adaptor/translator/translation_cache.h"
 #include "paddle/fluid/ir_adaptor/translator/type_translator.h"
 #include "paddle/ir/core/builder.h"
 #include "paddle/ir/core/builtin_op.h"
@@ -139,7 +140,9 @@ inline ir::Operation* InsertSliceOperationForTarget(
       ir::Operation::Create({defining_info.value},
                             op_attribute_map,
                             {src_vec_type[defining_info.idx_in_vector]},
-                            op_info);
+                            op_info,
+                            0,
+                            program->arena());
   program->block()->push_back(operation);
   ir::OpResult target_op_result = operation->GetResultByIndex(0);
   (*param_map)[arg_name] = VariableDefiningInfo(target_op_result);
@@ -163,7 +166,12 @@ inline ir::Operation* InsertCombineOperationForTarget(
   }
   ir::Type target_vec_type = ir::VectorType::get(ctx, types_in_vec);
   ir::Operation* operation =
-      ir::Operation::Create(src_values, {}, {target_vec_type}, op_info);
+      ir::Operation::Create(src_values,
+                            {},
+                            {target_vec_type},
+                            op_info,
+                            0,
+                            program->arena());
   program->block()->push_back(operation);
   return operation;
 }
@@ -209,7 +217,12 @@ inline ir::Operation* InsertFullArrayOperationForAttributeInput(
       phi::LoD{},
       0);  // TODO(lyk): to be done
   ir::Operation* operation =
-      ir::Operation::Create({}, {{"value", attr}}, {null_type}, op_info);
+      ir::Operation::Create({},
+                            {{"value", attr}},
+                            {null_type},
+                            op_info,
+                            0,
+                            program->arena());
   program->block()->push_back(operation);
   return operation;
 }
@@ -482,39 +495,66 @@ inline void RecordOpResultMapping(TranslationContext* param_map,
   }
 }
 
-ir::Operation* GeneralOpHandler(ir::IrContext* ctx,
-                                TranslationContext* param_map,
-                                ir::Program* program,
-                                const OpDesc& op_desc) {
-  auto op_info = LoopkUpOpInfo(ctx, op_desc);
+// Translate the parts of the op which don't depend on its inputs.
+std::shared_ptr<const OpTranslationTemplate> BuildOpTemplate(
+    ir::IrContext* ctx, const OpDesc& op_desc) {
+  auto op_template = std::make_shared<OpTranslationTemplate>();
+  op_template->op_info = LoopkUpOpInfo(ctx, op_desc);
   auto* op_info_concept =
-      op_info.GetInterfaceImpl<paddle::dialect::OpYamlInfoInterface>();
+      op_template->op_info
+          .GetInterfaceImpl<paddle::dialect::OpYamlInfoInterface>();
 
-  OpInputInfoList input_infos;
   OpAttributeInfoList attr_infos;
   OpOutputInfoList output_infos;
-  std::tie(input_infos, attr_infos, output_infos, std::ignore) =
+  std::tie(op_template->input_infos, attr_infos, output_infos, std::ignore) =
       op_info_concept->get_op_info_();
 
-  auto op_inputs = GenerateOperationInput(
-      ctx, param_map, program, op_desc, op_info.name(), input_infos);
-
-  OpOutputMapping arg_to_idx;
-  OpOutputTypeList op_output_types;
-  std::tie(op_output_types, arg_to_idx) =
+  std::tie(op_template->output_types, op_template->arg_to_idx) =
       GenerateOperationOutput(ctx, op_desc, output_infos);
 
-  auto attribute_map =
-      TranslateOpAttribute(op_info.name(), attr_infos, op_desc);
+  op_template->attributes =
+      TranslateOpAttribute(op_template->op_info.name(), attr_infos, op_desc);
+  return op_template;
+}
+
+ir::Operation* GeneralOpHandler(ir::IrContext* ctx,
+                                TranslationContext* param_map,
+                                ir::Program* program,
+                                const OpDesc& op_desc) {
+  std::shared_ptr<const OpTranslationTemplate> op_template;
+  if (TranslationCache::Enabled()) {
+    auto& translation_cache = TranslationCache::instance();
+    TranslationKey op_key = TranslationCache::HashOp(op_desc);
+    op_template = translation_cache.GetOpTemplate(op_key);
+    if (!op_template) {
+      op_template = BuildOpTemplate(ctx, op_desc);
+      translation_cache.SetOpTemplate(op_key, op_template);
+    }
+  } else {
+    op_template = BuildOpTemplate(ctx, op_desc);
+  }
+
+  auto op_inputs = GenerateOperationInput(ctx,
+                                          param_map,
+                                          program,
+                                          op_desc,
+                                          op_template->op_info.name(),
+                                          op_template->input_infos);
   VLOG(4) << "[general op][" << op_desc.Type() << "] preparation end.";
 
   ir::Operation* operation =
-      ir::Operation::Create(op_inputs, attribute_map, op_output_types, op_info);
+      ir::Operation::Create(op_inputs,
+                            op_template->attributes,
+                            op_template->output_types,
+                            op_template->op_info,
+                            0,
+                            program->arena());
   VLOG(4) << "[general op][" << op_desc.Type() << "] opearation creation end.";
   program->block()->push_back(operation);
 
   VLOG(4) << "[general op][" << op_desc.Type() << "] opearation insertion end.";
-  RecordOpResultMapping(param_map, op_desc, operation, arg_to_idx);
+  RecordOpResultMapping(
+      param_map, op_desc, operation, op_template->arg_to_idx);
 
   return operation;
 }
@@ -544,7 +584,12 @@ ir::Operation* FeedOpHandler(ir::IrContext* ctx,
   };
 
   ir::Operation* operation =
-      ir::Operation::Create(op_inputs, attribute_map, op_output_types, op_info);
+      ir::Operation::Create(op_inputs,
+                            attribute_map,
+                            op_output_types,
+                            op_info,
+                            0,
+                            program->arena());
   program->block()->push_back(operation);
   RecordOpResultMapping(param_map, op_desc, operation, arg_to_idx);
 
@@ -574,7 +619,12 @@ ir::Operation* FetchOpHandler(ir::IrContext* ctx,
   };
 
   ir::Operation* operation =
-      ir::Operation::Create(op_inputs, attribute_map, op_output_types, op_info);
+      ir::Operation::Create(op_inputs,
+                            attribute_map,
+                            op_output_types,
+                            op_info,
+                            0,
+                            program->arena());
   program->block()->push_back(operation);
 
   return operation;
@@ -19,6 +19,7 @@
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/ir/dialect/pd_dialect.h"
 #include "paddle/fluid/ir_adaptor/translator/program_translator.h"
+#include "paddle/fluid/ir_adaptor/translator/translation_cache.h"
 #include "paddle/ir/core/program.h"
 
 namespace paddle {
@@ -28,12 +29,22 @@ using Program = ::ir::Program;
 
 std::unique_ptr<Program> TranslateLegacyProgramToProgram(
     const LegacyProgramDesc& legacy_program) {
+  auto& translation_cache = translator::TranslationCache::instance();
+  bool use_cache = translator::TranslationCache::Enabled();
+  translator::TranslationKey blocks_key{0, 0};
+  if (use_cache) {
+    blocks_key = translator::TranslationCache::HashBlocks(legacy_program);
+    auto program = translation_cache.GetProgram(blocks_key);
+    if (program) return program;
+  }
+
   auto program = std::make_unique<Program>(ir::IrContext::Instance());
 
   translator::ProgramTranslator program_translator(&legacy_program,
                                                    program.get());
   program_translator.Translate();
 
+  if (use_cache) translation_cache.SetProgram(blocks_key, program.get());
   return program;
 }
 
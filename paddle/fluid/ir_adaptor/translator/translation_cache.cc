@@ -0,0 +1,299 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/ir_adaptor/translator/translation_cache.h"
+
+#include <xxhash.h>
+
+#include <type_traits>
+
+#include "glog/logging.h"
+
+#include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/framework/var_desc.h"
+#include "paddle/fluid/platform/flags.h"
+#include "paddle/ir/core/bytecode.h"
+#include "paddle/ir/core/ir_context.h"
+
+PADDLE_DEFINE_EXPORTED_bool(enable_translation_cache,
+                            true,
+                            "Whether to cache the translation of the "
+                            "ProgramDescs to the new IR programs.");
+
+namespace paddle {
+namespace translator {
+
+constexpr size_t TranslationCache::kMaxOpTemplates;
+constexpr size_t TranslationCache::kMaxPrograms;
+
+TranslationCache::TranslationCache() {
+  auto& statistics = ir::CacheStatistics::Instance();
+  op_counter = statistics.GetCounter("TranslationCache(op)");
+  program_counter = statistics.GetCounter("TranslationCache(block)");
+}
+
+bool TranslationCache::Enabled() { return FLAGS_enable_translation_cache; }
+
+namespace {
+// Hashes the content of the descs in memory. The protos are not used, since
+// the ones of the OpDescs are stale until they are flushed, and serializing
+// them costs more than translating a small op.
+class DescHasher {
+ public:
+  // The check digest is the same hash with another seed.
+  static constexpr uint64_t kCheckSeed = 0x9e3779b97f4a7c15ULL;
+
+  DescHasher() : key_{0, kCheckSeed} {}
+
+  const TranslationKey& key() const { return key_; }
+
+  void AddBytes(const void* data, size_t size) {
+    key_.hash = XXH64(data, size, key_.hash);
+    key_.check = XXH64(data, size, key_.check);
+  }
+
+  template <typename T,
+            typename = std::enable_if_t<std::is_arithmetic<T>::value ||
+                                        std::is_enum<T>::value>>
+  void Add(T value) {
+    AddBytes(&value, sizeof(T));
+  }
+
+  void Add(const std::string& str) {
+    Add(str.size());
+    AddBytes(str.data(), str.size());
+  }
+
+  template <typename T>
+  void Add(const std::vector<T>& values) {
+    Add(values.size());
+    for (const auto& value : values) {
+      Add(value);
+    }
+  }
+
+  void Add(const std::vector<bool>& values) {
+    Add(values.size());
+    for (bool value : values) {
+      Add(value);
+    }
+  }
+
+  void Add(const framework::BlockDesc* block) { Add(block->ID()); }
+
+  void Add(const framework::VarDesc* var) { Add(var->Name()); }
+
+  void Add(const paddle::experimental::Scalar& scalar) {
+    Add(scalar.ToString());
+  }
+
+  void Add(const paddle::blank&) {}
+
+  void Add(const framework::VariableNameMap& names) {
+    Add(names.size());
+    for (const auto& pair : names) {
+      Add(pair.first);
+      Add(pair.second);
+    }
+  }
+
+  // The order of the attributes in the map depends on the history of the
+  // desc, so the attributes are combined in an order independent way.
+  void Add(const framework::AttributeMap& attrs) {
+    TranslationKey sum{0, 0};
+    for (const auto& pair : attrs) {
+      DescHasher attr_hasher;
+      attr_hasher.Add(pair.first);
+      attr_hasher.Add(pair.second.index());
+      paddle::visit([&](const auto& value) { attr_hasher.Add(value); },
+                    pair.second);
+      sum.hash += attr_hasher.key().hash;
+      sum.check += attr_hasher.key().check;
+    }
+    Add(attrs.size());
+    Add(sum.hash);
+    Add(sum.check);
+  }
+
+  void Add(const framework::OpDesc& op_desc) {
+    Add(op_desc.Type());
+    Add(op_desc.Inputs());
+    Add(op_desc.Outputs());
+    Add(op_desc.GetAttrMap());
+    Add(op_desc.GetRuntimeAttrMap());
+  }
+
+  void Add(const framework::VarDesc& var) {
+    using VarType = framework::proto::VarType;
+    Add(var.Name());
+    Add(var.Persistable());
+    const auto& var_type = var.Proto()->type();
+    Add(var_type.has_type());
+    if (!var_type.has_type()) return;
+    Add(var_type.type());
+    switch (var_type.type()) {
+      case VarType::LOD_TENSOR:
+      case VarType::LOD_TENSOR_ARRAY:
+        Add(var.GetLoDLevel());
+        AddTensorDesc(var);
+        break;
+      case VarType::SELECTED_ROWS:
+      case VarType::STRINGS:
+      case VarType::VOCAB:
+      case VarType::SPARSE_COO:
+        AddTensorDesc(var);
+        break;
+      default:
+        break;
+    }
+  }
+
+ private:
+  void AddTensorDesc(const framework::VarDesc& var) {
+    Add(var.GetDataType());
+    Add(var.GetShape());
+  }
+
+  TranslationKey key_;
+};
+}  // namespace
+
+TranslationKey TranslationCache::HashOp(const OpDesc& op_desc) {
+  DescHasher hasher;
+  hasher.Add(op_desc);
+  // The types of the outputs are translated from their VarDescs.
+  const auto* block = op_desc.Block();
+  for (const auto& var_name : op_desc.OutputArgumentNames()) {
+    const auto* var = block->FindVarRecursive(var_name);
+    if (var == nullptr) continue;
+    hasher.Add(*var);
+  }
+  return hasher.key();
+}
+
+TranslationKey TranslationCache::HashBlocks(const ProgramDesc& program_desc) {
+  DescHasher hasher;
+  hasher.Add(program_desc.Size());
+  for (size_t i = 0; i < program_desc.Size(); ++i) {
+    const auto& block = program_desc.Block(i);
+    hasher.Add(block.Parent());
+    hasher.Add(block.ForwardBlockID());
+    auto vars = block.AllVars();
+    hasher.Add(vars.size());
+    for (const auto* var : vars) {
+      hasher.Add(*var);
+    }
+    hasher.Add(block.OpSize());
+    for (const auto* op : block.AllOps()) {
+      hasher.Add(*op);
+    }
+  }
+  return hasher.key();
+}
+
+std::shared_ptr<const OpTranslationTemplate> TranslationCache::GetOpTemplate(
+    const TranslationKey& key) {
+  std::shared_ptr<const OpTranslationTemplate> op_template;
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    auto it = op_templates.find(key.hash);
+    if (it != op_templates.end()) {
+      if (it->second.check == key.check) {
+        op_template = it->second.op_template;
+      } else {
+        VLOG(4) << "The hash " << key.hash << " of op templates collides.";
+      }
+    }
+  }
+  if (op_template) {
+    ++op_counter->hits;
+  } else {
+    ++op_counter->misses;
+  }
+  return op_template;
+}
+
+void TranslationCache::SetOpTemplate(
+    const TranslationKey& key,
+    std::shared_ptr<const OpTranslationTemplate> op_template) {
+  std::lock_guard<std::mutex> guard(mutex);
+  if (op_templates.size() >= kMaxOpTemplates) {
+    VLOG(6) << "Drop " << op_templates.size() << " cached op templates.";
+    op_templates.clear();
+  }
+  // The template of a colliding hash replaces the former one.
+  op_templates[key.hash] = {key.check, std::move(op_template)};
+}
+
+std::unique_ptr<ir::Program> TranslationCache::GetProgram(
+    const TranslationKey& key) {
+  std::shared_ptr<const std::string> bytecode;
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    auto it = programs.find(key.hash);
+    if (it != programs.end()) {
+      if (it->second.check == key.check) {
+        bytecode = it->second.bytecode;
+      } else {
+        VLOG(4) << "The hash " << key.hash << " of programs collides.";
+      }
+    }
+  }
+  if (!bytecode || bytecode->empty()) {
+    ++program_counter->misses;
+    return nullptr;
+  }
+  ++program_counter->hits;
+  return ir::BytecodeReader(
+             ir::IrContext::Instance(), bytecode->data(), bytecode->size())
+      .Read();
+}
+
+void TranslationCache::SetProgram(const TranslationKey& key,
+                                  ir::Program* program) {
+  std::string bytecode;
+  try {
+    bytecode =
+        ir::BytecodeWriter(program->module_op().ir_context()).Write(program);
+  } catch (const std::exception& e) {
+    // Remember the failure, so the program is not encoded again.
+    VLOG(4) << "The translated program can't be cached: " << e.what();
+  }
+  ProgramEntry entry{key.check,
+                     std::make_shared<const std::string>(std::move(bytecode))};
+
+  std::lock_guard<std::mutex> guard(mutex);
+  auto it = programs.find(key.hash);
+  if (it != programs.end()) {
+    // The program of a colliding hash replaces the former one in place.
+    if (it->second.check != key.check) it->second = std::move(entry);
+    return;
+  }
+  if (program_keys.size() >= kMaxPrograms) {
+    programs.erase(program_keys.front());
+    program_keys.pop_front();
+  }
+  programs.emplace(key.hash, std::move(entry));
+  program_keys.push_back(key.hash);
+}
+
+void TranslationCache::Clear() {
+  std::lock_guard<std::mutex> guard(mutex);
+  op_templates.clear();
+  programs.clear();
+  program_keys.clear();
+}
+
+}  // namespace translator
+}  // namespace paddle
@@ -0,0 +1,142 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/op_desc.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/ir/dialect/utils.h"
+#include "paddle/ir/core/attribute.h"
+#include "paddle/ir/core/op_info.h"
+#include "paddle/ir/core/program.h"
+#include "paddle/ir/core/type.h"
+#include "paddle/ir/pass/cache_statistics.h"
+
+namespace paddle {
+namespace translator {
+
+/// The part of a translated operation which only depends on the content of
+/// the OpDesc and the VarDescs of its outputs. Ops with the same content
+/// share one template, and only their inputs are resolved again.
+struct OpTranslationTemplate {
+  ir::OpInfo op_info;
+  std::vector<paddle::dialect::OpInputInfo> input_infos;
+  std::vector<ir::Type> output_types;
+  std::unordered_map<std::string, size_t> arg_to_idx;
+  ir::AttributeMap attributes;
+};
+
+/// The content hash of descs. The caches are indexed by hash, and check, a
+/// second digest of the same content, is compared on a hit, so that a
+/// collision of the hashes doesn't return the translation of other descs.
+struct TranslationKey {
+  uint64_t hash;
+  uint64_t check;
+};
+
+inline bool operator==(const TranslationKey& a, const TranslationKey& b) {
+  return a.hash == b.hash && a.check == b.check;
+}
+
+inline bool operator!=(const TranslationKey& a, const TranslationKey& b) {
+  return !(a == b);
+}
+
+///
+/// \brief TranslationCache speeds up translating the same ProgramDesc again,
+/// which is common in dynamic to static workflows. It works on two levels,
+/// both keyed by a content hash:
+/// 1. block level: the whole translated block is kept in the ir bytecode
+///    format, and decoded instead of translated on hit.
+/// 2. op level: the op info, output types and attributes of a translated
+///    op are kept as a template, so that only the inputs of an op with the
+///    same content are translated again.
+/// The hits and misses are reported through ir::CacheStatistics. The cache
+/// is turned off by FLAGS_enable_translation_cache.
+///
+class TranslationCache {
+  using OpDesc = paddle::framework::OpDesc;
+  using ProgramDesc = paddle::framework::ProgramDesc;
+
+ public:
+  TranslationCache(const TranslationCache&) = delete;
+  TranslationCache& operator=(const TranslationCache&) = delete;
+
+  static auto& instance() {
+    static TranslationCache translation_cache;
+    return translation_cache;
+  }
+
+  /// Whether the translation goes through the cache.
+  static bool Enabled();
+
+  /// The hash of the op and the variables it defines. The hashes are
+  /// computed from the descs in memory, the descs are neither serialized nor
+  /// flushed.
+  static TranslationKey HashOp(const OpDesc& op_desc);
+
+  /// The hash of the blocks of the program, including their variables.
+  static TranslationKey HashBlocks(const ProgramDesc& program_desc);
+
+  std::shared_ptr<const OpTranslationTemplate> GetOpTemplate(
+      const TranslationKey& key);
+  void SetOpTemplate(const TranslationKey& key,
+                     std::shared_ptr<const OpTranslationTemplate> op_template);
+
+  /// Decode the cached translation of the blocks, nullptr on miss.
+  std::unique_ptr<ir::Program> GetProgram(const TranslationKey& key);
+  /// Encode the translated program into the cache.
+  void SetProgram(const TranslationKey& key, ir::Program* program);
+
+  void Clear();
+
+  /// The caches are bounded, the op templates are dropped all together when
+  /// the limit is reached, while the programs are evicted in FIFO order.
+  static constexpr size_t kMaxOpTemplates = 1 << 16;
+  static constexpr size_t kMaxPrograms = 32;
+
+ private:
+  TranslationCache();
+
+  std::mutex mutex;
+
+  // The entries are indexed by TranslationKey::hash.
+  struct OpTemplateEntry {
+    uint64_t check;
+    std::shared_ptr<const OpTranslationTemplate> op_template;
+  };
+  std::unordered_map<uint64_t, OpTemplateEntry> op_templates;
+  ir::CacheStatistics::Counter* op_counter;
+
+  // The bytecode of the translated programs, an empty string marks a program
+  // which can't be encoded.
+  struct ProgramEntry {
+    uint64_t check;
+    std::shared_ptr<const std::string> bytecode;
+  };
+  std::unordered_map<uint64_t, ProgramEntry> programs;
+  std::deque<uint64_t> program_keys;
+  ir::CacheStatistics::Counter* program_counter;
+};
+
+}  // namespace translator
+}  // namespace paddle
@@ -19,7 +19,9 @@
 #include "paddle/fluid/memory/allocation/allocator_strategy.h"
 #include "paddle/fluid/memory/allocation/auto_growth_best_fit_allocator.h"
 #include "paddle/fluid/memory/allocation/cpu_allocator.h"
+#include "paddle/fluid/memory/allocation/huge_page_allocator.h"
 #include "paddle/fluid/memory/allocation/naive_best_fit_allocator.h"
+#include "paddle/fluid/memory/allocation/numa_allocator.h"
 #include "paddle/fluid/memory/allocation/retry_allocator.h"
 #include "paddle/fluid/memory/allocation/stat_allocator.h"
 #include "paddle/fluid/platform/device_context.h"
@@ -95,6 +97,38 @@ PADDLE_DEFINE_EXPORTED_bool(use_cuda_managed_memory,
                             "managed memory, only available for auto_growth "
                             "strategy");
 
+PADDLE_DEFINE_EXPORTED_bool(
+    use_auto_growth_cpu_allocator,
+    false,
+    "Whether to use AutoGrowthBestFitAllocator with size classes to allocate "
+    "CPU memory, only available for auto_growth strategy");
+
+PADDLE_DEFINE_EXPORTED_bool(
+    use_numa_cpu_allocator,
+    false,
+    "Whether to place the large CPU allocations on NUMA nodes, see "
+    "FLAGS_cpu_numa_node. Only works on Linux with more than one node.");
+
+PADDLE_DEFINE_EXPORTED_int32(
+    cpu_numa_node,
+    -1,
+    "The NUMA node to place the CPU memory on when "
+    "FLAGS_use_numa_cpu_allocator is set. -1 means the node of the "
+    "allocating thread, and -2 means interleaving over all the nodes.");
+
+PADDLE_DEFINE_EXPORTED_bool(
+    use_cpu_huge_page,
+    false,
+    "Whether to back the CPU allocations of 2MB and more with huge pages, "
+    "which reduces the TLB misses of large tensors. Only works on Linux.");
+
+PADDLE_DEFINE_EXPORTED_bool(
+    use_cpu_hugetlb,
+    false,
+    "Whether to map the huge pages from the hugetlbfs pool before falling "
+    "back to the transparent huge pages, when FLAGS_use_cpu_huge_page is "
+    "set.");
+
 PHI_DECLARE_string(allocator_strategy);
 PHI_DECLARE_uint64(auto_growth_chunk_size_in_mb);
 
@@ -213,7 +247,11 @@ class AllocatorFacadePrivate {
       }
 
       case AllocatorStrategy::kAutoGrowth: {
-        InitNaiveBestFitCPUAllocator();
+        if (FLAGS_use_auto_growth_cpu_allocator) {
+          InitAutoGrowthCPUAllocator();
+        } else {
+          InitNaiveBestFitCPUAllocator();
+        }
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
         allow_free_idle_chunk_ = allow_free_idle_chunk;
         for (int dev_id = 0; dev_id < platform::GetGPUDeviceCount(); ++dev_id) {
@@ -590,10 +628,43 @@ class AllocatorFacadePrivate {
     allocators_[platform::CPUPlace()] =
         std::make_shared<NaiveBestFitAllocator>(platform::CPUPlace());
 #else
-    allocators_[platform::CPUPlace()] = std::make_shared<CPUAllocator>();
+    allocators_[platform::CPUPlace()] = CreateCPUAllocator();
 #endif
   }
 
+  std::shared_ptr<Allocator> CreateCPUAllocator() {
+    if (FLAGS_use_cpu_huge_page) {
+      if (FLAGS_use_numa_cpu_allocator) {
+        LOG(WARNING) << "FLAGS_use_numa_cpu_allocator is ignored since "
+                        "FLAGS_use_cpu_huge_page is set.";
+      }
+      return std::make_shared<HugePageAllocator>(FLAGS_use_cpu_hugetlb);
+    }
+    if (FLAGS_use_numa_cpu_allocator) {
+      return std::make_shared<NUMAAllocator>(FLAGS_cpu_numa_node);
+    }
+    return std::make_shared<CPUAllocator>();
+  }
+
+  void InitAutoGrowthCPUAllocator() {
+    // The chunks are page aligned by CPUAllocator, while the blocks carved
+    // from them only need the cache line alignment. Chunks of 1MB at least,
+    // so that small allocations do not cost a system allocation each, and of
+    // a huge page if huge pages are used, so that every chunk is backed by
+    // huge pages.
+    constexpr size_t kCPUAlignment = 64;
+    size_t chunk_size = FLAGS_use_cpu_huge_page
+                            ? HugePageAllocator::kHugePageSize
+                            : static_cast<size_t>(1 << 20);
+    allocators_[platform::CPUPlace()] =
+        std::make_shared<AutoGrowthBestFitAllocator>(
+            CreateCPUAllocator(),
+            kCPUAlignment,
+            /*chunk_size=*/chunk_size,
+            /*allow_free_idle_chunk=*/true,
+            /*use_size_classes=*/true);
+  }
+
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   void InitNaiveBestFitCUDAPinnedAllocator() {
     allocators_[platform::CUDAPinnedPlace()] =
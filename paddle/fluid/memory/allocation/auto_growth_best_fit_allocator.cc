@@ -18,6 +18,7 @@
 #include <mutex>  // NOLINT
 
 #include "paddle/fluid/memory/allocation/aligned_allocator.h"
+#include "paddle/fluid/memory/stats.h"
 #include "paddle/fluid/platform/flags.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
 
@@ -41,20 +42,69 @@ namespace paddle {
 namespace memory {
 namespace allocation {
 
+constexpr size_t AutoGrowthBestFitAllocator::kMaxSizeClassSize;
+constexpr size_t AutoGrowthBestFitAllocator::kSizeClassCacheSize;
+constexpr size_t AutoGrowthBestFitAllocator::kMinSizeClassCacheNum;
+
 AutoGrowthBestFitAllocator::AutoGrowthBestFitAllocator(
     const std::shared_ptr<Allocator> &underlying_allocator,
     size_t alignment,
     size_t chunk_size,
-    bool allow_free_idle_chunk)
+    bool allow_free_idle_chunk,
+    bool use_size_classes)
     : underlying_allocator_(underlying_allocator),
       alignment_(alignment),
       chunk_size_(std::max(AlignedSize(chunk_size, alignment), alignment)),
-      allow_free_idle_chunk_(allow_free_idle_chunk) {
+      allow_free_idle_chunk_(allow_free_idle_chunk),
+      use_size_classes_(use_size_classes) {
   total_alloc_times_ = 0;
   total_alloc_size_ = 0;
   total_free_times_ = 0;
   total_free_size_ = 0;
   VLOG(4) << "chunk_size_:" << chunk_size_;
+
+  if (use_size_classes_) {
+    // 4 size classes per power of two, so that rounding up wastes at most
+    // 25% of a small request.
+    for (size_t size = alignment_; size <= kMaxSizeClassSize;) {
+      size_t capacity = std::max(kSizeClassCacheSize / size,
+                                 kMinSizeClassCacheNum);
+      size_class_sizes_.push_back(size);
+      size_classes_.emplace_back(new SizeClass());
+      size_classes_.back()->size_ = size;
+      size_classes_.back()->capacity_ = capacity;
+      size_t step = size / 4;
+      while (step & (step - 1)) {
+        step &= step - 1;
+      }
+      size = AlignedSize(size + std::max(step, alignment_), alignment_);
+    }
+    VLOG(4) << "size classes: " << size_class_sizes_.size();
+  }
+}
+
+AutoGrowthBestFitAllocator::~AutoGrowthBestFitAllocator() {
+  for (auto &size_class : size_classes_) {
+    auto &free_list = size_class->free_list_;
+    if (free_list.empty()) {
+      continue;
+    }
+    HOST_MEMORY_STAT_UPDATE(
+        Cached, 0, -static_cast<int64_t>(free_list.size() * size_class->size_));
+    for (auto *allocation : free_list) {
+      delete allocation;
+    }
+  }
+}
+
+AutoGrowthBestFitAllocator::SizeClass *
+AutoGrowthBestFitAllocator::GetSizeClass(size_t size) {
+  auto iter = std::lower_bound(
+      size_class_sizes_.begin(), size_class_sizes_.end(), size);
+  if (iter == size_class_sizes_.end()) {
+    return nullptr;
+  }
+  return size_classes_[iter - size_class_sizes_.begin()].get();
 }
 
 phi::Allocation *AutoGrowthBestFitAllocator::AllocateImpl(
@@ -65,7 +115,30 @@ phi::Allocation *AutoGrowthBestFitAllocator::AllocateImpl(
   size_t size = AlignedSize(unaligned_size, alignment_);
   VLOG(10) << "Allocate " << unaligned_size << " bytes, aligned to " << size;
 
+  SizeClass *size_class = use_size_classes_ ? GetSizeClass(size) : nullptr;
+  if (size_class != nullptr) {
+    size = size_class->size_;
+    phi::Allocation *allocation = nullptr;
+    {
+      std::lock_guard<SpinLock> guard(size_class->spinlock_);
+      if (!size_class->free_list_.empty()) {
+        allocation = size_class->free_list_.back();
+        size_class->free_list_.pop_back();
+      }
+    }
+    if (allocation != nullptr) {
+      HOST_MEMORY_STAT_UPDATE(Cached, 0, -static_cast<int64_t>(size));
+      VLOG(10) << "Alloc " << size << " bytes from size class, ptr = "
+               << allocation->ptr();
+      return allocation;
+    }
+  }
+
   std::lock_guard<SpinLock> guard(spinlock_);
+  return AllocateFromPool(size);
+}
+
+phi::Allocation *AutoGrowthBestFitAllocator::AllocateFromPool(size_t size) {
   auto iter = free_blocks_.lower_bound(std::make_pair(size, nullptr));
   BlockIt block_it;
   if (iter != free_blocks_.end()) {
@@ -75,6 +148,9 @@ phi::Allocation *AutoGrowthBestFitAllocator::AllocateImpl(
     size_t remaining_size = block_it->size_ - size;
     VLOG(10) << "Allocate " << size << " bytes from chunk size "
              << block_it->size_ << ", remaining " << remaining_size;
+    if (use_size_classes_) {
+      HOST_MEMORY_STAT_UPDATE(Idle, 0, -static_cast<int64_t>(size));
+    }
     if (remaining_size == 0) {
       block_it->is_free_ = false;
     } else {
@@ -89,6 +165,7 @@ phi::Allocation *AutoGrowthBestFitAllocator::AllocateImpl(
     }
   } else {
     if (FLAGS_free_when_no_cache_hit) {
+      FlushSizeClasses();
       FreeIdleChunks();
     }
     size_t realloc_size = std::max(size, chunk_size_);
@@ -98,6 +175,7 @@ phi::Allocation *AutoGrowthBestFitAllocator::AllocateImpl(
           underlying_allocator_->Allocate(realloc_size)));
     } catch (BadAlloc &ex) {
       if (FLAGS_free_when_no_cache_hit) throw ex;
+      FlushSizeClasses();
       FreeIdleChunks();
       chunks_.emplace_back(static_unique_ptr_cast<Allocation>(
           underlying_allocator_->Allocate(realloc_size)));
@@ -112,6 +190,9 @@ phi::Allocation *AutoGrowthBestFitAllocator::AllocateImpl(
     if (remaining_size > 0) {
       blocks.emplace_back(p, remaining_size, true, chunk);
       free_blocks_.emplace(std::make_pair(remaining_size, p), --(blocks.end()));
+      if (use_size_classes_) {
+        HOST_MEMORY_STAT_UPDATE(Idle, 0, remaining_size);
+      }
     }
     blocks.emplace_back(p + remaining_size, size, false, chunk);
     block_it = --(blocks.end());
@@ -130,12 +211,36 @@ void AutoGrowthBestFitAllocator::FreeImpl(phi::Allocation *allocation) {
                                9 /*level*/);
   VLOG(10) << "Free " << allocation->size()
            << " bytes, ptr = " << allocation->ptr();
+  SizeClass *size_class =
+      use_size_classes_ ? GetSizeClass(allocation->size()) : nullptr;
+  if (size_class != nullptr && size_class->size_ == allocation->size()) {
+    bool cached = false;
+    {
+      std::lock_guard<SpinLock> guard(size_class->spinlock_);
+      if (size_class->free_list_.size() < size_class->capacity_) {
+        size_class->free_list_.push_back(allocation);
+        cached = true;
+      }
+    }
+    if (cached) {
+      HOST_MEMORY_STAT_UPDATE(Cached, 0, allocation->size());
+      return;
+    }
+  }
+
   std::lock_guard<SpinLock> guard(spinlock_);
+  FreeToPool(allocation);
+}
+
+void AutoGrowthBestFitAllocator::FreeToPool(phi::Allocation *allocation) {
   auto block_it = static_cast<BlockAllocation *>(allocation)->block_it_;
   auto &blocks = block_it->chunk_->blocks_;
 
   total_free_times_ += 1;
   total_free_size_ += block_it->size_;
+  if (use_size_classes_) {
+    HOST_MEMORY_STAT_UPDATE(Idle, 0, block_it->size_);
+  }
 
   block_it->is_free_ = true;
 
@@ -170,6 +275,31 @@ void AutoGrowthBestFitAllocator::FreeImpl(phi::Allocation *allocation) {
   }
 }
 
+uint64_t AutoGrowthBestFitAllocator::ReleaseImpl(
+    const platform::Place &place) {
+  std::lock_guard<SpinLock> guard(spinlock_);
+  FlushSizeClasses();
+  return FreeIdleChunks();
+}
+
+void AutoGrowthBestFitAllocator::FlushSizeClasses() {
+  for (auto &size_class : size_classes_) {
+    std::vector<phi::Allocation *> free_list;
+    {
+      std::lock_guard<SpinLock> guard(size_class->spinlock_);
+      free_list.swap(size_class->free_list_);
+    }
+    if (free_list.empty()) {
+      continue;
+    }
+    HOST_MEMORY_STAT_UPDATE(
+        Cached, 0, -static_cast<int64_t>(free_list.size() * size_class->size_));
+    for (auto *allocation : free_list) {
+      FreeToPool(allocation);
+    }
+  }
+}
+
 uint64_t AutoGrowthBestFitAllocator::FreeIdleChunks() {
   if (!allow_free_idle_chunk_) {
     return 0;
@@ -182,6 +312,9 @@ uint64_t AutoGrowthBestFitAllocator::FreeIdleChunks() {
       VLOG(2) << "Free chunk with size " << block.size_;
       bytes += block.size_;
       free_blocks_.erase(std::make_pair(block.size_, block.ptr_));
+      if (use_size_classes_) {
+        HOST_MEMORY_STAT_UPDATE(Idle, 0, -static_cast<int64_t>(block.size_));
+      }
       chunk_it = chunks_.erase(chunk_it);
     } else {
       ++chunk_it;
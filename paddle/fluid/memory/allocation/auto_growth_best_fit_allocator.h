@@ -19,6 +19,7 @@
 #include <memory>
 #include <mutex>  // NOLINT
 #include <utility>
+#include <vector>
 
 #include "paddle/fluid/memory/allocation/allocator.h"
 #include "paddle/fluid/memory/allocation/spin_lock.h"
@@ -27,13 +28,23 @@ namespace paddle {
 namespace memory {
 namespace allocation {
 
+// If use_size_classes is set, the small requests are rounded up to a few
+// size classes, and the freed small allocations are cached in a free list per
+// size class instead of being merged back into the best-fit pool. A cache hit
+// only takes the lock of its size class, without looking up the best-fit map
+// nor allocating list nodes. The bytes cached in the free lists and the idle
+// bytes of the best-fit pool are reported to the host memory stats "Cached"
+// and "Idle", so size classes are only meant for host memory.
 class AutoGrowthBestFitAllocator : public Allocator {
  public:
   AutoGrowthBestFitAllocator(
       const std::shared_ptr<Allocator> &underlying_allocator,
       size_t alignment,
       size_t chunk_size = 0,
-      bool allow_free_idle_chunk = true);
+      bool allow_free_idle_chunk = true,
+      bool use_size_classes = false);
+
+  ~AutoGrowthBestFitAllocator();
 
   bool IsAllocThreadSafe() const override { return true; }
 
@@ -43,11 +54,35 @@ class AutoGrowthBestFitAllocator : public Allocator {
   void FreeImpl(phi::Allocation *allocation) override;
 
   // Release the memory block which is not used in pool.
-  uint64_t ReleaseImpl(const platform::Place &place) override {
-    return FreeIdleChunks();
-  }
+  uint64_t ReleaseImpl(const platform::Place &place) override;
 
  private:
+  // The requests not larger than this are served by the size classes.
+  static constexpr size_t kMaxSizeClassSize = 256 << 10;
+  // The bytes cached by a free list, which holds at least
+  // kMinSizeClassCacheNum allocations.
+  static constexpr size_t kSizeClassCacheSize = 4 << 20;
+  static constexpr size_t kMinSizeClassCacheNum = 8;
+
+  struct SizeClass {
+    size_t size_;
+    size_t capacity_;
+    SpinLock spinlock_;
+    std::vector<phi::Allocation *> free_list_;
+  };
+
+  // Returns the smallest size class not less than size, or nullptr if size is
+  // too large for the size classes.
+  SizeClass *GetSizeClass(size_t size);
+
+  // Return the allocations cached by the size classes to the best-fit pool,
+  // needs spinlock_ held.
+  void FlushSizeClasses();
+
+  // The best-fit pool, need spinlock_ held.
+  phi::Allocation *AllocateFromPool(size_t size);
+  void FreeToPool(phi::Allocation *allocation);
+
   uint64_t FreeIdleChunks();
   void Trace() const;
 
@@ -94,6 +129,10 @@ class AutoGrowthBestFitAllocator : public Allocator {
   size_t chunk_size_;
   bool allow_free_idle_chunk_;
 
+  bool use_size_classes_;
+  std::vector<size_t> size_class_sizes_;
+  std::vector<std::unique_ptr<SizeClass>> size_classes_;
+
   // stat info
   size_t total_alloc_times_;
   size_t total_alloc_size_;
@@ -18,6 +18,7 @@
 
 #include "gtest/gtest.h"
 #include "paddle/fluid/memory/allocation/aligned_allocator.h"
+#include "paddle/fluid/memory/stats.h"
 
 DECLARE_bool(free_idle_chunk);
 DECLARE_bool(free_when_no_cache_hit);
@@ -171,6 +172,57 @@ TEST(test_auto_growth_allocator, test_free_when_no_cache_hit) {
   TestFreeWhenNoCacheHit(true);
 }
 
+TEST(test_auto_growth_allocator, test_size_classes) {
+  FLAGS_free_idle_chunk = false;
+  FLAGS_free_when_no_cache_hit = false;
+  auto recorded_allocator = std::make_shared<RecordedAllocator>();
+  size_t alignment = 64;
+  size_t chunk_size = 1 << 20;
+  auto ag_allocator = std::make_shared<AutoGrowthBestFitAllocator>(
+      recorded_allocator,
+      alignment,
+      chunk_size,
+      /*allow_free_idle_chunk=*/true,
+      /*use_size_classes=*/true);
+  int64_t cached = HostMemoryStatCurrentValue("Cached", 0);
+
+  // A small request is rounded up to its size class, and the freed
+  // allocation is reused by the next request of the same size class.
+  auto allocation = ag_allocator->Allocate(1000);
+  void *ptr = allocation->ptr();
+  ASSERT_EQ(allocation->size(), 1024UL);
+  allocation.reset();
+  ASSERT_EQ(HostMemoryStatCurrentValue("Cached", 0), cached + 1024);
+  allocation = ag_allocator->Allocate(1020);
+  ASSERT_EQ(allocation->ptr(), ptr);
+  ASSERT_EQ(HostMemoryStatCurrentValue("Cached", 0), cached);
+
+  // A large request is served by the best-fit pool with its aligned size.
+  auto large_allocation = ag_allocator->Allocate((512 << 10) + 1);
+  ASSERT_EQ(large_allocation->size(), (512UL << 10) + alignment);
+  large_allocation.reset();
+  ASSERT_EQ(HostMemoryStatCurrentValue("Cached", 0), cached);
+
+  // Release flushes the size classes and frees the idle chunks.
+  std::vector<AllocationPtr> allocations;
+  for (size_t size = 1; size <= (256 << 10); size *= 2) {
+    allocations.emplace_back(ag_allocator->Allocate(size));
+  }
+  allocations.clear();
+  allocation.reset();
+  ASSERT_GT(HostMemoryStatCurrentValue("Cached", 0), cached);
+  ag_allocator->Release(platform::CPUPlace());
+  ASSERT_EQ(HostMemoryStatCurrentValue("Cached", 0), cached);
+  ASSERT_EQ(recorded_allocator->AllocatedSize(), 0UL);
+
+  // The allocations still cached are uncounted when the allocator is
+  // destroyed.
+  ag_allocator->Allocate(1000).reset();
+  ASSERT_EQ(HostMemoryStatCurrentValue("Cached", 0), cached + 1024);
+  ag_allocator.reset();
+  ASSERT_EQ(HostMemoryStatCurrentValue("Cached", 0), cached);
+}
+
 }  // namespace allocation
 }  // namespace memory
 }  // namespace paddle
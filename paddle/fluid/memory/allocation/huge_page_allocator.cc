@@ -0,0 +1,229 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/huge_page_allocator.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#include "paddle/fluid/memory/allocation/cpu_allocator.h"
+#include "paddle/fluid/memory/stats.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+constexpr size_t HugePageAllocator::kHugePageSize;
+
+namespace {
+
+class HugePageAllocation : public Allocation {
+ public:
+  HugePageAllocation(void* ptr, size_t size, size_t mapped_size)
+      : Allocation(ptr, size, platform::CPUPlace()),
+        mapped_size_(mapped_size) {}
+
+  // 0 if the memory is not mapped for huge pages.
+  size_t mapped_size() const { return mapped_size_; }
+
+ private:
+  size_t mapped_size_;
+};
+
+#ifdef __linux__
+// Map size bytes aligned to HugePageAllocator::kHugePageSize, by mapping one
+// more huge page and unmapping the unaligned head and tail.
+void* MapAligned(size_t size) {
+  constexpr size_t kAlignment = HugePageAllocator::kHugePageSize;
+  size_t mapped_size = size + kAlignment;
+  void* p = mmap(nullptr,
+                 mapped_size,
+                 PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS,
+                 -1,
+                 0);
+  PADDLE_ENFORCE_NE(p,
+                    MAP_FAILED,
+                    platform::errors::ResourceExhausted(
+                        "Fail to map memory of %ld size, error code is %d.",
+                        mapped_size,
+                        errno));
+  uintptr_t addr = reinterpret_cast<uintptr_t>(p);
+  uintptr_t aligned_addr = (addr + kAlignment - 1) / kAlignment * kAlignment;
+  size_t head = aligned_addr - addr;
+  size_t tail = mapped_size - head - size;
+  if (head > 0) {
+    munmap(p, head);
+  }
+  if (tail > 0) {
+    munmap(reinterpret_cast<void*>(aligned_addr + size), tail);
+  }
+  return reinterpret_cast<void*>(aligned_addr);
+}
+#endif
+
+}  // namespace
+
+HugePageAllocator::HugePageAllocator(bool use_hugetlb)
+    : use_hugetlb_(use_hugetlb) {}
+
+phi::Allocation* HugePageAllocator::AllocateImpl(size_t size) {
+#ifdef __linux__
+  if (size >= kHugePageSize) {
+    size_t mapped_size = AlignedSize(size, kHugePageSize);
+    void* p = nullptr;
+    bool is_hugetlb = false;
+    if (use_hugetlb_) {
+      p = mmap(nullptr,
+               mapped_size,
+               PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+               -1,
+               0);
+      if (p == MAP_FAILED) {
+        VLOG(4) << "Fail to map " << mapped_size
+                << " bytes from hugetlbfs, error code is " << errno;
+        p = nullptr;
+      } else {
+        is_hugetlb = true;
+      }
+    }
+    if (p == nullptr) {
+      p = MapAligned(mapped_size);
+      if (madvise(p, mapped_size, MADV_HUGEPAGE) != 0) {
+        VLOG(4) << "Fail to advise huge pages for " << mapped_size
+                << " bytes, error code is " << errno;
+      }
+    }
+
+    {
+      std::lock_guard<SpinLock> guard(spinlock_);
+      mappings_[reinterpret_cast<uintptr_t>(p)] =
+          std::make_pair(mapped_size, is_hugetlb);
+    }
+    requested_size_ += mapped_size;
+    HOST_MEMORY_STAT_UPDATE(Reserved, 0, size);
+    VLOG(10) << "Map " << mapped_size << " bytes for huge pages at " << p
+             << (is_hugetlb ? " from hugetlbfs" : "");
+    return new HugePageAllocation(p, size, mapped_size);
+  }
+#endif
+
+  void* p;
+#ifdef _WIN32
+  p = _aligned_malloc(size, CPUAllocator::kAlignment);
+#else
+  int error = posix_memalign(&p, CPUAllocator::kAlignment, size);
+  PADDLE_ENFORCE_EQ(
+      error,
+      0,
+      platform::errors::ResourceExhausted(
+          "Fail to alloc memory of %ld size, error code is %d.", size, error));
+#endif
+  HOST_MEMORY_STAT_UPDATE(Reserved, 0, size);
+  return new HugePageAllocation(p, size, 0);
+}
+
+void HugePageAllocator::FreeImpl(phi::Allocation* allocation) {
+  size_t size = allocation->size();
+  size_t mapped_size =
+      static_cast<HugePageAllocation*>(allocation)->mapped_size();
+  if (mapped_size > 0) {
+    {
+      std::lock_guard<SpinLock> guard(spinlock_);
+      mappings_.erase(reinterpret_cast<uintptr_t>(allocation->ptr()));
+    }
+    requested_size_ -= mapped_size;
+#ifdef __linux__
+    munmap(allocation->ptr(), mapped_size);
+#endif
+  } else {
+#ifdef _WIN32
+    _aligned_free(allocation->ptr());
+#else
+    free(allocation->ptr());
+#endif
+  }
+  HOST_MEMORY_STAT_UPDATE(Reserved, 0, -size);
+  delete allocation;
+}
+
+size_t HugePageAllocator::GrantedHugePageSize() const {
+  std::vector<std::pair<uintptr_t, uintptr_t>> ranges;
+  size_t granted_size = 0;
+  {
+    std::lock_guard<SpinLock> guard(spinlock_);
+    for (auto& item : mappings_) {
+      if (item.second.second) {
+        // The hugetlbfs pages are reserved when mapped.
+        granted_size += item.second.first;
+      } else {
+        ranges.emplace_back(item.first, item.first + item.second.first);
+      }
+    }
+  }
+  if (ranges.empty()) {
+    return granted_size;
+  }
+
+  // Sum up the AnonHugePages of the VMAs overlapping the mappings, which are
+  // listed in /proc/self/smaps as:
+  //   7f2c40000000-7f2c40400000 rw-p 00000000 00:00 0
+  //   ...
+  //   AnonHugePages:      4096 kB
+  std::ifstream fin("/proc/self/smaps");
+  std::string line;
+  size_t overlap = 0;
+  while (std::getline(fin, line)) {
+    if (line.compare(0, 14, "AnonHugePages:") == 0) {
+      if (overlap > 0) {
+        size_t huge_kb = std::strtoull(line.c_str() + 14, nullptr, 10);
+        granted_size += std::min(overlap, huge_kb << 10);
+      }
+      continue;
+    }
+    size_t dash = line.find('-');
+    size_t space = line.find(' ');
+    if (dash == std::string::npos || space == std::string::npos ||
+        dash > space || line.find(':') < space) {
+      continue;
+    }
+    uintptr_t start = std::strtoull(line.c_str(), nullptr, 16);
+    uintptr_t end = std::strtoull(line.c_str() + dash + 1, nullptr, 16);
+    overlap = 0;
+    for (auto& range : ranges) {
+      uintptr_t lo = std::max(start, range.first);
+      uintptr_t hi = std::min(end, range.second);
+      if (lo < hi) {
+        overlap += hi - lo;
+      }
+    }
+  }
+  return granted_size;
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,66 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <map>
+
+#include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/memory/allocation/spin_lock.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// HugePageAllocator backs the CPU allocations of at least kHugePageSize with
+// huge pages, to reduce the TLB misses of large tensors such as embedding
+// tables and weights. The allocations are mapped 2MB aligned and advised with
+// MADV_HUGEPAGE, so that the transparent huge pages can be used. If
+// use_hugetlb is set, they are mapped from the explicit hugetlbfs pool first,
+// falling back to the transparent huge pages when the pool is exhausted.
+//
+// The kernel may still back an advised range with normal pages, so the bytes
+// actually backed by huge pages are read from /proc/self/smaps by
+// GrantedHugePageSize. The smaller allocations and the other systems than
+// Linux are served like CPUAllocator.
+class HugePageAllocator : public Allocator {
+ public:
+  static constexpr size_t kHugePageSize = 2 << 20;
+
+  explicit HugePageAllocator(bool use_hugetlb = false);
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // The bytes mapped for huge pages, and the bytes among them which are
+  // actually backed by huge pages.
+  size_t RequestedHugePageSize() const { return requested_size_; }
+  size_t GrantedHugePageSize() const;
+
+ protected:
+  phi::Allocation* AllocateImpl(size_t size) override;
+  void FreeImpl(phi::Allocation* allocation) override;
+
+ private:
+  bool use_hugetlb_;
+  std::atomic<size_t> requested_size_{0};
+
+  mutable SpinLock spinlock_;
+  // start address -> (size, is hugetlb) of the live huge page mappings
+  std::map<uintptr_t, std::pair<size_t, bool>> mappings_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,116 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the embedding lookup and the GEMM on the memory with and without
+// huge pages:
+//   ./huge_page_allocator_benchmark
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/fluid/memory/allocation/cpu_allocator.h"
+#include "paddle/fluid/memory/allocation/huge_page_allocator.h"
+
+namespace {
+using paddle::memory::allocation::Allocator;
+using paddle::memory::allocation::CPUAllocator;
+using paddle::memory::allocation::HugePageAllocator;
+
+constexpr size_t kRows = 1 << 19;
+constexpr size_t kWidth = 64;
+constexpr size_t kLookups = 1 << 21;
+constexpr size_t kM = 768;
+
+double Seconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// Gathers and sums random rows of a 128MB table.
+double EmbeddingLookup(Allocator* allocator, const std::vector<size_t>& ids) {
+  auto table = allocator->Allocate(kRows * kWidth * sizeof(float));
+  auto* table_data = static_cast<float*>(table->ptr());
+  for (size_t i = 0; i < kRows * kWidth; ++i) {
+    table_data[i] = 1.0f;
+  }
+  std::vector<float> out(kWidth, 0.0f);
+  auto start = std::chrono::steady_clock::now();
+  for (size_t id : ids) {
+    const float* row = table_data + id * kWidth;
+    for (size_t j = 0; j < kWidth; ++j) {
+      out[j] += row[j];
+    }
+  }
+  double seconds = Seconds(start);
+  CHECK_EQ(out[0], static_cast<float>(ids.size()));
+  return seconds;
+}
+
+// C = A * B of kM x kM matrices of more than a huge page each, B is read by
+// columns.
+double Gemm(Allocator* allocator) {
+  size_t bytes = kM * kM * sizeof(float);
+  auto a = allocator->Allocate(bytes);
+  auto b = allocator->Allocate(bytes);
+  auto c = allocator->Allocate(bytes);
+  auto* a_data = static_cast<float*>(a->ptr());
+  auto* b_data = static_cast<float*>(b->ptr());
+  auto* c_data = static_cast<float*>(c->ptr());
+  for (size_t i = 0; i < kM * kM; ++i) {
+    a_data[i] = 1.0f;
+    b_data[i] = 2.0f;
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kM; ++i) {
+    for (size_t j = 0; j < kM; ++j) {
+      float sum = 0.0f;
+      for (size_t k = 0; k < kM; ++k) {
+        sum += a_data[i * kM + k] * b_data[k * kM + j];
+      }
+      c_data[i * kM + j] = sum;
+    }
+  }
+  double seconds = Seconds(start);
+  CHECK_EQ(c_data[0], 2.0f * kM);
+  return seconds;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<size_t> dist(0, kRows - 1);
+  std::vector<size_t> ids(kLookups);
+  for (auto& id : ids) {
+    id = dist(rng);
+  }
+
+  std::vector<std::pair<std::string, std::shared_ptr<Allocator>>> allocators;
+  allocators.emplace_back("CPUAllocator", std::make_shared<CPUAllocator>());
+  allocators.emplace_back("HugePageAllocator",
+                          std::make_shared<HugePageAllocator>());
+  for (auto& item : allocators) {
+    double lookup_seconds = EmbeddingLookup(item.second.get(), ids);
+    double gemm_seconds = Gemm(item.second.get());
+    LOG(INFO) << item.first << ": embedding lookup " << lookup_seconds
+              << "s, gemm " << gemm_seconds << "s";
+  }
+  return 0;
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/huge_page_allocator.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+TEST(HugePageAllocator, Allocate) {
+  for (bool use_hugetlb : {false, true}) {
+    HugePageAllocator allocator(use_hugetlb);
+    // Served like CPUAllocator
+    auto small_allocation = allocator.Allocate(1024);
+    ASSERT_EQ(small_allocation->size(), 1024UL);
+    memset(small_allocation->ptr(), 1, small_allocation->size());
+    EXPECT_EQ(allocator.RequestedHugePageSize(), 0UL);
+
+    size_t size = 3 * HugePageAllocator::kHugePageSize + 1;
+    auto allocation = allocator.Allocate(size);
+    ASSERT_EQ(allocation->size(), size);
+    memset(allocation->ptr(), 1, size);
+#ifdef __linux__
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(allocation->ptr()) %
+                  HugePageAllocator::kHugePageSize,
+              0UL);
+    EXPECT_EQ(allocator.RequestedHugePageSize(),
+              4 * HugePageAllocator::kHugePageSize);
+#endif
+    // The kernel may not grant any huge page, e.g., when the transparent huge
+    // pages are disabled.
+    size_t granted_size = allocator.GrantedHugePageSize();
+    LOG(INFO) << "Granted " << granted_size << " of "
+              << allocator.RequestedHugePageSize() << " bytes of huge pages"
+              << (use_hugetlb ? " with hugetlbfs" : "");
+    EXPECT_LE(granted_size, allocator.RequestedHugePageSize());
+
+    allocation.reset();
+    small_allocation.reset();
+    EXPECT_EQ(allocator.RequestedHugePageSize(), 0UL);
+    EXPECT_EQ(allocator.GrantedHugePageSize(), 0UL);
+  }
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -19,8 +19,11 @@
 #include <fcntl.h>
 #include <stdlib.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <atomic>
+#include <cerrno>
 #include <random>
 #include <string>
 
@@ -298,6 +301,47 @@ std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
   return std::make_shared<MemoryMapReaderAllocation>(ptr, size, ipc_name);
 }
 
+MappedFileAllocation::~MappedFileAllocation() {
+  if (munmap(this->ptr(), this->size()) == -1) {
+    LOG(WARNING) << "Could not unmap the file " << file_name_
+                 << ", error code is " << errno;
+  }
+}
+
+std::shared_ptr<MappedFileAllocation> MapFile(const std::string &file_name) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  PADDLE_ENFORCE_NE(
+      fd,
+      -1,
+      platform::errors::Unavailable("Fail to open file %s.", file_name));
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == -1) {
+    close(fd);
+    PADDLE_THROW(
+        platform::errors::Unavailable("Fail to stat file %s.", file_name));
+  }
+  size_t size = static_cast<size_t>(file_stat.st_size);
+  if (size == 0) {
+    close(fd);
+    PADDLE_THROW(platform::errors::InvalidArgument(
+        "Fail to map file %s, which is empty.", file_name));
+  }
+  // The pages are mapped writable but private, so that the in-place updates,
+  // e.g., by the fusion passes, copy the pages instead of writing the file.
+  void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  PADDLE_ENFORCE_NE(ptr,
+                    MAP_FAILED,
+                    platform::errors::Unavailable(
+                        "Memory map failed when mapping file %s of %ld size, "
+                        "error code is %d.",
+                        file_name,
+                        size,
+                        errno));
+  VLOG(4) << "Map file " << file_name << " of " << size << " bytes at " << ptr;
+  return std::make_shared<MappedFileAllocation>(ptr, size, file_name);
+}
+
 MemoryMapFdSet &MemoryMapFdSet::Instance() {  // NOLINT
   static MemoryMapFdSet set;
   return set;
@@ -140,6 +140,25 @@ std::shared_ptr<MemoryMapWriterAllocation> AllocateMemoryMapWriterAllocation(
 std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
     const std::string &ipc_name, size_t size);
 
+// A regular file mapped copy-on-write. The pages are shared with the page
+// cache, and thus with the other processes mapping the same file, until they
+// are written, e.g., the model parameters loaded by several predictors.
+class MappedFileAllocation : public Allocation {
+ public:
+  explicit MappedFileAllocation(void *ptr, size_t size, std::string file_name)
+      : Allocation(ptr, size, platform::CPUPlace()),
+        file_name_(std::move(file_name)) {}
+
+  inline const std::string &file_name() const { return file_name_; }
+
+  ~MappedFileAllocation() override;
+
+ private:
+  std::string file_name_;
+};
+
+std::shared_ptr<MappedFileAllocation> MapFile(const std::string &file_name);
+
 class MemoryMapFdSet {
  public:
   static MemoryMapFdSet &Instance();  // NOLINT
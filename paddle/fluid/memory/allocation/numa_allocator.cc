@@ -0,0 +1,288 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/numa_allocator.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <fstream>
+#include <string>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "paddle/fluid/memory/allocation/cpu_allocator.h"
+#include "paddle/fluid/memory/stats.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+constexpr int NUMAAllocator::kLocalNode;
+constexpr int NUMAAllocator::kInterleave;
+constexpr int NUMAAllocator::kMaxNumaNodes;
+constexpr size_t NUMAAllocator::kMinBindSize;
+
+namespace {
+
+#ifdef __linux__
+// Defined in <numaif.h> of libnuma, which is not a dependency of Paddle.
+constexpr int kMpolPreferred = 1;
+constexpr int kMpolInterleave = 3;
+#endif
+
+struct NumaMemoryStat {
+  std::atomic<int64_t> current{0};
+  std::atomic<int64_t> peak{0};
+};
+
+NumaMemoryStat* GetNumaMemoryStats() {
+  static NumaMemoryStat stats[NUMAAllocator::kMaxNumaNodes];
+  return stats;
+}
+
+void NumaMemoryStatUpdate(int numa_node, int64_t increment) {
+  if (numa_node < 0 || numa_node >= NUMAAllocator::kMaxNumaNodes) {
+    return;
+  }
+  NumaMemoryStat& stat = GetNumaMemoryStats()[numa_node];
+  int64_t current = stat.current.fetch_add(increment) + increment;
+  int64_t peak = stat.peak.load();
+  while (current > peak && !stat.peak.compare_exchange_weak(peak, current)) {
+  }
+}
+
+thread_local int current_thread_numa_node = NUMAAllocator::kLocalNode;
+
+// Reads the online nodes from sysfs, e.g., "0-1".
+int ReadNumNodes() {
+  std::ifstream fin("/sys/devices/system/node/online");
+  std::string online;
+  if (!fin || !std::getline(fin, online) || online.empty()) {
+    return 1;
+  }
+  size_t pos = online.find_last_of(",-");
+  int last_node =
+      std::atoi(online.c_str() + (pos == std::string::npos ? 0 : pos + 1));
+  return std::max(1, std::min(last_node + 1, NUMAAllocator::kMaxNumaNodes));
+}
+
+class NUMAAllocation : public Allocation {
+ public:
+  NUMAAllocation(void* ptr, size_t size, size_t mapped_size, int numa_node)
+      : Allocation(ptr, size, platform::CPUPlace()),
+        mapped_size_(mapped_size),
+        numa_node_(numa_node) {}
+
+  // 0 if the memory is not mapped by mmap.
+  size_t mapped_size() const { return mapped_size_; }
+
+  int numa_node() const { return numa_node_; }
+
+ private:
+  size_t mapped_size_;
+  int numa_node_;
+};
+
+}  // namespace
+
+NUMAAllocator::NUMAAllocator(int numa_node) : numa_node_(numa_node) {
+  PADDLE_ENFORCE_EQ(
+      numa_node >= kInterleave && numa_node < kMaxNumaNodes,
+      true,
+      platform::errors::InvalidArgument(
+          "The NUMA node should be in [%d, %d), but got %d.",
+          kInterleave,
+          kMaxNumaNodes,
+          numa_node));
+  if (numa_node >= NumNodes()) {
+    LOG(WARNING) << "NUMA node " << numa_node << " does not exist, there are "
+                 << NumNodes() << " nodes, use the local node instead.";
+    numa_node_ = kLocalNode;
+  }
+  VLOG(4) << "NUMAAllocator on node " << numa_node_ << " of " << NumNodes()
+          << " nodes";
+}
+
+int NUMAAllocator::NumNodes() {
+  static int num_nodes = ReadNumNodes();
+  return num_nodes;
+}
+
+int NUMAAllocator::CurrentThreadNumaNode() {
+  if (current_thread_numa_node >= 0) {
+    return current_thread_numa_node;
+  }
+#ifdef __linux__
+  unsigned cpu = 0, numa_node = 0;
+  if (syscall(SYS_getcpu, &cpu, &numa_node, nullptr) == 0) {
+    return static_cast<int>(numa_node);
+  }
+#endif
+  return 0;
+}
+
+void NUMAAllocator::SetCurrentThreadNumaNode(int numa_node) {
+  PADDLE_ENFORCE_EQ(
+      numa_node == kLocalNode || (numa_node >= 0 && numa_node < NumNodes()),
+      true,
+      platform::errors::InvalidArgument(
+          "The NUMA node should be in [0, %d) or kLocalNode, but got %d.",
+          NumNodes(),
+          numa_node));
+  current_thread_numa_node = numa_node;
+}
+
+int NUMAAllocator::GetPageNumaNode(const void* ptr) {
+#ifdef __linux__
+  void* page = reinterpret_cast<void*>(
+      reinterpret_cast<uintptr_t>(ptr) &
+      ~(static_cast<uintptr_t>(sysconf(_SC_PAGESIZE)) - 1));
+  int status = -1;
+  // move_pages only queries the nodes when the target nodes are null.
+  if (syscall(SYS_move_pages, 0, 1, &page, nullptr, &status, 0) == 0 &&
+      status >= 0) {
+    return status;
+  }
+#endif
+  return -1;
+}
+
+phi::Allocation* NUMAAllocator::AllocateImpl(size_t size) {
+#ifdef __linux__
+  if (size >= kMinBindSize && NumNodes() > 1) {
+    size_t mapped_size =
+        AlignedSize(size, static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+    void* p = mmap(nullptr,
+                   mapped_size,
+                   PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS,
+                   -1,
+                   0);
+    PADDLE_ENFORCE_NE(p,
+                      MAP_FAILED,
+                      platform::errors::ResourceExhausted(
+                          "Fail to map memory of %ld size, error code is %d.",
+                          mapped_size,
+                          errno));
+
+    int numa_node =
+        numa_node_ == kLocalNode ? CurrentThreadNumaNode() : numa_node_;
+    unsigned long nodemask = 0;  // NOLINT
+    int mode = kMpolPreferred;
+    if (numa_node == kInterleave) {
+      mode = kMpolInterleave;
+      for (int i = 0; i < NumNodes(); ++i) {
+        nodemask |= 1UL << i;
+      }
+    } else if (numa_node < kMaxNumaNodes) {
+      nodemask = 1UL << numa_node;
+    }
+    // The pages are not touched yet, so they are placed by the policy when
+    // first written. MPOL_PREFERRED falls back to the other nodes instead of
+    // failing when the node is out of memory.
+    bool bound = nodemask != 0 && syscall(SYS_mbind,
+                                          p,
+                                          mapped_size,
+                                          mode,
+                                          &nodemask,
+                                          kMaxNumaNodes + 1,
+                                          0) == 0;
+    if (!bound) {
+      VLOG(4) << "Fail to bind " << mapped_size << " bytes to NUMA node "
+              << numa_node << ", error code is " << errno;
+      numa_node = kLocalNode;
+    }
+
+    if (numa_node == kInterleave) {
+      for (int i = 0; i < NumNodes(); ++i) {
+        NumaMemoryStatUpdate(i, mapped_size / NumNodes());
+      }
+    } else {
+      NumaMemoryStatUpdate(numa_node, mapped_size);
+    }
+    HOST_MEMORY_STAT_UPDATE(Reserved, 0, size);
+    return new NUMAAllocation(p, size, mapped_size, numa_node);
+  }
+#endif
+
+  void* p;
+#ifdef _WIN32
+  p = _aligned_malloc(size, CPUAllocator::kAlignment);
+#else
+  int error = posix_memalign(&p, CPUAllocator::kAlignment, size);
+  PADDLE_ENFORCE_EQ(
+      error,
+      0,
+      platform::errors::ResourceExhausted(
+          "Fail to alloc memory of %ld size, error code is %d.", size, error));
+#endif
+  HOST_MEMORY_STAT_UPDATE(Reserved, 0, size);
+  return new NUMAAllocation(p, size, 0, kLocalNode);
+}
+
+void NUMAAllocator::FreeImpl(phi::Allocation* allocation) {
+  auto* numa_allocation = static_cast<NUMAAllocation*>(allocation);
+  size_t size = allocation->size();
+  size_t mapped_size = numa_allocation->mapped_size();
+  if (mapped_size > 0) {
+#ifdef __linux__
+    munmap(allocation->ptr(), mapped_size);
+#endif
+    int numa_node = numa_allocation->numa_node();
+    if (numa_node == kInterleave) {
+      int64_t node_size = mapped_size / NumNodes();
+      for (int i = 0; i < NumNodes(); ++i) {
+        NumaMemoryStatUpdate(i, -node_size);
+      }
+    } else {
+      NumaMemoryStatUpdate(numa_node, -static_cast<int64_t>(mapped_size));
+    }
+  } else {
+#ifdef _WIN32
+    _aligned_free(allocation->ptr());
+#else
+    free(allocation->ptr());
+#endif
+  }
+  HOST_MEMORY_STAT_UPDATE(Reserved, 0, -size);
+  delete allocation;
+}
+
+int64_t NumaMemoryStatCurrentValue(int numa_node) {
+  PADDLE_ENFORCE_EQ(
+      numa_node >= 0 && numa_node < NUMAAllocator::kMaxNumaNodes,
+      true,
+      platform::errors::OutOfRange("Invalid NUMA node %d.", numa_node));
+  return GetNumaMemoryStats()[numa_node].current.load();
+}
+
+int64_t NumaMemoryStatPeakValue(int numa_node) {
+  PADDLE_ENFORCE_EQ(
+      numa_node >= 0 && numa_node < NUMAAllocator::kMaxNumaNodes,
+      true,
+      platform::errors::OutOfRange("Invalid NUMA node %d.", numa_node));
+  return GetNumaMemoryStats()[numa_node].peak.load();
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,77 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+
+#include "paddle/fluid/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// NUMAAllocator allocates CPU memory whose pages are placed on a NUMA node.
+// The large allocations are mapped directly and bound with mbind to:
+//   - numa_node, if it is not negative;
+//   - the node of the allocating thread, if numa_node is kLocalNode. A thread
+//     can also choose its node with SetCurrentThreadNumaNode, e.g., a
+//     predictor pinned to one socket;
+//   - all the nodes page by page, if numa_node is kInterleave.
+// The small allocations are served like CPUAllocator, since binding them
+// costs more than the remote accesses it saves.
+//
+// On a machine with a single node, or on other systems than Linux, it works
+// like CPUAllocator.
+class NUMAAllocator : public Allocator {
+ public:
+  static constexpr int kLocalNode = -1;
+  static constexpr int kInterleave = -2;
+  static constexpr int kMaxNumaNodes = 64;
+  // The allocations smaller than this are not bound.
+  static constexpr size_t kMinBindSize = 64 << 10;
+
+  explicit NUMAAllocator(int numa_node = kLocalNode);
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // Returns the number of the NUMA nodes, 1 if the topology is unknown.
+  static int NumNodes();
+
+  // Returns the node of the calling thread, i.e., the node set by
+  // SetCurrentThreadNumaNode or the node of the cpu it is running on.
+  static int CurrentThreadNumaNode();
+
+  // Let the allocations of the calling thread be placed on numa_node by the
+  // NUMAAllocators of kLocalNode, kLocalNode resets it.
+  static void SetCurrentThreadNumaNode(int numa_node);
+
+  // Returns the node of the page containing ptr, or -1 if it is unknown.
+  static int GetPageNumaNode(const void* ptr);
+
+ protected:
+  phi::Allocation* AllocateImpl(size_t size) override;
+  void FreeImpl(phi::Allocation* allocation) override;
+
+ private:
+  int numa_node_;
+};
+
+// The bytes bound to each NUMA node by NUMAAllocator.
+int64_t NumaMemoryStatCurrentValue(int numa_node);
+int64_t NumaMemoryStatPeakValue(int numa_node);
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
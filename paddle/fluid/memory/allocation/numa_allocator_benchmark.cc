@@ -0,0 +1,66 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the read bandwidth of the memory on the local node with the memory
+// interleaved over all the nodes. They are the same on a single node machine:
+//   ./numa_allocator_benchmark
+
+#include <chrono>
+
+#include "glog/logging.h"
+#include "paddle/fluid/memory/allocation/numa_allocator.h"
+
+namespace {
+using paddle::memory::allocation::NUMAAllocator;
+
+constexpr size_t kSize = 256 << 20;
+constexpr int kRepeat = 5;
+
+// Returns the read bandwidth in GB/s.
+double ReadBandwidth(int numa_node) {
+  NUMAAllocator allocator(numa_node);
+  auto allocation = allocator.Allocate(kSize);
+  auto* data = static_cast<int64_t*>(allocation->ptr());
+  size_t num = kSize / sizeof(int64_t);
+  for (size_t i = 0; i < num; ++i) {
+    data[i] = 1;
+  }
+
+  int64_t sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < kRepeat; ++r) {
+    for (size_t i = 0; i < num; ++i) {
+      sum += data[i];
+    }
+  }
+  double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+  CHECK_EQ(sum, static_cast<int64_t>(num) * kRepeat);
+  return kSize * kRepeat / seconds / (1 << 30);
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  for (int numa_node :
+       {NUMAAllocator::kLocalNode, NUMAAllocator::kInterleave}) {
+    double bandwidth = ReadBandwidth(numa_node);
+    LOG(INFO) << (numa_node == NUMAAllocator::kLocalNode ? "Local"
+                                                         : "Interleaved")
+              << " placement on " << NUMAAllocator::NumNodes()
+              << " nodes: " << bandwidth << " GB/s";
+  }
+  return 0;
+}
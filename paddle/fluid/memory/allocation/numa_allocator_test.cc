@@ -0,0 +1,77 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/numa_allocator.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+TEST(NUMAAllocator, Allocate) {
+  int num_nodes = NUMAAllocator::NumNodes();
+  ASSERT_GE(num_nodes, 1);
+  for (int numa_node :
+       {NUMAAllocator::kLocalNode, 0, NUMAAllocator::kInterleave}) {
+    NUMAAllocator allocator(numa_node);
+    for (size_t size : {1024UL, 4UL << 20}) {
+      int64_t reserved = NumaMemoryStatCurrentValue(0);
+      auto allocation = allocator.Allocate(size);
+      ASSERT_NE(allocation->ptr(), nullptr);
+      ASSERT_EQ(allocation->size(), size);
+      ASSERT_EQ(reinterpret_cast<uintptr_t>(allocation->ptr()) % 4096, 0UL);
+      memset(allocation->ptr(), 1, size);
+
+      // Only the large allocations are bound, and only if there are several
+      // nodes.
+      bool bound = num_nodes > 1 && size >= NUMAAllocator::kMinBindSize;
+      if (bound && numa_node == 0) {
+        EXPECT_EQ(NUMAAllocator::GetPageNumaNode(allocation->ptr()), 0);
+        EXPECT_GE(NumaMemoryStatCurrentValue(0),
+                  reserved + static_cast<int64_t>(size));
+      } else if (!bound) {
+        EXPECT_EQ(NumaMemoryStatCurrentValue(0), reserved);
+      }
+      allocation.reset();
+      EXPECT_EQ(NumaMemoryStatCurrentValue(0), reserved);
+    }
+  }
+}
+
+TEST(NUMAAllocator, CurrentThreadNumaNode) {
+  int num_nodes = NUMAAllocator::NumNodes();
+  NUMAAllocator::SetCurrentThreadNumaNode(num_nodes - 1);
+  EXPECT_EQ(NUMAAllocator::CurrentThreadNumaNode(), num_nodes - 1);
+
+  NUMAAllocator allocator(NUMAAllocator::kLocalNode);
+  auto allocation = allocator.Allocate(4 << 20);
+  memset(allocation->ptr(), 1, allocation->size());
+  if (num_nodes > 1) {
+    EXPECT_EQ(NUMAAllocator::GetPageNumaNode(allocation->ptr()),
+              num_nodes - 1);
+  }
+  allocation.reset();
+
+  NUMAAllocator::SetCurrentThreadNumaNode(NUMAAllocator::kLocalNode);
+  int numa_node = NUMAAllocator::CurrentThreadNumaNode();
+  EXPECT_GE(numa_node, 0);
+  EXPECT_LT(numa_node, num_nodes);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -136,6 +136,8 @@ int RegisterAllStats() {
 
   HOST_MEMORY_STAT_REGISTER(Allocated);
   HOST_MEMORY_STAT_REGISTER(Reserved);
+  HOST_MEMORY_STAT_REGISTER(Cached);
+  HOST_MEMORY_STAT_REGISTER(Idle);
   return 0;
 }
 
@@ -216,6 +216,10 @@ DEVICE_MEMORY_STAT_DECLARE(Reserved);
 
 HOST_MEMORY_STAT_DECLARE(Allocated);
 HOST_MEMORY_STAT_DECLARE(Reserved);
+// Bytes cached by the size classes of AutoGrowthBestFitAllocator.
+HOST_MEMORY_STAT_DECLARE(Cached);
+// Free bytes of the chunks held by AutoGrowthBestFitAllocator.
+HOST_MEMORY_STAT_DECLARE(Idle);
 
 }  // namespace memory
 }  // namespace paddle
@@ -17,6 +17,15 @@ limitations under the License. */
 #include <string>
 #include <vector>
 
+#include "paddle/fluid/platform/flags.h"
+
+PADDLE_DEFINE_EXPORTED_bool(
+    load_combine_use_mmap,
+    false,
+    "Whether load_combine maps the parameter file and shares its pages with "
+    "the CPU tensors instead of copying them, so that the processes loading "
+    "the same model share the memory. The tensors are copy-on-write.");
+
 namespace paddle {
 namespace operators {
 
@@ -25,6 +25,13 @@ limitations under the License. */
 #include "paddle/fluid/framework/string_array.h"
 #include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/platform/device_context.h"
+#include "paddle/phi/core/flags.h"
+
+#ifndef _WIN32
+#include "paddle/fluid/memory/allocation/mmap_allocator.h"
+#endif
+
+PHI_DECLARE_bool(load_combine_use_mmap);
 
 namespace paddle {
 namespace operators {
@@ -45,6 +52,13 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
                           "it to be greater than 0.",
                           out_var_names.size()));
     if (!model_from_memory) {
+#ifndef _WIN32
+      if (FLAGS_load_combine_use_mmap && platform::is_cpu_place(place) &&
+          !HasVocab(ctx)) {
+        LoadParamsFromMappedFile(ctx, filename, load_as_fp16, out_var_names);
+        return;
+      }
+#endif
       std::ifstream fin(filename, std::ios::binary);
       PADDLE_ENFORCE_EQ(
           static_cast<bool>(fin),
@@ -116,27 +130,7 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
         // Get data from fin to tensor
         paddle::framework::DeserializeFromStream(*buffer, tensor, dev_ctx);
 
-        auto in_dtype = tensor->dtype();
-        auto out_dtype = load_as_fp16 ? phi::DataType::FLOAT16 : in_dtype;
-
-        if (in_dtype != out_dtype) {
-          // convert to float16 tensor
-          auto in_kernel_type =
-              phi::KernelKey(place, phi::DataLayout::ALL_LAYOUT, in_dtype);
-          auto out_kernel_type =
-              phi::KernelKey(place, phi::DataLayout::ALL_LAYOUT, out_dtype);
-          phi::DenseTensor fp16_tensor;
-          // copy LoD info to the new tensor
-          fp16_tensor.set_lod(tensor->lod());
-          framework::TransDataType(
-              in_kernel_type, out_kernel_type, *tensor, &fp16_tensor);
-
-          // reset output tensor
-          out_vars[i]->Clear();
-          tensor = out_vars[i]->GetMutable<phi::DenseTensor>();
-          tensor->set_lod(fp16_tensor.lod());
-          tensor->ShareDataWith(fp16_tensor);
-        }
+        ConvertToFP16(place, load_as_fp16, out_vars[i]);
       }
     }
     buffer->peek();
@@ -146,6 +140,76 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
                           "Not allowed to load partial data via "
                           "load_combine_op, please use load_op instead."));
   }
+
+#ifndef _WIN32
+  // Maps the file and lets the tensors share its pages instead of copying
+  // them, so the processes loading the same file share the physical memory,
+  // and only the pages touched are read from the disk.
+  void LoadParamsFromMappedFile(
+      const framework::ExecutionContext &context,
+      const std::string &filename,
+      bool load_as_fp16,
+      const std::vector<std::string> &out_var_names) const {
+    auto buffer = memory::allocation::MapFile(filename);
+    auto out_vars = context.MultiOutputVar("Out");
+    size_t offset = 0;
+    for (size_t i = 0; i < out_var_names.size(); i++) {
+      VLOG(4) << "loading tensor: " << out_var_names[i] << " from "
+              << filename << " mapped";
+      PADDLE_ENFORCE_NOT_NULL(
+          out_vars[i],
+          platform::errors::InvalidArgument(
+              "The variable %s to be loaded cannot be found.",
+              out_var_names[i]));
+      auto *tensor = out_vars[i]->GetMutable<phi::DenseTensor>();
+      framework::DeserializeFromBuffer(buffer, &offset, tensor);
+      ConvertToFP16(context.GetPlace(), load_as_fp16, out_vars[i]);
+    }
+    PADDLE_ENFORCE_EQ(offset,
+                      buffer->size(),
+                      platform::errors::Unavailable(
+                          "Not allowed to load partial data via "
+                          "load_combine_op, please use load_op instead."));
+  }
+#endif
+
+ private:
+  // The vocabularies are only loaded from the stream.
+  bool HasVocab(const framework::ExecutionContext &context) const {
+    for (auto *var : context.MultiOutputVar("Out")) {
+      if (var != nullptr && var->IsType<framework::Vocab>()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void ConvertToFP16(const platform::Place &place,
+                     bool load_as_fp16,
+                     framework::Variable *out_var) const {
+    auto *tensor = out_var->GetMutable<phi::DenseTensor>();
+    auto in_dtype = tensor->dtype();
+    auto out_dtype = load_as_fp16 ? phi::DataType::FLOAT16 : in_dtype;
+
+    if (in_dtype != out_dtype) {
+      // convert to float16 tensor
+      auto in_kernel_type =
+          phi::KernelKey(place, phi::DataLayout::ALL_LAYOUT, in_dtype);
+      auto out_kernel_type =
+          phi::KernelKey(place, phi::DataLayout::ALL_LAYOUT, out_dtype);
+      phi::DenseTensor fp16_tensor;
+      // copy LoD info to the new tensor
+      fp16_tensor.set_lod(tensor->lod());
+      framework::TransDataType(
+          in_kernel_type, out_kernel_type, *tensor, &fp16_tensor);
+
+      // reset output tensor
+      out_var->Clear();
+      tensor = out_var->GetMutable<phi::DenseTensor>();
+      tensor->set_lod(fp16_tensor.lod());
+      tensor->ShareDataWith(fp16_tensor);
+    }
+  }
 };
 
 }  // namespace operators
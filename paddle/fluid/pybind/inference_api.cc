@@ -820,6 +820,10 @@ void BindAnalysisConfig(py::module *m) {
       .def("enable_memory_optim",
            &AnalysisConfig::EnableMemoryOptim,
            py::arg("x") = true)
+      .def("enable_weight_sharing",
+           &AnalysisConfig::EnableWeightSharing,
+           py::arg("x") = true)
+      .def("weight_sharing_enabled", &AnalysisConfig::weight_sharing_enabled)
       .def("enable_profile", &AnalysisConfig::EnableProfile)
       .def("disable_glog_info", &AnalysisConfig::DisableGlogInfo)
       .def("glog_info_disabled", &AnalysisConfig::glog_info_disabled)
@@ -1127,6 +1131,12 @@ void BindPaddleInferPredictor(py::module *m) {
            })
 #endif
       .def("try_shrink_memory", &paddle_infer::Predictor::TryShrinkMemory)
+      .def("get_weight_memory_size",
+           [](paddle_infer::Predictor &self) {
+             uint64_t shared_size = 0;
+             uint64_t size = self.GetWeightMemorySize(&shared_size);
+             return std::make_pair(size, shared_size);
+           })
       .def("clear_intermediate_tensor",
            &paddle_infer::Predictor::ClearIntermediateTensor)
       .def("register_output_hook",
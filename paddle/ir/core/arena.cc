@@ -0,0 +1,85 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/ir/core/arena.h"
+
+#include "paddle/ir/core/enforce.h"
+#include "paddle/ir/core/utils.h"
+
+namespace ir {
+
+constexpr size_t Arena::kAlignment;
+constexpr size_t Arena::kDefaultSlabSize;
+
+Arena::Arena(size_t slab_size) : slab_size_(AlignedSize(slab_size)) {}
+
+Arena::~Arena() {
+  for (void *slab : slabs_) {
+    aligned_free(slab);
+  }
+}
+
+char *Arena::NewSlab(size_t size) {
+  void *slab = aligned_malloc(size, kAlignment);
+  IR_ENFORCE(slab != nullptr, "Allocate a slab of %d bytes failed.", size);
+  slabs_.push_back(slab);
+  reserved_bytes_ += size;
+  return reinterpret_cast<char *>(slab);
+}
+
+void *Arena::Allocate(size_t size) {
+  size = AlignedSize(size);
+  allocated_bytes_ += size;
+
+  // 1. Reuse the recycled memory of the same size.
+  size_t index = size / kAlignment;
+  if (index < free_lists_.size() && free_lists_[index] != nullptr) {
+    FreeNode *node = free_lists_[index];
+    free_lists_[index] = node->next;
+    return node;
+  }
+
+  // 2. Large objects get a dedicated slab, so that they don't waste the tail
+  // of the current slab.
+  if (size > slab_size_ / 2) {
+    return NewSlab(size);
+  }
+
+  // 3. Bump from the current slab.
+  if (cur_ == nullptr || static_cast<size_t>(end_ - cur_) < size) {
+    cur_ = NewSlab(slab_size_);
+    end_ = cur_ + slab_size_;
+  }
+  char *ptr = cur_;
+  cur_ += size;
+  return ptr;
+}
+
+void Arena::Deallocate(void *ptr, size_t size) {
+  if (ptr == nullptr) return;
+  size = AlignedSize(size);
+  allocated_bytes_ -= size;
+  // The dedicated slabs of large objects are held until the arena is
+  // destroyed.
+  if (size > slab_size_ / 2) return;
+  size_t index = size / kAlignment;
+  if (index >= free_lists_.size()) {
+    free_lists_.resize(index + 1, nullptr);
+  }
+  FreeNode *node = reinterpret_cast<FreeNode *>(ptr);
+  node->next = free_lists_[index];
+  free_lists_[index] = node;
+}
+
+}  // namespace ir
@@ -0,0 +1,88 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace ir {
+
+///
+/// \brief Arena is a bump allocator used to hold the storage of the IR
+/// objects (Operation, Region, Block and the use lists) of a Program. Memory
+/// is carved out of large slabs, and all slabs are released at once when the
+/// arena is destroyed. Deallocated memory is recycled by size class, so
+/// erasing and re-creating operations does not grow the arena.
+/// NOTE: Arena is not thread safe, same as the Program which owns it.
+///
+class Arena {
+ public:
+  static constexpr size_t kAlignment = 8;
+  static constexpr size_t kDefaultSlabSize = 256 * 1024;
+
+  explicit Arena(size_t slab_size = kDefaultSlabSize);
+
+  ~Arena();
+
+  ///
+  /// \brief Allocate 8-byte aligned memory of the given size.
+  ///
+  void *Allocate(size_t size);
+
+  ///
+  /// \brief Return the memory allocated by Allocate to the arena, the memory
+  /// will be reused by the following allocations of the same size. Objects
+  /// larger than half of a slab are not recycled.
+  ///
+  void Deallocate(void *ptr, size_t size);
+
+  /// The total bytes of all slabs held by this arena.
+  size_t reserved_bytes() const { return reserved_bytes_; }
+
+  /// The bytes handed out by Allocate and not yet deallocated.
+  size_t allocated_bytes() const { return allocated_bytes_; }
+
+  size_t num_slabs() const { return slabs_.size(); }
+
+ private:
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  struct FreeNode {
+    FreeNode *next;
+  };
+
+  static size_t AlignedSize(size_t size) {
+    return (size + kAlignment - 1) / kAlignment * kAlignment;
+  }
+
+  char *NewSlab(size_t size);
+
+  size_t slab_size_;
+
+  // The current slab to bump from.
+  char *cur_{nullptr};
+  char *end_{nullptr};
+
+  std::vector<void *> slabs_;
+
+  // free_lists_[i] holds the recycled memory of size (i * kAlignment).
+  std::vector<FreeNode *> free_lists_;
+
+  size_t reserved_bytes_{0};
+  size_t allocated_bytes_{0};
+};
+
+}  // namespace ir
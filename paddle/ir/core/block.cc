@@ -13,11 +13,33 @@
 // limitations under the License.
 
 #include "paddle/ir/core/block.h"
+
+#include <new>
+
+#include "paddle/ir/core/arena.h"
 #include "paddle/ir/core/operation.h"
 #include "paddle/ir/core/region.h"
 
 namespace ir {
 Block::~Block() { clear(); }
+
+Block *Block::Create(Arena *arena) {
+  if (arena == nullptr) return new Block;
+  Block *block = new (arena->Allocate(sizeof(Block))) Block;
+  block->arena_ = arena;
+  return block;
+}
+
+void Block::Destroy() {
+  if (arena_ == nullptr) {
+    delete this;
+    return;
+  }
+  Arena *arena = arena_;
+  this->~Block();
+  arena->Deallocate(this, sizeof(Block));
+}
+
 void Block::push_back(Operation *op) { insert(ops_.end(), op); }
 
 void Block::push_front(Operation *op) { insert(ops_.begin(), op); }
@@ -32,6 +54,11 @@ Block::iterator Block::insert(const_iterator iterator, Operation *op) {
   return iter;
 }
 
+Block::iterator Block::erase(const_iterator position) {
+  (*position)->Destroy();
+  return ops_.erase(position);
+}
+
 void Block::clear() {
   while (!empty()) {
     ops_.back()->Destroy();
@@ -18,6 +18,7 @@
 #include <list>
 
 namespace ir {
+class Arena;
 class Region;
 class Operation;
 
@@ -30,6 +31,14 @@ class Block {
   Block() = default;
   ~Block();
 
+  ///
+  /// \brief Create a block, the memory is allocated from arena if it is not
+  /// nullptr. NOTE: Blocks created by Create() or new can both be released by
+  /// Destroy().
+  ///
+  static Block *Create(Arena *arena = nullptr);
+  void Destroy();
+
   Region *GetParent() const { return parent_; }
   Operation *GetParentOp() const;
 
@@ -46,6 +55,8 @@ class Block {
   void push_back(Operation *op);
   void push_front(Operation *op);
   iterator insert(const_iterator iterator, Operation *op);
+  /// Remove the operation at position from this block and destroy it.
+  iterator erase(const_iterator position);
   void clear();
 
  private:
@@ -56,7 +67,8 @@ class Block {
   void SetParent(Region *parent) { parent_ = parent; }
 
  private:
-  Region *parent_;              // not owned
+  Region *parent_{nullptr};     // not owned
+  Arena *arena_{nullptr};       // not owned
   std::list<Operation *> ops_;  // owned
 };
 }  // namespace ir
@@ -19,7 +19,7 @@
 namespace ir {
 /// Create an operation given the fields represented as an OperationState.
 Operation *Builder::Build(OperationArgument &&argument) {
-  return Insert(Operation::Create(std::move(argument)));
+  return Insert(Operation::Create(std::move(argument), arena()));
 }
 
 /// Creates an operation with the given fields.
@@ -30,9 +30,15 @@ Operation *Builder::Build(const std::vector<OpResult> &inputs,
   return Build(OperationArgument(inputs, attribute, output_types, op_info));
 }
 
+Arena *Builder::arena() const {
+  Operation *parent_op = block_ ? block_->GetParentOp() : nullptr;
+  return parent_op ? parent_op->arena() : nullptr;
+}
+
 Operation *Builder::Insert(Operation *op) {
   if (block_) {
     block_->insert(insert_point_, op);
+    NotifyOperationInserted(op);
   } else {
     LOG(WARNING) << "Builder's Block is nullptr, insert failed.";
   }
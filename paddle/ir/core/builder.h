@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <iterator>
 #include <list>
 
 #include "paddle/ir/core/block.h"
@@ -30,6 +31,10 @@ class Builder {
       : context_(context), block_(block), insert_point_(insert_point) {}
   Builder(IrContext *context, Block *block)
       : Builder(context, block, block->end()) {}
+  explicit Builder(IrContext *context)
+      : Builder(context, nullptr, Block::iterator{}) {}
+
+  virtual ~Builder() = default;
 
   static Builder AtBlockBegin(IrContext *context, Block *block) {
     return Builder(context, block, block->begin());
@@ -43,6 +48,40 @@ class Builder {
 
   Block *block() const { return block_; }
 
+  Block::iterator insertion_point() const { return insert_point_; }
+
+  /// The arena used to allocate the operations built by this builder, which is
+  /// inherited from the parent operation of the insertion block.
+  Arena *arena() const;
+
+  /// Set the insertion point to the specified location.
+  void SetInsertionPoint(Block *block, Block::iterator insert_point) {
+    block_ = block;
+    insert_point_ = insert_point;
+  }
+
+  /// Sets the insertion point to the specified operation, which will cause
+  /// subsequent insertions to go right before it.
+  void SetInsertionPoint(Operation *op) {
+    SetInsertionPoint(op->GetParent(), Block::iterator(*op));
+  }
+
+  /// Sets the insertion point to the node after the specified operation, which
+  /// will cause subsequent insertions to go right after it.
+  void SetInsertionPointAfter(Operation *op) {
+    SetInsertionPoint(op->GetParent(), std::next(Block::iterator(*op)));
+  }
+
+  /// Sets the insertion point to the start of the specified block.
+  void SetInsertionPointToStart(Block *block) {
+    SetInsertionPoint(block, block->begin());
+  }
+
+  /// Sets the insertion point to the end of the specified block.
+  void SetInsertionPointToEnd(Block *block) {
+    SetInsertionPoint(block, block->end());
+  }
+
   /// Creates an operation given the fields represented as an OperationState.
   Operation *Build(OperationArgument &&argument);
 
@@ -61,6 +100,10 @@ class Builder {
     return op->dyn_cast<OpTy>();
   }
 
+ protected:
+  /// Called after an operation has been inserted by this builder.
+  virtual void NotifyOperationInserted(Operation *op) {}
+
  private:
   Operation *Insert(Operation *op);
 
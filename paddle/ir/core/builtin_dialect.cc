@@ -16,8 +16,36 @@
 #include "paddle/ir/core/builtin_attribute.h"
 #include "paddle/ir/core/builtin_op.h"
 #include "paddle/ir/core/builtin_type.h"
+#include "paddle/ir/core/bytecode.h"
 
 namespace ir {
+namespace {
+// The kinds of the builtin types and attributes in the bytecode, the values
+// are persisted and must not be changed.
+enum class BuiltinTypeKind : uint8_t {
+  kBFloat16 = 0,
+  kFloat16 = 1,
+  kFloat32 = 2,
+  kFloat64 = 3,
+  kInt8 = 4,
+  kInt16 = 5,
+  kInt32 = 6,
+  kInt64 = 7,
+  kBool = 8,
+  kVector = 9,
+};
+
+enum class BuiltinAttributeKind : uint8_t {
+  kStr = 0,
+  kBool = 1,
+  kFloat = 2,
+  kDouble = 3,
+  kInt32 = 4,
+  kInt64 = 5,
+  kArray = 6,
+};
+}  // namespace
+
 BuiltinDialect::BuiltinDialect(IrContext *context)
     : Dialect(name(), context, TypeId::get<BuiltinDialect>()) {
   initialize();
@@ -53,4 +81,134 @@ void BuiltinDialect::initialize() {
               ConstantOp>();
 }
 
+void BuiltinDialect::WriteType(Type type, BytecodeWriter &writer) const {
+  auto write_kind = [&writer](BuiltinTypeKind kind) {
+    writer.WriteByte(static_cast<uint8_t>(kind));
+  };
+  if (type.isa<BFloat16Type>()) {
+    write_kind(BuiltinTypeKind::kBFloat16);
+  } else if (type.isa<Float16Type>()) {
+    write_kind(BuiltinTypeKind::kFloat16);
+  } else if (type.isa<Float32Type>()) {
+    write_kind(BuiltinTypeKind::kFloat32);
+  } else if (type.isa<Float64Type>()) {
+    write_kind(BuiltinTypeKind::kFloat64);
+  } else if (type.isa<Int8Type>()) {
+    write_kind(BuiltinTypeKind::kInt8);
+  } else if (type.isa<Int16Type>()) {
+    write_kind(BuiltinTypeKind::kInt16);
+  } else if (type.isa<Int32Type>()) {
+    write_kind(BuiltinTypeKind::kInt32);
+  } else if (type.isa<Int64Type>()) {
+    write_kind(BuiltinTypeKind::kInt64);
+  } else if (type.isa<BoolType>()) {
+    write_kind(BuiltinTypeKind::kBool);
+  } else if (auto vector_type = type.dyn_cast<VectorType>()) {
+    write_kind(BuiltinTypeKind::kVector);
+    std::vector<Type> data = vector_type.data();
+    writer.WriteVarInt(data.size());
+    for (Type element : data) {
+      writer.WriteType(element);
+    }
+  } else {
+    IR_THROW("The type can't be written into bytecode by builtin dialect.");
+  }
+}
+
+Type BuiltinDialect::ReadType(BytecodeReader &reader) const {
+  IrContext *ctx = ir_context();
+  switch (static_cast<BuiltinTypeKind>(reader.ReadByte())) {
+    case BuiltinTypeKind::kBFloat16:
+      return BFloat16Type::get(ctx);
+    case BuiltinTypeKind::kFloat16:
+      return Float16Type::get(ctx);
+    case BuiltinTypeKind::kFloat32:
+      return Float32Type::get(ctx);
+    case BuiltinTypeKind::kFloat64:
+      return Float64Type::get(ctx);
+    case BuiltinTypeKind::kInt8:
+      return Int8Type::get(ctx);
+    case BuiltinTypeKind::kInt16:
+      return Int16Type::get(ctx);
+    case BuiltinTypeKind::kInt32:
+      return Int32Type::get(ctx);
+    case BuiltinTypeKind::kInt64:
+      return Int64Type::get(ctx);
+    case BuiltinTypeKind::kBool:
+      return BoolType::get(ctx);
+    case BuiltinTypeKind::kVector: {
+      std::vector<Type> data(reader.ReadVarInt());
+      for (auto &element : data) {
+        element = reader.ReadType();
+      }
+      return VectorType::get(ctx, data);
+    }
+  }
+  IR_THROW("Unknown builtin type kind in bytecode.");
+}
+
+void BuiltinDialect::WriteAttribute(Attribute attr,
+                                    BytecodeWriter &writer) const {
+  auto write_kind = [&writer](BuiltinAttributeKind kind) {
+    writer.WriteByte(static_cast<uint8_t>(kind));
+  };
+  if (auto str = attr.dyn_cast<StrAttribute>()) {
+    write_kind(BuiltinAttributeKind::kStr);
+    writer.WriteString(str.data());
+  } else if (auto boolean = attr.dyn_cast<BoolAttribute>()) {
+    write_kind(BuiltinAttributeKind::kBool);
+    writer.WriteByte(boolean.data());
+  } else if (auto fp32 = attr.dyn_cast<FloatAttribute>()) {
+    write_kind(BuiltinAttributeKind::kFloat);
+    writer.WriteFixed(fp32.data());
+  } else if (auto fp64 = attr.dyn_cast<DoubleAttribute>()) {
+    write_kind(BuiltinAttributeKind::kDouble);
+    writer.WriteFixed(fp64.data());
+  } else if (auto int32 = attr.dyn_cast<Int32_tAttribute>()) {
+    write_kind(BuiltinAttributeKind::kInt32);
+    writer.WriteSignedVarInt(int32.data());
+  } else if (auto int64 = attr.dyn_cast<Int64_tAttribute>()) {
+    write_kind(BuiltinAttributeKind::kInt64);
+    writer.WriteSignedVarInt(int64.data());
+  } else if (auto array = attr.dyn_cast<ArrayAttribute>()) {
+    write_kind(BuiltinAttributeKind::kArray);
+    std::vector<Attribute> data = array.data();
+    writer.WriteVarInt(data.size());
+    for (Attribute element : data) {
+      writer.WriteAttribute(element);
+    }
+  } else {
+    // PointerAttribute refers to memory of the running process.
+    IR_THROW(
+        "The attribute can't be written into bytecode by builtin dialect.");
+  }
+}
+
+Attribute BuiltinDialect::ReadAttribute(BytecodeReader &reader) const {
+  IrContext *ctx = ir_context();
+  switch (static_cast<BuiltinAttributeKind>(reader.ReadByte())) {
+    case BuiltinAttributeKind::kStr:
+      return StrAttribute::get(ctx, reader.ReadString());
+    case BuiltinAttributeKind::kBool:
+      return BoolAttribute::get(ctx, reader.ReadByte() != 0);
+    case BuiltinAttributeKind::kFloat:
+      return FloatAttribute::get(ctx, reader.ReadFixed<float>());
+    case BuiltinAttributeKind::kDouble:
+      return DoubleAttribute::get(ctx, reader.ReadFixed<double>());
+    case BuiltinAttributeKind::kInt32:
+      return Int32_tAttribute::get(
+          ctx, static_cast<int32_t>(reader.ReadSignedVarInt()));
+    case BuiltinAttributeKind::kInt64:
+      return Int64_tAttribute::get(ctx, reader.ReadSignedVarInt());
+    case BuiltinAttributeKind::kArray: {
+      std::vector<Attribute> data(reader.ReadVarInt());
+      for (auto &element : data) {
+        element = reader.ReadAttribute();
+      }
+      return ArrayAttribute::get(ctx, data);
+    }
+  }
+  IR_THROW("Unknown builtin attribute kind in bytecode.");
+}
+
 }  // namespace ir
@@ -33,6 +33,12 @@ class BuiltinDialect : public ir::Dialect {
   ///
   static const char *name() { return "builtin"; }
 
+  void WriteType(Type type, BytecodeWriter &writer) const override;
+  Type ReadType(BytecodeReader &reader) const override;
+
+  void WriteAttribute(Attribute attr, BytecodeWriter &writer) const override;
+  Attribute ReadAttribute(BytecodeReader &reader) const override;
+
  private:
   void initialize();
 };
@@ -16,6 +16,7 @@
 #include "paddle/ir/core/builtin_attribute.h"
 #include "paddle/ir/core/builtin_type.h"
 #include "paddle/ir/core/enforce.h"
+#include "paddle/ir/core/program.h"
 #include "paddle/phi/core/enforce.h"
 
 namespace ir {
@@ -42,7 +43,8 @@ ModuleOp ModuleOp::Create(IrContext *context, Program *pointer) {
   OperationArgument argument(info);
   argument.AddRegion()->emplace_back();
   argument.AddAttribute("program", PointerAttribute::get(context, pointer));
-  return ModuleOp(Operation::Create(std::move(argument)));
+  Arena *arena = pointer ? pointer->arena() : nullptr;
+  return ModuleOp(Operation::Create(std::move(argument), arena));
 }
 
 void ModuleOp::Destroy() {
@@ -21,10 +21,34 @@ namespace ir {
 
 class Program;
 class Block;
+
+///
+/// \brief This trait indicates that an operation has effects other than
+/// producing its results, e.g. it writes a parameter, an input in place or the
+/// outside of the program, or it is a random or collective operation. The
+/// optimization passes don't erase or merge the operations with this trait.
+///
+class SideEffectTrait : public OpTraitBase<SideEffectTrait> {
+ public:
+  explicit SideEffectTrait(Operation *op) : OpTraitBase<SideEffectTrait>(op) {}
+};
+
+///
+/// \brief This trait indicates that the regions of an operation don't use any
+/// value defined outside of them, so the passes can be run on sibling
+/// operations with this trait concurrently.
+///
+class IsolatedFromAboveTrait : public OpTraitBase<IsolatedFromAboveTrait> {
+ public:
+  explicit IsolatedFromAboveTrait(Operation *op)
+      : OpTraitBase<IsolatedFromAboveTrait>(op) {}
+};
+
 ///
-/// \brief ModuleOp
+/// \brief ModuleOp, the modules nested in a program are isolated from each
+/// other, so the passes are run on them concurrently.
 ///
-class ModuleOp : public ir::Op<ModuleOp> {
+class ModuleOp : public ir::Op<ModuleOp, IsolatedFromAboveTrait> {
  public:
   using Op::Op;
   static const char *name() { return "builtin.module"; }
@@ -63,7 +87,7 @@ class GetParameterOp : public ir::Op<GetParameterOp> {
 /// \brief SetParameterOp: SetParameterOp(OpOperand, {StrAttribute,
 /// StrAttribute})
 ///
-class SetParameterOp : public ir::Op<SetParameterOp> {
+class SetParameterOp : public ir::Op<SetParameterOp, SideEffectTrait> {
  public:
   using Op::Op;
   static const char *name() { return "builtin.set_parameter"; }
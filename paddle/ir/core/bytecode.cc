@@ -0,0 +1,528 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/ir/core/bytecode.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "paddle/ir/core/dialect.h"
+#include "paddle/ir/core/enforce.h"
+#include "paddle/ir/core/ir_context.h"
+#include "paddle/ir/core/operation.h"
+#include "paddle/ir/core/program.h"
+#include "paddle/ir/core/region.h"
+
+// The layout of the bytecode, all integers are varints unless noted:
+//
+//   magic "PDIRBC" | version
+//   dialect names  : count, strings
+//   op names       : count, strings
+//   strings        : count, strings
+//   types          : count, entries
+//   attributes     : count, entries
+//   parameters     : count, (name, has_data,
+//                    [type, is_mutable, size, padding (byte), padding bytes,
+//                     bytes])
+//   module body    : count, operations
+//
+// A string is its length followed by the bytes. An entry is its length
+// followed by the dialect index and the payload written by the dialect, so
+// the reader can skip it until it is referenced. An operation is encoded as:
+//
+//   op name | operand value ids | result types | (attr name, attr) pairs |
+//   regions, each one is a list of blocks, each block a list of operations
+//
+// The results of the operations are numbered in the order of definition from
+// 1, the id 0 stands for the null value, type or attribute. The data of the
+// parameters is aligned to kParameterAlignment from the start of the
+// bytecode, the padding is absent in version 1.
+
+namespace ir {
+
+namespace {
+constexpr char kMagic[] = "PDIRBC";
+constexpr size_t kMagicSize = sizeof(kMagic) - 1;
+constexpr size_t kParameterAlignment = 64;
+
+template <typename MapT, typename KeyT>
+uint64_t Intern(const KeyT &key,
+                MapT *ids,
+                std::vector<std::string> *table,
+                const std::string &entry) {
+  auto it = ids->find(key);
+  if (it != ids->end()) return it->second;
+  table->push_back(entry);
+  return ids->emplace(key, table->size() - 1).first->second;
+}
+}  // namespace
+
+//===----------------------------------------------------------------------===//
+// BytecodeWriter
+//===----------------------------------------------------------------------===//
+void BytecodeWriter::WriteVarInt(uint64_t value) {
+  while (value >= 0x80) {
+    out_->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out_->push_back(static_cast<char>(value));
+}
+
+uint64_t BytecodeWriter::InternDialect(const Dialect &dialect) {
+  return Intern(dialect.name(), &dialect_ids_, &dialects_, dialect.name());
+}
+
+uint64_t BytecodeWriter::InternString(const std::string &str) {
+  return Intern(str, &string_ids_, &strings_, str);
+}
+
+uint64_t BytecodeWriter::InternOpName(const std::string &name) {
+  return Intern(name, &op_name_ids_, &op_names_, name);
+}
+
+uint64_t BytecodeWriter::InternType(Type type) {
+  if (!type) return 0;
+  auto it = type_ids_.find(type);
+  if (it != type_ids_.end()) return it->second;
+
+  // The nested types are interned while encoding this one, so the entry is
+  // written into its own buffer.
+  std::string entry;
+  std::string *prev_out = out_;
+  out_ = &entry;
+  const Dialect &dialect = type.dialect();
+  WriteVarInt(InternDialect(dialect));
+  dialect.WriteType(type, *this);
+  out_ = prev_out;
+
+  types_.push_back(std::move(entry));
+  type_ids_[type] = types_.size();
+  return types_.size();
+}
+
+uint64_t BytecodeWriter::InternAttribute(Attribute attr) {
+  if (!attr) return 0;
+  auto it = attribute_ids_.find(attr);
+  if (it != attribute_ids_.end()) return it->second;
+
+  std::string entry;
+  std::string *prev_out = out_;
+  out_ = &entry;
+  const Dialect &dialect = attr.dialect();
+  WriteVarInt(InternDialect(dialect));
+  dialect.WriteAttribute(attr, *this);
+  out_ = prev_out;
+
+  attributes_.push_back(std::move(entry));
+  attribute_ids_[attr] = attributes_.size();
+  return attributes_.size();
+}
+
+void BytecodeWriter::WriteOperation(Operation *op) {
+  WriteVarInt(InternOpName(op->name()));
+
+  WriteVarInt(op->num_operands());
+  for (uint32_t i = 0; i < op->num_operands(); ++i) {
+    Value value = op->GetOperandByIndex(i).source();
+    if (!value) {
+      WriteVarInt(0);
+      continue;
+    }
+    auto it = value_ids_.find(value);
+    IR_ENFORCE(it != value_ids_.end(),
+               "The operand %d of %s is not defined before it is used.",
+               i,
+               op->name());
+    WriteVarInt(it->second);
+  }
+
+  WriteVarInt(op->num_results());
+  for (uint32_t i = 0; i < op->num_results(); ++i) {
+    OpResult result = op->GetResultByIndex(i);
+    WriteType(result.type());
+    value_ids_.emplace(result, value_ids_.size() + 1);
+  }
+
+  // Sort the attributes by name, so that the output is deterministic.
+  std::vector<std::pair<std::string, Attribute>> attributes(
+      op->attributes().begin(), op->attributes().end());
+  std::sort(attributes.begin(),
+            attributes.end(),
+            [](const std::pair<std::string, Attribute> &lhs,
+               const std::pair<std::string, Attribute> &rhs) {
+              return lhs.first < rhs.first;
+            });
+  WriteVarInt(attributes.size());
+  for (auto &attribute : attributes) {
+    WriteVarInt(InternString(attribute.first));
+    WriteAttribute(attribute.second);
+  }
+
+  WriteVarInt(op->num_regions());
+  for (size_t i = 0; i < op->num_regions(); ++i) {
+    Region &region = op->GetRegion(i);
+    WriteVarInt(region.size());
+    for (Block *block : region) {
+      WriteVarInt(block->size());
+      for (Operation *nested_op : *block) {
+        WriteOperation(nested_op);
+      }
+    }
+  }
+}
+
+void BytecodeWriter::WriteTable(const std::vector<std::string> &table) {
+  WriteVarInt(table.size());
+  for (auto &entry : table) {
+    WriteString(entry);
+  }
+}
+
+std::string BytecodeWriter::Write(Program *program) {
+  // The operations and parameters are encoded first to fill the tables,
+  // which are placed ahead of them in the output.
+  std::string body;
+  out_ = &body;
+  Block *block = program->block();
+  WriteVarInt(block->size());
+  for (Operation *op : *block) {
+    WriteOperation(op);
+  }
+
+  std::vector<std::string> names;
+  for (auto &parameter : program->parameters()) {
+    names.push_back(parameter.first);
+  }
+  std::sort(names.begin(), names.end());
+  // The tables are written ahead of the parameters, so the names and types of
+  // the parameters are interned first.
+  for (auto &name : names) {
+    InternString(name);
+    Parameter *parameter = program->GetParameter(name);
+    if (parameter) InternType(parameter->type());
+  }
+
+  std::string result;
+  out_ = &result;
+  WriteBytes(kMagic, kMagicSize);
+  WriteVarInt(kBytecodeVersion);
+  WriteTable(dialects_);
+  WriteTable(op_names_);
+  WriteTable(strings_);
+  WriteTable(types_);
+  WriteTable(attributes_);
+
+  WriteVarInt(names.size());
+  for (auto &name : names) {
+    Parameter *parameter = program->GetParameter(name);
+    WriteVarInt(InternString(name));
+    // The translated programs hold placeholders without data.
+    WriteByte(parameter != nullptr);
+    if (!parameter) continue;
+    WriteType(parameter->type());
+    WriteByte(parameter->is_mutable());
+    WriteVarInt(parameter->size());
+    // The data is aligned in the file, so that the reader can use it in place.
+    size_t padding = (kParameterAlignment -
+                      (result.size() + 1) % kParameterAlignment) %
+                     kParameterAlignment;
+    WriteByte(padding);
+    result.append(padding, '\0');
+    WriteBytes(parameter->data(), parameter->size());
+  }
+  WriteBytes(body.data(), body.size());
+  out_ = nullptr;
+  return result;
+}
+
+//===----------------------------------------------------------------------===//
+// BytecodeReader
+//===----------------------------------------------------------------------===//
+uint64_t BytecodeReader::ReadVarInt() {
+  uint64_t value = 0;
+  for (uint32_t shift = 0;; shift += 7) {
+    IR_ENFORCE(shift < 64,
+               "Malformed varint at offset %d of the bytecode.",
+               cur_ - begin_);
+    uint8_t byte = ReadByte();
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) break;
+  }
+  return value;
+}
+
+const char *BytecodeReader::ReadBytes(size_t size) {
+  IR_ENFORCE(size <= static_cast<size_t>(end_ - cur_),
+             "Unexpected end of the bytecode at offset %d, %d bytes are "
+             "required but only %d bytes are left.",
+             cur_ - begin_,
+             size,
+             end_ - cur_);
+  const char *data = cur_;
+  cur_ += size;
+  return data;
+}
+
+void BytecodeReader::ReadHeader() {
+  IR_ENFORCE(static_cast<size_t>(end_ - cur_) >= kMagicSize &&
+                 std::memcmp(cur_, kMagic, kMagicSize) == 0,
+             "The data is not in the ir bytecode format.");
+  cur_ += kMagicSize;
+  version_ = ReadVarInt();
+  IR_ENFORCE(version_ <= kBytecodeVersion,
+             "The bytecode version %d is newer than the supported version %d.",
+             version_,
+             kBytecodeVersion);
+}
+
+std::vector<std::string> BytecodeReader::ReadStringTable() {
+  std::vector<std::string> table(ReadVarInt());
+  for (auto &str : table) {
+    str = ReadString();
+  }
+  return table;
+}
+
+std::vector<BytecodeReader::Entry> BytecodeReader::ReadEntryTable() {
+  std::vector<Entry> table(ReadVarInt());
+  for (auto &entry : table) {
+    entry.size = ReadVarInt();
+    entry.data = ReadBytes(entry.size);
+  }
+  return table;
+}
+
+template <typename T, typename DecodeFunc>
+T BytecodeReader::DecodeEntry(const Entry &entry, DecodeFunc decode) {
+  // Nested entries are decoded recursively, so the cursor is restored after
+  // the decoding of this entry.
+  const char *prev_cur = cur_;
+  const char *prev_end = end_;
+  cur_ = entry.data;
+  end_ = entry.data + entry.size;
+  uint64_t dialect_id = ReadVarInt();
+  IR_ENFORCE(dialect_id < dialects_.size(),
+             "The dialect index %d is out of range.",
+             dialect_id);
+  Dialect *dialect = dialects_[dialect_id];
+  T value = decode(dialect);
+  IR_ENFORCE(cur_ == end_,
+             "The entry is not fully consumed by dialect %s.",
+             dialect->name());
+  cur_ = prev_cur;
+  end_ = prev_end;
+  return value;
+}
+
+Type BytecodeReader::GetType(uint64_t index) {
+  if (index == 0) return Type();
+  IR_ENFORCE(index <= type_entries_.size(),
+             "The type index %d is out of range.",
+             index);
+  if (!types_[index]) {
+    types_[index] = DecodeEntry<Type>(
+        type_entries_[index - 1],
+        [this](Dialect *dialect) { return dialect->ReadType(*this); });
+  }
+  return types_[index];
+}
+
+Attribute BytecodeReader::GetAttribute(uint64_t index) {
+  if (index == 0) return Attribute();
+  IR_ENFORCE(index <= attribute_entries_.size(),
+             "The attribute index %d is out of range.",
+             index);
+  if (!attributes_[index]) {
+    attributes_[index] = DecodeEntry<Attribute>(
+        attribute_entries_[index - 1],
+        [this](Dialect *dialect) { return dialect->ReadAttribute(*this); });
+  }
+  return attributes_[index];
+}
+
+Operation *BytecodeReader::ReadOperation(Program *program) {
+  uint64_t op_id = ReadVarInt();
+  IR_ENFORCE(
+      op_id < op_infos_.size(), "The op index %d is out of range.", op_id);
+
+  std::vector<OpResult> inputs(ReadVarInt());
+  for (auto &input : inputs) {
+    uint64_t value_id = ReadVarInt();
+    IR_ENFORCE(value_id < values_.size(),
+               "The value %d is used before it is defined.",
+               value_id);
+    input = values_[value_id];
+  }
+
+  std::vector<Type> output_types(ReadVarInt());
+  for (auto &type : output_types) {
+    type = ReadType();
+  }
+
+  AttributeMap attributes;
+  uint64_t num_attributes = ReadVarInt();
+  for (uint64_t i = 0; i < num_attributes; ++i) {
+    uint64_t name_id = ReadVarInt();
+    IR_ENFORCE(name_id < strings_.size(),
+               "The string index %d is out of range.",
+               name_id);
+    attributes.emplace(strings_[name_id], ReadAttribute());
+  }
+
+  size_t num_regions = ReadVarInt();
+  Operation *op = Operation::Create(inputs,
+                                    attributes,
+                                    output_types,
+                                    op_infos_[op_id],
+                                    num_regions,
+                                    program->arena());
+  for (uint32_t i = 0; i < op->num_results(); ++i) {
+    values_.push_back(op->GetResultByIndex(i));
+  }
+
+  for (size_t i = 0; i < num_regions; ++i) {
+    Region &region = op->GetRegion(i);
+    uint64_t num_blocks = ReadVarInt();
+    for (uint64_t j = 0; j < num_blocks; ++j) {
+      region.emplace_back();
+      Block *block = region.back();
+      uint64_t num_ops = ReadVarInt();
+      for (uint64_t k = 0; k < num_ops; ++k) {
+        block->push_back(ReadOperation(program));
+      }
+    }
+  }
+  return op;
+}
+
+std::unique_ptr<Program> BytecodeReader::Read() {
+  ReadHeader();
+
+  for (auto &name : ReadStringTable()) {
+    Dialect *dialect = context_->GetRegisteredDialect(name);
+    IR_ENFORCE(dialect != nullptr,
+               "The dialect %s used by the bytecode is not registered.",
+               name);
+    dialects_.push_back(dialect);
+  }
+  for (auto &name : ReadStringTable()) {
+    OpInfo info = context_->GetRegisteredOpInfo(name);
+    IR_ENFORCE(
+        info, "The op %s used by the bytecode is not registered.", name);
+    op_infos_.push_back(info);
+  }
+  strings_ = ReadStringTable();
+  type_entries_ = ReadEntryTable();
+  types_.assign(type_entries_.size() + 1, Type());
+  attribute_entries_ = ReadEntryTable();
+  attributes_.assign(attribute_entries_.size() + 1, Attribute());
+
+  auto program = std::make_unique<Program>(context_, /*use_arena=*/true);
+
+  uint64_t num_parameters = ReadVarInt();
+  for (uint64_t i = 0; i < num_parameters; ++i) {
+    uint64_t name_id = ReadVarInt();
+    IR_ENFORCE(name_id < strings_.size(),
+               "The string index %d is out of range.",
+               name_id);
+    if (!ReadByte()) {
+      program->SetParameter(strings_[name_id], nullptr);
+      continue;
+    }
+    Type type = ReadType();
+    bool is_mutable = ReadByte();
+    size_t size = ReadVarInt();
+    if (version_ >= 2) {
+      ReadBytes(ReadByte());
+    }
+    char *data = const_cast<char *>(ReadBytes(size));
+    // The large parameters view the mapped file, their pages are only read
+    // from the file when they are accessed.
+    std::unique_ptr<Parameter> parameter;
+    if (holder_ && size >= kMinViewParameterSize) {
+      parameter = std::make_unique<Parameter>(data, size, type, holder_);
+    } else {
+      parameter = std::make_unique<Parameter>(data, size, type);
+    }
+    if (is_mutable) parameter->set_mutable();
+    program->SetParameter(strings_[name_id], std::move(parameter));
+  }
+
+  values_.assign(1, OpResult());
+  Block *block = program->block();
+  uint64_t num_ops = ReadVarInt();
+  for (uint64_t i = 0; i < num_ops; ++i) {
+    block->push_back(ReadOperation(program.get()));
+  }
+  IR_ENFORCE(cur_ == end_,
+             "%d trailing bytes are found after the program.",
+             end_ - cur_);
+  return program;
+}
+
+//===----------------------------------------------------------------------===//
+// File interfaces
+//===----------------------------------------------------------------------===//
+void SaveBytecode(Program *program, const std::string &path) {
+  std::string data =
+      BytecodeWriter(program->module_op().ir_context()).Write(program);
+  std::ofstream fout(path, std::ios::binary);
+  IR_ENFORCE(fout.is_open(), "Open file %s to write bytecode failed.", path);
+  fout.write(data.data(), data.size());
+  IR_ENFORCE(fout.good(), "Write bytecode to file %s failed.", path);
+}
+
+std::unique_ptr<Program> LoadBytecode(IrContext *context,
+                                      const std::string &path) {
+#if !defined(_WIN32)
+  int fd = open(path.c_str(), O_RDONLY);
+  IR_ENFORCE(fd >= 0, "Open bytecode file %s failed.", path);
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+    close(fd);
+    IR_THROW("The bytecode file %s is empty or can't be accessed.", path);
+  }
+  size_t size = file_stat.st_size;
+  // The mapping is private and writable, the writes to the parameters viewing
+  // it are copy on write and never reach the file.
+  void *data =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  IR_ENFORCE(data != MAP_FAILED, "Map bytecode file %s failed.", path);
+  // The types and attributes copy what they keep, the mapping is kept alive
+  // by the large parameters viewing it.
+  std::shared_ptr<void> mapping(data,
+                                [size](void *ptr) { munmap(ptr, size); });
+  return BytecodeReader(
+             context, static_cast<const char *>(data), size, mapping)
+      .Read();
+#else
+  std::ifstream fin(path, std::ios::binary);
+  IR_ENFORCE(fin.is_open(), "Open bytecode file %s failed.", path);
+  std::stringstream buffer;
+  buffer << fin.rdbuf();
+  std::string data = buffer.str();
+  return BytecodeReader(context, data.data(), data.size()).Read();
+#endif
+}
+
+}  // namespace ir
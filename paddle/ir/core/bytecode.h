@@ -0,0 +1,243 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/ir/core/attribute.h"
+#include "paddle/ir/core/op_info.h"
+#include "paddle/ir/core/type.h"
+#include "paddle/ir/core/value.h"
+
+namespace ir {
+class Dialect;
+class IrContext;
+class Operation;
+class Program;
+
+///
+/// \brief The version of the bytecode format, readers reject files written
+/// with a newer version.
+///
+constexpr uint64_t kBytecodeVersion = 2;
+
+///
+/// \brief The parameters of at least this size are not copied by
+/// BytecodeReader if the data is owned by a holder, they view the data.
+///
+constexpr size_t kMinViewParameterSize = 4096;
+
+///
+/// \brief BytecodeWriter encodes a Program into the binary bytecode format.
+/// Types, attributes, op names and strings are interned into tables, and the
+/// operations only refer to them by index. Dialects encode the parameters of
+/// their types and attributes through Dialect::WriteType and
+/// Dialect::WriteAttribute with the primitives of this class.
+///
+class BytecodeWriter {
+ public:
+  explicit BytecodeWriter(IrContext *context) : context_(context) {}
+
+  IrContext *ir_context() const { return context_; }
+
+  void WriteVarInt(uint64_t value);
+
+  void WriteSignedVarInt(int64_t value) {
+    // Zigzag encoding, so that small negative values stay small.
+    WriteVarInt((static_cast<uint64_t>(value) << 1) ^
+                static_cast<uint64_t>(value >> 63));
+  }
+
+  void WriteByte(uint8_t value) { out_->push_back(static_cast<char>(value)); }
+
+  void WriteBytes(const void *data, size_t size) {
+    out_->append(reinterpret_cast<const char *>(data), size);
+  }
+
+  template <typename T>
+  void WriteFixed(T value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "WriteFixed only supports trivially copyable types.");
+    WriteBytes(&value, sizeof(T));
+  }
+
+  void WriteString(const std::string &str) {
+    WriteVarInt(str.size());
+    WriteBytes(str.data(), str.size());
+  }
+
+  /// Write a reference to the type, the type is encoded in the type table.
+  void WriteType(Type type) { WriteVarInt(InternType(type)); }
+
+  /// Write a reference to the attribute, the attribute is encoded in the
+  /// attribute table.
+  void WriteAttribute(Attribute attr) { WriteVarInt(InternAttribute(attr)); }
+
+  /// Encode the program, including its parameters.
+  std::string Write(Program *program);
+
+ private:
+  uint64_t InternDialect(const Dialect &dialect);
+  uint64_t InternType(Type type);
+  uint64_t InternAttribute(Attribute attr);
+  uint64_t InternString(const std::string &str);
+  uint64_t InternOpName(const std::string &name);
+
+  void WriteOperation(Operation *op);
+
+  void WriteTable(const std::vector<std::string> &table);
+
+  IrContext *context_;
+
+  // The buffer being written.
+  std::string *out_{nullptr};
+
+  std::unordered_map<std::string, uint64_t> dialect_ids_;
+  std::vector<std::string> dialects_;
+
+  std::unordered_map<std::string, uint64_t> op_name_ids_;
+  std::vector<std::string> op_names_;
+
+  std::unordered_map<std::string, uint64_t> string_ids_;
+  std::vector<std::string> strings_;
+
+  // The encoded entries, indexed by their ids minus one since 0 is null.
+  // Nested types and attributes always have smaller ids than the entries
+  // referring to them.
+  std::unordered_map<Type, uint64_t> type_ids_;
+  std::vector<std::string> types_;
+  std::unordered_map<Attribute, uint64_t> attribute_ids_;
+  std::vector<std::string> attributes_;
+
+  std::unordered_map<Value, uint64_t> value_ids_;
+};
+
+///
+/// \brief BytecodeReader decodes a Program from the bytecode format. The
+/// types and attributes are created in the IrContext directly from the
+/// encoded data, and only when they are referenced for the first time, so
+/// unused entries of the tables are never decoded. If holder owns the data,
+/// the large parameters view the data instead of copying it, and keep holder
+/// alive.
+///
+class BytecodeReader {
+ public:
+  BytecodeReader(IrContext *context,
+                 const char *data,
+                 size_t size,
+                 std::shared_ptr<void> holder = nullptr)
+      : context_(context),
+        begin_(data),
+        cur_(data),
+        end_(data + size),
+        holder_(std::move(holder)) {}
+
+  IrContext *ir_context() const { return context_; }
+
+  uint64_t ReadVarInt();
+
+  int64_t ReadSignedVarInt() {
+    uint64_t value = ReadVarInt();
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+
+  uint8_t ReadByte() { return static_cast<uint8_t>(*ReadBytes(1)); }
+
+  /// Return a pointer to the next size bytes in the buffer, no copy is made.
+  const char *ReadBytes(size_t size);
+
+  template <typename T>
+  T ReadFixed() {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "ReadFixed only supports trivially copyable types.");
+    T value;
+    std::memcpy(&value, ReadBytes(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  std::string ReadString() {
+    size_t size = ReadVarInt();
+    return std::string(ReadBytes(size), size);
+  }
+
+  Type ReadType() { return GetType(ReadVarInt()); }
+
+  Attribute ReadAttribute() { return GetAttribute(ReadVarInt()); }
+
+  /// Decode the program, all dialects used by the program must have been
+  /// registered in the IrContext.
+  std::unique_ptr<Program> Read();
+
+ private:
+  // An encoded type or attribute, which is decoded on first use.
+  struct Entry {
+    const char *data;
+    size_t size;
+  };
+
+  void ReadHeader();
+  std::vector<std::string> ReadStringTable();
+  std::vector<Entry> ReadEntryTable();
+
+  template <typename T, typename DecodeFunc>
+  T DecodeEntry(const Entry &entry, DecodeFunc decode);
+
+  Type GetType(uint64_t index);
+  Attribute GetAttribute(uint64_t index);
+
+  Operation *ReadOperation(Program *program);
+
+  IrContext *context_;
+
+  const char *begin_;
+  const char *cur_;
+  const char *end_;
+  std::shared_ptr<void> holder_;
+  uint64_t version_{0};
+
+  std::vector<Dialect *> dialects_;
+  std::vector<OpInfo> op_infos_;
+  std::vector<std::string> strings_;
+
+  // The decoded types and attributes, indexed by their ids, 0 is null.
+  std::vector<Entry> type_entries_;
+  std::vector<Type> types_;
+  std::vector<Entry> attribute_entries_;
+  std::vector<Attribute> attributes_;
+
+  // Values indexed by their ids, 0 is the null value.
+  std::vector<OpResult> values_;
+};
+
+///
+/// \brief Write the program into a file in the bytecode format.
+///
+void SaveBytecode(Program *program, const std::string &path);
+
+///
+/// \brief Load a program from a file written by SaveBytecode. The file is
+/// memory mapped and decoded in place, the large parameters view the mapping
+/// and are read from the file on demand.
+///
+std::unique_ptr<Program> LoadBytecode(IrContext *context,
+                                      const std::string &path);
+
+}  // namespace ir
@@ -25,6 +25,8 @@
 #include "paddle/ir/core/type_base.h"
 
 namespace ir {
+class BytecodeReader;
+class BytecodeWriter;
 class DialectInterface;
 ///
 /// \brief Dialect can basically be understood as a namespace. In Dialect, we
@@ -140,6 +142,27 @@ class Dialect {
     IR_THROW("dialect has no registered attribute printing hook");
   }
 
+  ///
+  /// \brief Hooks to encode the parameters of the types and attributes of
+  /// this dialect into the bytecode, see paddle/ir/core/bytecode.h. The
+  /// readers must consume exactly the data written by the writers.
+  ///
+  virtual void WriteType(Type type, BytecodeWriter &writer) const {
+    IR_THROW("dialect %s has no registered type writing hook", name_);
+  }
+
+  virtual Type ReadType(BytecodeReader &reader) const {
+    IR_THROW("dialect %s has no registered type reading hook", name_);
+  }
+
+  virtual void WriteAttribute(Attribute attr, BytecodeWriter &writer) const {
+    IR_THROW("dialect %s has no registered attribute writing hook", name_);
+  }
+
+  virtual Attribute ReadAttribute(BytecodeReader &reader) const {
+    IR_THROW("dialect %s has no registered attribute reading hook", name_);
+  }
+
  private:
   Dialect(const Dialect &) = delete;
 
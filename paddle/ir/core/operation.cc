@@ -14,6 +14,7 @@
 
 #include <ostream>
 
+#include "paddle/ir/core/arena.h"
 #include "paddle/ir/core/block.h"
 #include "paddle/ir/core/dialect.h"
 #include "paddle/ir/core/enforce.h"
@@ -25,12 +26,13 @@
 #include "paddle/ir/core/value_impl.h"
 
 namespace ir {
-Operation *Operation::Create(OperationArgument &&argument) {
+Operation *Operation::Create(OperationArgument &&argument, Arena *arena) {
   Operation *op = Create(argument.inputs,
                          argument.attributes,
                          argument.output_types,
                          argument.info,
-                         argument.regions.size());
+                         argument.regions.size(),
+                         arena);
 
   for (size_t index = 0; index < argument.regions.size(); ++index) {
     op->GetRegion(index).TakeBody(std::move(*argument.regions[index]));
@@ -45,7 +47,8 @@ Operation *Operation::Create(const std::vector<ir::OpResult> &inputs,
                              const AttributeMap &attributes,
                              const std::vector<ir::Type> &output_types,
                              ir::OpInfo op_info,
-                             size_t num_regions) {
+                             size_t num_regions,
+                             Arena *arena) {
   // 0. Verify
   if (op_info) {
     op_info.Verify(inputs, output_types, attributes);
@@ -68,7 +71,9 @@ Operation *Operation::Create(const std::vector<ir::OpResult> &inputs,
   size_t base_size =
       result_mem_size + op_mem_size + operand_mem_size + region_mem_size;
   // 2. Malloc memory.
-  char *base_ptr = reinterpret_cast<char *>(aligned_malloc(base_size, 8));
+  char *base_ptr =
+      arena ? reinterpret_cast<char *>(arena->Allocate(base_size))
+            : reinterpret_cast<char *>(aligned_malloc(base_size, 8));
   // 3.1. Construct OpResults.
   for (size_t idx = num_results; idx > 0; idx--) {
     if (idx > max_inline_result_num) {
@@ -83,6 +88,7 @@ Operation *Operation::Create(const std::vector<ir::OpResult> &inputs,
   // 3.2. Construct Operation.
   Operation *op = new (base_ptr)
       Operation(attributes, op_info, num_results, num_operands, num_regions);
+  op->arena_ = arena;
   base_ptr += sizeof(Operation);
   // 3.3. Construct OpOperands.
   if ((reinterpret_cast<uintptr_t>(base_ptr) & 0x7) != 0) {
@@ -123,6 +129,10 @@ void Operation::Destroy() {
                 sizeof(detail::OpInlineResultImpl) * max_inline_result_num
           : sizeof(detail::OpInlineResultImpl) * num_results_;
   char *aligned_ptr = reinterpret_cast<char *>(this) - result_mem_size;
+  size_t base_size = result_mem_size + sizeof(Operation) +
+                     sizeof(detail::OpOperandImpl) * num_operands_ +
+                     sizeof(Region) * num_regions_;
+  Arena *arena = arena_;
   // 2.1. Deconstruct OpResult.
   char *base_ptr = aligned_ptr;
   for (size_t idx = num_results_; idx > 0; idx--) {
@@ -160,8 +170,12 @@ void Operation::Destroy() {
   // 3. Free memory.
   VLOG(4) << "Destroy an Operation: {ptr = "
           << reinterpret_cast<void *>(aligned_ptr)
-          << ", size = " << result_mem_size << "}";
-  aligned_free(reinterpret_cast<void *>(aligned_ptr));
+          << ", size = " << base_size << "}";
+  if (arena) {
+    arena->Deallocate(aligned_ptr, base_size);
+  } else {
+    aligned_free(reinterpret_cast<void *>(aligned_ptr));
+  }
 }
 
 IrContext *Operation::ir_context() const { return info_.ir_context(); }
@@ -207,6 +221,13 @@ ir::OpOperand Operation::GetOperandByIndex(uint32_t index) const {
   return ir::OpOperand(reinterpret_cast<const detail::OpOperandImpl *>(ptr));
 }
 
+bool Operation::use_empty() const {
+  for (uint32_t index = 0; index < num_results_; ++index) {
+    if (!GetResultByIndex(index).use_empty()) return false;
+  }
+  return true;
+}
+
 std::string Operation::name() const {
   auto p_name = info_.name();
   return p_name ? p_name : "";
@@ -21,6 +21,7 @@
 #include "paddle/ir/core/type.h"
 
 namespace ir {
+class Arena;
 class OpBase;
 class Program;
 class OpOperand;
@@ -32,14 +33,17 @@ class alignas(8) Operation final {
   /// \brief Malloc memory and construct objects in the following order:
   /// OpResultImpls|Operation|OpOperandImpls.
   /// NOTE: Similar to new and delete, the destroy() and the create() need to be
-  /// used in conjunction.
+  /// used in conjunction. If arena is not nullptr, the memory is allocated
+  /// from the arena and returned to it by destroy().
   ///
   static Operation *Create(const std::vector<ir::OpResult> &inputs,
                            const AttributeMap &attributes,
                            const std::vector<ir::Type> &output_types,
                            ir::OpInfo op_info,
-                           size_t num_regions = 0);
-  static Operation *Create(OperationArgument &&op_argument);
+                           size_t num_regions = 0,
+                           Arena *arena = nullptr);
+  static Operation *Create(OperationArgument &&op_argument,
+                           Arena *arena = nullptr);
 
   ///
   /// \brief Destroy the operation objects and free memory by create().
@@ -48,6 +52,10 @@ class alignas(8) Operation final {
 
   IrContext *ir_context() const;
 
+  /// The arena which holds the memory of this operation, nullptr if the
+  /// operation is allocated from the heap.
+  Arena *arena() const { return arena_; }
+
   OpResult GetResultByIndex(uint32_t index) const;
 
   OpOperand GetOperandByIndex(uint32_t index) const;
@@ -68,6 +76,9 @@ class alignas(8) Operation final {
 
   uint32_t num_regions() const { return num_regions_; }
 
+  /// Returns true if none of the results of this operation has any use.
+  bool use_empty() const;
+
   std::string name() const;
 
   template <typename T>
@@ -134,6 +145,7 @@ class alignas(8) Operation final {
   const uint32_t num_regions_ = 0;
 
   Region *regions_{nullptr};
+  Arena *arena_{nullptr};
   Block *parent_{nullptr};
   Block::iterator position_;
 };
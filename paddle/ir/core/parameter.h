@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include "paddle/ir/core/type.h"
 
 namespace ir {
@@ -29,6 +31,17 @@ class Parameter {
     type_ = type;
   }
 
+  ///
+  /// \brief Construct a parameter viewing the data owned by holder, e.g. a
+  /// mapped file, the data is not copied and holder is kept alive by the
+  /// parameter.
+  ///
+  Parameter(void* data,
+            size_t size,
+            ir::Type type,
+            std::shared_ptr<void> holder)
+      : data_(data), size_(size), type_(type), holder_(std::move(holder)) {}
+
   Parameter(const Parameter& param) {
     data_ = malloc(param.size_);
     memcpy(data_, param.data_, param.size_);
@@ -37,6 +50,7 @@ class Parameter {
   }
 
   Parameter& operator=(const Parameter& param) {
+    holder_.reset();
     data_ = malloc(param.size_);
     memcpy(data_, param.data_, param.size_);
     size_ = param.size_;
@@ -44,12 +58,22 @@ class Parameter {
     return *this;
   }
 
-  ~Parameter() { free(data_); }
+  ~Parameter() {
+    if (!holder_) free(data_);
+  }
 
   Type type() const { return type_; }
 
   void* data() const { return data_; }
 
+  size_t size() const { return size_; }
+
+  ///
+  /// \brief Whether the data is owned by the parameter, or it is a view of
+  /// the data owned by a holder.
+  ///
+  bool owns_data() const { return holder_ == nullptr; }
+
   bool is_mutable() const { return is_mutable_; }
 
   void set_mutable() { is_mutable_ = true; }
@@ -65,6 +89,11 @@ class Parameter {
   Type type_;
 
   bool is_mutable_ = false;
+
+  ///
+  /// \brief Keeps the viewed data alive, null if data_ is owned.
+  ///
+  std::shared_ptr<void> holder_;
 };
 
 }  // namespace ir
@@ -17,7 +17,10 @@
 
 namespace ir {
 
-Program::Program(IrContext* context) {
+Program::Program(IrContext* context, bool use_arena) {
+  if (use_arena) {
+    arena_ = std::make_unique<Arena>();
+  }
   module_ = ModuleOp::Create(context, this);
 }
 
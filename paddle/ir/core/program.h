@@ -15,9 +15,11 @@
 #pragma once
 
 #include <list>
+#include <memory>
 #include <ostream>
 #include <unordered_map>
 
+#include "paddle/ir/core/arena.h"
 #include "paddle/ir/core/attribute.h"
 #include "paddle/ir/core/block.h"
 #include "paddle/ir/core/builtin_attribute.h"
@@ -40,7 +42,12 @@ class Program {
  public:
   using ParameterMap =
       std::unordered_map<std::string, std::unique_ptr<Parameter>>;
-  explicit Program(IrContext* context);
+  ///
+  /// \brief Construct a program. If use_arena is true, the operations and
+  /// blocks of this program built through ir::Builder are allocated from an
+  /// arena owned by the program, and released in bulk with the program.
+  ///
+  explicit Program(IrContext* context, bool use_arena = false);
   Program(Program&&) = delete;
   Program(const Program& program) = delete;
   Program& operator=(const Program&) = delete;
@@ -54,6 +61,9 @@ class Program {
 
   Block* block() { return module_.block(); }
 
+  /// The arena of this program, nullptr if the program doesn't use arena.
+  Arena* arena() const { return arena_.get(); }
+
   Parameter* GetParameter(std::string name) const;
   void SetParameter(std::string name, std::unique_ptr<Parameter>&& parameter);
 
@@ -63,6 +73,8 @@ class Program {
   }
 
  private:
+  // storage of operations and blocks, must outlive module_
+  std::unique_ptr<Arena> arena_;
   // computation graph
   ModuleOp module_;
   // weight
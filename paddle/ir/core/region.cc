@@ -14,6 +14,7 @@
 
 #include "paddle/ir/core/region.h"
 #include "paddle/ir/core/block.h"
+#include "paddle/ir/core/operation.h"
 
 namespace ir {
 Region::~Region() { clear(); }
@@ -23,7 +24,9 @@ void Region::push_back(Block *block) {
   blocks_.push_back(block);
 }
 
-void Region::emplace_back() { push_back(new Block); }
+void Region::emplace_back() {
+  push_back(Block::Create(parent_ ? parent_->arena() : nullptr));
+}
 
 void Region::push_front(Block *block) {
   block->SetParent(this);
@@ -44,7 +47,7 @@ void Region::TakeBody(Region &&other) {
 
 void Region::clear() {
   while (!empty()) {
-    delete blocks_.back();
+    blocks_.back()->Destroy();
     blocks_.pop_back();
   }
 }
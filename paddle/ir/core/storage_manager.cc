@@ -15,105 +15,184 @@
 #include "paddle/ir/core/storage_manager.h"
 
 #include <memory>
-#include <unordered_map>
 
 #include "paddle/ir/core/enforce.h"
 
 namespace ir {
-// This is a structure for creating, caching, and looking up Storage of
-// parametric types.
-struct ParametricStorageManager {
-  using StorageBase = StorageManager::StorageBase;
-
-  explicit ParametricStorageManager(std::function<void(StorageBase *)> destroy)
-      : destroy_(destroy) {}
-
-  ~ParametricStorageManager() {
-    for (const auto &instance : parametric_instances_) {
-      destroy_(instance.second);
+///
+/// \brief An insert-only map from TypeId to the registered storage of a type.
+/// Types are registered rarely (when a dialect is loaded) but looked up on
+/// every Type::get or Attribute::get, so lookups walk the buckets without a
+/// lock and only insertions are serialized.
+///
+template <typename ValueT>
+class StorageRegistry {
+ public:
+  StorageRegistry() {
+    for (auto &bucket : buckets_) {
+      bucket.store(nullptr, std::memory_order_relaxed);
     }
-    parametric_instances_.clear();
   }
 
-  // Get the storage of parametric type, if not in the cache, create and
-  // insert the cache.
-  StorageBase *GetOrCreate(std::size_t hash_value,
-                           std::function<bool(StorageBase *)> equal_func,
-                           std::function<StorageBase *()> constructor) {
-    if (parametric_instances_.count(hash_value) != 0) {
-      auto pr = parametric_instances_.equal_range(hash_value);
-      while (pr.first != pr.second) {
-        if (equal_func(pr.first->second)) {
-          VLOG(4) << "Found a cached parametric storage of: [param_hash="
-                  << hash_value << ", storage_ptr=" << pr.first->second << "].";
-          return pr.first->second;
-        }
-        ++pr.first;
+  ~StorageRegistry() {
+    for (auto &bucket : buckets_) {
+      const Node *node = bucket.load(std::memory_order_relaxed);
+      while (node != nullptr) {
+        const Node *next = node->next;
+        delete node;
+        node = next;
       }
     }
-    StorageBase *storage = constructor();
-    parametric_instances_.emplace(hash_value, storage);
-    VLOG(4) << "No cache found, construct and cache a new parametric storage "
-               "of: [param_hash="
-            << hash_value << ", storage_ptr=" << storage << "].";
-    return storage;
+  }
+
+  // Returns nullptr if type_id is not registered.
+  const ValueT *Find(TypeId type_id) const {
+    const Node *node =
+        buckets_[BucketIndex(type_id)].load(std::memory_order_acquire);
+    for (; node != nullptr; node = node->next) {
+      if (node->type_id == type_id) return &node->value;
+    }
+    return nullptr;
+  }
+
+  // Returns false if type_id is already registered.
+  bool Insert(TypeId type_id, ValueT &&value) {
+    std::lock_guard<ir::SpinLock> guard(lock_);
+    if (Find(type_id) != nullptr) return false;
+    auto &bucket = buckets_[BucketIndex(type_id)];
+    bucket.store(new Node{type_id,
+                          std::move(value),
+                          bucket.load(std::memory_order_relaxed)},
+                 std::memory_order_release);
+    return true;
   }
 
  private:
-  // In order to prevent hash conflicts, the unordered_multimap data structure
-  // is used for storage.
-  std::unordered_multimap<size_t, StorageBase *> parametric_instances_;
-  std::function<void(StorageBase *)> destroy_;
+  struct Node {
+    TypeId type_id;
+    ValueT value;
+    const Node *next;
+  };
+
+  static constexpr size_t kNumBuckets = 256;
+
+  static size_t BucketIndex(TypeId type_id) {
+    return std::hash<TypeId>()(type_id) % kNumBuckets;
+  }
+
+  std::atomic<const Node *> buckets_[kNumBuckets];
+  ir::SpinLock lock_;
 };
 
-StorageManager::StorageManager() {}
+constexpr size_t ParametricStorageManager::kNumShards;
+constexpr size_t ParametricStorageManager::kInitialNumBuckets;
+
+ParametricStorageManager::Table::Table(size_t num_buckets)
+    : mask(num_buckets - 1),
+      buckets(new std::atomic<const Node *>[num_buckets]) {
+  for (size_t i = 0; i < num_buckets; ++i) {
+    buckets[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+ParametricStorageManager::ParametricStorageManager(
+    std::function<void(StorageBase *)> destroy)
+    : destroy_(destroy) {
+  for (auto &shard : shards_) {
+    shard.tables.push_back(std::make_unique<Table>(kInitialNumBuckets));
+    shard.table.store(shard.tables.back().get(), std::memory_order_release);
+  }
+}
+
+ParametricStorageManager::~ParametricStorageManager() {
+  // Every storage is held by exactly one node of the current table.
+  for (auto &shard : shards_) {
+    for (const auto &node : shard.tables.back()->nodes) {
+      destroy_(node->storage);
+    }
+  }
+}
+
+void ParametricStorageManager::InsertNode(Table *table,
+                                          std::size_t hash_value,
+                                          StorageBase *storage) {
+  auto &bucket = table->buckets[BucketIndex(*table, hash_value)];
+  table->nodes.emplace_back(new Node{
+      hash_value, storage, bucket.load(std::memory_order_relaxed)});
+  bucket.store(table->nodes.back().get(), std::memory_order_release);
+}
+
+void ParametricStorageManager::Insert(Shard *shard,
+                                      std::size_t hash_value,
+                                      StorageBase *storage) {
+  Table *table = shard->tables.back().get();
+  if (table->nodes.size() > table->mask) {
+    // The load factor reaches 1, rehash into a table twice as large. The old
+    // nodes are copied rather than relinked, so that concurrent lookups can
+    // finish walking the old table.
+    auto new_table = std::make_unique<Table>((table->mask + 1) * 2);
+    for (const auto &node : table->nodes) {
+      InsertNode(new_table.get(), node->hash_value, node->storage);
+    }
+    shard->tables.push_back(std::move(new_table));
+    table = shard->tables.back().get();
+  }
+  InsertNode(table, hash_value, storage);
+  shard->table.store(table, std::memory_order_release);
+  VLOG(4) << "No cache found, construct and cache a new parametric storage "
+             "of: [param_hash="
+          << hash_value << ", storage_ptr=" << storage << "].";
+}
+
+StorageManager::StorageManager()
+    : parametric_instance_(std::make_unique<StorageRegistry<
+                               std::unique_ptr<ParametricStorageManager>>>()),
+      parameterless_instance_(
+          std::make_unique<StorageRegistry<StorageBase *>>()) {}
 
 StorageManager::~StorageManager() = default;
 
-StorageManager::StorageBase *StorageManager::GetParametricStorageImpl(
-    TypeId type_id,
-    std::size_t hash_value,
-    std::function<bool(const StorageBase *)> equal_func,
-    std::function<StorageBase *()> constructor) {
-  std::lock_guard<ir::SpinLock> guard(parametric_instance_lock_);
-  VLOG(4) << "Try to get a parametric storage of: [TypeId_hash="
-          << std::hash<ir::TypeId>()(type_id) << ", param_hash=" << hash_value
-          << "].";
-  if (parametric_instance_.find(type_id) == parametric_instance_.end()) {
+ParametricStorageManager &StorageManager::GetParametricStorageManager(
+    TypeId type_id) {
+  auto *parametric_storage = parametric_instance_->Find(type_id);
+  if (parametric_storage == nullptr) {
     IR_THROW("The input data pointer is null.");
   }
-  ParametricStorageManager &parametric_storage = *parametric_instance_[type_id];
-  return parametric_storage.GetOrCreate(hash_value, equal_func, constructor);
+  return **parametric_storage;
 }
 
 StorageManager::StorageBase *StorageManager::GetParameterlessStorageImpl(
     TypeId type_id) {
-  std::lock_guard<ir::SpinLock> guard(parameterless_instance_lock_);
   VLOG(4) << "Try to get a parameterless storage of: [TypeId_hash="
           << std::hash<ir::TypeId>()(type_id) << "].";
-  if (parameterless_instance_.find(type_id) == parameterless_instance_.end())
+  auto *parameterless_instance = parameterless_instance_->Find(type_id);
+  if (parameterless_instance == nullptr)
     IR_THROW("TypeId not found in IrContext.");
-  StorageBase *parameterless_instance = parameterless_instance_[type_id];
-  return parameterless_instance;
+  return *parameterless_instance;
 }
 
 void StorageManager::RegisterParametricStorageImpl(
     TypeId type_id, std::function<void(StorageBase *)> destroy) {
-  std::lock_guard<ir::SpinLock> guard(parametric_instance_lock_);
   VLOG(4) << "Register a parametric storage of: [TypeId_hash="
           << std::hash<ir::TypeId>()(type_id) << "].";
-  parametric_instance_.emplace(
+  parametric_instance_->Insert(
       type_id, std::make_unique<ParametricStorageManager>(destroy));
 }
 
 void StorageManager::RegisterParameterlessStorageImpl(
-    TypeId type_id, std::function<StorageBase *()> constructor) {
-  std::lock_guard<ir::SpinLock> guard(parameterless_instance_lock_);
+    TypeId type_id,
+    std::function<StorageBase *()> constructor,
+    std::function<void(StorageBase *)> destroy) {
   VLOG(4) << "Register a parameterless storage of: [TypeId_hash="
           << std::hash<ir::TypeId>()(type_id) << "].";
-  if (parameterless_instance_.find(type_id) != parameterless_instance_.end())
+  if (parameterless_instance_->Find(type_id) != nullptr)
     IR_THROW("storage class already registered");
-  parameterless_instance_.emplace(type_id, constructor());
+  // Another thread may register the same type id after the Find.
+  StorageBase *storage = constructor();
+  if (!parameterless_instance_->Insert(type_id, std::move(storage))) {
+    destroy(storage);
+    IR_THROW("storage class already registered");
+  }
 }
 
 }  // namespace ir
@@ -14,19 +14,21 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <type_traits>
-#include <unordered_map>
+#include <vector>
 
 #include "paddle/ir/core/spin_lock.h"
 #include "paddle/ir/core/type_id.h"
 
 namespace ir {
-///
-/// \brief The implementation of the class StorageManager.
-///
-// struct StorageManagerImpl;
-struct ParametricStorageManager;
+class ParametricStorageManager;
+
+template <typename ValueT>
+class StorageRegistry;
 
 ///
 /// \brief A utility class for getting or creating Storage class instances.
@@ -39,6 +41,8 @@ struct ParametricStorageManager;
 /// provide a hash method on the ParamKey for storage and access; (3) Need to
 /// provide method 'bool operator==(const ParamKey &) const', used to compare
 /// Storage instance and ParamKey instance.
+/// NOTE: Getting a storage instance never takes a lock once the storage is
+/// created, only registering and creating storage instances do.
 ///
 class StorageManager {
  public:
@@ -63,24 +67,10 @@ class StorageManager {
   /// \param args Parameters of the wrapped function.
   /// \return A uniqued instance of Storage.
   ///
-  template <typename Storage, typename... Args>
-  Storage *GetParametricStorage(std::function<void(Storage *)> init_func,
+  template <typename Storage, typename InitFunc, typename... Args>
+  Storage *GetParametricStorage(InitFunc &&init_func,
                                 TypeId type_id,
-                                Args &&...args) {
-    typename Storage::ParamKey param =
-        typename Storage::ParamKey(std::forward<Args>(args)...);
-    std::size_t hash_value = Storage::HashValue(param);
-    auto equal_func = [&param](const StorageBase *existing) {
-      return static_cast<const Storage &>(*existing) == param;
-    };
-    auto constructor = [&]() {
-      auto *storage = Storage::Construct(param);
-      if (init_func) init_func(storage);
-      return storage;
-    };
-    return static_cast<Storage *>(
-        GetParametricStorageImpl(type_id, hash_value, equal_func, constructor));
-  }
+                                Args &&...args);
 
   ///
   /// \brief Get a unique storage instance of parameterless Type.
@@ -119,15 +109,14 @@ class StorageManager {
       if (init_func) init_func(storage);
       return storage;
     };
-    RegisterParameterlessStorageImpl(type_id, constructor);
+    RegisterParameterlessStorageImpl(
+        type_id, constructor, [](StorageBase *storage) {
+          delete static_cast<Storage *>(storage);
+        });
   }
 
  private:
-  StorageBase *GetParametricStorageImpl(
-      TypeId type_id,
-      std::size_t hash_value,
-      std::function<bool(const StorageBase *)> equal_func,
-      std::function<StorageBase *()> constructor);
+  ParametricStorageManager &GetParametricStorageManager(TypeId type_id);
 
   StorageBase *GetParameterlessStorageImpl(TypeId type_id);
 
@@ -135,18 +124,144 @@ class StorageManager {
       TypeId type_id, std::function<void(StorageBase *)> destroy);
 
   void RegisterParameterlessStorageImpl(
-      TypeId type_id, std::function<StorageBase *()> constructor);
+      TypeId type_id,
+      std::function<StorageBase *()> constructor,
+      std::function<void(StorageBase *)> destroy);
 
   // This map is a mapping between type id and parametric type storage.
-  std::unordered_map<TypeId, std::unique_ptr<ParametricStorageManager>>
+  std::unique_ptr<StorageRegistry<std::unique_ptr<ParametricStorageManager>>>
       parametric_instance_;
 
-  ir::SpinLock parametric_instance_lock_;
-
   // This map is a mapping between type id and parameterless type storage.
-  std::unordered_map<TypeId, StorageBase *> parameterless_instance_;
+  std::unique_ptr<StorageRegistry<StorageBase *>> parameterless_instance_;
+};
+
+///
+/// \brief This is a structure for creating, caching, and looking up Storage of
+/// a parametric type. The storages are kept in kNumShards hash tables selected
+/// by the hash value. Lookups don't take any lock: the nodes of a table are
+/// immutable once they are published to a bucket, and a table is never freed
+/// before the manager when the shard grows. Creating a storage only locks the
+/// shard it belongs to.
+///
+class ParametricStorageManager {
+ public:
+  using StorageBase = StorageManager::StorageBase;
+
+  static constexpr size_t kNumShards = 16;
+  static constexpr size_t kInitialNumBuckets = 16;
 
-  ir::SpinLock parameterless_instance_lock_;
+  explicit ParametricStorageManager(
+      std::function<void(StorageBase *)> destroy);
+
+  ~ParametricStorageManager();
+
+  ///
+  /// \brief Find the cached storage equal to the parameter.
+  ///
+  /// \param hash_value The hash value of the parameter.
+  /// \param equal_func Returns true if the storage equals to the parameter.
+  /// \return The cached storage, or nullptr if not found.
+  ///
+  template <typename EqualFunc>
+  StorageBase *Lookup(std::size_t hash_value,
+                      const EqualFunc &equal_func) const {
+    const Shard &shard = shards_[ShardIndex(hash_value)];
+    const Table *table = shard.table.load(std::memory_order_acquire);
+    const Node *node = table->buckets[BucketIndex(*table, hash_value)].load(
+        std::memory_order_acquire);
+    for (; node != nullptr; node = node->next) {
+      if (node->hash_value == hash_value && equal_func(node->storage)) {
+        return node->storage;
+      }
+    }
+    return nullptr;
+  }
+
+  ///
+  /// \brief Get the storage of parametric type, if not in the cache, create
+  /// and insert the cache.
+  ///
+  template <typename EqualFunc, typename Constructor>
+  StorageBase *GetOrCreate(std::size_t hash_value,
+                           const EqualFunc &equal_func,
+                           const Constructor &constructor) {
+    StorageBase *storage = Lookup(hash_value, equal_func);
+    if (storage != nullptr) return storage;
+
+    Shard &shard = shards_[ShardIndex(hash_value)];
+    std::lock_guard<ir::SpinLock> guard(shard.lock);
+    // Another thread may have created the storage before the lock is taken.
+    storage = Lookup(hash_value, equal_func);
+    if (storage != nullptr) return storage;
+    storage = constructor();
+    Insert(&shard, hash_value, storage);
+    return storage;
+  }
+
+ private:
+  struct Node {
+    std::size_t hash_value;
+    StorageBase *storage;
+    const Node *next;
+  };
+
+  struct Table {
+    explicit Table(size_t num_buckets);
+
+    size_t mask;
+    std::unique_ptr<std::atomic<const Node *>[]> buckets;
+    std::vector<std::unique_ptr<Node>> nodes;
+  };
+
+  struct Shard {
+    // The table visible to lookups, which is tables.back().
+    std::atomic<const Table *> table{nullptr};
+    // All tables created by this shard, the retired ones are only released
+    // with the manager since lookups may still be walking them.
+    std::vector<std::unique_ptr<Table>> tables;
+    ir::SpinLock lock;
+  };
+
+  // The low bits select the shard and the remaining bits select the bucket,
+  // so that the storages of a shard are spread over all of its buckets.
+  static size_t ShardIndex(std::size_t hash_value) {
+    return hash_value % kNumShards;
+  }
+
+  static size_t BucketIndex(const Table &table, std::size_t hash_value) {
+    return (hash_value / kNumShards) & table.mask;
+  }
+
+  static void InsertNode(Table *table,
+                         std::size_t hash_value,
+                         StorageBase *storage);
+
+  // Insert a newly created storage, the lock of shard must be held.
+  void Insert(Shard *shard, std::size_t hash_value, StorageBase *storage);
+
+  Shard shards_[kNumShards];
+  std::function<void(StorageBase *)> destroy_;
 };
 
+template <typename Storage, typename InitFunc, typename... Args>
+Storage *StorageManager::GetParametricStorage(InitFunc &&init_func,
+                                              TypeId type_id,
+                                              Args &&...args) {
+  typename Storage::ParamKey param =
+      typename Storage::ParamKey(std::forward<Args>(args)...);
+  std::size_t hash_value = Storage::HashValue(param);
+  auto equal_func = [&param](const StorageBase *existing) {
+    return static_cast<const Storage &>(*existing) == param;
+  };
+  auto constructor = [&]() {
+    auto *storage = Storage::Construct(param);
+    init_func(storage);
+    return storage;
+  };
+  return static_cast<Storage *>(
+      GetParametricStorageManager(type_id).GetOrCreate(
+          hash_value, equal_func, constructor));
+}
+
 }  // namespace ir
@@ -39,6 +39,8 @@ Value OpOperand::source() const { return impl_->source(); }
 
 Operation *OpOperand::owner() const { return impl_->owner(); }
 
+void OpOperand::set_source(Value value) { impl_->set_source(value); }
+
 // Value
 Value::Value(const detail::ValueImpl *impl)
     : impl_(const_cast<detail::ValueImpl *>(impl)) {}
@@ -76,6 +78,15 @@ Value::use_iterator Value::end() const { return Value::use_iterator(); }
 
 OpOperand Value::first_use() const { return impl()->first_use(); }
 
+bool Value::use_empty() const { return impl()->use_empty(); }
+
+void Value::ReplaceAllUsesWith(Value new_value) const {
+  if (*this == new_value) return;
+  while (!use_empty()) {
+    first_use().set_source(new_value);
+  }
+}
+
 // OpResult
 bool OpResult::classof(Value value) {
   return ir::isa<detail::OpResultImpl>(value.impl());
@@ -107,15 +118,25 @@ void OpOperandImpl::release_source() { source_ = nullptr; }
 
 OpOperandImpl::OpOperandImpl(ir::Value source, ir::Operation *owner)
     : source_(source), owner_(owner) {
-  if (!source) {
+  insert_to_ud_chain();
+}
+
+void OpOperandImpl::set_source(ir::Value source) {
+  remove_from_ud_chain();
+  source_ = source;
+  insert_to_ud_chain();
+}
+
+void OpOperandImpl::insert_to_ud_chain() {
+  if (!source_) {
     return;
   }
-  prev_use_addr_ = source.impl()->first_use_addr();
-  next_use_ = source.impl()->first_use();
+  prev_use_addr_ = source_.impl()->first_use_addr();
+  next_use_ = source_.impl()->first_use();
   if (next_use_) {
     next_use_->prev_use_addr_ = &next_use_;
   }
-  source.impl()->SetFirstUse(this);
+  source_.impl()->SetFirstUse(this);
 }
 
 void OpOperandImpl::remove_from_ud_chain() {
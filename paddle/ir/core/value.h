@@ -57,6 +57,12 @@ class OpOperand {
 
   Operation *owner() const;
 
+  ///
+  /// \brief Set the source of this operand, the operand will be removed from
+  /// the use list of the old source and added to the use list of the new one.
+  ///
+  void set_source(Value value);
+
   //  detail::OpOperandImpl *impl() const { return impl_;}
 
  private:
@@ -150,6 +156,13 @@ class Value {
 
   OpOperand first_use() const;
 
+  bool use_empty() const;
+
+  ///
+  /// \brief Replace all uses of this value with new_value.
+  ///
+  void ReplaceAllUsesWith(Value new_value) const;
+
   friend struct std::hash<Value>;
 
  protected:
@@ -35,6 +35,10 @@ class OpOperandImpl {
 
   void release_source();
 
+  /// Reset the source of this operand, and move it to the use list of the new
+  /// source.
+  void set_source(ir::Value source);
+
   /// Remove this operand from the current use list.
   void remove_from_ud_chain();
 
@@ -45,6 +49,9 @@ class OpOperandImpl {
  private:
   OpOperandImpl(ir::Value source, ir::Operation *owner);
 
+  /// Insert this operand to the front of the use list of source_.
+  void insert_to_ud_chain();
+
   ir::detail::OpOperandImpl *next_use_ = nullptr;
 
   ir::detail::OpOperandImpl **prev_use_addr_ = nullptr;
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -33,6 +34,29 @@ class Operation;
 class AnalysisManager;
 class PassInstrumentor;
 
+///
+/// \brief The features of the IR which an analysis is computed from. An
+/// analysis declares the features it depends on with a static member
+/// `kDependentIrFeatures`, and a pass reports the features it changed through
+/// Pass::MarkChangedIrFeatures(). After a pass is run, only the analyses
+/// depending on the changed features are invalidated. An analysis without the
+/// declaration depends on all features.
+///
+struct IrFeatures {
+  enum : uint32_t {
+    kNone = 0,
+    // The insertion, erasure and order of operations, blocks and regions.
+    kOperations = 1u << 0,
+    // The operands of operations, i.e. the use-def chains.
+    kOperands = 1u << 1,
+    // The attributes of operations.
+    kAttributes = 1u << 2,
+    // The types of values.
+    kTypes = 1u << 3,
+    kAll = ~0u,
+  };
+};
+
 namespace detail {
 
 /// A utility class to reprensent the analyses that are kwnown to be preserved.
@@ -74,11 +98,22 @@ class PreservedAnalyses {
     preserved_ids_.erase(TypeId::get<AnalysisT>());
   }
 
+  /// Mark that only the given IrFeatures have been changed, the analyses not
+  /// depending on them are preserved as well. All features are considered
+  /// changed by default.
+  void SetChangedIrFeatures(uint32_t features) {
+    changed_ir_features_ = features;
+  }
+
+  uint32_t changed_ir_features() const { return changed_ir_features_; }
+
  private:
   template <typename>
   friend struct AnalysisModel;
 
   std::unordered_set<TypeId> preserved_ids_;
+
+  uint32_t changed_ir_features_{IrFeatures::kAll};
 };
 
 namespace detail {
@@ -96,10 +131,30 @@ IsInvalidated(AnalysisT& analysis, const PreservedAnalyses& pa) {  // NOLINT
 }
 
 /// Default implementation of `IsInvalidated`.
+template <typename T>
+using has_dependent_ir_features = decltype(T::kDependentIrFeatures);
+
+template <typename AnalysisT>
+constexpr std::enable_if_t<
+    is_detected<has_dependent_ir_features, AnalysisT>::value,
+    uint32_t>
+GetDependentIrFeatures() {
+  return AnalysisT::kDependentIrFeatures;
+}
+
+template <typename AnalysisT>
+constexpr std::enable_if_t<
+    !is_detected<has_dependent_ir_features, AnalysisT>::value,
+    uint32_t>
+GetDependentIrFeatures() {
+  return IrFeatures::kAll;
+}
+
 template <typename AnalysisT>
 std::enable_if_t<!is_detected<has_is_invalidated, AnalysisT>::value, bool>
 IsInvalidated(AnalysisT& analysis, const PreservedAnalyses& pa) {  // NOLINT
-  return !pa.IsPreserved<AnalysisT>();
+  return !pa.IsPreserved<AnalysisT>() &&
+         (GetDependentIrFeatures<AnalysisT>() & pa.changed_ir_features()) != 0;
 }
 }  // namespace detail
 
@@ -190,7 +245,11 @@ class AnalysisMap {
                              AnalysisManager& am) {  // NOLINT
     TypeId id = TypeId::get<AnalysisT>();
     auto it = analyses_.find(id);
-    if (it == analyses_.end()) {
+    if (it != analyses_.end()) {
+      if (pi) {
+        pi->RunAfterAnalysisCacheHit(GetAnalysisName<AnalysisT>(), id, ir_);
+      }
+    } else {
       if (pi) {
         pi->RunBeforeAnalysis(GetAnalysisName<AnalysisT>(), id, ir_);
       }
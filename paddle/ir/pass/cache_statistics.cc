@@ -0,0 +1,69 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/ir/pass/cache_statistics.h"
+
+namespace ir {
+
+CacheStatistics &CacheStatistics::Instance() {
+  static CacheStatistics statistics;
+  return statistics;
+}
+
+CacheStatistics::Counter *CacheStatistics::GetCounter(
+    const std::string &name) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto &counter = counters_[name];
+  if (!counter) counter = std::make_unique<Counter>();
+  return counter.get();
+}
+
+void CacheStatistics::ForEach(
+    const std::function<void(const std::string &, const Counter &)> &func)
+    const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (auto &counter : counters_) {
+    func(counter.first, *counter.second);
+  }
+}
+
+void CacheStatistics::Reset() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (auto &counter : counters_) {
+    counter.second->hits = 0;
+    counter.second->misses = 0;
+  }
+}
+
+CacheStatistics::Scope::Scope() {
+  CacheStatistics::Instance().ForEach(
+      [this](const std::string &name, const Counter &counter) {
+        start_[name] = std::make_pair(counter.hits.load(),
+                                      counter.misses.load());
+      });
+}
+
+size_t CacheStatistics::Scope::hits(const std::string &name) const {
+  auto it = start_.find(name);
+  size_t start = it == start_.end() ? 0 : it->second.first;
+  return CacheStatistics::Instance().GetCounter(name)->hits - start;
+}
+
+size_t CacheStatistics::Scope::misses(const std::string &name) const {
+  auto it = start_.find(name);
+  size_t start = it == start_.end() ? 0 : it->second.second;
+  return CacheStatistics::Instance().GetCounter(name)->misses - start;
+}
+
+}  // namespace ir
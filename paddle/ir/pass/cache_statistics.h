@@ -0,0 +1,80 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace ir {
+
+///
+/// \brief CacheStatistics collects the hits and misses of the caches which
+/// speed up building and transforming programs outside of the analysis
+/// manager, e.g. the translation cache of the legacy programs. The counters
+/// are process wide and reported by the pass timing instrumentation.
+///
+class CacheStatistics {
+ public:
+  struct Counter {
+    std::atomic<size_t> hits{0};
+    std::atomic<size_t> misses{0};
+  };
+
+  ///
+  /// \brief Scope reports the hits and misses counted since it was created,
+  /// so that the users, e.g. the tests, are not affected by the caches used
+  /// before and don't have to reset the process wide counters.
+  ///
+  class Scope {
+   public:
+    Scope();
+
+    size_t hits(const std::string &name) const;
+    size_t misses(const std::string &name) const;
+
+   private:
+    std::map<std::string, std::pair<size_t, size_t>> start_;
+  };
+
+  static CacheStatistics &Instance();
+
+  ///
+  /// \brief Get the counter of the named cache, which is created on first
+  /// use. The counter is never destroyed, so the callers can keep it.
+  ///
+  Counter *GetCounter(const std::string &name);
+
+  /// Call func on every counter, in the order of names.
+  void ForEach(
+      const std::function<void(const std::string &, const Counter &)> &func)
+      const;
+
+  /// Set all counters to zero.
+  void Reset();
+
+ private:
+  CacheStatistics() = default;
+
+  mutable std::mutex mutex_;
+  std::map<std::string, std::unique_ptr<Counter>> counters_;
+};
+
+}  // namespace ir
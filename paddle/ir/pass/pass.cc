@@ -13,6 +13,14 @@
 // limitations under the License.
 
 #include "paddle/ir/pass/pass.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "paddle/ir/core/builtin_op.h"
 #include "paddle/ir/core/ir_context.h"
 #include "paddle/ir/core/operation.h"
 #include "paddle/ir/core/program.h"
@@ -20,9 +28,46 @@
 #include "paddle/ir/pass/pass_adaptor.h"
 #include "paddle/ir/pass/pass_instrumentation.h"
 #include "paddle/ir/pass/pass_manager.h"
+#include "paddle/ir/pass/thread_pool.h"
 
 namespace ir {
 
+namespace detail {
+namespace {
+// The execution states of the passes running on the current thread.
+thread_local std::unordered_map<const Pass*, PassExecutionState*> pass_states;
+
+// Set the execution state of a pass on the current thread during the scope,
+// the previous state is restored on exit since the adaptor runs re-entrantly.
+class PassExecutionStateScope {
+ public:
+  PassExecutionStateScope(const Pass* pass, PassExecutionState* state)
+      : pass_(pass) {
+    auto& slot = pass_states[pass];
+    prev_state_ = slot;
+    slot = state;
+  }
+
+  ~PassExecutionStateScope() {
+    if (prev_state_) {
+      pass_states[pass_] = prev_state_;
+    } else {
+      pass_states.erase(pass_);
+    }
+  }
+
+ private:
+  const Pass* pass_;
+  PassExecutionState* prev_state_;
+};
+}  // namespace
+
+PassExecutionState* GetPassExecutionState(const Pass* pass) {
+  auto it = pass_states.find(pass);
+  return it == pass_states.end() ? nullptr : it->second;
+}
+}  // namespace detail
+
 //===----------------------------------------------------------------------===//
 // Pass
 //===----------------------------------------------------------------------===//
@@ -41,17 +86,42 @@ void detail::PassAdaptor::RunImpl(Operation* op,
                                   uint8_t opt_level,
                                   bool verify) {
   auto last_am = analysis_manager();
+  ThreadPool* thread_pool = pm_->thread_pool_.get();
 
   for (size_t i = 0; i < op->num_regions(); ++i) {
     auto& region = op->GetRegion(i);
     for (auto it = region.begin(); it != region.end(); ++it) {
       auto* block = *it;
+      // The isolated operations don't share any value with their siblings, so
+      // the pipeline can be run on them concurrently. Except for the ones
+      // allocated from an arena, since the operations a pass creates or
+      // destroys in them go through the arena, which is not thread-safe.
+      std::vector<Operation*> isolated_ops;
       for (auto it = block->begin(); it != block->end(); ++it) {
         auto* op = *it;
+        if (thread_pool && op->HasTrait<IsolatedFromAboveTrait>() &&
+            op->arena() == nullptr) {
+          isolated_ops.push_back(op);
+          continue;
+        }
         AnalysisManagerHolder am(op, last_am.GetPassInstrumentor());
         if (!RunPipeline(*pm_, op, am, opt_level, verify))
           return SignalPassFailure();
       }
+
+      if (isolated_ops.empty()) continue;
+      std::atomic<bool> pipeline_failed{false};
+      thread_pool->ParallelFor(isolated_ops.size(), [&](size_t index) {
+        if (pipeline_failed) return;
+        // Each operation has its own analysis manager, which is only
+        // accessed by the thread running the pipeline on it.
+        AnalysisManagerHolder am(isolated_ops[index],
+                                 last_am.GetPassInstrumentor());
+        if (!RunPipeline(*pm_, isolated_ops[index], am, opt_level, verify)) {
+          pipeline_failed = true;
+        }
+      });
+      if (pipeline_failed) return SignalPassFailure();
     }
   }
   return;
@@ -94,7 +164,8 @@ bool detail::PassAdaptor::RunPass(Pass* pass,
                                   bool verify) {
   if (opt_level < pass->pass_info().opt_level) return true;
 
-  pass->pass_state_ = PassExecutionState(op, am);
+  PassExecutionState pass_state(op, am);
+  PassExecutionStateScope pass_state_scope(pass, &pass_state);
 
   PassInstrumentor* instrumentor = am.GetPassInstrumentor();
 
@@ -104,9 +175,12 @@ bool detail::PassAdaptor::RunPass(Pass* pass,
     if (instrumentor) instrumentor->RunBeforePass(pass, op);
     pass->Run(op);
     if (instrumentor) instrumentor->RunAfterPass(pass, op);
+
+    // Drop the cached analyses which were invalidated by the pass.
+    am.Invalidate(pass_state.preserved_analyses);
   }
 
-  bool pass_failed = pass->pass_state().pass_failed;
+  bool pass_failed = pass_state.pass_failed;
 
   // TODO(liuyuanle): Support verification of operation
   if (!pass_failed && verify) {
@@ -125,6 +199,8 @@ PassManager::PassManager(IrContext* context, uint8_t opt_level)
   pass_adaptor_ = std::make_unique<detail::PassAdaptor>(this);
 }
 
+PassManager::~PassManager() = default;
+
 bool PassManager::Run(Program* program) {
   if (!Initialize(context_)) {
     return false;
@@ -153,13 +229,25 @@ void PassManager::AddInstrumentation(std::unique_ptr<PassInstrumentation> pi) {
   instrumentor_->AddInstrumentation(std::move(pi));
 }
 
+void PassManager::EnableMultiThreading(size_t num_threads) {
+  if (num_threads == 0) {
+    num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  thread_pool_.reset();
+  if (num_threads > 1) {
+    thread_pool_ = std::make_unique<detail::ThreadPool>(num_threads);
+  }
+}
+
 //----------------------------------------------------------------------------------------------//
 // PassInstrumentor
 //----------------------------------------------------------------------------------------------//
 namespace detail {
 struct PassInstrumentorImpl {
-  // TODO(wilber): Support multi-thread.
   std::vector<std::unique_ptr<PassInstrumentation>> instrumentations;
+
+  // The passes may run on several threads, so the callbacks are serialized.
+  std::mutex mutex;
 };
 }  // namespace detail
 
@@ -170,6 +258,7 @@ PassInstrumentor::~PassInstrumentor() = default;
 
 void PassInstrumentor::RunBeforePipeline(Operation* op) {
   if (op->num_regions() == 0) return;
+  std::lock_guard<std::mutex> guard(impl_->mutex);
   for (auto& instr : impl_->instrumentations) {
     instr->RunBeforePipeline(op);
   }
@@ -177,6 +266,7 @@ void PassInstrumentor::RunBeforePipeline(Operation* op) {
 
 void PassInstrumentor::RunAfterPipeline(Operation* op) {
   if (op->num_regions() == 0) return;
+  std::lock_guard<std::mutex> guard(impl_->mutex);
   for (auto it = impl_->instrumentations.rbegin();
        it != impl_->instrumentations.rend();
        ++it) {
@@ -186,6 +276,7 @@ void PassInstrumentor::RunAfterPipeline(Operation* op) {
 
 void PassInstrumentor::RunBeforePass(Pass* pass, Operation* op) {
   if (op->num_regions() == 0) return;
+  std::lock_guard<std::mutex> guard(impl_->mutex);
   for (auto& instr : impl_->instrumentations) {
     instr->RunBeforePass(pass, op);
   }
@@ -193,6 +284,7 @@ void PassInstrumentor::RunBeforePass(Pass* pass, Operation* op) {
 
 void PassInstrumentor::RunAfterPass(Pass* pass, Operation* op) {
   if (op->num_regions() == 0) return;
+  std::lock_guard<std::mutex> guard(impl_->mutex);
   for (auto it = impl_->instrumentations.rbegin();
        it != impl_->instrumentations.rend();
        ++it) {
@@ -204,6 +296,7 @@ void PassInstrumentor::RunBeforeAnalysis(const std::string& name,
                                          TypeId id,
                                          Operation* op) {
   if (op->num_regions() == 0) return;
+  std::lock_guard<std::mutex> guard(impl_->mutex);
   for (auto& instr : impl_->instrumentations) {
     instr->RunBeforeAnalysis(name, id, op);
   }
@@ -213,15 +306,27 @@ void PassInstrumentor::RunAfterAnalysis(const std::string& name,
                                         TypeId id,
                                         Operation* op) {
   if (op->num_regions() == 0) return;
+  std::lock_guard<std::mutex> guard(impl_->mutex);
   for (auto it = impl_->instrumentations.rbegin();
        it != impl_->instrumentations.rend();
        ++it) {
-    (*it)->RunBeforeAnalysis(name, id, op);
+    (*it)->RunAfterAnalysis(name, id, op);
+  }
+}
+
+void PassInstrumentor::RunAfterAnalysisCacheHit(const std::string& name,
+                                                TypeId id,
+                                                Operation* op) {
+  if (op->num_regions() == 0) return;
+  std::lock_guard<std::mutex> guard(impl_->mutex);
+  for (auto& instr : impl_->instrumentations) {
+    instr->RunAfterAnalysisCacheHit(name, id, op);
   }
 }
 
 void PassInstrumentor::AddInstrumentation(
     std::unique_ptr<PassInstrumentation> pi) {
+  std::lock_guard<std::mutex> guard(impl_->mutex);
   impl_->instrumentations.emplace_back(std::move(pi));
 }
 
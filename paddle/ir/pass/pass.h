@@ -20,12 +20,12 @@
 
 #include "paddle/ir/pass/analysis_manager.h"
 #include "paddle/phi/core/enforce.h"
-#include "paddle/utils/optional.h"
 
 namespace ir {
 
 class IrContext;
 class Operation;
+class Pass;
 
 namespace detail {
 class PassAdaptor;
@@ -65,6 +65,12 @@ struct PassInfo {
   std::vector<std::string> dependents;
 };
 
+// Returns the execution state of pass on the current thread, or nullptr if
+// the pass is not running on the current thread. When multi-threading is
+// enabled, the same pass may run on several operations concurrently, each
+// thread sees its own state.
+PassExecutionState* GetPassExecutionState(const Pass* pass);
+
 }  // namespace detail
 
 /// We can access pass only from PassManager.
@@ -91,19 +97,34 @@ class Pass {
   AnalysisManager analysis_manager() { return pass_state().am; }
 
   detail::PassExecutionState& pass_state() {
-    PADDLE_ENFORCE_EQ(pass_state_.is_initialized(),
-                      true,
-                      phi::errors::Fatal("pass state was never initialized"));
-    return *pass_state_;
+    detail::PassExecutionState* state = detail::GetPassExecutionState(this);
+    PADDLE_ENFORCE_NOT_NULL(
+        state, phi::errors::Fatal("pass state was never initialized"));
+    return *state;
   }
 
   void SignalPassFailure() { pass_state().pass_failed = true; }
 
+  /// Mark all analyses as preserved, i.e. the pass doesn't change the IR.
+  void MarkAllAnalysesPreserved() {
+    pass_state().preserved_analyses.PreserveAll();
+  }
+
+  /// Mark the given analyses as preserved.
+  template <typename... AnalysesT>
+  void MarkAnalysesPreserved() {
+    pass_state().preserved_analyses.Preserve<AnalysesT...>();
+  }
+
+  /// Report that the pass only changed the given IrFeatures, so that the
+  /// analyses not depending on them are kept in the cache.
+  void MarkChangedIrFeatures(uint32_t features) {
+    pass_state().preserved_analyses.SetChangedIrFeatures(features);
+  }
+
  private:
   detail::PassInfo pass_info_;
 
-  paddle::optional<detail::PassExecutionState> pass_state_;
-
   friend class PassManager;
   friend class detail::PassAdaptor;
 };
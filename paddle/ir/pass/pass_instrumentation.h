@@ -53,6 +53,12 @@ class PassInstrumentation {
   virtual void RunAfterAnalysis(const std::string& name,
                                 TypeId id,
                                 Operation* op) {}
+
+  // A callback to run when a cached analysis is reused instead of being
+  // executed again.
+  virtual void RunAfterAnalysisCacheHit(const std::string& name,
+                                        TypeId id,
+                                        Operation* op) {}
 };
 
 /// This class holds a collection of PassInstrumentation obejcts, and invokes
@@ -78,6 +84,10 @@ class PassInstrumentor {
 
   void RunAfterAnalysis(const std::string& name, TypeId id, Operation* op);
 
+  void RunAfterAnalysisCacheHit(const std::string& name,
+                                TypeId id,
+                                Operation* op);
+
   // TODO(wilber): Add other hooks.
 
  private:
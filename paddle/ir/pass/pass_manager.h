@@ -32,13 +32,14 @@ class PassInstrumentor;
 
 namespace detail {
 class PassAdaptor;
+class ThreadPool;
 }
 
 class PassManager {
  public:
   explicit PassManager(IrContext *context, uint8_t opt_level = 2);
 
-  ~PassManager() = default;
+  ~PassManager();
 
   const std::vector<std::unique_ptr<Pass>> &passes() const { return passes_; }
 
@@ -116,6 +117,15 @@ class PassManager {
 
   void AddInstrumentation(std::unique_ptr<PassInstrumentation> pi);
 
+  ///
+  /// \brief Run the pipeline on sibling operations with the
+  /// IsolatedFromAboveTrait concurrently, on a pool of num_threads threads.
+  /// If num_threads is 0, the number of hardware threads is used.
+  /// NOTE: The passes must not modify their own members in Run(), and the
+  /// callbacks of the instrumentations are serialized.
+  ///
+  void EnableMultiThreading(size_t num_threads = 0);
+
  private:
   bool Initialize(IrContext *context);
 
@@ -134,6 +144,8 @@ class PassManager {
 
   std::unique_ptr<PassInstrumentor> instrumentor_;
 
+  std::unique_ptr<detail::ThreadPool> thread_pool_;
+
   // For access member of pass_adaptor_.
   friend class detail::PassAdaptor;
 };
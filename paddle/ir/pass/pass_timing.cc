@@ -14,11 +14,13 @@
 
 #include <chrono>
 #include <iomanip>
+#include <map>
 #include <ostream>
 #include <string>
 #include <unordered_map>
 
 #include "paddle/ir/core/operation.h"
+#include "paddle/ir/pass/cache_statistics.h"
 #include "paddle/ir/pass/pass.h"
 #include "paddle/ir/pass/pass_instrumentation.h"
 #include "paddle/ir/pass/pass_manager.h"
@@ -75,6 +77,18 @@ class PassTimer : public PassInstrumentation {
     pass_timers_[op][pass->name()].Stop();
   }
 
+  void RunBeforeAnalysis(const std::string& name,
+                         TypeId id,
+                         Operation* op) override {
+    ++analysis_counters_[name].misses;
+  }
+
+  void RunAfterAnalysisCacheHit(const std::string& name,
+                                TypeId id,
+                                Operation* op) override {
+    ++analysis_counters_[name].hits;
+  }
+
  private:
   void PrintTime(Operation* op, std::ostream& os) {
     if (print_module_ && op->name() != "builtin.module") return;
@@ -105,6 +119,29 @@ class PassTimer : public PassInstrumentation {
          << "%)"
          << "  " << v.first << "\n";
     }
+
+    if (!analysis_counters_.empty()) {
+      os << "\n  ----Hits----  ----Misses----  ----Analysis----\n";
+      for (auto& v : analysis_counters_) {
+        os << "  " << std::setw(12) << v.second.hits << "  " << std::setw(14)
+           << v.second.misses << "  " << v.first << "\n";
+      }
+    }
+
+    bool print_cache_header = true;
+    CacheStatistics::Instance().ForEach(
+        [&](const std::string& name, const CacheStatistics::Counter& counter) {
+          size_t hits = counter.hits, misses = counter.misses;
+          if (hits + misses == 0) return;
+          if (print_cache_header) {
+            os << "\n  ----Hits----  ----Misses----  ----Hit Rate----  "
+                  "----Cache----\n";
+            print_cache_header = false;
+          }
+          os << "  " << std::setw(12) << hits << "  " << std::setw(14)
+             << misses << "  " << std::setw(15) << std::setprecision(1)
+             << 100.0 * hits / (hits + misses) << "%  " << name << "\n";
+        });
   }
 
  private:
@@ -115,6 +152,14 @@ class PassTimer : public PassInstrumentation {
   std::unordered_map<Operation*,
                      std::unordered_map<std::string /*pass name*/, Timer>>
       pass_timers_;
+
+  struct AnalysisCounter {
+    size_t hits{0};
+    size_t misses{0};
+  };
+
+  // The analyses reused from the cache and computed, of all operations.
+  std::map<std::string /*analysis name*/, AnalysisCounter> analysis_counters_;
 };
 
 void PassManager::EnablePassTiming(bool print_module) {
@@ -0,0 +1,120 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/ir/pass/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace ir {
+namespace detail {
+
+namespace {
+// Whether the current thread is running a task of ParallelFor.
+thread_local bool in_parallel_for = false;
+
+struct ParallelForState {
+  explicit ParallelForState(size_t num_tasks, size_t num_helpers)
+      : num_tasks(num_tasks), pending_helpers(num_helpers) {}
+
+  // Claim and run tasks until there are none left.
+  void Run(const std::function<void(size_t)>& func) {
+    bool prev_in_parallel_for = in_parallel_for;
+    in_parallel_for = true;
+    for (size_t i = next_task++; i < num_tasks; i = next_task++) {
+      try {
+        func(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (!exception) exception = std::current_exception();
+      }
+    }
+    in_parallel_for = prev_in_parallel_for;
+  }
+
+  const size_t num_tasks;
+  std::atomic<size_t> next_task{0};
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  size_t pending_helpers;
+  std::exception_ptr exception;
+};
+}  // namespace
+
+ThreadPool::ThreadPool(size_t num_threads) {
+  for (size_t i = 1; i < num_threads; ++i) {
+    workers_.emplace_back([this] { WorkerLoop(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::WorkerLoop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+      if (stop_ && tasks_.empty()) return;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+void ThreadPool::ParallelFor(size_t num_tasks,
+                             const std::function<void(size_t)>& func) {
+  if (num_tasks == 0) return;
+  if (workers_.empty() || num_tasks == 1 || in_parallel_for) {
+    for (size_t i = 0; i < num_tasks; ++i) {
+      func(i);
+    }
+    return;
+  }
+
+  size_t num_helpers = std::min(workers_.size(), num_tasks - 1);
+  auto state = std::make_shared<ParallelForState>(num_tasks, num_helpers);
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (size_t i = 0; i < num_helpers; ++i) {
+      tasks_.emplace_back([state, &func] {
+        state->Run(func);
+        std::lock_guard<std::mutex> guard(state->mutex);
+        if (--state->pending_helpers == 0) state->cv.notify_one();
+      });
+    }
+  }
+  cv_.notify_all();
+
+  state->Run(func);
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->cv.wait(lock, [&state] { return state->pending_helpers == 0; });
+  if (state->exception) std::rethrow_exception(state->exception);
+}
+
+}  // namespace detail
+}  // namespace ir
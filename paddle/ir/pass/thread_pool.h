@@ -0,0 +1,64 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ir {
+namespace detail {
+
+///
+/// \brief A fixed size thread pool used to run passes on isolated operations
+/// concurrently. The thread calling ParallelFor takes part in the work, so a
+/// pool of num_threads only spawns num_threads - 1 workers.
+///
+class ThreadPool {
+ public:
+  explicit ThreadPool(size_t num_threads);
+
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  size_t num_threads() const { return workers_.size() + 1; }
+
+  ///
+  /// \brief Call func(i) for i in [0, num_tasks) on the threads of the pool,
+  /// and return when all calls are finished. If any call throws, the first
+  /// exception is rethrown on the calling thread. A ParallelFor nested in a
+  /// running task is executed serially on the current thread.
+  ///
+  void ParallelFor(size_t num_tasks, const std::function<void(size_t)>& func);
+
+ private:
+  void WorkerLoop();
+
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  bool stop_{false};
+};
+
+}  // namespace detail
+}  // namespace ir
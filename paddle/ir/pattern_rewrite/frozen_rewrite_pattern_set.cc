@@ -0,0 +1,200 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/ir/pattern_rewrite/frozen_rewrite_pattern_set.h"
+
+#include <algorithm>
+#include <string>
+
+#include "paddle/ir/core/ir_context.h"
+
+namespace ir {
+
+namespace {
+void SortByBenefit(FrozenRewritePatternSet::PatternListT* patterns) {
+  std::stable_sort(
+      patterns->begin(),
+      patterns->end(),
+      [](const RewritePattern* lhs, const RewritePattern* rhs) {
+        return lhs->benefit() > rhs->benefit();
+      });
+}
+
+const FrozenRewritePatternSet::PatternListT& EmptyPatternList() {
+  static const FrozenRewritePatternSet::PatternListT empty;
+  return empty;
+}
+
+template <class Map, class Key>
+void AppendPatterns(const Map& map,
+                    const Key& key,
+                    FrozenRewritePatternSet::PatternListT* patterns) {
+  auto it = map.find(key);
+  if (it != map.end()) {
+    patterns->insert(patterns->end(), it->second.begin(), it->second.end());
+  }
+}
+}  // namespace
+
+FrozenRewritePatternSet::PatternListT
+FrozenRewritePatternSet::Impl::CollectOpSpecificNativePatterns(
+    OpInfo info) const {
+  PatternListT op_patterns;
+  AppendPatterns(op_name_native_pattern_map, info, &op_patterns);
+  AppendPatterns(unregistered_op_name_native_pattern_map,
+                 std::string(info.name()),
+                 &op_patterns);
+  for (const auto& interface : interface_native_pattern_map) {
+    if (info.HasInterface(interface.first)) {
+      op_patterns.insert(
+          op_patterns.end(), interface.second.begin(), interface.second.end());
+    }
+  }
+  for (const auto& trait : trait_native_pattern_map) {
+    if (info.HasTrait(trait.first)) {
+      op_patterns.insert(
+          op_patterns.end(), trait.second.begin(), trait.second.end());
+    }
+  }
+  SortByBenefit(&op_patterns);
+  return op_patterns;
+}
+
+FrozenRewritePatternSet::FrozenRewritePatternSet()
+    : impl_(std::make_shared<Impl>()) {}
+
+FrozenRewritePatternSet::FrozenRewritePatternSet(RewritePatternSet&& patterns) {
+  auto impl = std::make_shared<Impl>();
+  IrContext* context = patterns.context();
+  impl->native_patterns = std::move(patterns.native_patterns());
+
+  // 1. Bucket the patterns by the kind of their root.
+  for (const auto& pattern : impl->native_patterns) {
+    switch (pattern->root_kind()) {
+      case Pattern::RootKind::OperationName: {
+        OpInfo info = context->GetRegisteredOpInfo(pattern->root_name());
+        if (!info) {
+          // The dialect of the root op may be loaded later, the pattern is
+          // resolved by name when the op is looked up.
+          LOG(WARNING) << "The root op " << pattern->root_name()
+                       << " of pattern " << pattern->debug_name()
+                       << " is not registered, the pattern will not be "
+                          "applied until the op is registered.";
+          impl->unregistered_op_name_native_pattern_map[pattern->root_name()]
+              .push_back(pattern.get());
+          break;
+        }
+        impl->op_name_native_pattern_map[info].push_back(pattern.get());
+        break;
+      }
+      case Pattern::RootKind::InterfaceId:
+        impl->interface_native_pattern_map[pattern->root_interface_id()]
+            .push_back(pattern.get());
+        break;
+      case Pattern::RootKind::TraitId:
+        impl->trait_native_pattern_map[pattern->root_trait_id()].push_back(
+            pattern.get());
+        break;
+      case Pattern::RootKind::Any:
+        impl->match_any_op_native_patterns.push_back(pattern.get());
+        break;
+    }
+  }
+
+  // 2. Sort all buckets by benefit.
+  for (auto& pair : impl->op_name_native_pattern_map) {
+    SortByBenefit(&pair.second);
+  }
+  for (auto& pair : impl->unregistered_op_name_native_pattern_map) {
+    SortByBenefit(&pair.second);
+  }
+  for (auto& pair : impl->interface_native_pattern_map) {
+    SortByBenefit(&pair.second);
+  }
+  for (auto& pair : impl->trait_native_pattern_map) {
+    SortByBenefit(&pair.second);
+  }
+  SortByBenefit(&impl->match_any_op_native_patterns);
+
+  // 3. Build the dispatch table of each registered op.
+  for (const auto& pair : context->registered_op_info_map()) {
+    impl->op_specific_native_pattern_map[pair.second] =
+        impl->CollectOpSpecificNativePatterns(pair.second);
+  }
+  impl->has_late_op_patterns =
+      !impl->unregistered_op_name_native_pattern_map.empty() ||
+      !impl->interface_native_pattern_map.empty() ||
+      !impl->trait_native_pattern_map.empty();
+
+  impl_ = std::move(impl);
+}
+const FrozenRewritePatternSet::PatternListT&
+FrozenRewritePatternSet::GetOpSpecificNativePatterns(OpInfo info) const {
+  auto it = impl_->op_specific_native_pattern_map.find(info);
+  if (it != impl_->op_specific_native_pattern_map.end()) {
+    return it->second;
+  }
+  if (!info || !impl_->has_late_op_patterns) {
+    return EmptyPatternList();
+  }
+  // The op is registered after the set is frozen, its patterns are collected
+  // from the buckets and cached.
+  const auto* late_map =
+      impl_->late_op_native_pattern_map.load(std::memory_order_acquire);
+  if (late_map != nullptr) {
+    auto late_it = late_map->find(info);
+    if (late_it != late_map->end()) {
+      return *late_it->second;
+    }
+  }
+  std::lock_guard<std::mutex> guard(impl_->late_op_mutex);
+  late_map = impl_->late_op_native_pattern_map.load(std::memory_order_relaxed);
+  if (late_map != nullptr) {
+    auto late_it = late_map->find(info);
+    if (late_it != late_map->end()) {
+      return *late_it->second;
+    }
+  }
+  impl_->late_op_native_patterns.emplace_back(
+      new PatternListT(impl_->CollectOpSpecificNativePatterns(info)));
+  const PatternListT* patterns = impl_->late_op_native_patterns.back().get();
+  std::unique_ptr<Impl::LateOpPatternMap> new_map(
+      late_map == nullptr ? new Impl::LateOpPatternMap()
+                          : new Impl::LateOpPatternMap(*late_map));
+  new_map->emplace(info, patterns);
+  late_map = new_map.get();
+  impl_->late_op_native_pattern_maps.emplace_back(std::move(new_map));
+  impl_->late_op_native_pattern_map.store(late_map, std::memory_order_release);
+  return *patterns;
+}
+
+const FrozenRewritePatternSet::PatternListT&
+FrozenRewritePatternSet::GetInterfaceNativePatterns(TypeId interface_id) const {
+  auto it = impl_->interface_native_pattern_map.find(interface_id);
+  if (it == impl_->interface_native_pattern_map.end()) {
+    return EmptyPatternList();
+  }
+  return it->second;
+}
+
+const FrozenRewritePatternSet::PatternListT&
+FrozenRewritePatternSet::GetTraitNativePatterns(TypeId trait_id) const {
+  auto it = impl_->trait_native_pattern_map.find(trait_id);
+  if (it == impl_->trait_native_pattern_map.end()) {
+    return EmptyPatternList();
+  }
+  return it->second;
+}
+
+}  // namespace ir
@@ -0,0 +1,129 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/ir/core/op_info.h"
+#include "paddle/ir/core/type_id.h"
+#include "paddle/ir/pattern_rewrite/pattern_match.h"
+
+namespace ir {
+
+///
+/// \brief This class represents a frozen set of patterns that can be processed
+/// by a pattern applicator. The patterns are sorted in descending order of
+/// benefit and bucketed by the kind of their root once, at construction time.
+/// This class is immutable and cheap to copy, so it can be shared by several
+/// passes and threads.
+///
+class FrozenRewritePatternSet {
+ public:
+  using NativePatternListT = std::vector<std::unique_ptr<RewritePattern>>;
+  using PatternListT = std::vector<const RewritePattern*>;
+
+  FrozenRewritePatternSet();
+  FrozenRewritePatternSet(RewritePatternSet&& patterns);  // NOLINT
+  FrozenRewritePatternSet(FrozenRewritePatternSet&& patterns) = default;
+  FrozenRewritePatternSet(const FrozenRewritePatternSet& patterns) = default;
+  FrozenRewritePatternSet& operator=(FrozenRewritePatternSet&& patterns) =
+      default;
+  FrozenRewritePatternSet& operator=(const FrozenRewritePatternSet& patterns) =
+      default;
+  ~FrozenRewritePatternSet() = default;
+
+  /// Return the patterns that may match an op with the given OpInfo, which
+  /// contains the patterns rooted at the op name, and the interface and trait
+  /// patterns applicable to the op. Patterns matching any op are not
+  /// included, see match_any_op_native_patterns(). The patterns of an op
+  /// registered after the set is frozen are collected on the first lookup.
+  const PatternListT& GetOpSpecificNativePatterns(OpInfo info) const;
+
+  /// Return the op specific native patterns held by this set, the lists are
+  /// computed for all ops registered in the context when the set is frozen,
+  /// the ops registered later are not included.
+  const std::unordered_map<OpInfo, PatternListT>& op_specific_native_patterns()
+      const {
+    return impl_->op_specific_native_pattern_map;
+  }
+
+  /// Return the patterns rooted at the given interface.
+  const PatternListT& GetInterfaceNativePatterns(TypeId interface_id) const;
+
+  /// Return the patterns rooted at the given trait.
+  const PatternListT& GetTraitNativePatterns(TypeId trait_id) const;
+
+  /// Return the native patterns that may match any op.
+  const PatternListT& match_any_op_native_patterns() const {
+    return impl_->match_any_op_native_patterns;
+  }
+
+  /// Return all native patterns held by this set.
+  const NativePatternListT& native_patterns() const {
+    return impl_->native_patterns;
+  }
+
+  size_t size() const { return impl_->native_patterns.size(); }
+
+  bool empty() const { return impl_->native_patterns.empty(); }
+
+ private:
+  struct Impl {
+    /// The set of native patterns, which own the memory.
+    NativePatternListT native_patterns;
+
+    /// Patterns bucketed by the kind of their root, sorted by benefit.
+    std::unordered_map<OpInfo, PatternListT> op_name_native_pattern_map;
+    /// Patterns rooted at an op not registered when the set is frozen.
+    std::unordered_map<std::string, PatternListT>
+        unregistered_op_name_native_pattern_map;
+    std::unordered_map<TypeId, PatternListT> interface_native_pattern_map;
+    std::unordered_map<TypeId, PatternListT> trait_native_pattern_map;
+    PatternListT match_any_op_native_patterns;
+
+    /// The dispatch table of each registered op, merged from the op name,
+    /// interface and trait buckets, sorted by benefit.
+    std::unordered_map<OpInfo, PatternListT> op_specific_native_pattern_map;
+
+    /// Whether an op registered after the set is frozen may have patterns.
+    bool has_late_op_patterns{false};
+    /// The dispatch table of the ops registered after the set is frozen,
+    /// filled on lookup. The table is copied on write under late_op_mutex
+    /// and published atomically, so the lookups of the cached ops take no
+    /// lock. The former tables are kept, since lookups may still read them.
+    using LateOpPatternMap = std::unordered_map<OpInfo, const PatternListT*>;
+    mutable std::mutex late_op_mutex;
+    mutable std::atomic<const LateOpPatternMap*> late_op_native_pattern_map{
+        nullptr};
+    mutable std::vector<std::unique_ptr<const LateOpPatternMap>>
+        late_op_native_pattern_maps;
+    mutable std::vector<std::unique_ptr<const PatternListT>>
+        late_op_native_patterns;
+
+    /// Merge the buckets applicable to the op, sorted by benefit.
+    PatternListT CollectOpSpecificNativePatterns(OpInfo info) const;
+  };
+
+  /// The internal implementation of the frozen pattern set, which is shared
+  /// between all copies.
+  std::shared_ptr<const Impl> impl_;
+};
+
+}  // namespace ir
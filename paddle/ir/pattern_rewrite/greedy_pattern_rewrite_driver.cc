@@ -0,0 +1,219 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/ir/pattern_rewrite/greedy_pattern_rewrite_driver.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/ir/core/block.h"
+#include "paddle/ir/core/operation.h"
+#include "paddle/ir/core/program.h"
+#include "paddle/ir/core/region.h"
+#include "paddle/ir/core/value.h"
+
+namespace ir {
+
+namespace {
+
+// Collect all the operations nested in the regions of op.
+void CollectNestedOps(Operation* op,
+                      bool pre_order,
+                      std::vector<Operation*>* ops) {
+  for (uint32_t i = 0; i < op->num_regions(); ++i) {
+    auto& region = op->GetRegion(i);
+    for (auto block : region) {
+      for (auto nested_op : *block) {
+        if (pre_order) ops->push_back(nested_op);
+        CollectNestedOps(nested_op, pre_order, ops);
+        if (!pre_order) ops->push_back(nested_op);
+      }
+    }
+  }
+}
+
+class GreedyPatternRewriteDriver : public PatternRewriter {
+ public:
+  GreedyPatternRewriteDriver(IrContext* ctx,
+                             const FrozenRewritePatternSet& patterns,
+                             const GreedyRewriteConfig& config)
+      : PatternRewriter(ctx), patterns_(patterns), config_(config) {}
+
+  // Returns true if the rewrite converged.
+  bool Simplify(Operation* op) {
+    bool changed = false;
+    int64_t iteration = 0;
+    do {
+      worklist_.clear();
+      worklist_map_.clear();
+
+      std::vector<Operation*> ops;
+      CollectNestedOps(op, config_.use_top_down_traversal, &ops);
+      // The worklist is processed from back to front, so reverse the
+      // pre-ordered list to visit the operations in program order.
+      if (config_.use_top_down_traversal) {
+        std::reverse(ops.begin(), ops.end());
+      }
+      for (auto* nested_op : ops) {
+        AddToWorklist(nested_op);
+      }
+
+      changed = ProcessWorklist();
+      ++iteration;
+      VLOG(4) << "GreedyPatternRewriteDriver finished iteration " << iteration
+              << ", changed = " << changed << ".";
+    } while (changed && (config_.max_iterations < 0 ||
+                         iteration < config_.max_iterations));
+
+    return !changed;
+  }
+
+ protected:
+  void NotifyOperationInserted(Operation* op) override { AddToWorklist(op); }
+
+  void FinalizeRootUpdate(Operation* op) override { AddToWorklist(op); }
+
+  void NotifyRootReplaced(Operation* op,
+                          const std::vector<Value>& new_values) override {
+    AddUsersToWorklist(op);
+  }
+
+  void NotifyOperationRemoved(Operation* op) override {
+    AddOperandsToWorklist(op);
+    RemoveFromWorklist(op);
+    std::vector<Operation*> nested_ops;
+    CollectNestedOps(op, true, &nested_ops);
+    for (auto* nested_op : nested_ops) {
+      RemoveFromWorklist(nested_op);
+    }
+  }
+
+ private:
+  void AddToWorklist(Operation* op) {
+    if (worklist_map_.count(op)) return;
+    worklist_map_[op] = worklist_.size();
+    worklist_.push_back(op);
+  }
+
+  Operation* PopFromWorklist() {
+    Operation* op = worklist_.back();
+    worklist_.pop_back();
+    if (op) worklist_map_.erase(op);
+    return op;
+  }
+
+  void RemoveFromWorklist(Operation* op) {
+    auto it = worklist_map_.find(op);
+    if (it != worklist_map_.end()) {
+      worklist_[it->second] = nullptr;
+      worklist_map_.erase(it);
+    }
+  }
+
+  void AddOperandsToWorklist(Operation* op) {
+    for (uint32_t i = 0; i < op->num_operands(); ++i) {
+      auto operand = op->GetOperandByIndex(i);
+      if (!operand) continue;
+      if (auto* def_op = operand.source().GetDefiningOp()) {
+        AddToWorklist(def_op);
+      }
+    }
+  }
+
+  void AddUsersToWorklist(Operation* op) {
+    for (uint32_t i = 0; i < op->num_results(); ++i) {
+      auto result = op->GetResultByIndex(i);
+      for (auto it = result.begin(); it != result.end(); ++it) {
+        AddToWorklist(it.owner());
+      }
+    }
+  }
+
+  // Returns true if any rewrite was applied.
+  bool ProcessWorklist() {
+    bool changed = false;
+    int64_t num_rewrites = 0;
+    while (!worklist_.empty() && (config_.max_num_rewrites < 0 ||
+                                  num_rewrites < config_.max_num_rewrites)) {
+      Operation* op = PopFromWorklist();
+      if (op == nullptr) continue;
+      if (MatchAndRewrite(op)) {
+        changed = true;
+        ++num_rewrites;
+      }
+    }
+    return changed;
+  }
+
+  // Try the patterns rooted at op and the patterns matching any op, in
+  // descending order of benefit.
+  bool MatchAndRewrite(Operation* op) {
+    const auto& op_patterns =
+        patterns_.GetOpSpecificNativePatterns(op->info());
+    const auto& any_op_patterns = patterns_.match_any_op_native_patterns();
+
+    size_t op_idx = 0, any_idx = 0;
+    while (op_idx < op_patterns.size() || any_idx < any_op_patterns.size()) {
+      const RewritePattern* pattern = nullptr;
+      if (any_idx == any_op_patterns.size() ||
+          (op_idx < op_patterns.size() &&
+           op_patterns[op_idx]->benefit() >=
+               any_op_patterns[any_idx]->benefit())) {
+        pattern = op_patterns[op_idx++];
+      } else {
+        pattern = any_op_patterns[any_idx++];
+      }
+
+      SetInsertionPoint(op);
+      if (pattern->MatchAndRewrite(op, *this)) {
+        VLOG(6) << "Pattern " << pattern->debug_name() << " applied.";
+        return true;
+      }
+    }
+    return false;
+  }
+
+  const FrozenRewritePatternSet& patterns_;
+
+  GreedyRewriteConfig config_;
+
+  // The worklist is processed as a stack, erased operations are replaced with
+  // nullptr in place to keep the indices in worklist_map_ valid.
+  std::vector<Operation*> worklist_;
+  std::unordered_map<Operation*, size_t> worklist_map_;
+};
+
+}  // namespace
+
+bool ApplyPatternsGreedily(Operation* op,
+                           const FrozenRewritePatternSet& patterns,
+                           GreedyRewriteConfig config) {
+  GreedyPatternRewriteDriver driver(op->ir_context(), patterns, config);
+  bool converged = driver.Simplify(op);
+  if (!converged) {
+    VLOG(4) << "The pattern rewrite did not converge after scanning "
+            << config.max_iterations << " times.";
+  }
+  return converged;
+}
+
+bool ApplyPatternsGreedily(Program* program,
+                           const FrozenRewritePatternSet& patterns,
+                           GreedyRewriteConfig config) {
+  return ApplyPatternsGreedily(
+      program->module_op().operation(), patterns, config);
+}
+
+}  // namespace ir
@@ -0,0 +1,64 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+
+#include "paddle/ir/pattern_rewrite/frozen_rewrite_pattern_set.h"
+
+namespace ir {
+
+class Operation;
+class Program;
+
+/// This class allows control over how the GreedyPatternRewriteDriver works.
+struct GreedyRewriteConfig {
+  /// If true, the initial worklist is filled in pre-order, so producers are
+  /// visited before their users. Otherwise, the worklist is filled in
+  /// post-order, so users are visited before their producers.
+  bool use_top_down_traversal = false;
+
+  /// The maximum number of times the worklist is refilled with all nested
+  /// operations. The driver stops early once an iteration makes no change.
+  /// A negative value means no limit.
+  int64_t max_iterations = 10;
+
+  /// The maximum number of successful rewrites per iteration. A negative value
+  /// means no limit.
+  int64_t max_num_rewrites = -1;
+};
+
+///
+/// \brief Rewrite the operations nested in the regions of `op` with the given
+/// patterns, in a greedy worklist-driven way, until a fixed point is reached.
+/// Patterns are dispatched by the OpInfo of the op through the frozen set and
+/// tried in descending order of benefit. After a successful rewrite only the
+/// touched operations (newly inserted ops, modified ops, users of replaced
+/// results and producers of erased ops) are revisited.
+///
+/// \return true if the rewrite converges within config.max_iterations.
+///
+bool ApplyPatternsGreedily(Operation* op,
+                           const FrozenRewritePatternSet& patterns,
+                           GreedyRewriteConfig config = GreedyRewriteConfig());
+
+///
+/// \brief Apply the patterns greedily to the module op of the program.
+///
+bool ApplyPatternsGreedily(Program* program,
+                           const FrozenRewritePatternSet& patterns,
+                           GreedyRewriteConfig config = GreedyRewriteConfig());
+
+}  // namespace ir
@@ -15,6 +15,8 @@
 #include "paddle/ir/pattern_rewrite/pattern_match.h"
 #include <cassert>
 #include <cstdint>
+#include "paddle/ir/core/block.h"
+#include "paddle/ir/core/enforce.h"
 #include "paddle/ir/core/operation.h"
 
 namespace ir {
@@ -80,65 +82,78 @@ RewritePattern::~RewritePattern() = default;
 
 RewriterBase::~RewriterBase() = default;
 
-// TODO(wilber): value support replace method.
-// void RewriterBase::ReplaceOpWithIf(Operation* op,
-//                                    ValueRange new_values,
-//                                    bool* all_uses_replaced,
-//                                    std::function<bool(OpOperand&)> functor) {
-//   // assert(op->num_results() == new_values.size() && "incorrect number of
-//   values to replace operation"); NotifyRootReplaced(op, new_values); bool
-//   replace_all_uses = true; for (uint32_t i = 0; i < op->num_results(); ++i) {
-//     // op->GetResultByIndex(0)
-//   }
-// }
-// void RewriterBase::ReplaceOpWithIf(Operation* op,
-//                        ValueRange new_values,
-//                        std::function<bool(OpOperand&)> functor) {
-//   ReplaceOpWithIf(op, new_values, nullptr, functor);
-// }
-
-// TODO(wilber): support erase.
-// void ReplaceOp(Operation* op, ValueRange new_values) {
-//   NotifyRootReplaced(op, new_values);
-//   assert(op->num_results() == new_values.size() && "incorrect # of
-//   replacement values"); op->ReplaceAllUsesWith(new_values);
-//   NotifyOperationRemoved(op);
-//   op->erase();
-// }
+void RewriterBase::ReplaceOpWithIf(Operation* op,
+                                   const std::vector<Value>& new_values,
+                                   bool* all_uses_replaced,
+                                   std::function<bool(OpOperand)> functor) {
+  IR_ENFORCE(op->num_results() == new_values.size(),
+             "incorrect number of values to replace operation");
+  NotifyRootReplaced(op, new_values);
+  bool replace_all_uses = true;
+  for (uint32_t i = 0; i < op->num_results(); ++i) {
+    Value result = op->GetResultByIndex(i);
+    ReplaceUseIf(result, new_values[i], functor);
+    replace_all_uses &= result.use_empty();
+  }
+  if (all_uses_replaced) {
+    *all_uses_replaced = replace_all_uses;
+  }
+  if (replace_all_uses) {
+    EraseOp(op);
+  }
+}
+
+void RewriterBase::ReplaceOpWithIf(Operation* op,
+                                   const std::vector<Value>& new_values,
+                                   std::function<bool(OpOperand)> functor) {
+  ReplaceOpWithIf(op, new_values, nullptr, functor);
+}
+
+void RewriterBase::ReplaceOp(Operation* op,
+                             const std::vector<Value>& new_values) {
+  IR_ENFORCE(op->num_results() == new_values.size(),
+             "incorrect number of values to replace operation");
+  NotifyRootReplaced(op, new_values);
+  for (uint32_t i = 0; i < op->num_results(); ++i) {
+    ReplaceAllUsesWith(op->GetResultByIndex(i), new_values[i]);
+  }
+  EraseOp(op);
+}
+
 void RewriterBase::EraseOp(Operation* op) {
-  //   assert(op->use_empty() && "expected 'op' to have no uses");
-  //   NotifyOperationRemoved(op);
-  //   op->erase();
+  IR_ENFORCE(op->use_empty(), "expected 'op' to have no uses");
+  NotifyOperationRemoved(op);
+  op->GetParent()->erase(Block::iterator(*op));
 }
 
 void RewriterBase::ReplaceAllUsesWith(Value from, Value to) {
-  // from.
-  // for (mlir::OpOperand& operand : llvm::make_early_inc_range(from.getUses()))
-  // {
-  //   mlir::Operation* op = operand.getOwner();
-  //   UpdateRootInPlace(op, [&]() { operand.set(to); });
-  // }
+  ReplaceUseIf(from, to, [](OpOperand) { return true; });
 }
 
-// TODO(wilber): iterator maybe should support modify inplace.
 void RewriterBase::ReplaceUseIf(Value from,
                                 Value to,
-                                std::function<bool(OpOperand&)> functor) {
-  // for (auto it = from.begin(); it != from.end(); ++it) {
-  //   // TODO: need a lvalue.
-  //   if (functor(it.get())) {
-  //     UpdateRootInplace(it.owner(), [&](){it.get().set(to)});
-  //   }
-  // }
+                                std::function<bool(OpOperand)> functor) {
+  // Collect the uses first, since updating an operand will unlink it from
+  // the use list of `from`.
+  std::vector<OpOperand> uses;
+  for (auto it = from.begin(); it != from.end(); ++it) {
+    if (functor(*it)) uses.push_back(*it);
+  }
+  for (auto& operand : uses) {
+    UpdateRootInplace(operand.owner(), [&]() { operand.set_source(to); });
+  }
 }
 
 void RewriterBase::ReplaceOpWithResultsOfAnotherOp(Operation* op,
                                                    Operation* new_op) {
-  assert(op->num_results() == new_op->num_results() &&
-         "replacement op doesn't match results of original op");
-  // TODO(wilber): Op support results method.
-  // if (op->num_results() == 1) return ReplaceOp(op,
-  // new_op->GetResultByIndex(0)); return ReplaceOp(op, new_op->GetResults());
+  IR_ENFORCE(op->num_results() == new_op->num_results(),
+             "replacement op doesn't match results of original op");
+  std::vector<Value> new_values;
+  new_values.reserve(new_op->num_results());
+  for (uint32_t i = 0; i < new_op->num_results(); ++i) {
+    new_values.push_back(new_op->GetResultByIndex(i));
+  }
+  ReplaceOp(op, new_values);
 }
 
 }  // namespace ir
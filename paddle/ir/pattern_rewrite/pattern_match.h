@@ -21,6 +21,7 @@
 #include <type_traits>
 #include <utility>
 #include <vector>
+#include "paddle/ir/core/builder.h"
 #include "paddle/ir/core/ir_context.h"
 #include "paddle/ir/core/operation.h"
 #include "paddle/ir/core/type_id.h"
@@ -36,7 +37,7 @@ class PatternBenefit {
  public:
   PatternBenefit(unsigned val) : val_(val) {}  // NOLINT
 
-  unsigned benefit() { return val_; }
+  unsigned benefit() const { return val_; }
 
   bool operator==(const PatternBenefit& rhs) const { return val_ == rhs.val_; }
   bool operator!=(const PatternBenefit& rhs) const { return !(*this == rhs); }
@@ -53,11 +54,25 @@ class PatternBenefit {
 /// any methods for the matching. This class is used to interface with the
 /// metadata of a pattern, such as benefit or root operation.
 class Pattern {
+ public:
   enum class RootKind { Any, OperationName, InterfaceId, TraitId };
 
- public:
   PatternBenefit benefit() const { return benefit_; }
 
+  RootKind root_kind() const { return root_kind_; }
+
+  /// The name of the root operation, only valid if the root kind is
+  /// OperationName.
+  const std::string& root_name() const { return op_name_; }
+
+  /// The interface id of the root operation, only valid if the root kind is
+  /// InterfaceId.
+  ir::TypeId root_interface_id() const { return interface_id_; }
+
+  /// The trait id of the root operation, only valid if the root kind is
+  /// TraitId.
+  ir::TypeId root_trait_id() const { return trait_id_; }
+
   IrContext* context() const { return context_; }
 
   std::string debug_name() const { return debug_name_; }
@@ -213,11 +228,7 @@ struct OpRewritePattern
                    PatternBenefit benefit = 1,
                    const std::vector<std::string>& generated_names = {})
       : detail::OpOrInterfaceRewritePatternBase<SourceOp>(
-            "NeedToFix",  // TODO(wilber): Need to fix. SourceOp maybe should
-                          // have a getOperationName static method.
-            benefit,
-            context,
-            generated_names) {}
+            SourceOp::name(), benefit, context, generated_names) {}
 };
 
 // TODO(wilber): Support OpInterfaceRewritePattern and OpTraitRewritePattern.
@@ -226,22 +237,38 @@ struct OpRewritePattern
 /// This class provides a series of interfaces for modifying IR and tracking IR
 /// changes. This class provides a unified API for IR modification.
 ///
-class RewriterBase {  // maybe should inherit OpBuilder.
+class RewriterBase : public Builder {
  public:
   // TODO(wilber): Supplementary methods of block and region.
 
-  // TODO(wilber): Support ValueRange.
-  // virtual void ReplaceOpWithIf(Operation* op,
-  //                              ValueRange new_values,
-  //                              bool* all_uses_replaced,
-  //                              std::function<bool(OpOperand&)> functor);
-  // void ReplaceOpWithIf(Operation* op,
-  //                      ValueRange new_values,
-  //                      std::function<bool(OpOperand&)> functor);
-  // virtual void ReplaceOp(Operation* op, ValueRange new_values);
-
-  // virtual void ReplaceOpWithNewOp()
+  /// Replace the results of the given operation with the specified list of
+  /// values, only the uses for which `functor` returns true are replaced.
+  /// `all_uses_replaced` is set to true if all uses have been replaced, and
+  /// the op is erased in this case.
+  virtual void ReplaceOpWithIf(Operation* op,
+                               const std::vector<Value>& new_values,
+                               bool* all_uses_replaced,
+                               std::function<bool(OpOperand)> functor);
+  void ReplaceOpWithIf(Operation* op,
+                       const std::vector<Value>& new_values,
+                       std::function<bool(OpOperand)> functor);
+
+  /// Replace the results of the given operation with the specified list of
+  /// values, then erase the op. The number of values must match the number of
+  /// results of op.
+  virtual void ReplaceOp(Operation* op, const std::vector<Value>& new_values);
+
+  /// Replace the results of op with a new op of type OpTy, which is created
+  /// right before op with the given args.
+  template <typename OpTy, typename... Args>
+  OpTy ReplaceOpWithNewOp(Operation* op, Args&&... args) {
+    SetInsertionPoint(op);
+    auto new_op = Build<OpTy>(std::forward<Args>(args)...);
+    ReplaceOpWithResultsOfAnotherOp(op, new_op.operation());
+    return new_op;
+  }
 
+  /// Erase an operation that is known to have no uses.
   virtual void EraseOp(Operation* op);
 
   virtual void StartRootUpdate(Operation* op) {}
@@ -259,15 +286,18 @@ class RewriterBase {  // maybe should inherit OpBuilder.
 
   void ReplaceUseIf(Value from,
                     Value to,
-                    std::function<bool(OpOperand&)> functor);
+                    std::function<bool(OpOperand)> functor);
 
  protected:
-  explicit RewriterBase(IrContext* ctx) : ctx_(ctx) {}
+  explicit RewriterBase(IrContext* ctx) : Builder(ctx) {}
 
   virtual ~RewriterBase();
 
-  // virtual void NotifyRootReplaced(Operation* op, ValueRange replacement) {}
+  /// Called before the results of op are replaced by new_values.
+  virtual void NotifyRootReplaced(Operation* op,
+                                  const std::vector<Value>& new_values) {}
 
+  /// Called right before an operation is erased.
   virtual void NotifyOperationRemoved(Operation* op) {}
 
   // virtual bool NotifyMatchFailure()
@@ -277,9 +307,6 @@ class RewriterBase {  // maybe should inherit OpBuilder.
   RewriterBase(const RewriterBase&) = delete;
 
   void ReplaceOpWithResultsOfAnotherOp(Operation* op, Operation* new_op);
-
- private:
-  IrContext* ctx_;
 };
 
 class PatternRewriter : public RewriterBase {
@@ -303,6 +330,10 @@ class RewritePatternSet {
 
   NativePatternListT& native_patterns() { return native_patterns_; }
 
+  const NativePatternListT& native_patterns() const {
+    return native_patterns_;
+  }
+
   void Clear() { native_patterns_.clear(); }
 
   // 'add' methods for adding patterns to the set.
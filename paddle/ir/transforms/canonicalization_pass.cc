@@ -0,0 +1,103 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/ir/transforms/canonicalization_pass.h"
+
+#include "paddle/ir/core/builtin_attribute.h"
+#include "paddle/ir/core/builtin_op.h"
+#include "paddle/ir/core/operation.h"
+#include "paddle/ir/pass/pass.h"
+#include "paddle/ir/pattern_rewrite/frozen_rewrite_pattern_set.h"
+#include "paddle/ir/pattern_rewrite/greedy_pattern_rewrite_driver.h"
+#include "paddle/ir/pattern_rewrite/pattern_match.h"
+#include "paddle/ir/transforms/dead_code_elimination_pass.h"
+
+namespace ir {
+
+namespace {
+
+// slice(combine(x_0, ..., x_n), i) => x_i
+class FoldSliceOfCombinePattern : public OpRewritePattern<SliceOp> {
+ public:
+  using OpRewritePattern<SliceOp>::OpRewritePattern;
+
+  bool MatchAndRewrite(SliceOp op,
+                       PatternRewriter &rewriter) const override {  // NOLINT
+    Operation *combine_op = op->GetOperandByIndex(0).source().GetDefiningOp();
+    if (!combine_op || combine_op->name() != CombineOp::name()) return false;
+    auto index = op->attributes().at("index").dyn_cast<Int32_tAttribute>();
+    rewriter.ReplaceOp(
+        op, {combine_op->GetOperandByIndex(index.data()).source()});
+    return true;
+  }
+};
+
+// Erase the operations whose results are unused and have no side effect.
+class EraseTriviallyDeadOpPattern : public RewritePattern {
+ public:
+  explicit EraseTriviallyDeadOpPattern(IrContext *context)
+      : RewritePattern(MatchAnyOpTypeTag(), 1, context) {}
+
+  bool MatchAndRewrite(Operation *op,
+                       PatternRewriter &rewriter) const override {  // NOLINT
+    if (!IsOpTriviallyDead(op)) return false;
+    rewriter.EraseOp(op);
+    return true;
+  }
+};
+
+class CanonicalizationPass : public Pass {
+ public:
+  explicit CanonicalizationPass(
+      std::function<void(RewritePatternSet *)> populate_patterns)
+      : Pass("CanonicalizationPass", 0),
+        populate_patterns_(std::move(populate_patterns)) {}
+
+  bool Initialize(IrContext *context) override {
+    RewritePatternSet patterns(context);
+    patterns.Add<FoldSliceOfCombinePattern>(context);
+    patterns.Add<EraseTriviallyDeadOpPattern>(context);
+    if (populate_patterns_) populate_patterns_(&patterns);
+    patterns_ = FrozenRewritePatternSet(std::move(patterns));
+    return true;
+  }
+
+  void Run(Operation *op) override {
+    GreedyRewriteConfig config;
+    config.use_top_down_traversal = true;
+    if (!ApplyPatternsGreedily(op, patterns_, config)) {
+      LOG(WARNING) << "CanonicalizationPass doesn't converge in "
+                   << config.max_iterations << " iterations.";
+    }
+  }
+
+  // The patterns are applied to all the nested operations at once, so the
+  // pass only runs on the top level operation.
+  bool CanApplyOn(Operation *op) const override {
+    return op->num_regions() > 0 && op->GetParentOp() == nullptr;
+  }
+
+ private:
+  std::function<void(RewritePatternSet *)> populate_patterns_;
+  FrozenRewritePatternSet patterns_;
+};
+
+}  // namespace
+
+std::unique_ptr<Pass> CreateCanonicalizationPass(
+    std::function<void(RewritePatternSet *)> populate_patterns) {
+  return std::make_unique<CanonicalizationPass>(std::move(populate_patterns));
+}
+
+}  // namespace ir
@@ -0,0 +1,35 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+
+namespace ir {
+
+class Pass;
+class RewritePatternSet;
+
+///
+/// \brief Create a pass that canonicalizes the operations nested in the top
+/// level operation by applying the rewrite patterns greedily until a fixed
+/// point is reached. Besides the builtin patterns, which fold the slices of
+/// combined values and erase the trivially dead operations, the callers may
+/// add the patterns of their dialects through `populate_patterns`.
+///
+std::unique_ptr<Pass> CreateCanonicalizationPass(
+    std::function<void(RewritePatternSet *)> populate_patterns = nullptr);
+
+}  // namespace ir
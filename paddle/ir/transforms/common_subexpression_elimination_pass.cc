@@ -0,0 +1,163 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/ir/transforms/common_subexpression_elimination_pass.h"
+
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/ir/core/builtin_op.h"
+#include "paddle/ir/core/operation.h"
+#include "paddle/ir/core/region.h"
+#include "paddle/ir/core/utils.h"
+#include "paddle/ir/pass/pass.h"
+
+namespace ir {
+
+namespace {
+
+bool IsOpEliminable(Operation *op) {
+  return op->num_results() > 0 && op->num_regions() == 0 &&
+         !op->HasTrait<SideEffectTrait>();
+}
+
+struct OperationHash {
+  std::size_t operator()(Operation *op) const {
+    std::size_t hash_value = std::hash<OpInfo>()(op->info());
+    for (uint32_t i = 0; i < op->num_operands(); ++i) {
+      hash_value = hash_combine(
+          hash_value, std::hash<Value>()(op->GetOperandByIndex(i).source()));
+    }
+    for (uint32_t i = 0; i < op->num_results(); ++i) {
+      hash_value = hash_combine(
+          hash_value, std::hash<Type>()(op->GetResultByIndex(i).type()));
+    }
+    // The iteration order of the attribute map is unspecified, so the hashes
+    // of the entries are combined commutatively.
+    std::size_t attributes_hash = 0;
+    for (auto &attribute : op->attributes()) {
+      attributes_hash +=
+          hash_combine(std::hash<std::string>()(attribute.first),
+                       std::hash<Attribute>()(attribute.second));
+    }
+    return hash_combine(hash_value, attributes_hash);
+  }
+};
+
+struct OperationEqual {
+  bool operator()(Operation *lhs, Operation *rhs) const {
+    if (lhs == rhs) return true;
+    if (lhs->info() != rhs->info() ||
+        lhs->num_operands() != rhs->num_operands() ||
+        lhs->num_results() != rhs->num_results()) {
+      return false;
+    }
+    for (uint32_t i = 0; i < lhs->num_operands(); ++i) {
+      if (lhs->GetOperandByIndex(i).source() !=
+          rhs->GetOperandByIndex(i).source()) {
+        return false;
+      }
+    }
+    for (uint32_t i = 0; i < lhs->num_results(); ++i) {
+      if (lhs->GetResultByIndex(i).type() != rhs->GetResultByIndex(i).type()) {
+        return false;
+      }
+    }
+    return lhs->attributes() == rhs->attributes();
+  }
+};
+
+class CommonSubexpressionEliminationPass : public Pass {
+ public:
+  CommonSubexpressionEliminationPass()
+      : Pass("CommonSubexpressionEliminationPass", 2) {}
+
+  void Run(Operation *op) override {
+    size_t num_erased = 0;
+    for (size_t i = 0; i < op->num_regions(); ++i) {
+      for (Block *block : op->GetRegion(i)) {
+        num_erased += SimplifyBlock(block);
+      }
+    }
+    VLOG(6) << "CommonSubexpressionEliminationPass erased " << num_erased
+            << " operations.";
+    if (num_erased == 0) {
+      MarkAllAnalysesPreserved();
+    } else {
+      MarkChangedIrFeatures(IrFeatures::kOperations | IrFeatures::kOperands);
+    }
+  }
+
+ private:
+  size_t SimplifyBlock(Block *block) {
+    size_t num_erased = 0;
+    std::unordered_set<Operation *, OperationHash, OperationEqual> known_ops;
+    // The known operations without operand, which may read the state changed
+    // by a side effect, e.g. get_parameter.
+    std::vector<Operation *> known_source_ops;
+    for (auto it = block->begin(); it != block->end();) {
+      Operation *op = *it;
+      if (op->HasTrait<SideEffectTrait>()) {
+        InvalidateKnownOps(op, &known_ops, &known_source_ops);
+        ++it;
+        continue;
+      }
+      if (!IsOpEliminable(op)) {
+        ++it;
+        continue;
+      }
+      auto known_op = known_ops.insert(op);
+      if (known_op.second) {
+        if (op->num_operands() == 0) known_source_ops.push_back(op);
+        ++it;
+        continue;
+      }
+      for (uint32_t i = 0; i < op->num_results(); ++i) {
+        op->GetResultByIndex(i).ReplaceAllUsesWith(
+            (*known_op.first)->GetResultByIndex(i));
+      }
+      it = block->erase(it);
+      ++num_erased;
+    }
+    return num_erased;
+  }
+
+  // An operation with side effect may write its operands in place, so the
+  // known users of them can't be reused after it, neither can the known
+  // operations reading the state.
+  template <typename KnownOpSet>
+  void InvalidateKnownOps(Operation *op,
+                          KnownOpSet *known_ops,
+                          std::vector<Operation *> *known_source_ops) {
+    for (uint32_t i = 0; i < op->num_operands(); ++i) {
+      Value operand = op->GetOperandByIndex(i).source();
+      if (!operand) continue;
+      for (auto use = operand.begin(); use != operand.end(); ++use) {
+        known_ops->erase(use.owner());
+      }
+    }
+    for (Operation *source_op : *known_source_ops) {
+      known_ops->erase(source_op);
+    }
+    known_source_ops->clear();
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<Pass> CreateCommonSubexpressionEliminationPass() {
+  return std::make_unique<CommonSubexpressionEliminationPass>();
+}
+
+}  // namespace ir
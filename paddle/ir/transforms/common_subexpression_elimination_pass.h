@@ -0,0 +1,32 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+
+namespace ir {
+
+class Pass;
+
+///
+/// \brief Create a pass that eliminates the common subexpressions in each
+/// block: an operation is replaced by a preceding one with the same OpInfo,
+/// attributes, operands and result types. The operations with regions or side
+/// effects are never merged. After a side effect, the preceding users of its
+/// operands and the preceding operations without operand are not reused.
+///
+std::unique_ptr<Pass> CreateCommonSubexpressionEliminationPass();
+
+}  // namespace ir
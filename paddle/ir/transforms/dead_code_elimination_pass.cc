@@ -0,0 +1,67 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/ir/transforms/dead_code_elimination_pass.h"
+
+#include <vector>
+
+#include "paddle/ir/core/builtin_op.h"
+#include "paddle/ir/core/operation.h"
+#include "paddle/ir/core/region.h"
+#include "paddle/ir/pass/pass.h"
+
+namespace ir {
+
+bool IsOpTriviallyDead(Operation *op) {
+  return op->num_results() > 0 && op->num_regions() == 0 &&
+         !op->HasTrait<SideEffectTrait>() && op->use_empty();
+}
+
+namespace {
+
+class DeadCodeEliminationPass : public Pass {
+ public:
+  DeadCodeEliminationPass() : Pass("DeadCodeEliminationPass", 0) {}
+
+  void Run(Operation *op) override {
+    size_t num_erased = 0;
+    for (size_t i = 0; i < op->num_regions(); ++i) {
+      for (Block *block : op->GetRegion(i)) {
+        // Erasing an operation may make its producers dead, so the users are
+        // visited before their producers.
+        std::vector<Operation *> ops(block->rbegin(), block->rend());
+        for (Operation *cur_op : ops) {
+          if (!IsOpTriviallyDead(cur_op)) continue;
+          block->erase(Block::iterator(*cur_op));
+          ++num_erased;
+        }
+      }
+    }
+    VLOG(6) << "DeadCodeEliminationPass erased " << num_erased
+            << " operations.";
+    if (num_erased == 0) {
+      MarkAllAnalysesPreserved();
+    } else {
+      MarkChangedIrFeatures(IrFeatures::kOperations | IrFeatures::kOperands);
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<Pass> CreateDeadCodeEliminationPass() {
+  return std::make_unique<DeadCodeEliminationPass>();
+}
+
+}  // namespace ir
@@ -0,0 +1,38 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+
+namespace ir {
+
+class Operation;
+class Pass;
+
+///
+/// \brief Return true if the operation can be erased when all of its results
+/// are unused: it has results, no region and no side effect.
+///
+bool IsOpTriviallyDead(Operation *op);
+
+///
+/// \brief Create a pass that erases the operations whose results are unused
+/// and which have no side effect, see IsOpTriviallyDead. The operations are
+/// visited from the end of each block, so a chain of dead operations is erased
+/// in a single run.
+///
+std::unique_ptr<Pass> CreateDeadCodeEliminationPass();
+
+}  // namespace ir
@@ -771,6 +771,10 @@ class SparseTable(Table):
             table_proto.enable_revert = usr_table_proto.enable_revert
         if usr_table_proto.HasField("shard_merge_rate"):
             table_proto.shard_merge_rate = usr_table_proto.shard_merge_rate
+        if usr_table_proto.HasField("use_flat_shard"):
+            table_proto.use_flat_shard = usr_table_proto.use_flat_shard
+        if usr_table_proto.HasField("save_binary"):
+            table_proto.save_binary = usr_table_proto.save_binary
 
         if usr_table_proto.accessor.ByteSize() == 0:
             warnings.warn(
@@ -17,9 +17,14 @@ limitations under the License. */
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
+#ifndef _WIN32
+#include "paddle/fluid/memory/allocation/mmap_allocator.h"
+#endif
 #include "paddle/fluid/platform/bfloat16.h"
 #include "paddle/fluid/platform/float16.h"
+#include "paddle/phi/core/flags.h"
 #include "paddle/phi/core/kernel_registry.h"
 
 USE_OP_ITSELF(save_combine);
@@ -27,6 +32,8 @@ USE_OP_ITSELF(load_combine);
 PD_DECLARE_KERNEL(save_combine_tensor, CPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(load_combine, CPU, ALL_LAYOUT);
 
+PHI_DECLARE_bool(load_combine_use_mmap);
+
 template <typename T, typename U>
 T* CreateForSaveCombineOp(int x,
                           int y,
@@ -160,6 +167,50 @@ TEST(SaveLoadCombineBF16Op, CPU) {
   SaveLoadCombineOp<paddle::platform::bfloat16, paddle::platform::bfloat16>();
 }
 
+#ifndef _WIN32
+TEST(SaveLoadCombineOpWithMmap, CPU) {
+  FLAGS_load_combine_use_mmap = true;
+  SaveLoadCombineOp<paddle::platform::bfloat16, paddle::platform::bfloat16>();
+  SaveLoadCombineOp<int, int>();
+
+  // The tensors share the copy-on-write pages of the file, so writing them
+  // changes neither the file nor the other tensors loaded from it.
+  paddle::platform::CPUPlace place;
+  paddle::framework::AttributeMap attrs;
+  attrs.insert({"file_path", std::string("check_tensor.ls")});
+  std::vector<int*> actuals;
+  paddle::framework::Scope scope1, scope2;
+  for (auto* scope : {&scope1, &scope2}) {
+    auto target = GeneratePlaceholderBeforeLoad("out_var1", scope);
+    GeneratePlaceholderBeforeLoad("out_var2", scope);
+    GeneratePlaceholderBeforeLoad("out_var3", scope);
+    GeneratePlaceholderBeforeLoad("out_var4", scope);
+    auto load_combine_op = paddle::framework::OpRegistry::CreateOp(
+        "load_combine",
+        {},
+        {{"Out", {"out_var1", "out_var2", "out_var3", "out_var4"}}},
+        attrs);
+    load_combine_op->Run(*scope, place);
+    actuals.push_back(target->data<int>());
+
+    // The data saved by save_combine is aligned, so it isn't copied.
+    auto* slice = dynamic_cast<paddle::framework::BufferSliceAllocation*>(
+        target->Holder().get());
+    ASSERT_NE(slice, nullptr);
+    auto* mapped_file =
+        dynamic_cast<paddle::memory::allocation::MappedFileAllocation*>(
+            slice->buffer().get());
+    ASSERT_NE(mapped_file, nullptr);
+    EXPECT_EQ(mapped_file->file_name(), "check_tensor.ls");
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(target->data()) % 64, 0UL);
+  }
+  EXPECT_NE(actuals[0], actuals[1]);
+  actuals[0][0] = -1;
+  EXPECT_EQ(actuals[1][0], 0);
+  FLAGS_load_combine_use_mmap = false;
+}
+#endif
+
 // FP16 version of SaveLoadCombineOp Test, only altering the saving aspect
 // to save as FP16.
 TEST(SaveCombineFP16Op, CPU) {
@@ -279,6 +279,65 @@ TEST(AnalysisPredictor, Clone) {
   }
 }
 
+uint64_t WeightMemorySize(PaddlePredictor* predictor, uint64_t* shared_size) {
+  return static_cast<AnalysisPredictor*>(predictor)->GetWeightMemorySize(
+      shared_size);
+}
+
+TEST(AnalysisPredictor, WeightSharing) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SwitchIrOptim(true);
+  config.DisableGpu();
+  config.EnableWeightSharing();
+  LOG(INFO) << config.Summary();
+
+  auto predictor0 = CreatePaddlePredictor(config);
+  uint64_t shared_size = 0;
+  uint64_t size = WeightMemorySize(predictor0.get(), &shared_size);
+  ASSERT_GT(size, 0UL);
+  EXPECT_EQ(shared_size, 0UL);
+  size_t num_weights = ResourceManager::Instance().NumRegisteredWeights();
+  EXPECT_GT(num_weights, 0UL);
+
+  // The second predictor of the same model uses the weights of the first.
+  auto predictor1 = CreatePaddlePredictor(config);
+  EXPECT_EQ(WeightMemorySize(predictor1.get(), &shared_size), size);
+  EXPECT_EQ(shared_size, size);
+  WeightMemorySize(predictor0.get(), &shared_size);
+  EXPECT_EQ(shared_size, size);
+  EXPECT_EQ(ResourceManager::Instance().NumRegisteredWeights(), num_weights);
+
+  // The clone shares the scope.
+  auto predictor2 = predictor1->Clone();
+  EXPECT_EQ(WeightMemorySize(predictor2.get(), &shared_size), size);
+  EXPECT_EQ(shared_size, size);
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+  std::vector<PaddleTensor> outputs0, outputs1;
+  ASSERT_TRUE(predictor0->Run(inputs, &outputs0));
+  predictor0.reset();
+  ASSERT_TRUE(predictor1->Run(inputs, &outputs1));
+  ASSERT_EQ(outputs0.size(), outputs1.size());
+  ASSERT_EQ(outputs0[0].data.length(), outputs1[0].data.length());
+  const float* data0 = static_cast<const float*>(outputs0[0].data.data());
+  const float* data1 = static_cast<const float*>(outputs1[0].data.data());
+  for (size_t i = 0; i < outputs0[0].data.length() / sizeof(float); ++i) {
+    EXPECT_EQ(data0[i], data1[i]);
+  }
+
+  // The weights are still registered while predictor1 uses them.
+  EXPECT_EQ(ResourceManager::Instance().NumRegisteredWeights(), num_weights);
+  predictor2.reset();
+  predictor1.reset();
+  EXPECT_EQ(ResourceManager::Instance().NumRegisteredWeights(), 0UL);
+}
+
 // This function is not released yet, will fail on some machine.
 // TODO(Superjomn) Turn on it latter.
 /*
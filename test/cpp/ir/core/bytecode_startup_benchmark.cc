@@ -0,0 +1,89 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the startup from a legacy program, which is parsed and translated,
+// with the startup from the bytecode of the translated program:
+//   ./bytecode_startup_benchmark resnet50_main.prog
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include "glog/logging.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/ir/dialect/pd_dialect.h"
+#include "paddle/fluid/ir_adaptor/translator/translate.h"
+#include "paddle/fluid/ir_adaptor/translator/translation_cache.h"
+#include "paddle/ir/core/builtin_dialect.h"
+#include "paddle/ir/core/bytecode.h"
+#include "paddle/ir/core/ir_context.h"
+#include "paddle/ir/core/program.h"
+
+namespace {
+using paddle::framework::ProgramDesc;
+
+ProgramDesc LoadFromFile(const std::string &file_name) {
+  std::ifstream fin(file_name, std::ios::in | std::ios::binary);
+  fin.seekg(0, std::ios::end);
+  std::string buffer(fin.tellg(), ' ');
+  fin.seekg(0, std::ios::beg);
+  fin.read(&buffer[0], buffer.size());
+  return ProgramDesc(buffer);
+}
+
+double ElapsedMs(std::chrono::steady_clock::time_point start) {
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  if (argc < 2) {
+    LOG(ERROR) << "Usage: " << argv[0] << " <program file>";
+    return 1;
+  }
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::PaddleDialect>();
+  ctx->GetOrRegisterDialect<ir::BuiltinDialect>();
+
+  paddle::translator::TranslationCache::instance().Clear();
+  auto start = std::chrono::steady_clock::now();
+  ProgramDesc program_desc = LoadFromFile(argv[1]);
+  auto program = paddle::TranslateLegacyProgramToProgram(program_desc);
+  double translate_cost = ElapsedMs(start);
+
+  char path[] = "/tmp/bytecode_startup_benchmark_XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    LOG(ERROR) << "Failed to create the temporary bytecode file.";
+    return 1;
+  }
+  close(fd);
+  ir::SaveBytecode(program.get(), path);
+
+  start = std::chrono::steady_clock::now();
+  auto loaded = ir::LoadBytecode(ctx, path);
+  double load_cost = ElapsedMs(start);
+  std::remove(path);
+
+  LOG(INFO) << "Startup of " << loaded->block()->size()
+            << " ops: translation from ProgramDesc costs " << translate_cost
+            << "ms, loading bytecode costs " << load_cost << "ms.";
+  return 0;
+}
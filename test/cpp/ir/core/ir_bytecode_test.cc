@@ -0,0 +1,232 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "paddle/ir/core/builder.h"
+#include "paddle/ir/core/builtin_attribute.h"
+#include "paddle/ir/core/builtin_op.h"
+#include "paddle/ir/core/builtin_type.h"
+#include "paddle/ir/core/bytecode.h"
+#include "paddle/ir/core/enforce.h"
+#include "paddle/ir/core/ir_context.h"
+#include "paddle/ir/core/program.h"
+
+namespace {
+// A temporary file removed when it goes out of scope.
+class TempFile {
+ public:
+  explicit TempFile(const std::string &prefix)
+      : path_("/tmp/" + prefix + "_XXXXXX") {
+    int fd = mkstemp(&path_[0]);
+    EXPECT_GE(fd, 0);
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+  ~TempFile() { std::remove(path_.c_str()); }
+  const std::string &path() const { return path_; }
+
+ private:
+  std::string path_;
+};
+
+// Build a program of constants, which are combined and sliced:
+//   c_i = constant(i), v = combine(c_0, ..., c_n), s = slice(v, 1)
+void BuildProgram(ir::Program *program, size_t num_constants) {
+  ir::IrContext *ctx = program->module_op().ir_context();
+  ir::Builder builder(ctx, program->block());
+
+  std::vector<ir::OpResult> constants;
+  std::vector<ir::Type> types;
+  for (size_t i = 0; i < num_constants; ++i) {
+    ir::Type type = i % 2 == 0
+                        ? static_cast<ir::Type>(ir::Float32Type::get(ctx))
+                        : ir::Int64Type::get(ctx);
+    ir::Attribute value =
+        i % 2 == 0 ? static_cast<ir::Attribute>(
+                         ir::FloatAttribute::get(ctx, 0.5f * i))
+                   : ir::Int64_tAttribute::get(ctx, -static_cast<int64_t>(i));
+    ir::ConstantOp constant = builder.Build<ir::ConstantOp>(value, type);
+    constants.push_back(constant->GetResultByIndex(0));
+    types.push_back(type);
+  }
+
+  ir::OpInfo combine_info = ctx->GetRegisteredOpInfo(ir::CombineOp::name());
+  ir::Operation *combine = builder.Build(
+      constants, {}, {ir::VectorType::get(ctx, types)}, combine_info);
+
+  ir::OpInfo slice_info = ctx->GetRegisteredOpInfo(ir::SliceOp::name());
+  builder.Build({combine->GetResultByIndex(0)},
+                {{"index", ir::Int32_tAttribute::get(ctx, 1)}},
+                {types[1]},
+                slice_info);
+
+  std::vector<float> data = {1.0f, 2.0f, 3.0f};
+  auto parameter = std::make_unique<ir::Parameter>(
+      data.data(), data.size() * sizeof(float), ir::Float32Type::get(ctx));
+  parameter->set_mutable();
+  program->SetParameter("weight", std::move(parameter));
+  bool flag = true;
+  program->SetParameter("flag",
+                        std::make_unique<ir::Parameter>(
+                            &flag, sizeof(flag), ir::BoolType::get(ctx)));
+  program->SetParameter("placeholder", nullptr);
+
+  std::vector<ir::Attribute> shape = {ir::Int64_tAttribute::get(ctx, 3),
+                                      ir::BoolAttribute::get(ctx, true),
+                                      ir::DoubleAttribute::get(ctx, 0.25)};
+  ir::AttributeMap attributes = {
+      {"parameter_name", ir::StrAttribute::get(ctx, "weight")},
+      {"shape", ir::ArrayAttribute::get(ctx, shape)}};
+  ir::OpInfo get_parameter_info =
+      ctx->GetRegisteredOpInfo(ir::GetParameterOp::name());
+  builder.Build(
+      {}, attributes, {ir::Float64Type::get(ctx)}, get_parameter_info);
+}
+
+std::string PrintProgram(ir::Program *program) {
+  std::stringstream ss;
+  program->Print(ss);
+  return ss.str();
+}
+}  // namespace
+
+TEST(ir_bytecode_test, round_trip) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ir::Program program(ctx);
+  BuildProgram(&program, 4);
+
+  std::string data = ir::BytecodeWriter(ctx).Write(&program);
+  // The encoding is deterministic.
+  EXPECT_EQ(data, ir::BytecodeWriter(ctx).Write(&program));
+
+  auto loaded = ir::BytecodeReader(ctx, data.data(), data.size()).Read();
+  EXPECT_EQ(loaded->block()->size(), program.block()->size());
+  EXPECT_EQ(PrintProgram(loaded.get()), PrintProgram(&program));
+
+  // Types and attributes are uniqued in the context, so the loaded operations
+  // refer to the same storages.
+  auto it = program.block()->begin();
+  auto loaded_it = loaded->block()->begin();
+  for (; it != program.block()->end(); ++it, ++loaded_it) {
+    ir::Operation *op = *it;
+    ir::Operation *loaded_op = *loaded_it;
+    EXPECT_EQ(loaded_op->info(), op->info());
+    EXPECT_EQ(loaded_op->attributes(), op->attributes());
+    ASSERT_EQ(loaded_op->num_results(), op->num_results());
+    for (uint32_t i = 0; i < op->num_results(); ++i) {
+      EXPECT_EQ(loaded_op->GetResultByIndex(i).type(),
+                op->GetResultByIndex(i).type());
+    }
+  }
+
+  // The uses are rebuilt from the value ids.
+  ir::Operation *combine = *std::next(loaded->block()->begin(), 4);
+  ir::Operation *slice = *std::next(loaded->block()->begin(), 5);
+  EXPECT_EQ(slice->GetOperandByIndex(0).source(),
+            combine->GetResultByIndex(0));
+  EXPECT_EQ(combine->GetOperandByIndex(2).source(),
+            (*std::next(loaded->block()->begin(), 2))->GetResultByIndex(0));
+
+  ir::Parameter *parameter = loaded->GetParameter("weight");
+  ASSERT_NE(parameter, nullptr);
+  EXPECT_TRUE(parameter->is_mutable());
+  EXPECT_EQ(parameter->type(), ir::Float32Type::get(ctx));
+  ASSERT_EQ(parameter->size(), 3 * sizeof(float));
+  EXPECT_EQ(static_cast<float *>(parameter->data())[2], 3.0f);
+  ASSERT_NE(loaded->GetParameter("flag"), nullptr);
+  EXPECT_EQ(loaded->GetParameter("flag")->type(), ir::BoolType::get(ctx));
+  EXPECT_FALSE(loaded->GetParameter("flag")->is_mutable());
+  EXPECT_EQ(loaded->parameters().count("placeholder"), 1u);
+  EXPECT_EQ(loaded->GetParameter("placeholder"), nullptr);
+}
+
+TEST(ir_bytecode_test, save_and_load_file) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ir::Program program(ctx);
+  BuildProgram(&program, 64);
+
+  TempFile file("ir_bytecode_test");
+  const std::string &path = file.path();
+  ir::SaveBytecode(&program, path);
+  auto loaded = ir::LoadBytecode(ctx, path);
+  EXPECT_EQ(PrintProgram(loaded.get()), PrintProgram(&program));
+  EXPECT_NE(loaded->arena(), nullptr);
+}
+
+TEST(ir_bytecode_test, view_large_parameters) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ir::Program program(ctx);
+  BuildProgram(&program, 4);
+  std::vector<float> data(ir::kMinViewParameterSize);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<float>(i);
+  }
+  program.SetParameter(
+      "large",
+      std::make_unique<ir::Parameter>(
+          data.data(), data.size() * sizeof(float), ir::Float32Type::get(ctx)));
+
+  TempFile file("ir_bytecode_view_test");
+  const std::string &path = file.path();
+  ir::SaveBytecode(&program, path);
+  {
+    auto loaded = ir::LoadBytecode(ctx, path);
+    // The large parameter views the mapped file, the small ones are copied.
+    ir::Parameter *large = loaded->GetParameter("large");
+    ASSERT_NE(large, nullptr);
+    EXPECT_FALSE(large->owns_data());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(large->data()) % 64, 0u);
+    ASSERT_EQ(large->size(), data.size() * sizeof(float));
+    EXPECT_EQ(std::memcmp(large->data(), data.data(), large->size()), 0);
+    EXPECT_TRUE(loaded->GetParameter("weight")->owns_data());
+
+    // The writes to the view don't reach the file.
+    static_cast<float *>(large->data())[1] = -1.0f;
+  }
+  auto reloaded = ir::LoadBytecode(ctx, path);
+  EXPECT_EQ(static_cast<float *>(reloaded->GetParameter("large")->data())[1],
+            1.0f);
+
+  // The parameters decoded from a buffer without a holder are copied.
+  std::string bytes = ir::BytecodeWriter(ctx).Write(&program);
+  auto copied = ir::BytecodeReader(ctx, bytes.data(), bytes.size()).Read();
+  EXPECT_TRUE(copied->GetParameter("large")->owns_data());
+}
+
+TEST(ir_bytecode_test, reject_malformed_data) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ir::Program program(ctx);
+  BuildProgram(&program, 4);
+  std::string data = ir::BytecodeWriter(ctx).Write(&program);
+
+  // Truncated data.
+  EXPECT_THROW(
+      ir::BytecodeReader(ctx, data.data(), data.size() - 1).Read(),
+      ir::IrNotMetException);
+  // Unknown format.
+  std::string bad_magic = data;
+  bad_magic[0] = 'X';
+  EXPECT_THROW(
+      ir::BytecodeReader(ctx, bad_magic.data(), bad_magic.size()).Read(),
+      ir::IrNotMetException);
+}
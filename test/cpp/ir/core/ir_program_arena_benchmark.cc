@@ -0,0 +1,60 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares building and destroying a Program with and without the arena:
+//   ./ir_program_arena_benchmark
+
+#include <chrono>
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/ir/core/builder.h"
+#include "paddle/ir/core/builtin_type.h"
+#include "paddle/ir/core/ir_context.h"
+#include "paddle/ir/core/program.h"
+
+namespace {
+// Build a chain of num_ops operations: a0 = op(); a1 = op(a0); ...
+void BuildChain(ir::Program *program, size_t num_ops) {
+  ir::IrContext *ctx = program->module_op().ir_context();
+  ir::Builder builder(ctx, program->block());
+  std::vector<ir::Type> output_types = {ir::Float32Type::get(ctx)};
+  ir::Operation *prev = builder.Build({}, {}, output_types, ir::OpInfo());
+  for (size_t i = 1; i < num_ops; ++i) {
+    prev = builder.Build(
+        {prev->GetResultByIndex(0)}, {}, output_types, ir::OpInfo());
+  }
+}
+
+double BuildAndDestroy(size_t num_ops, bool use_arena) {
+  auto start = std::chrono::steady_clock::now();
+  {
+    ir::Program program(ir::IrContext::Instance(), use_arena);
+    BuildChain(&program, num_ops);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  for (size_t num_ops : {10000u, 100000u, 1000000u}) {
+    double heap_cost = BuildAndDestroy(num_ops, false);
+    double arena_cost = BuildAndDestroy(num_ops, true);
+    LOG(INFO) << "Build and destroy " << num_ops << " ops: heap costs "
+              << heap_cost << "ms, arena costs " << arena_cost << "ms.";
+  }
+  return 0;
+}
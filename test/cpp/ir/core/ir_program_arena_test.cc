@@ -0,0 +1,91 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "paddle/ir/core/arena.h"
+#include "paddle/ir/core/builder.h"
+#include "paddle/ir/core/builtin_type.h"
+#include "paddle/ir/core/ir_context.h"
+#include "paddle/ir/core/program.h"
+
+namespace {
+// Build a chain of num_ops operations: a0 = op(); a1 = op(a0); ...
+void BuildChain(ir::Program *program, size_t num_ops) {
+  ir::IrContext *ctx = program->module_op().ir_context();
+  ir::Builder builder(ctx, program->block());
+  std::vector<ir::Type> output_types = {ir::Float32Type::get(ctx)};
+  ir::Operation *prev = builder.Build({}, {}, output_types, ir::OpInfo());
+  for (size_t i = 1; i < num_ops; ++i) {
+    prev = builder.Build(
+        {prev->GetResultByIndex(0)}, {}, output_types, ir::OpInfo());
+  }
+}
+}  // namespace
+
+TEST(ir_arena_test, allocate_and_recycle) {
+  ir::Arena arena(1024);
+  void *a = arena.Allocate(20);
+  void *b = arena.Allocate(24);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(a) % ir::Arena::kAlignment, 0u);
+  EXPECT_EQ(reinterpret_cast<char *>(b) - reinterpret_cast<char *>(a), 24);
+  EXPECT_EQ(arena.allocated_bytes(), 48u);
+  EXPECT_EQ(arena.num_slabs(), 1u);
+
+  // Memory of the same size class is reused.
+  arena.Deallocate(a, 20);
+  EXPECT_EQ(arena.allocated_bytes(), 24u);
+  EXPECT_EQ(arena.Allocate(24), a);
+
+  // Large objects get a dedicated slab.
+  void *large = arena.Allocate(4096);
+  EXPECT_NE(large, nullptr);
+  EXPECT_EQ(arena.num_slabs(), 2u);
+  EXPECT_EQ(arena.reserved_bytes(), 1024u + 4096u);
+  arena.Deallocate(large, 4096);
+  EXPECT_EQ(arena.allocated_bytes(), 48u);
+}
+
+TEST(ir_arena_test, program_with_arena) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ir::Program program(ctx, true);
+  ASSERT_NE(program.arena(), nullptr);
+  EXPECT_EQ(program.module_op().operation()->arena(), program.arena());
+
+  BuildChain(&program, 100);
+  EXPECT_EQ(program.block()->size(), 100u);
+  for (auto op : *program.block()) {
+    EXPECT_EQ(op->arena(), program.arena());
+  }
+
+  // Erasing and re-creating operations reuses the recycled memory.
+  size_t allocated = program.arena()->allocated_bytes();
+  size_t reserved = program.arena()->reserved_bytes();
+  ir::Block *block = program.block();
+  for (auto it = block->end(); it != block->begin();) {
+    it = block->erase(--it);
+  }
+  EXPECT_TRUE(block->empty());
+  EXPECT_LT(program.arena()->allocated_bytes(), allocated);
+  BuildChain(&program, 100);
+  EXPECT_EQ(program.arena()->allocated_bytes(), allocated);
+  EXPECT_EQ(program.arena()->reserved_bytes(), reserved);
+
+  ir::Program heap_program(ctx);
+  EXPECT_EQ(heap_program.arena(), nullptr);
+  BuildChain(&heap_program, 10);
+  for (auto op : *heap_program.block()) {
+    EXPECT_EQ(op->arena(), nullptr);
+  }
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures DenseTensorType lookups and StrAttribute creations from several
+// threads:
+//   ./ir_storage_manager_benchmark
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/fluid/ir/dialect/pd_dialect.h"
+#include "paddle/fluid/ir/dialect/pd_type.h"
+#include "paddle/ir/core/builtin_attribute.h"
+#include "paddle/ir/core/builtin_type.h"
+#include "paddle/ir/core/ir_context.h"
+
+namespace {
+template <typename Func>
+double RunInThreads(size_t num_threads, Func func) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads.emplace_back(func, i);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+ir::Type GetDenseTensorType(ir::IrContext *ctx, int64_t dim) {
+  return paddle::dialect::DenseTensorType::get(ctx,
+                                               ir::Float32Type::get(ctx),
+                                               phi::make_ddim({dim, 64}),
+                                               phi::DataLayout::NCHW,
+                                               phi::LoD(),
+                                               0);
+}
+
+void RunBenchmark() {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::PaddleDialect>();
+  const int64_t num_iters = 200000;
+  const int64_t num_shapes = 256;
+  for (int64_t i = 0; i < num_shapes; ++i) {
+    GetDenseTensorType(ctx, i);
+  }
+
+  for (size_t num_threads : {1, 2, 4, 8}) {
+    // Lookups of existing types.
+    double type_cost = RunInThreads(num_threads, [&](size_t tid) {
+      for (int64_t i = 0; i < num_iters; ++i) {
+        GetDenseTensorType(ctx, i % num_shapes);
+      }
+    });
+    // Creation of new attributes, each thread creates its own values.
+    double attr_cost = RunInThreads(num_threads, [&](size_t tid) {
+      std::string prefix = std::to_string(num_threads) + "_" +
+                           std::to_string(tid) + "_";
+      for (int64_t i = 0; i < num_iters / 10; ++i) {
+        ir::StrAttribute::get(ctx, prefix + std::to_string(i));
+      }
+    });
+    LOG(INFO) << num_threads << " threads: " << num_iters
+              << " DenseTensorType::get per thread cost " << type_cost
+              << "ms, " << num_iters / 10
+              << " StrAttribute::get of new values per thread cost "
+              << attr_cost << "ms.";
+  }
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  RunBenchmark();
+  return 0;
+}
@@ -0,0 +1,109 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "paddle/fluid/ir/dialect/pd_dialect.h"
+#include "paddle/fluid/ir/dialect/pd_type.h"
+#include "paddle/ir/core/builtin_attribute.h"
+#include "paddle/ir/core/builtin_type.h"
+#include "paddle/ir/core/enforce.h"
+#include "paddle/ir/core/ir_context.h"
+#include "paddle/ir/core/storage_manager.h"
+
+namespace {
+template <typename Func>
+double RunInThreads(size_t num_threads, Func func) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads.emplace_back(func, i);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+ir::Type GetDenseTensorType(ir::IrContext *ctx, int64_t dim) {
+  return paddle::dialect::DenseTensorType::get(ctx,
+                                               ir::Float32Type::get(ctx),
+                                               phi::make_ddim({dim, 64}),
+                                               phi::DataLayout::NCHW,
+                                               phi::LoD(),
+                                               0);
+}
+}  // namespace
+
+TEST(storage_manager_test, concurrent_get_is_unique) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::PaddleDialect>();
+  const size_t num_threads = 8;
+  const int64_t num_values = 4096;
+
+  // Every thread creates the same storages concurrently, in different orders.
+  std::vector<std::vector<ir::Attribute>> attrs(num_threads);
+  std::vector<std::vector<ir::Type>> types(num_threads);
+  RunInThreads(num_threads, [&](size_t tid) {
+    for (int64_t i = 0; i < num_values; ++i) {
+      int64_t value = tid % 2 == 0 ? i : num_values - 1 - i;
+      attrs[tid].push_back(ir::Int64_tAttribute::get(ctx, value));
+      types[tid].push_back(GetDenseTensorType(ctx, value));
+    }
+  });
+
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    for (int64_t i = 0; i < num_values; ++i) {
+      int64_t value = tid % 2 == 0 ? i : num_values - 1 - i;
+      ir::Attribute attr = attrs[tid][i];
+      EXPECT_EQ(attr, ir::Int64_tAttribute::get(ctx, value));
+      EXPECT_EQ(attr.dyn_cast<ir::Int64_tAttribute>().data(), value);
+      EXPECT_EQ(types[tid][i], GetDenseTensorType(ctx, value));
+    }
+  }
+}
+
+struct TestParameterlessStorage : public ir::StorageManager::StorageBase {};
+
+TEST(storage_manager_test, concurrent_register_parameterless) {
+  const size_t num_threads = 8;
+  for (int iter = 0; iter < 100; ++iter) {
+    ir::StorageManager manager;
+    std::atomic<int> num_registered{0};
+    std::atomic<int> num_rejected{0};
+    std::atomic<size_t> num_ready{0};
+    RunInThreads(num_threads, [&](size_t tid) {
+      // Start the registrations at the same time.
+      ++num_ready;
+      while (num_ready.load() < num_threads) {
+        std::this_thread::yield();
+      }
+      try {
+        manager.RegisterParameterlessStorage<TestParameterlessStorage>(
+            ir::TypeId::get<TestParameterlessStorage>(), nullptr);
+        ++num_registered;
+      } catch (ir::IrNotMetException &e) {
+        ++num_rejected;
+      }
+    });
+    EXPECT_EQ(num_registered.load(), 1);
+    EXPECT_EQ(num_rejected.load(), static_cast<int>(num_threads - 1));
+  }
+}
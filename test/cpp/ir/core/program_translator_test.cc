@@ -13,9 +13,14 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
-#include <chrono>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <sstream>
 #include <string>
 
 #include "paddle/fluid/framework/framework.pb.h"
@@ -23,10 +28,16 @@
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/ir/dialect/pd_dialect.h"
 #include "paddle/fluid/ir_adaptor/translator/translate.h"
+#include "paddle/fluid/ir_adaptor/translator/translation_cache.h"
 #include "paddle/ir/core/builtin_dialect.h"
+#include "paddle/ir/core/bytecode.h"
 #include "paddle/ir/core/dialect.h"
 #include "paddle/ir/core/ir_context.h"
 #include "paddle/ir/core/program.h"
+#include "paddle/ir/pass/cache_statistics.h"
+#include "paddle/ir/pass/pass.h"
+#include "paddle/ir/pass/pass_manager.h"
+#include "paddle/phi/core/flags.h"
 
 using PaddleDialect = paddle::dialect::PaddleDialect;
 using ProgramDesc = paddle::framework::ProgramDesc;
@@ -35,6 +46,8 @@ using OpDesc = paddle::framework::OpDesc;
 using VarDesc = paddle::framework::VarDesc;
 using VarType = paddle::framework::proto::VarType;
 
+PHI_DECLARE_bool(enable_translation_cache);
+
 ProgramDesc load_from_file(const std::string &file_name) {
   std::ifstream fin(file_name, std::ios::in | std::ios::binary);
   fin.seekg(0, std::ios::end);
@@ -46,6 +59,24 @@ ProgramDesc load_from_file(const std::string &file_name) {
   return ProgramDesc(buffer);
 }
 
+// A temporary file removed when it goes out of scope.
+class TempFile {
+ public:
+  explicit TempFile(const std::string &prefix)
+      : path_("/tmp/" + prefix + "_XXXXXX") {
+    int fd = mkstemp(&path_[0]);
+    EXPECT_GE(fd, 0);
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+  ~TempFile() { std::remove(path_.c_str()); }
+  const std::string &path() const { return path_; }
+
+ private:
+  std::string path_;
+};
+
 TEST(PaddleDialectTest, MainProgram) {
   auto p = load_from_file("resnet50_main.prog");
   EXPECT_EQ(p.Size(), 1u);
@@ -81,3 +112,124 @@ TEST(PaddleDialectTest, StartupProgram) {
 
   program->Print(std::cout);
 }
+
+TEST(PaddleDialectTest, BytecodeRoundTrip) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<PaddleDialect>();
+  ctx->GetOrRegisterDialect<ir::BuiltinDialect>();
+  auto p = load_from_file("resnet50_main.prog");
+  auto program = paddle::TranslateLegacyProgramToProgram(p);
+
+  TempFile file("resnet50_main_pdirbc");
+  ir::SaveBytecode(program.get(), file.path());
+  auto loaded = ir::LoadBytecode(ctx, file.path());
+
+  EXPECT_EQ(loaded->block()->size(), program->block()->size());
+  EXPECT_EQ(loaded->parameters_num(), program->parameters_num());
+  std::stringstream expected, actual;
+  program->Print(expected);
+  loaded->Print(actual);
+  EXPECT_EQ(actual.str(), expected.str());
+}
+
+TEST(PaddleDialectTest, TranslationCache) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<PaddleDialect>();
+  ctx->GetOrRegisterDialect<ir::BuiltinDialect>();
+  auto p = load_from_file("resnet50_main.prog");
+
+  paddle::translator::TranslationCache::instance().Clear();
+  ir::CacheStatistics::Scope statistics;
+  const std::string block_counter = "TranslationCache(block)";
+  const std::string op_counter = "TranslationCache(op)";
+
+  auto program = paddle::TranslateLegacyProgramToProgram(p);
+  EXPECT_EQ(statistics.hits(block_counter), 0u);
+  EXPECT_EQ(statistics.misses(block_counter), 1u);
+  size_t num_ops = statistics.hits(op_counter) + statistics.misses(op_counter);
+  size_t op_misses = statistics.misses(op_counter);
+  EXPECT_GT(num_ops, 0u);
+  std::stringstream expected;
+  program->Print(expected);
+
+  // The same program is decoded from the block cache.
+  auto cached_program = paddle::TranslateLegacyProgramToProgram(p);
+  EXPECT_EQ(statistics.hits(block_counter), 1u);
+  EXPECT_EQ(statistics.hits(op_counter) + statistics.misses(op_counter),
+            num_ops);
+  std::stringstream actual;
+  cached_program->Print(actual);
+  EXPECT_EQ(actual.str(), expected.str());
+
+  // A new variable changes the block, but none of the ops, so every op is
+  // built from its template.
+  p.MutableBlock(0)->Var("translation_cache_test_var");
+  auto retranslated_program = paddle::TranslateLegacyProgramToProgram(p);
+  EXPECT_EQ(statistics.misses(block_counter), 2u);
+  EXPECT_EQ(statistics.misses(op_counter), op_misses);
+  EXPECT_EQ(statistics.hits(op_counter) + statistics.misses(op_counter),
+            2 * num_ops);
+  actual.str("");
+  retranslated_program->Print(actual);
+  EXPECT_EQ(actual.str(), expected.str());
+
+  // An attribute changes the hash of its op and of the block.
+  OpDesc *first_op = p.MutableBlock(0)->Op(0);
+  auto op_hash = paddle::translator::TranslationCache::HashOp(*first_op);
+  auto blocks_hash = paddle::translator::TranslationCache::HashBlocks(p);
+  EXPECT_EQ(paddle::translator::TranslationCache::HashOp(*first_op), op_hash);
+  first_op->SetAttr("translation_cache_test_attr", 1);
+  EXPECT_NE(paddle::translator::TranslationCache::HashOp(*first_op), op_hash);
+  EXPECT_NE(paddle::translator::TranslationCache::HashBlocks(p), blocks_hash);
+  first_op->RemoveAttr("translation_cache_test_attr");
+  EXPECT_EQ(paddle::translator::TranslationCache::HashOp(*first_op), op_hash);
+
+  // The hit rates are reported by the pass timing.
+  ir::PassManager pm(ctx);
+  pm.EnablePassTiming();
+  EXPECT_TRUE(pm.Run(retranslated_program.get()));
+}
+
+TEST(PaddleDialectTest, TranslationCacheCollision) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<PaddleDialect>();
+  ctx->GetOrRegisterDialect<ir::BuiltinDialect>();
+  auto &translation_cache = paddle::translator::TranslationCache::instance();
+  translation_cache.Clear();
+
+  // The entries of the same hash but another check digest are missed.
+  paddle::translator::TranslationKey key{1, 2};
+  paddle::translator::TranslationKey colliding_key{1, 3};
+  translation_cache.SetOpTemplate(
+      key, std::make_shared<paddle::translator::OpTranslationTemplate>());
+  EXPECT_NE(translation_cache.GetOpTemplate(key), nullptr);
+  EXPECT_EQ(translation_cache.GetOpTemplate(colliding_key), nullptr);
+
+  ir::Program program(ctx);
+  translation_cache.SetProgram(key, &program);
+  EXPECT_NE(translation_cache.GetProgram(key), nullptr);
+  EXPECT_EQ(translation_cache.GetProgram(colliding_key), nullptr);
+  translation_cache.Clear();
+}
+
+TEST(PaddleDialectTest, TranslationCacheDisabled) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<PaddleDialect>();
+  ctx->GetOrRegisterDialect<ir::BuiltinDialect>();
+  auto p = load_from_file("resnet50_main.prog");
+  auto program = paddle::TranslateLegacyProgramToProgram(p);
+
+  // The translation doesn't go through the cache with the flag off.
+  FLAGS_enable_translation_cache = false;
+  ir::CacheStatistics::Scope statistics;
+  auto uncached_program = paddle::TranslateLegacyProgramToProgram(p);
+  FLAGS_enable_translation_cache = true;
+  EXPECT_EQ(statistics.hits("TranslationCache(block)"), 0u);
+  EXPECT_EQ(statistics.misses("TranslationCache(block)"), 0u);
+  EXPECT_EQ(statistics.hits("TranslationCache(op)"), 0u);
+  EXPECT_EQ(statistics.misses("TranslationCache(op)"), 0u);
+  std::stringstream expected, actual;
+  program->Print(expected);
+  uncached_program->Print(actual);
+  EXPECT_EQ(actual.str(), expected.str());
+}
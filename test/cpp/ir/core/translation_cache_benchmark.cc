@@ -0,0 +1,96 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares translating a program with and without the translation cache, and
+// the cost of computing the cache keys:
+//   ./translation_cache_benchmark resnet50_main.prog
+
+#include <chrono>
+#include <fstream>
+#include <string>
+
+#include "glog/logging.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/ir/dialect/pd_dialect.h"
+#include "paddle/fluid/ir_adaptor/translator/translate.h"
+#include "paddle/fluid/ir_adaptor/translator/translation_cache.h"
+#include "paddle/ir/core/builtin_dialect.h"
+#include "paddle/ir/core/ir_context.h"
+
+namespace {
+using paddle::framework::ProgramDesc;
+using paddle::translator::TranslationCache;
+
+constexpr int kRepeat = 20;
+
+ProgramDesc LoadFromFile(const std::string &file_name) {
+  std::ifstream fin(file_name, std::ios::in | std::ios::binary);
+  fin.seekg(0, std::ios::end);
+  std::string buffer(fin.tellg(), ' ');
+  fin.seekg(0, std::ios::beg);
+  fin.read(&buffer[0], buffer.size());
+  return ProgramDesc(buffer);
+}
+
+// Returns the average cost of fn in milliseconds.
+template <typename Fn>
+double Measure(Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kRepeat; ++i) {
+    fn();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() /
+         kRepeat;
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  if (argc < 2) {
+    LOG(ERROR) << "Usage: " << argv[0] << " <program file>";
+    return 1;
+  }
+  ProgramDesc program_desc = LoadFromFile(argv[1]);
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::PaddleDialect>();
+  ctx->GetOrRegisterDialect<ir::BuiltinDialect>();
+
+  double uncached_cost = Measure([&] {
+    TranslationCache::instance().Clear();
+    paddle::TranslateLegacyProgramToProgram(program_desc);
+  });
+  // Warm the cache up before measuring the cached translation.
+  paddle::TranslateLegacyProgramToProgram(program_desc);
+  double cached_cost = Measure(
+      [&] { paddle::TranslateLegacyProgramToProgram(program_desc); });
+  double hash_blocks_cost =
+      Measure([&] { TranslationCache::HashBlocks(program_desc); });
+  size_t num_ops = 0;
+  double hash_ops_cost = Measure([&] {
+    num_ops = 0;
+    for (size_t i = 0; i < program_desc.Size(); ++i) {
+      for (auto *op_desc : program_desc.Block(i).AllOps()) {
+        TranslationCache::HashOp(*op_desc);
+        ++num_ops;
+      }
+    }
+  });
+
+  LOG(INFO) << "Translate " << num_ops << " ops: uncached costs "
+            << uncached_cost << "ms, cached costs " << cached_cost
+            << "ms, HashBlocks costs " << hash_blocks_cost
+            << "ms, HashOp over all ops costs " << hash_ops_cost << "ms.";
+  return 0;
+}
@@ -0,0 +1,115 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <map>
+
+#include "paddle/ir/core/ir_context.h"
+#include "paddle/ir/core/program.h"
+#include "paddle/ir/pass/pass.h"
+#include "paddle/ir/pass/pass_instrumentation.h"
+#include "paddle/ir/pass/pass_manager.h"
+
+// Depends on the operations only.
+struct OperationsAnalysis {
+  static constexpr uint32_t kDependentIrFeatures = ir::IrFeatures::kOperations;
+  explicit OperationsAnalysis(ir::Operation *op) { ++num_constructed; }
+  static int num_constructed;
+};
+int OperationsAnalysis::num_constructed = 0;
+
+// Depends on all features of the IR.
+struct FullAnalysis {
+  explicit FullAnalysis(ir::Operation *op) { ++num_constructed; }
+  static int num_constructed;
+};
+int FullAnalysis::num_constructed = 0;
+
+class LambdaPass : public ir::Pass {
+ public:
+  LambdaPass(const std::string &name, std::function<void(LambdaPass *)> func)
+      : ir::Pass(name, 0), func_(func) {}
+
+  void Run(ir::Operation *op) override {
+    analysis_manager().GetAnalysis<OperationsAnalysis>();
+    analysis_manager().GetAnalysis<FullAnalysis>();
+    func_(this);
+  }
+
+  using ir::Pass::MarkAllAnalysesPreserved;
+  using ir::Pass::MarkAnalysesPreserved;
+  using ir::Pass::MarkChangedIrFeatures;
+
+ private:
+  std::function<void(LambdaPass *)> func_;
+};
+
+class AnalysisCounter : public ir::PassInstrumentation {
+ public:
+  explicit AnalysisCounter(std::map<std::string, int> *hits,
+                           std::map<std::string, int> *misses)
+      : hits_(hits), misses_(misses) {}
+
+  void RunBeforeAnalysis(const std::string &name,
+                         ir::TypeId id,
+                         ir::Operation *op) override {
+    ++(*misses_)[name];
+  }
+
+  void RunAfterAnalysisCacheHit(const std::string &name,
+                                ir::TypeId id,
+                                ir::Operation *op) override {
+    ++(*hits_)[name];
+  }
+
+ private:
+  std::map<std::string, int> *hits_;
+  std::map<std::string, int> *misses_;
+};
+
+TEST(analysis_manager_test, invalidate_by_ir_features) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ir::Program program(ctx);
+  std::map<std::string, int> hits, misses;
+
+  ir::PassManager pm(ctx);
+  // 1. Only attributes are changed, OperationsAnalysis survives.
+  pm.AddPass(std::make_unique<LambdaPass>("p1", [](LambdaPass *pass) {
+    pass->MarkChangedIrFeatures(ir::IrFeatures::kAttributes);
+  }));
+  // 2. Nothing is changed.
+  pm.AddPass(std::make_unique<LambdaPass>(
+      "p2", [](LambdaPass *pass) { pass->MarkAllAnalysesPreserved(); }));
+  // 3. FullAnalysis is explicitly preserved, OperationsAnalysis isn't.
+  pm.AddPass(std::make_unique<LambdaPass>("p3", [](LambdaPass *pass) {
+    pass->MarkAnalysesPreserved<FullAnalysis>();
+  }));
+  // 4. Everything may have changed.
+  pm.AddPass(std::make_unique<LambdaPass>("p4", [](LambdaPass *pass) {}));
+  pm.AddPass(std::make_unique<LambdaPass>("p5", [](LambdaPass *pass) {}));
+  pm.AddInstrumentation(std::make_unique<AnalysisCounter>(&hits, &misses));
+  pm.EnablePassTiming();
+
+  EXPECT_TRUE(pm.Run(&program));
+  // p1 computes both, p2 reuses OperationsAnalysis, p3 reuses both, p4
+  // reuses FullAnalysis, p5 computes both.
+  EXPECT_EQ(OperationsAnalysis::num_constructed, 3);
+  EXPECT_EQ(FullAnalysis::num_constructed, 3);
+  EXPECT_EQ(misses["OperationsAnalysis"], 3);
+  EXPECT_EQ(hits["OperationsAnalysis"], 2);
+  EXPECT_EQ(misses["FullAnalysis"], 3);
+  EXPECT_EQ(hits["FullAnalysis"], 2);
+}
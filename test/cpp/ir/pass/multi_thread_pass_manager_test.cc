@@ -0,0 +1,212 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "paddle/ir/core/builtin_op.h"
+#include "paddle/ir/core/dialect.h"
+#include "paddle/ir/core/ir_context.h"
+#include "paddle/ir/core/op_base.h"
+#include "paddle/ir/core/program.h"
+#include "paddle/ir/pass/pass.h"
+#include "paddle/ir/pass/pass_manager.h"
+
+// A function like op, whose body is isolated from the enclosing region.
+class FuncOp : public ir::Op<FuncOp, ir::IsolatedFromAboveTrait> {
+ public:
+  using Op::Op;
+  static const char *name() { return "test.func"; }
+  static constexpr uint32_t attributes_num = 0;
+  static constexpr const char **attributes_name = nullptr;
+  static void Verify(const std::vector<ir::OpResult> &inputs,
+                     const std::vector<ir::Type> &outputs,
+                     const ir::AttributeMap &attributes) {}
+};
+
+class NopOp : public ir::Op<NopOp> {
+ public:
+  using Op::Op;
+  static const char *name() { return "test.nop"; }
+  static constexpr uint32_t attributes_num = 0;
+  static constexpr const char **attributes_name = nullptr;
+  static void Verify(const std::vector<ir::OpResult> &inputs,
+                     const std::vector<ir::Type> &outputs,
+                     const ir::AttributeMap &attributes) {}
+};
+
+class TestDialect : public ir::Dialect {
+ public:
+  explicit TestDialect(ir::IrContext *context)
+      : ir::Dialect(name(), context, ir::TypeId::get<TestDialect>()) {
+    RegisterOps<FuncOp, NopOp>();
+  }
+  static const char *name() { return "test"; }
+};
+
+// Counts the operations in the body of a function or a module.
+struct OpCountAnalysis {
+  explicit OpCountAnalysis(ir::Operation *op)
+      : num_ops(op->GetRegion(0).front()->size()) {}
+  size_t num_ops;
+};
+
+class CountOpsPass : public ir::Pass {
+ public:
+  CountOpsPass() : ir::Pass("CountOpsPass", 0) {}
+
+  void Run(ir::Operation *op) override {
+    size_t active = ++num_active;
+    size_t max = max_active.load();
+    while (active > max && !max_active.compare_exchange_weak(max, active)) {
+    }
+    // Simulate a pass with some workload.
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    auto &analysis = analysis_manager().GetAnalysis<OpCountAnalysis>();
+    num_ops += analysis.num_ops;
+    if (analysis.num_ops == fail_on_num_ops) SignalPassFailure();
+    --num_active;
+  }
+
+  // Counts the nested functions or modules named root_name.
+  bool CanApplyOn(ir::Operation *op) const override {
+    return op->name() == root_name && op->GetParentOp() != nullptr;
+  }
+
+  static std::string root_name;
+  static std::atomic<size_t> num_ops;
+  static std::atomic<size_t> num_active;
+  static std::atomic<size_t> max_active;
+  static size_t fail_on_num_ops;
+};
+
+std::string CountOpsPass::root_name = FuncOp::name();  // NOLINT
+std::atomic<size_t> CountOpsPass::num_ops{0};
+std::atomic<size_t> CountOpsPass::num_active{0};
+std::atomic<size_t> CountOpsPass::max_active{0};
+size_t CountOpsPass::fail_on_num_ops = 0;
+
+// Build num_funcs functions, the i-th one holds i + 1 nop ops.
+void BuildFuncs(ir::IrContext *ctx, ir::Program *program, size_t num_funcs) {
+  ir::OpInfo func_info = ctx->GetRegisteredOpInfo(FuncOp::name());
+  ir::OpInfo nop_info = ctx->GetRegisteredOpInfo(NopOp::name());
+  for (size_t i = 0; i < num_funcs; ++i) {
+    ir::Operation *func = ir::Operation::Create(
+        {}, {}, {}, func_info, 1, program->arena());
+    program->block()->push_back(func);
+    func->GetRegion(0).emplace_back();
+    ir::Block *body = func->GetRegion(0).front();
+    for (size_t j = 0; j <= i; ++j) {
+      body->push_back(
+          ir::Operation::Create({}, {}, {}, nop_info, 0, program->arena()));
+    }
+  }
+}
+
+// Build num_modules modules nested in the program, the i-th one holds i + 1
+// nop ops.
+void BuildModules(ir::IrContext *ctx,
+                  ir::Program *program,
+                  size_t num_modules) {
+  ir::OpInfo nop_info = ctx->GetRegisteredOpInfo(NopOp::name());
+  for (size_t i = 0; i < num_modules; ++i) {
+    ir::ModuleOp module = ir::ModuleOp::Create(ctx, nullptr);
+    program->block()->push_back(module.operation());
+    for (size_t j = 0; j <= i; ++j) {
+      module.block()->push_back(ir::Operation::Create({}, {}, {}, nop_info));
+    }
+  }
+}
+
+double RunCountOpsPass(ir::IrContext *ctx,
+                       ir::Program *program,
+                       size_t num_threads,
+                       bool *success) {
+  CountOpsPass::num_ops = 0;
+  CountOpsPass::max_active = 0;
+  ir::PassManager pm(ctx);
+  pm.AddPass(std::make_unique<CountOpsPass>());
+  pm.EnableMultiThreading(num_threads);
+  auto start = std::chrono::steady_clock::now();
+  *success = pm.Run(program);
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+TEST(multi_thread_pass_manager_test, run_on_isolated_ops) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<TestDialect>();
+  ir::Program program(ctx);
+  const size_t num_funcs = 64;
+  BuildFuncs(ctx, &program, num_funcs);
+  const size_t expected_num_ops = num_funcs * (num_funcs + 1) / 2;
+
+  bool success = false;
+  double serial_cost = RunCountOpsPass(ctx, &program, 1, &success);
+  EXPECT_TRUE(success);
+  EXPECT_EQ(CountOpsPass::num_ops, expected_num_ops);
+  EXPECT_EQ(CountOpsPass::max_active, 1u);
+
+  double parallel_cost = RunCountOpsPass(ctx, &program, 4, &success);
+  EXPECT_TRUE(success);
+  EXPECT_EQ(CountOpsPass::num_ops, expected_num_ops);
+  EXPECT_GT(CountOpsPass::max_active, 1u);
+  EXPECT_LE(CountOpsPass::max_active, 4u);
+
+  LOG(INFO) << "Run pass on " << num_funcs << " functions, 1 thread costs "
+            << serial_cost << "ms, 4 threads cost " << parallel_cost << "ms.";
+
+  // The failure of a pass on any function fails the pipeline.
+  CountOpsPass::fail_on_num_ops = num_funcs / 2;
+  RunCountOpsPass(ctx, &program, 4, &success);
+  EXPECT_FALSE(success);
+  CountOpsPass::fail_on_num_ops = 0;
+}
+
+TEST(multi_thread_pass_manager_test, run_on_ops_in_arena) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<TestDialect>();
+  ir::Program program(ctx, /*use_arena=*/true);
+  const size_t num_funcs = 16;
+  BuildFuncs(ctx, &program, num_funcs);
+
+  // The functions share the arena of the program, so they are run one by one.
+  bool success = false;
+  RunCountOpsPass(ctx, &program, 4, &success);
+  EXPECT_TRUE(success);
+  EXPECT_EQ(CountOpsPass::num_ops, num_funcs * (num_funcs + 1) / 2);
+  EXPECT_EQ(CountOpsPass::max_active, 1u);
+}
+
+TEST(multi_thread_pass_manager_test, run_on_nested_modules) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<TestDialect>();
+  EXPECT_TRUE(ctx->GetRegisteredOpInfo(ir::ModuleOp::name())
+                  .HasTrait<ir::IsolatedFromAboveTrait>());
+  ir::Program program(ctx);
+  const size_t num_modules = 16;
+  BuildModules(ctx, &program, num_modules);
+
+  CountOpsPass::root_name = ir::ModuleOp::name();
+  bool success = false;
+  RunCountOpsPass(ctx, &program, 4, &success);
+  EXPECT_TRUE(success);
+  EXPECT_EQ(CountOpsPass::num_ops, num_modules * (num_modules + 1) / 2);
+  EXPECT_GT(CountOpsPass::max_active, 1u);
+  CountOpsPass::root_name = FuncOp::name();
+}
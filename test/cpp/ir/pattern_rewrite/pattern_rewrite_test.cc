@@ -14,10 +14,19 @@
 
 #include <gtest/gtest.h>
 
+#include <thread>  // NOLINT
+#include <vector>
+
+
+#include "paddle/ir/core/builder.h"
 #include "paddle/ir/core/builtin_attribute.h"
 #include "paddle/ir/core/builtin_dialect.h"
+#include "paddle/ir/core/builtin_type.h"
 #include "paddle/ir/core/dialect.h"
 #include "paddle/ir/core/ir_context.h"
+#include "paddle/ir/core/program.h"
+#include "paddle/ir/pattern_rewrite/frozen_rewrite_pattern_set.h"
+#include "paddle/ir/pattern_rewrite/greedy_pattern_rewrite_driver.h"
 #include "paddle/ir/pattern_rewrite/pattern_match.h"
 
 TEST(PatternBenefit, PatternBenefit) {
@@ -59,6 +68,34 @@ class Operation1 : public ir::Op<Operation1> {
 const char *Operation1::attributes_name[attributes_num] = {"op2_attr1",
                                                            "op2_attr2"};
 
+// Define op2, op2 transposes the input, two consecutive op2 cancel each other.
+class TransposeOp : public ir::Op<TransposeOp> {
+ public:
+  using Op::Op;
+  static const char *name() { return "test.transpose"; }
+  static constexpr uint32_t attributes_num = 0;
+  static constexpr const char **attributes_name = nullptr;
+  static void Verify(const std::vector<ir::OpResult> &inputs,
+                     const std::vector<ir::Type> &outputs,
+                     const ir::AttributeMap &attributes) {
+    if (inputs.size() != 1 || outputs.size() != 1) {
+      throw("TransposeOp should have one input and one output.");
+    }
+  }
+};
+
+// Define op3, op3 produces or consumes values without any side effect.
+class DataOp : public ir::Op<DataOp> {
+ public:
+  using Op::Op;
+  static const char *name() { return "test.data"; }
+  static constexpr uint32_t attributes_num = 0;
+  static constexpr const char **attributes_name = nullptr;
+  static void Verify(const std::vector<ir::OpResult> &inputs,
+                     const std::vector<ir::Type> &outputs,
+                     const ir::AttributeMap &attributes) {}
+};
+
 // Define a dialect, op1 and op2 will be registered by this dialect.
 class TestDialect : public ir::Dialect {
  public:
@@ -69,7 +106,7 @@ class TestDialect : public ir::Dialect {
   static const char *name() { return "test"; }
 
  private:
-  void initialize() { RegisterOps<Operation1>(); }
+  void initialize() { RegisterOps<Operation1, TransposeOp, DataOp>(); }
 };
 
 // TODO(wilber): Add logical when ir support erase, replace or update.
@@ -113,3 +150,213 @@ TEST(RewritePattern, OpRewritePattern) {
   EXPECT_EQ(ps.native_patterns()[0]->benefit(), 2U);
   EXPECT_EQ(ps.native_patterns()[1]->benefit(), 2U);
 }
+
+// transpose(transpose(x)) -> x
+class RedundantTransposePattern : public ir::OpRewritePattern<TransposeOp> {
+ public:
+  using ir::OpRewritePattern<TransposeOp>::OpRewritePattern;
+  bool MatchAndRewrite(
+      TransposeOp op,
+      ir::PatternRewriter &rewriter) const override {  // NOLINT
+    ir::Operation *prev_op = op->GetOperandByIndex(0).source().GetDefiningOp();
+    if (prev_op == nullptr || !prev_op->dyn_cast<TransposeOp>()) {
+      return false;
+    }
+    rewriter.ReplaceOp(op, {prev_op->GetOperandByIndex(0).source()});
+    if (prev_op->use_empty()) {
+      rewriter.EraseOp(prev_op);
+    }
+    return true;
+  }
+};
+
+TEST(GreedyPatternRewriteDriver, RemoveRedundantTranspose) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<ir::BuiltinDialect>();
+  ctx->GetOrRegisterDialect<TestDialect>();
+
+  ir::Program program(ctx);
+  ir::Builder builder(ctx, program.block());
+  ir::Type fp32_dtype = ir::Float32Type::get(ctx);
+  ir::OpInfo data_info = ctx->GetRegisteredOpInfo(DataOp::name());
+  ir::OpInfo transpose_info = ctx->GetRegisteredOpInfo(TransposeOp::name());
+
+  // data -> transpose x 5 -> data
+  ir::Operation *source = builder.Build({}, {}, {fp32_dtype}, data_info);
+  ir::OpResult value = source->GetResultByIndex(0);
+  for (size_t i = 0; i < 5; ++i) {
+    value = builder.Build({value}, {}, {fp32_dtype}, transpose_info)
+                ->GetResultByIndex(0);
+  }
+  ir::Operation *sink = builder.Build({value}, {}, {}, data_info);
+  EXPECT_EQ(program.block()->size(), 7u);
+
+  ir::RewritePatternSet ps(ctx);
+  ps.Add<RedundantTransposePattern>(ctx);
+  ir::FrozenRewritePatternSet frozen_ps(std::move(ps));
+  EXPECT_TRUE(ir::ApplyPatternsGreedily(&program, frozen_ps));
+
+  // Only one transpose is left.
+  EXPECT_EQ(program.block()->size(), 3u);
+  ir::Operation *transpose =
+      sink->GetOperandByIndex(0).source().GetDefiningOp();
+  EXPECT_EQ(transpose->name(), TransposeOp::name());
+  EXPECT_EQ(transpose->GetOperandByIndex(0).source().GetDefiningOp(), source);
+
+  // Nothing to rewrite, converge in the first iteration.
+  ir::GreedyRewriteConfig config;
+  config.max_iterations = 1;
+  EXPECT_TRUE(ir::ApplyPatternsGreedily(&program, frozen_ps, config));
+  EXPECT_EQ(program.block()->size(), 3u);
+}
+
+class TestAnyOpPattern : public ir::RewritePattern {
+ public:
+  TestAnyOpPattern(ir::IrContext *context, ir::PatternBenefit benefit)
+      : ir::RewritePattern(MatchAnyOpTypeTag(), benefit, context) {}
+  bool MatchAndRewrite(
+      ir::Operation *op,
+      ir::PatternRewriter &rewriter) const override {  // NOLINT
+    return false;
+  }
+};
+
+TEST(FrozenRewritePatternSet, DispatchByRoot) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<ir::BuiltinDialect>();
+  ctx->GetOrRegisterDialect<TestDialect>();
+
+  ir::RewritePatternSet ps(ctx);
+  ps.Add<RedundantTransposePattern>(ctx, 1);
+  ps.Add<RedundantTransposePattern>(ctx, 3);
+  ps.Add<TestPatternRewrite>(ctx, 2);
+  ps.Add<TestAnyOpPattern>(ctx, 1);
+  ps.Add<TestAnyOpPattern>(ctx, 4);
+  ir::FrozenRewritePatternSet frozen_ps(std::move(ps));
+  EXPECT_EQ(frozen_ps.size(), 5u);
+
+  const auto &transpose_patterns = frozen_ps.GetOpSpecificNativePatterns(
+      ctx->GetRegisteredOpInfo(TransposeOp::name()));
+  EXPECT_EQ(transpose_patterns.size(), 2u);
+  EXPECT_EQ(transpose_patterns[0]->benefit(), 3u);
+  EXPECT_EQ(transpose_patterns[1]->benefit(), 1u);
+
+  EXPECT_EQ(frozen_ps
+                .GetOpSpecificNativePatterns(
+                    ctx->GetRegisteredOpInfo(Operation1::name()))
+                .size(),
+            1u);
+  EXPECT_TRUE(frozen_ps
+                  .GetOpSpecificNativePatterns(
+                      ctx->GetRegisteredOpInfo(DataOp::name()))
+                  .empty());
+
+  const auto &any_op_patterns = frozen_ps.match_any_op_native_patterns();
+  EXPECT_EQ(any_op_patterns.size(), 2u);
+  EXPECT_EQ(any_op_patterns[0]->benefit(), 4u);
+
+  // Copies share the same frozen patterns.
+  ir::FrozenRewritePatternSet copied_ps = frozen_ps;
+  EXPECT_EQ(copied_ps.native_patterns().data(),
+            frozen_ps.native_patterns().data());
+}
+
+// Define an op with a trait in a dialect which is only registered after the
+// patterns are frozen.
+class LateOp : public ir::Op<LateOp, ir::SideEffectTrait> {
+ public:
+  using Op::Op;
+  static const char *name() { return "test_late.late_op"; }
+  static constexpr uint32_t attributes_num = 0;
+  static constexpr const char **attributes_name = nullptr;
+  static void Verify(const std::vector<ir::OpResult> &inputs,
+                     const std::vector<ir::Type> &outputs,
+                     const ir::AttributeMap &attributes) {}
+};
+
+class TestLateDialect : public ir::Dialect {
+ public:
+  explicit TestLateDialect(ir::IrContext *context)
+      : ir::Dialect(name(), context, ir::TypeId::get<TestLateDialect>()) {
+    initialize();
+  }
+  static const char *name() { return "test_late"; }
+
+ private:
+  void initialize() { RegisterOps<LateOp>(); }
+};
+
+class TestLateOpPattern : public ir::OpRewritePattern<LateOp> {
+ public:
+  using ir::OpRewritePattern<LateOp>::OpRewritePattern;
+  bool MatchAndRewrite(
+      LateOp op,
+      ir::PatternRewriter &rewriter) const override {  // NOLINT
+    return false;
+  }
+};
+
+class TestSideEffectTraitPattern : public ir::RewritePattern {
+ public:
+  TestSideEffectTraitPattern(ir::IrContext *context,
+                             ir::PatternBenefit benefit)
+      : ir::RewritePattern(MatchTraitOpTypeTag(),
+                           ir::TypeId::get<ir::SideEffectTrait>(),
+                           benefit,
+                           context) {}
+  bool MatchAndRewrite(
+      ir::Operation *op,
+      ir::PatternRewriter &rewriter) const override {  // NOLINT
+    return false;
+  }
+};
+
+TEST(FrozenRewritePatternSet, DispatchLateRegisteredOp) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<ir::BuiltinDialect>();
+  EXPECT_FALSE(ctx->GetRegisteredOpInfo(LateOp::name()));
+
+  ir::RewritePatternSet ps(ctx);
+  ps.Add<TestLateOpPattern>(ctx, 1);
+  ps.Add<TestSideEffectTraitPattern>(ctx, 2);
+  ir::FrozenRewritePatternSet frozen_ps(std::move(ps));
+  ir::RewritePatternSet shared_ps(ctx);
+  shared_ps.Add<TestLateOpPattern>(ctx, 1);
+  ir::FrozenRewritePatternSet shared_frozen_ps(std::move(shared_ps));
+
+  // The patterns apply to the op registered after the set is frozen.
+  ctx->GetOrRegisterDialect<TestLateDialect>();
+  ir::OpInfo late_info = ctx->GetRegisteredOpInfo(LateOp::name());
+  ASSERT_TRUE(late_info);
+  EXPECT_EQ(frozen_ps.op_specific_native_patterns().count(late_info), 0u);
+  const auto &late_patterns = frozen_ps.GetOpSpecificNativePatterns(late_info);
+  ASSERT_EQ(late_patterns.size(), 2u);
+  EXPECT_EQ(late_patterns[0]->benefit(), 2u);
+  EXPECT_EQ(late_patterns[1]->benefit(), 1u);
+  EXPECT_EQ(&frozen_ps.GetOpSpecificNativePatterns(late_info), &late_patterns);
+
+  // The threads looking the late op up get the same cached patterns.
+  std::vector<const ir::FrozenRewritePatternSet::PatternListT *> lookups(4);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < lookups.size(); ++i) {
+    threads.emplace_back([&, i]() {
+      for (int j = 0; j < 1000; ++j) {
+        lookups[i] = &shared_frozen_ps.GetOpSpecificNativePatterns(late_info);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(lookups[0]->size(), 1u);
+  for (auto *lookup : lookups) {
+    EXPECT_EQ(lookup, lookups[0]);
+  }
+
+  // The trait pattern also applies to the builtin ops with the trait.
+  EXPECT_EQ(frozen_ps
+                .GetOpSpecificNativePatterns(
+                    ctx->GetRegisteredOpInfo(ir::SetParameterOp::name()))
+                .size(),
+            1u);
+}
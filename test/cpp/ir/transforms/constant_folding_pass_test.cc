@@ -0,0 +1,191 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/ir/dialect/pd_dialect.h"
+#include "paddle/fluid/ir/dialect/pd_op.h"
+#include "paddle/fluid/ir/dialect/pd_type.h"
+#include "paddle/fluid/ir/transforms/constant_folding_pass.h"
+#include "paddle/ir/core/builder.h"
+#include "paddle/ir/core/builtin_attribute.h"
+#include "paddle/ir/core/builtin_op.h"
+#include "paddle/ir/core/builtin_type.h"
+#include "paddle/ir/core/ir_context.h"
+#include "paddle/ir/core/parameter.h"
+#include "paddle/ir/core/program.h"
+#include "paddle/ir/pass/pass.h"
+#include "paddle/ir/pass/pass_manager.h"
+#include "paddle/phi/core/kernel_registry.h"
+
+PD_DECLARE_KERNEL(full, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(add, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(multiply, CPU, ALL_LAYOUT);
+
+namespace {
+ir::Type Float32TensorType(ir::IrContext *ctx) {
+  return paddle::dialect::DenseTensorType::get(ctx,
+                                               ir::Float32Type::get(ctx),
+                                               phi::make_ddim({2, 2}),
+                                               phi::DataLayout::NCHW,
+                                               phi::LoD(),
+                                               0);
+}
+
+ir::OpResult BuildGetParameter(ir::Builder *builder,
+                               const std::string &name) {
+  ir::IrContext *ctx = builder->context();
+  return builder
+      ->Build({},
+              {{"parameter_name", ir::StrAttribute::get(ctx, name)}},
+              {Float32TensorType(ctx)},
+              ctx->GetRegisteredOpInfo(ir::GetParameterOp::name()))
+      ->GetResultByIndex(0);
+}
+
+void SetParameter(ir::Program *program,
+                  const std::string &name,
+                  std::vector<float> data) {
+  ir::IrContext *ctx = program->module_op().ir_context();
+  program->SetParameter(
+      name,
+      std::make_unique<ir::Parameter>(
+          data.data(), data.size() * sizeof(float), Float32TensorType(ctx)));
+}
+
+size_t CountOps(ir::Program *program, const std::string &name) {
+  size_t count = 0;
+  for (auto *op : *program->block()) {
+    if (op->name() == name) ++count;
+  }
+  return count;
+}
+
+bool RunConstantFolding(ir::Program *program,
+                        paddle::framework::Scope *scope = nullptr) {
+  ir::PassManager pm(program->module_op().ir_context());
+  pm.AddPass(ir::CreateConstantFoldingPass(scope));
+  return pm.Run(program);
+}
+}  // namespace
+
+TEST(constant_folding_pass_test, fold_constants_and_parameters) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::PaddleDialect>();
+  ir::Program program(ctx);
+  ir::Builder builder(ctx, program.block());
+
+  // out = (full(1) + full(2)) * w + uniform, only the uniform isn't constant.
+  SetParameter(&program, "w", {1.0f, 2.0f, 3.0f, 4.0f});
+  auto x = builder.Build<paddle::dialect::FullOp>(std::vector<int64_t>{2, 2},
+                                                  1.0f);
+  auto y = builder.Build<paddle::dialect::FullOp>(std::vector<int64_t>{2, 2},
+                                                  2.0f);
+  auto add = builder.Build<paddle::dialect::AddOp>(x->GetResultByIndex(0),
+                                                   y->GetResultByIndex(0));
+  auto mul = builder.Build<paddle::dialect::MultiplyOp>(
+      add->GetResultByIndex(0), BuildGetParameter(&builder, "w"));
+  auto uniform = builder.Build<paddle::dialect::UniformOp>(
+      std::vector<int64_t>{2, 2}, phi::DataType::FLOAT32, 0.0, 1.0, 2,
+      phi::CPUPlace());
+  auto out = builder.Build<paddle::dialect::AddOp>(
+      mul->GetResultByIndex(0), uniform->GetResultByIndex(0));
+  size_t num_params = program.parameters().size();
+
+  EXPECT_TRUE(RunConstantFolding(&program));
+  // Only the min and max attributes of uniform are left.
+  EXPECT_EQ(CountOps(&program, paddle::dialect::FullOp::name()), 2u);
+  EXPECT_EQ(CountOps(&program, paddle::dialect::MultiplyOp::name()), 0u);
+  EXPECT_EQ(CountOps(&program, paddle::dialect::AddOp::name()), 1u);
+  // The parameter read by the folded operations only is dropped.
+  EXPECT_EQ(CountOps(&program, ir::GetParameterOp::name()), 1u);
+  ASSERT_EQ(program.parameters().size(), num_params + 1);
+
+  ir::Operation *folded = out->GetOperandByIndex(0).source().GetDefiningOp();
+  ASSERT_EQ(folded->name(), ir::GetParameterOp::name());
+  std::string name = folded->attributes()
+                         .at("parameter_name")
+                         .dyn_cast<ir::StrAttribute>()
+                         .data();
+  ir::Parameter *parameter = program.GetParameter(name);
+  ASSERT_NE(parameter, nullptr);
+  ASSERT_EQ(parameter->size(), 4 * sizeof(float));
+  auto *data = static_cast<float *>(parameter->data());
+  EXPECT_EQ(data[0], 3.0f);
+  EXPECT_EQ(data[3], 12.0f);
+}
+
+TEST(constant_folding_pass_test, keep_written_parameters) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::PaddleDialect>();
+  ir::Program program(ctx);
+  ir::Builder builder(ctx, program.block());
+
+  // v is updated by the program, the parameter without data is read from
+  // the scope.
+  SetParameter(&program, "v", {1.0f, 1.0f, 1.0f, 1.0f});
+  program.SetParameter("u", nullptr);
+  paddle::framework::Scope scope;
+  auto *u = scope.Var("u")->GetMutable<phi::DenseTensor>();
+  u->Resize(phi::make_ddim({2, 2}));
+  float *u_data = u->mutable_data<float>(phi::CPUPlace());
+  for (int i = 0; i < 4; ++i) u_data[i] = 2.0f;
+
+  ir::OpResult v = BuildGetParameter(&builder, "v");
+  auto v_add = builder.Build<paddle::dialect::AddOp>(v, v);
+  builder.Build({v_add->GetResultByIndex(0)},
+                {{"parameter_name", ir::StrAttribute::get(ctx, "v")}},
+                {},
+                ctx->GetRegisteredOpInfo(ir::SetParameterOp::name()));
+  ir::OpResult u_value = BuildGetParameter(&builder, "u");
+  auto u_add = builder.Build<paddle::dialect::AddOp>(u_value, u_value);
+  auto out = builder.Build<paddle::dialect::AddOp>(v_add->GetResultByIndex(0),
+                                                   u_add->GetResultByIndex(0));
+
+  EXPECT_TRUE(RunConstantFolding(&program, &scope));
+  EXPECT_EQ(CountOps(&program, paddle::dialect::AddOp::name()), 2u);
+  ir::Operation *folded = out->GetOperandByIndex(1).source().GetDefiningOp();
+  ASSERT_EQ(folded->name(), ir::GetParameterOp::name());
+  std::string name = folded->attributes()
+                         .at("parameter_name")
+                         .dyn_cast<ir::StrAttribute>()
+                         .data();
+  // The folded result is also stored in the scope.
+  auto *var = scope.FindVar(name);
+  ASSERT_NE(var, nullptr);
+  EXPECT_EQ(var->Get<phi::DenseTensor>().data<float>()[0], 4.0f);
+  EXPECT_EQ(static_cast<float *>(program.GetParameter(name)->data())[1], 4.0f);
+}
+
+TEST(constant_folding_pass_test, keep_inplace_written_parameters) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::PaddleDialect>();
+  ir::Program program(ctx);
+  ir::Builder builder(ctx, program.block());
+
+  // w is written by relu_, so the add reading it through another
+  // get_parameter op isn't folded.
+  SetParameter(&program, "w", {-1.0f, 1.0f, -1.0f, 1.0f});
+  builder.Build<paddle::dialect::Relu_Op>(BuildGetParameter(&builder, "w"));
+  ir::OpResult w = BuildGetParameter(&builder, "w");
+  builder.Build<paddle::dialect::AddOp>(w, w);
+  size_t num_params = program.parameters().size();
+
+  EXPECT_TRUE(RunConstantFolding(&program));
+  EXPECT_EQ(CountOps(&program, paddle::dialect::Relu_Op::name()), 1u);
+  EXPECT_EQ(CountOps(&program, paddle::dialect::AddOp::name()), 1u);
+  EXPECT_EQ(CountOps(&program, ir::GetParameterOp::name()), 2u);
+  EXPECT_EQ(program.parameters().size(), num_params);
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "paddle/fluid/ir/dialect/pd_dialect.h"
+#include "paddle/fluid/ir/dialect/pd_op.h"
+#include "paddle/ir/core/builder.h"
+#include "paddle/ir/core/ir_context.h"
+#include "paddle/ir/core/op_base.h"
+#include "paddle/ir/core/program.h"
+#include "paddle/ir/pass/pass.h"
+#include "paddle/ir/pass/pass_manager.h"
+#include "paddle/ir/transforms/common_subexpression_elimination_pass.h"
+
+namespace {
+size_t CountOps(ir::Program *program, const std::string &name) {
+  size_t count = 0;
+  for (auto *op : *program->block()) {
+    if (op->name() == name) ++count;
+  }
+  return count;
+}
+}  // namespace
+
+TEST(pd_op_side_effect_test, random_ops_have_side_effect) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::PaddleDialect>();
+  // The random ops whose names don't tell they are random.
+  for (const char *name : {paddle::dialect::GumbelSoftmaxOp::name(),
+                           paddle::dialect::ClassCenterSampleOp::name(),
+                           paddle::dialect::RreluOp::name(),
+                           paddle::dialect::RnnOp::name(),
+                           paddle::dialect::UniformOp::name()}) {
+    ir::OpInfo op_info = ctx->GetRegisteredOpInfo(name);
+    ASSERT_TRUE(op_info) << name;
+    EXPECT_TRUE(op_info.HasTrait<ir::SideEffectTrait>()) << name;
+  }
+  ir::OpInfo relu_info =
+      ctx->GetRegisteredOpInfo(paddle::dialect::ReluOp::name());
+  EXPECT_FALSE(relu_info.HasTrait<ir::SideEffectTrait>());
+}
+
+TEST(pd_op_side_effect_test, cse_keeps_random_ops) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::PaddleDialect>();
+  ir::Program program(ctx);
+  ir::Builder builder(ctx, program.block());
+
+  auto x = builder.Build<paddle::dialect::FullOp>(std::vector<int64_t>{2, 2},
+                                                  1.0f);
+  for (int i = 0; i < 2; ++i) {
+    builder.Build<paddle::dialect::UniformOp>(std::vector<int64_t>{2, 2},
+                                              phi::DataType::FLOAT32,
+                                              0.0,
+                                              1.0,
+                                              0,
+                                              phi::CPUPlace());
+    builder.Build<paddle::dialect::GumbelSoftmaxOp>(x->GetResultByIndex(0));
+    builder.Build<paddle::dialect::ReluOp>(x->GetResultByIndex(0));
+  }
+
+  ir::PassManager pm(ctx);
+  pm.AddPass(ir::CreateCommonSubexpressionEliminationPass());
+  EXPECT_TRUE(pm.Run(&program));
+  // The identical random ops are not merged, the identical relus are.
+  EXPECT_EQ(CountOps(&program, paddle::dialect::UniformOp::name()), 2u);
+  EXPECT_EQ(CountOps(&program, paddle::dialect::GumbelSoftmaxOp::name()), 2u);
+  EXPECT_EQ(CountOps(&program, paddle::dialect::ReluOp::name()), 1u);
+}
@@ -0,0 +1,223 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "paddle/ir/core/builder.h"
+#include "paddle/ir/core/builtin_attribute.h"
+#include "paddle/ir/core/builtin_op.h"
+#include "paddle/ir/core/builtin_type.h"
+#include "paddle/ir/core/dialect.h"
+#include "paddle/ir/core/ir_context.h"
+#include "paddle/ir/core/op_base.h"
+#include "paddle/ir/core/program.h"
+#include "paddle/ir/pass/pass.h"
+#include "paddle/ir/pass/pass_manager.h"
+#include "paddle/ir/transforms/canonicalization_pass.h"
+#include "paddle/ir/transforms/common_subexpression_elimination_pass.h"
+#include "paddle/ir/transforms/dead_code_elimination_pass.h"
+
+// A random op, whose results differ from run to run.
+class RandomOp : public ir::Op<RandomOp, ir::SideEffectTrait> {
+ public:
+  using Op::Op;
+  static const char *name() { return "test.random"; }
+  static constexpr uint32_t attributes_num = 0;
+  static constexpr const char **attributes_name = nullptr;
+  static void Verify(const std::vector<ir::OpResult> &inputs,
+                     const std::vector<ir::Type> &outputs,
+                     const ir::AttributeMap &attributes) {}
+};
+
+class TestDialect : public ir::Dialect {
+ public:
+  explicit TestDialect(ir::IrContext *context)
+      : ir::Dialect(name(), context, ir::TypeId::get<TestDialect>()) {
+    RegisterOps<RandomOp>();
+  }
+  static const char *name() { return "test"; }
+};
+
+namespace {
+ir::OpResult BuildConstant(ir::Builder *builder, float value) {
+  ir::IrContext *ctx = builder->context();
+  return builder
+      ->Build<ir::ConstantOp>(ir::FloatAttribute::get(ctx, value),
+                              ir::Float32Type::get(ctx))
+      ->GetResultByIndex(0);
+}
+
+ir::OpResult BuildRandom(ir::Builder *builder) {
+  ir::IrContext *ctx = builder->context();
+  return builder
+      ->Build({},
+              {},
+              {ir::Float32Type::get(ctx)},
+              ctx->GetRegisteredOpInfo(RandomOp::name()))
+      ->GetResultByIndex(0);
+}
+
+ir::OpResult BuildCombine(ir::Builder *builder,
+                          const std::vector<ir::OpResult> &inputs) {
+  ir::IrContext *ctx = builder->context();
+  std::vector<ir::Type> types;
+  for (auto &input : inputs) types.push_back(input.type());
+  return builder
+      ->Build(inputs,
+              {},
+              {ir::VectorType::get(ctx, types)},
+              ctx->GetRegisteredOpInfo(ir::CombineOp::name()))
+      ->GetResultByIndex(0);
+}
+
+ir::OpResult BuildSlice(ir::Builder *builder, ir::OpResult input, int index) {
+  ir::IrContext *ctx = builder->context();
+  ir::Type type = input.type().dyn_cast<ir::VectorType>()[index];
+  return builder
+      ->Build({input},
+              {{"index", ir::Int32_tAttribute::get(ctx, index)}},
+              {type},
+              ctx->GetRegisteredOpInfo(ir::SliceOp::name()))
+      ->GetResultByIndex(0);
+}
+
+ir::Operation *BuildSetParameter(ir::Builder *builder,
+                                 ir::OpResult input,
+                                 const std::string &name) {
+  ir::IrContext *ctx = builder->context();
+  return builder->Build(
+      {input},
+      {{"parameter_name", ir::StrAttribute::get(ctx, name)}},
+      {},
+      ctx->GetRegisteredOpInfo(ir::SetParameterOp::name()));
+}
+
+bool RunPass(ir::Program *program, std::unique_ptr<ir::Pass> pass) {
+  ir::PassManager pm(program->module_op().ir_context());
+  pm.AddPass(std::move(pass));
+  return pm.Run(program);
+}
+}  // namespace
+
+TEST(transforms_test, dead_code_elimination) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<TestDialect>();
+  ir::Program program(ctx);
+  ir::Builder builder(ctx, program.block());
+
+  ir::OpResult c0 = BuildConstant(&builder, 1.0f);
+  ir::OpResult c1 = BuildConstant(&builder, 2.0f);
+  // A chain of unused ops.
+  BuildSlice(&builder, BuildCombine(&builder, {c0, c1}), 1);
+  // The ops with side effects are kept even if the results are unused.
+  BuildRandom(&builder);
+  BuildSetParameter(&builder, c0, "a");
+  EXPECT_EQ(program.block()->size(), 6u);
+
+  EXPECT_TRUE(RunPass(&program, ir::CreateDeadCodeEliminationPass()));
+  ASSERT_EQ(program.block()->size(), 3u);
+  auto it = program.block()->begin();
+  EXPECT_EQ((*it++)->name(), ir::ConstantOp::name());
+  EXPECT_EQ((*it++)->name(), RandomOp::name());
+  EXPECT_EQ((*it++)->name(), ir::SetParameterOp::name());
+}
+
+TEST(transforms_test, common_subexpression_elimination) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<TestDialect>();
+  ir::Program program(ctx);
+  ir::Builder builder(ctx, program.block());
+
+  ir::OpResult c0 = BuildConstant(&builder, 1.0f);
+  ir::OpResult c1 = BuildConstant(&builder, 1.0f);
+  ir::OpResult c2 = BuildConstant(&builder, 2.0f);
+  // Identical after c1 is replaced by c0.
+  BuildSetParameter(&builder, BuildCombine(&builder, {c0, c2}), "a");
+  BuildSetParameter(&builder, BuildCombine(&builder, {c1, c2}), "b");
+  // The random ops are never merged.
+  ir::OpResult r0 = BuildRandom(&builder);
+  ir::OpResult r1 = BuildRandom(&builder);
+  // c3 reads no operand, so it may observe the side effects above and is
+  // not replaced by c0.
+  ir::OpResult c3 = BuildConstant(&builder, 1.0f);
+  BuildSetParameter(&builder, BuildCombine(&builder, {r0, r1, c3}), "c");
+  EXPECT_EQ(program.block()->size(), 12u);
+
+  EXPECT_TRUE(
+      RunPass(&program, ir::CreateCommonSubexpressionEliminationPass()));
+  ASSERT_EQ(program.block()->size(), 10u);
+  auto it = program.block()->begin();
+  ir::Operation *constant = *it++;
+  ir::Operation *constant2 = *it++;
+  EXPECT_EQ(constant->name(), ir::ConstantOp::name());
+  EXPECT_EQ(constant2->name(), ir::ConstantOp::name());
+  ir::Operation *combine = *it++;
+  EXPECT_EQ(combine->name(), ir::CombineOp::name());
+  EXPECT_EQ(combine->GetOperandByIndex(0).source(),
+            constant->GetResultByIndex(0));
+  ir::Operation *set_a = *it++;
+  ir::Operation *set_b = *it++;
+  EXPECT_EQ(set_a->GetOperandByIndex(0).source(),
+            combine->GetResultByIndex(0));
+  EXPECT_EQ(set_b->GetOperandByIndex(0).source(),
+            combine->GetResultByIndex(0));
+  EXPECT_EQ((*it++)->name(), RandomOp::name());
+  EXPECT_EQ((*it++)->name(), RandomOp::name());
+  EXPECT_EQ((*it++)->name(), ir::ConstantOp::name());
+}
+
+TEST(transforms_test, canonicalization) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<TestDialect>();
+  ir::Program program(ctx);
+  ir::Builder builder(ctx, program.block());
+
+  ir::OpResult c0 = BuildConstant(&builder, 1.0f);
+  ir::OpResult r0 = BuildRandom(&builder);
+  ir::OpResult combine = BuildCombine(&builder, {c0, r0});
+  BuildSetParameter(&builder, BuildSlice(&builder, combine, 1), "a");
+  EXPECT_EQ(program.block()->size(), 5u);
+
+  // slice(combine(c0, r0), 1) is folded to r0, then the combine and c0 are
+  // dead.
+  EXPECT_TRUE(RunPass(&program, ir::CreateCanonicalizationPass()));
+  ASSERT_EQ(program.block()->size(), 2u);
+  ir::Operation *random = program.block()->front();
+  ir::Operation *set_parameter = program.block()->back();
+  EXPECT_EQ(random->name(), RandomOp::name());
+  EXPECT_EQ(set_parameter->name(), ir::SetParameterOp::name());
+  EXPECT_EQ(set_parameter->GetOperandByIndex(0).source(),
+            random->GetResultByIndex(0));
+}
+
+TEST(transforms_test, run_pipeline) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ir::Program program(ctx);
+  ir::Builder builder(ctx, program.block());
+
+  ir::OpResult c0 = BuildConstant(&builder, 1.0f);
+  ir::OpResult c1 = BuildConstant(&builder, 1.0f);
+  ir::OpResult combine = BuildCombine(&builder, {c0, c1});
+  BuildSetParameter(&builder, BuildSlice(&builder, combine, 1), "a");
+  BuildConstant(&builder, 3.0f);
+
+  ir::PassManager pm(ctx);
+  pm.AddPass(ir::CreateCanonicalizationPass());
+  pm.AddPass(ir::CreateCommonSubexpressionEliminationPass());
+  pm.AddPass(ir::CreateDeadCodeEliminationPass());
+  EXPECT_TRUE(pm.Run(&program));
+  ASSERT_EQ(program.block()->size(), 2u);
+  EXPECT_EQ(program.block()->back()->GetOperandByIndex(0).source(),
+            program.block()->front()->GetResultByIndex(0));
+}
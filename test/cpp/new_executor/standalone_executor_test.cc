@@ -16,8 +16,10 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <mutex>
 #include <string>
 
 #include "paddle/phi/core/kernel_registry.h"
@@ -75,6 +77,7 @@ PD_DECLARE_KERNEL(add_raw, KPS, ALL_LAYOUT);
 PD_DECLARE_KERNEL(add, KPS, ALL_LAYOUT);
 PD_DECLARE_KERNEL(add, CPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(multiply, KPS, ALL_LAYOUT);
+PD_DECLARE_KERNEL(multiply, CPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(multiply_grad, GPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(divide, KPS, ALL_LAYOUT);
 #ifdef PADDLE_WITH_XPU_KP
@@ -103,6 +106,10 @@ PD_DECLARE_KERNEL(cross_entropy_with_softmax_grad, GPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(sqrt, GPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(add_n, GPU, ALL_LAYOUT);
 
+DECLARE_bool(new_executor_critical_path_scheduling);
+DECLARE_bool(new_executor_replay);
+DECLARE_bool(new_executor_static_memory_plan);
+
 namespace paddle {
 namespace framework {
 
@@ -283,5 +290,240 @@ TEST(InterpreterCore, workqueue_multiplexing) {
       program, {"a", "b"}, {tensor_a, tensor_b}, {"c"}, {0.0, 1.1, 2.2, 3.3});
 }
 
+TEST(InterpreterCore, static_memory_plan) {
+  FLAGS_new_executor_static_memory_plan = true;
+
+  // c = a + b, d = c * b, e = d + a, f = e * b
+  ProgramDesc program;
+  BlockDesc* main_block = program.MutableBlock(0);
+  for (auto& name : {"a", "b", "c", "d", "e", "f"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  auto AppendOp = [main_block](const std::string& type,
+                               const std::string& x,
+                               const std::string& y,
+                               const std::string& out) {
+    OpDesc* op = main_block->AppendOp();
+    op->SetType(type);
+    op->SetInput("X", {x});
+    op->SetInput("Y", {y});
+    op->SetOutput("Out", {out});
+  };
+  AppendOp("elementwise_add", "a", "b", "c");
+  AppendOp("elementwise_mul", "c", "b", "d");
+  AppendOp("elementwise_add", "d", "a", "e");
+  AppendOp("elementwise_mul", "e", "b", "f");
+
+  const platform::CPUPlace place = platform::CPUPlace();
+  phi::DDim dims = phi::make_ddim({2, 2});
+  phi::DenseTensor tensor_a;
+  phi::DenseTensor tensor_b;
+  float data_a[] = {0, 1, 2, 3};
+  float data_b[] = {1, 2, 3, 4};
+  std::copy_n(data_a, 4, tensor_a.mutable_data<float>(dims, place));
+  std::copy_n(data_b, 4, tensor_b.mutable_data<float>(dims, place));
+
+  interpreter::ExecutionConfig execution_config;
+  execution_config.skip_gc_vars = {"f"};
+  Scope scope;
+  InterpreterCore core(place, program.Block(0), &scope, execution_config);
+
+  Scope* local_scope = nullptr;
+  for (int i = 0; i < 4; ++i) {
+    core.Run({"a", "b"}, {tensor_a, tensor_b});
+    local_scope = scope.kids().back();
+    const float* data_f =
+        local_scope->FindVar("f")->Get<phi::DenseTensor>().data<float>();
+    for (int j = 0; j < 4; ++j) {
+      float expected = ((data_a[j] + data_b[j]) * data_b[j] + data_a[j]) *
+                       data_b[j];
+      ASSERT_FLOAT_EQ(data_f[j], expected);
+    }
+  }
+
+  // c and e are never alive at the same time, so they share the same offset
+  // of the arena, while d overlaps both of them.
+  auto DataOf = [local_scope](const std::string& name) {
+    return local_scope->FindVar(name)->Get<phi::DenseTensor>().data();
+  };
+  EXPECT_EQ(DataOf("c"), DataOf("e"));
+  EXPECT_NE(DataOf("c"), DataOf("d"));
+
+  FLAGS_new_executor_static_memory_plan = false;
+}
+
+TEST(InterpreterCore, replay) {
+  FLAGS_new_executor_replay = true;
+
+  // c = a + b, d = c * b
+  ProgramDesc program;
+  BlockDesc* main_block = program.MutableBlock(0);
+  for (auto& name : {"a", "b", "c", "d"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  OpDesc* add = main_block->AppendOp();
+  add->SetType("elementwise_add");
+  add->SetInput("X", {"a"});
+  add->SetInput("Y", {"b"});
+  add->SetOutput("Out", {"c"});
+  OpDesc* mul = main_block->AppendOp();
+  mul->SetType("elementwise_mul");
+  mul->SetInput("X", {"c"});
+  mul->SetInput("Y", {"b"});
+  mul->SetOutput("Out", {"d"});
+
+  const platform::CPUPlace place = platform::CPUPlace();
+  phi::DDim dims = phi::make_ddim({2, 2});
+
+  interpreter::ExecutionConfig execution_config;
+  execution_config.skip_gc_vars = {"d"};
+  Scope scope;
+  InterpreterCore core(place, program.Block(0), &scope, execution_config);
+
+  // The feeds change between runs, while their shapes stay the same.
+  for (int i = 0; i < 4; ++i) {
+    phi::DenseTensor tensor_a;
+    phi::DenseTensor tensor_b;
+    float* data_a = tensor_a.mutable_data<float>(dims, place);
+    float* data_b = tensor_b.mutable_data<float>(dims, place);
+    for (int j = 0; j < 4; ++j) {
+      data_a[j] = static_cast<float>(i + j);
+      data_b[j] = static_cast<float>(i * j);
+    }
+    core.Run({"a", "b"}, {tensor_a, tensor_b});
+
+    const float* data_d = scope.kids()
+                              .back()
+                              ->FindVar("d")
+                              ->Get<phi::DenseTensor>()
+                              .data<float>();
+    for (int j = 0; j < 4; ++j) {
+      ASSERT_FLOAT_EQ(data_d[j], (data_a[j] + data_b[j]) * data_b[j]);
+    }
+
+    // The first run builds the instructions, the second one runs them and
+    // builds the replay list, and the following ones replay it.
+    if (i == 0) {
+      ASSERT_EQ(core.ReplayListSize(), 0UL);
+    } else {
+      ASSERT_EQ(core.ReplayListSize(), 2UL);
+    }
+    ASSERT_EQ(core.ReplayedRunNum(), std::max(i - 1, 0));
+  }
+
+  FLAGS_new_executor_replay = false;
+}
+
+TEST(InterpreterCore, critical_path_scheduling) {
+  FLAGS_new_executor_critical_path_scheduling = true;
+
+  // A chain c = a + b, d = c * b, e = d + a, beside a single f = a * b.
+  ProgramDesc program;
+  BlockDesc* main_block = program.MutableBlock(0);
+  for (auto& name : {"a", "b", "c", "d", "e", "f"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  auto AppendOp = [main_block](const std::string& type,
+                               const std::string& x,
+                               const std::string& y,
+                               const std::string& out) {
+    OpDesc* op = main_block->AppendOp();
+    op->SetType(type);
+    op->SetInput("X", {x});
+    op->SetInput("Y", {y});
+    op->SetOutput("Out", {out});
+  };
+  AppendOp("elementwise_add", "a", "b", "c");
+  AppendOp("elementwise_mul", "c", "b", "d");
+  AppendOp("elementwise_add", "d", "a", "e");
+  AppendOp("elementwise_mul", "a", "b", "f");
+
+  const platform::CPUPlace place = platform::CPUPlace();
+  phi::DDim dims = phi::make_ddim({2, 2});
+  phi::DenseTensor tensor_a;
+  phi::DenseTensor tensor_b;
+  std::fill_n(tensor_a.mutable_data<float>(dims, place), 4, 1.0f);
+  std::fill_n(tensor_b.mutable_data<float>(dims, place), 4, 2.0f);
+
+  Scope scope;
+  InterpreterCore core(
+      place, program.Block(0), &scope, interpreter::ExecutionConfig());
+
+  // Each instruction takes unit cost before measured.
+  core.Run({"a", "b"}, {tensor_a, tensor_b});
+  std::vector<double> unit_cost = {3, 2, 1, 1};
+  EXPECT_EQ(core.CriticalPathCost(), unit_cost);
+
+  core.Run({"a", "b"}, {tensor_a, tensor_b});
+  const std::vector<double>& cost = core.CriticalPathCost();
+  ASSERT_EQ(cost.size(), 4UL);
+  EXPECT_GE(cost[0], cost[1]);
+  EXPECT_GE(cost[1], cost[2]);
+  EXPECT_GT(cost[2], 0.0);
+
+  FLAGS_new_executor_critical_path_scheduling = false;
+}
+
+TEST(InterpreterCore, critical_path_dispatch_order) {
+  FLAGS_new_executor_critical_path_scheduling = true;
+
+  // x = a + b fans out to s, the head of p (a chain of 3 ops) and the head of
+  // q (a chain of 2 ops). s runs next in the same thread, p and q are
+  // dispatched in one batch, p first although q is pushed later.
+  ProgramDesc program;
+  BlockDesc* main_block = program.MutableBlock(0);
+  for (auto& name : {"a", "b", "x", "s", "p0", "p1", "p2", "q0", "q1"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  auto AppendOp = [main_block](const std::string& type,
+                               const std::string& x,
+                               const std::string& y,
+                               const std::string& out) {
+    OpDesc* op = main_block->AppendOp();
+    op->SetType(type);
+    op->SetInput("X", {x});
+    op->SetInput("Y", {y});
+    op->SetOutput("Out", {out});
+  };
+  AppendOp("elementwise_add", "a", "b", "x");
+  AppendOp("elementwise_mul", "x", "b", "s");
+  AppendOp("elementwise_add", "x", "a", "p0");
+  AppendOp("elementwise_mul", "x", "a", "q0");
+  AppendOp("elementwise_mul", "p0", "b", "p1");
+  AppendOp("elementwise_add", "p1", "a", "p2");
+  AppendOp("elementwise_add", "q0", "b", "q1");
+
+  const platform::CPUPlace place = platform::CPUPlace();
+  phi::DDim dims = phi::make_ddim({2, 2});
+  phi::DenseTensor tensor_a;
+  phi::DenseTensor tensor_b;
+  std::fill_n(tensor_a.mutable_data<float>(dims, place), 4, 1.0f);
+  std::fill_n(tensor_b.mutable_data<float>(dims, place), 4, 2.0f);
+
+  // A single host thread runs the ops in the order they are dispatched.
+  interpreter::ExecutionConfig execution_config;
+  execution_config.host_num_threads = 1;
+  execution_config.device_num_threads = 1;
+  Scope scope;
+  InterpreterCore core(place, program.Block(0), &scope, execution_config);
+  std::mutex mutex;
+  std::vector<std::string> run_order;
+  core.SetOutputHooks({[&](OperatorBase* op, Scope*) {
+    std::lock_guard<std::mutex> guard(mutex);
+    run_order.push_back(op->Output("Out"));
+  }});
+
+  // The first run builds the instructions, the second one dispatches them by
+  // the unit costs.
+  core.Run({"a", "b"}, {tensor_a, tensor_b});
+  run_order.clear();
+  core.Run({"a", "b"}, {tensor_a, tensor_b});
+  std::vector<std::string> expected_order = {
+      "x", "s", "p0", "p1", "p2", "q0", "q1"};
+  EXPECT_EQ(run_order, expected_order);
+
+  FLAGS_new_executor_critical_path_scheduling = false;
+}
+
 }  // namespace framework
 }  // namespace paddle